@@ -14,6 +14,7 @@
 // Include files
 // ********************************************************************************
 
+#include <bit>
 #include <climits>
 #include <cstdint>
 #include <numeric>
@@ -51,6 +52,45 @@ static inline std::int32_t nlz(std::uint32_t v) {
   return 1054 - (u.asu64 >> 52); // 1054(=ゲタ(bias)の数+32-1) - vの指数部を返す
 }
 
+/**
+ * @brief  64ビットの符号なし整数vの先頭から続くゼロの数を数える
+ * @note   nlzの倍精度浮動小数点数への変換は仮数部(53ビット)に収まる32ビットまでしか正しく数えられないので、
+ *         64ビットではstd::countl_zero(lzcntかbsrに展開される)を使う
+ * @param  std::uint64_t v 符号なし整数v
+ * @return vの先頭から続くゼロの数(v = 0のとき64)
+ */
+constexpr std::int32_t nlz64(std::uint64_t v) noexcept {
+  return std::countl_zero(v);
+}
+
+/**
+ * @brief  符号なし整数vの末尾から続くゼロの数を数える
+ * @param  std::uint32_t v 符号なし整数v
+ * @return vの末尾から続くゼロの数(v = 0のとき32)
+ */
+constexpr std::int32_t ntz(std::uint32_t v) noexcept {
+  return std::countr_zero(v);
+}
+
+/**
+ * @brief  64ビットの符号なし整数vの末尾から続くゼロの数を数える
+ * @note   最下位の1のビットの位置になる(tzcntかbsfに展開される)
+ * @param  std::uint64_t v 符号なし整数v
+ * @return vの末尾から続くゼロの数(v = 0のとき64)
+ */
+constexpr std::int32_t ntz64(std::uint64_t v) noexcept {
+  return std::countr_zero(v);
+}
+
+/**
+ * @brief  64ビットの符号なし整数vの1のビットの数を数える
+ * @param  std::uint64_t v 符号なし整数v
+ * @return vの1のビットの数
+ */
+constexpr std::int32_t pop64(std::uint64_t v) noexcept {
+  return std::popcount(v);
+}
+
 /**
  * @brief In left rotation, the bits that fall off at left end are put back at
  * right end.
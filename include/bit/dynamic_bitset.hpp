@@ -0,0 +1,357 @@
+/**
+ * @brief  実行時に大きさを決めるビット集合
+ * @note   64ビットの語の配列にビットを詰め、論理積・論理和・排他的論理和・ビット数の計数を語単位で並列に行う
+ *         AVX2(__AVX2__)が使えるときは256ビット(4語)ずつ処理し、ビット数の計数には
+ *         4ビットごとの表引き(vpshufb)とvpsadbwによる足し合わせを使う(Muła, Kurz, Lemire)
+ * @note   末尾の語のsize()以降のビットは常に0に保つ. 2項演算は同じ大きさのビット集合どうしでのみ行う
+ * @note   プールの使用中の印、変更のあった要素の印(dirty)、可視集合の積などに使う
+ */
+
+#ifndef DYNAMIC_BITSET_HPP
+#define DYNAMIC_BITSET_HPP
+
+#include "bit/bit.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace bit {
+
+namespace impl {
+
+/**< @brief 語ごとの論理積 */
+struct and_op {
+  std::uint64_t operator()(std::uint64_t x, std::uint64_t y) const noexcept {
+    return x & y;
+  }
+#if defined(__AVX2__)
+  __m256i operator()(__m256i x, __m256i y) const noexcept {
+    return _mm256_and_si256(x, y);
+  }
+#endif
+};
+
+/**< @brief 語ごとの論理和 */
+struct or_op {
+  std::uint64_t operator()(std::uint64_t x, std::uint64_t y) const noexcept {
+    return x | y;
+  }
+#if defined(__AVX2__)
+  __m256i operator()(__m256i x, __m256i y) const noexcept {
+    return _mm256_or_si256(x, y);
+  }
+#endif
+};
+
+/**< @brief 語ごとの排他的論理和 */
+struct xor_op {
+  std::uint64_t operator()(std::uint64_t x, std::uint64_t y) const noexcept {
+    return x ^ y;
+  }
+#if defined(__AVX2__)
+  __m256i operator()(__m256i x, __m256i y) const noexcept {
+    return _mm256_xor_si256(x, y);
+  }
+#endif
+};
+
+/**< @brief 語ごとの差(x & ~y) */
+struct and_not_op {
+  std::uint64_t operator()(std::uint64_t x, std::uint64_t y) const noexcept {
+    return x & ~y;
+  }
+#if defined(__AVX2__)
+  __m256i operator()(__m256i x, __m256i y) const noexcept {
+    return _mm256_andnot_si256(y, x);
+  }
+#endif
+};
+
+/**< @brief 語ごとにyを選ぶ(計数で片方だけを数えるときに使う) */
+struct second_op {
+  std::uint64_t operator()(std::uint64_t, std::uint64_t y) const noexcept {
+    return y;
+  }
+#if defined(__AVX2__)
+  __m256i operator()(__m256i, __m256i y) const noexcept { return y; }
+#endif
+};
+
+/**< @brief x[i] = op(x[i], y[i])をn語について行う */
+template <class Op>
+void transform_words(std::uint64_t *x, const std::uint64_t *y, std::size_t n,
+                     Op op) noexcept {
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(x + i), op(a, b));
+  }
+#endif
+  for (; i < n; i++) {
+    x[i] = op(x[i], y[i]);
+  }
+}
+
+#if defined(__AVX2__)
+/**< @brief 各バイトの1のビットの数を4ビットごとの表引きで求める */
+inline __m256i popcount_bytes(__m256i v) noexcept {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                       1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0f);
+  const __m256i lo = _mm256_and_si256(v, low);
+  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+  return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                         _mm256_shuffle_epi8(lookup, hi));
+}
+#endif
+
+/**< @brief op(x[i], y[i])の1のビットの数をn語について足し合わせる */
+template <class Op>
+std::size_t count_words(const std::uint64_t *x, const std::uint64_t *y,
+                        std::size_t n, Op op) noexcept {
+  std::size_t i = 0, c = 0;
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+    acc = _mm256_add_epi64(
+        acc, _mm256_sad_epu8(popcount_bytes(op(a, b)), _mm256_setzero_si256()));
+  }
+  c += static_cast<std::size_t>(_mm256_extract_epi64(acc, 0)) +
+       static_cast<std::size_t>(_mm256_extract_epi64(acc, 1)) +
+       static_cast<std::size_t>(_mm256_extract_epi64(acc, 2)) +
+       static_cast<std::size_t>(_mm256_extract_epi64(acc, 3));
+#endif
+  for (; i < n; i++) {
+    c += pop64(op(x[i], y[i]));
+  }
+  return c;
+}
+
+} // namespace impl
+
+/**
+ * @brief  実行時に大きさを決めるビット集合
+ * @tparam Allocator アロケータの型(std::uint64_tへrebindして使う)
+ */
+template <class Allocator =
+              boost::container::pmr::polymorphic_allocator<std::uint64_t>>
+class dynamic_bitset {
+  using word_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::uint64_t>;
+
+public:
+  /**
+   * @param std::size_t n       ビット数
+   * @param bool value          全てのビットの初期値
+   * @param const Allocator& a  アロケータ
+   */
+  explicit dynamic_bitset(std::size_t n = 0, bool value = false,
+                          const Allocator &a = Allocator())
+      : words_(word_alloc(a)) {
+    resize(n, value);
+  }
+
+  /**< @brief ビット数を返す */
+  std::size_t size() const noexcept { return n_; }
+  /**< @brief 語の数を返す */
+  std::size_t num_words() const noexcept { return words_.size(); }
+  /**< @brief 語の配列を返す */
+  const std::uint64_t *data() const noexcept { return words_.data(); }
+
+  /**< @brief i番目のビットを返す */
+  bool test(std::size_t i) const noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    return (words_[i >> 6] >> (i & 63)) & 1;
+  }
+  bool operator[](std::size_t i) const noexcept { return test(i); }
+
+  /**< @brief i番目のビットを1にする */
+  dynamic_bitset &set(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    words_[i >> 6] |= std::uint64_t{1} << (i & 63);
+    return *this;
+  }
+  /**< @brief i番目のビットをvalueにする */
+  dynamic_bitset &set(std::size_t i, bool value) noexcept {
+    return value ? set(i) : reset(i);
+  }
+  /**< @brief i番目のビットを0にする */
+  dynamic_bitset &reset(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    words_[i >> 6] &= ~(std::uint64_t{1} << (i & 63));
+    return *this;
+  }
+  /**< @brief i番目のビットを反転する */
+  dynamic_bitset &flip(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    words_[i >> 6] ^= std::uint64_t{1} << (i & 63);
+    return *this;
+  }
+
+  /**< @brief 全てのビットを1にする */
+  dynamic_bitset &set() noexcept {
+    std::fill(words_.begin(), words_.end(), ~std::uint64_t{0});
+    clear_tail();
+    return *this;
+  }
+  /**< @brief 全てのビットを0にする */
+  dynamic_bitset &reset() noexcept {
+    std::fill(words_.begin(), words_.end(), 0);
+    return *this;
+  }
+  /**< @brief 全てのビットを反転する */
+  dynamic_bitset &flip() noexcept {
+    for (std::uint64_t &w : words_) {
+      w = ~w;
+    }
+    clear_tail();
+    return *this;
+  }
+
+  /**< @brief ビット数をnにする. 増えたビットはvalueにする */
+  void resize(std::size_t n, bool value = false) {
+    const std::size_t old = n_;
+    words_.resize((n + 63) >> 6, value ? ~std::uint64_t{0} : 0);
+    n_ = n;
+    if (value && old < n && (old & 63) != 0) { // 元の末尾の語の残りを埋める
+      words_[old >> 6] |= ~std::uint64_t{0} << (old & 63);
+    }
+    clear_tail();
+  }
+
+  /**< @brief 1のビットの数を返す */
+  std::size_t count() const noexcept {
+    return impl::count_words(words_.data(), words_.data(), words_.size(),
+                             impl::second_op());
+  }
+  /**< @brief xとの共通部分の1のビットの数を返す(共通部分を作らずに数える) */
+  std::size_t count_and(const dynamic_bitset &x) const noexcept {
+    BOOST_ASSERT_MSG(n_ == x.n_, "Bitset size mismatch.");
+    return impl::count_words(words_.data(), x.words_.data(), words_.size(),
+                             impl::and_op());
+  }
+  /**< @brief xと共通の1のビットがあるかどうか返す */
+  bool intersects(const dynamic_bitset &x) const noexcept {
+    BOOST_ASSERT_MSG(n_ == x.n_, "Bitset size mismatch.");
+    for (std::size_t i = 0; i < words_.size(); i++) {
+      if ((words_[i] & x.words_[i]) != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  /**< @brief 1のビットがあるかどうか返す */
+  bool any() const noexcept {
+    return std::any_of(words_.begin(), words_.end(),
+                       [](std::uint64_t w) { return w != 0; });
+  }
+  /**< @brief 1のビットがないかどうか返す */
+  bool none() const noexcept { return !any(); }
+  /**< @brief 全てのビットが1かどうか返す */
+  bool all() const noexcept { return count() == n_; }
+
+  dynamic_bitset &operator&=(const dynamic_bitset &x) noexcept {
+    return apply(x, impl::and_op());
+  }
+  dynamic_bitset &operator|=(const dynamic_bitset &x) noexcept {
+    return apply(x, impl::or_op());
+  }
+  dynamic_bitset &operator^=(const dynamic_bitset &x) noexcept {
+    return apply(x, impl::xor_op());
+  }
+  /**< @brief 差集合(*this & ~x)にする */
+  dynamic_bitset &operator-=(const dynamic_bitset &x) noexcept {
+    return apply(x, impl::and_not_op());
+  }
+
+  friend dynamic_bitset operator&(dynamic_bitset x, const dynamic_bitset &y) {
+    return x &= y;
+  }
+  friend dynamic_bitset operator|(dynamic_bitset x, const dynamic_bitset &y) {
+    return x |= y;
+  }
+  friend dynamic_bitset operator^(dynamic_bitset x, const dynamic_bitset &y) {
+    return x ^= y;
+  }
+  friend dynamic_bitset operator-(dynamic_bitset x, const dynamic_bitset &y) {
+    return x -= y;
+  }
+  friend bool operator==(const dynamic_bitset &x,
+                         const dynamic_bitset &y) noexcept {
+    return x.n_ == y.n_ && std::equal(x.words_.begin(), x.words_.end(),
+                                      y.words_.begin());
+  }
+
+  /**< @brief 最初の1のビットの位置を返す(無ければstd::nullopt) */
+  std::optional<std::size_t> find_first() const noexcept {
+    return find_next(0);
+  }
+
+  /**< @brief i番目以降で最初の1のビットの位置を返す(無ければstd::nullopt) */
+  std::optional<std::size_t> find_next(std::size_t i) const noexcept {
+    if (i >= n_) {
+      return std::nullopt;
+    }
+    std::size_t wi = i >> 6;
+    std::uint64_t w = words_[wi] & (~std::uint64_t{0} << (i & 63));
+    while (w == 0) {
+      if (++wi == words_.size()) {
+        return std::nullopt;
+      }
+      w = words_[wi];
+    }
+    return (wi << 6) + ntz64(w);
+  }
+
+  /**
+   * @brief  1のビットの位置を昇順に巡回する
+   * @tparam class F std::size_tを引数に取る関数オブジェクトの型
+   */
+  template <class F> void for_each(F fn) const {
+    for (std::size_t wi = 0; wi < words_.size(); wi++) {
+      for (std::uint64_t w = words_[wi]; w != 0; w &= w - 1) {
+        fn((wi << 6) + ntz64(w));
+      }
+    }
+  }
+
+private:
+  template <class Op>
+  dynamic_bitset &apply(const dynamic_bitset &x, Op op) noexcept {
+    BOOST_ASSERT_MSG(n_ == x.n_, "Bitset size mismatch.");
+    impl::transform_words(words_.data(), x.words_.data(), words_.size(), op);
+    return *this;
+  }
+
+  /**< @brief 末尾の語のsize()以降のビットを0にする */
+  void clear_tail() noexcept {
+    if ((n_ & 63) != 0) {
+      words_.back() &= (std::uint64_t{1} << (n_ & 63)) - 1;
+    }
+  }
+
+  std::vector<std::uint64_t, word_alloc> words_; /**< 語の配列 */
+  std::size_t n_ = 0;                            /**< ビット数 */
+};
+
+} // namespace bit
+
+#endif // end of DYNAMIC_BITSET_HPP
@@ -0,0 +1,309 @@
+/**
+ * @brief  階層ビットマップ
+ * @note   最下段は各ビットをそのまま持ち、上の段の各ビットは直下の段の64ビットの語が0でないかどうかを表す
+ *         最上段が1語に収まるまで段を重ねるので、段の数はlog64(n)(nが26万までなら3段)になる
+ * @note   最初の1のビットは最上段からntz64で1の位置を辿って降りるだけで見つかり、計算量はΟ(段の数)である
+ *         ビットの変更も語が0になる・0でなくなるときだけ上の段へ伝えればよいので、最悪でもΟ(段の数)で済む
+ * @note   bitmap_allocatorは空き番号を1のビットで表し、最も小さい空き番号から割り当てる
+ *         自由リストと違って割り当てる番号が小さい方に詰まるので、プールの先頭側に要素が集まる
+ */
+
+#ifndef HIERARCHICAL_BITMAP_HPP
+#define HIERARCHICAL_BITMAP_HPP
+
+#include "bit/bit.hpp"
+#include <algorithm>
+#include <array>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace bit {
+
+/**
+ * @brief  階層ビットマップ
+ * @tparam Allocator アロケータの型(std::uint64_tへrebindして使う)
+ */
+template <class Allocator =
+              boost::container::pmr::polymorphic_allocator<std::uint64_t>>
+class hierarchical_bitmap {
+  using word_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::uint64_t>;
+  static constexpr std::size_t max_levels = 6; /**< 64^6 = 2^36ビットまで */
+
+public:
+  /**
+   * @param std::size_t n       ビット数
+   * @param bool value          全てのビットの初期値
+   * @param const Allocator& a  アロケータ
+   */
+  explicit hierarchical_bitmap(std::size_t n = 0, bool value = false,
+                               const Allocator &a = Allocator())
+      : words_(word_alloc(a)) {
+    resize(n, value);
+  }
+
+  /**< @brief ビット数を返す */
+  std::size_t size() const noexcept { return n_; }
+  /**< @brief 段の数を返す */
+  std::size_t levels() const noexcept { return levels_; }
+  /**< @brief 1のビットの数を返す */
+  std::size_t count() const noexcept { return count_; }
+  /**< @brief 1のビットがあるかどうか返す */
+  bool any() const noexcept { return count_ != 0; }
+  /**< @brief 1のビットがないかどうか返す */
+  bool none() const noexcept { return count_ == 0; }
+
+  /**< @brief i番目のビットを返す */
+  bool test(std::size_t i) const noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    return (words_[i >> 6] >> (i & 63)) & 1;
+  }
+
+  /**< @brief i番目のビットを1にする. 計算量はΟ(段の数) */
+  void set(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    for (std::size_t l = 0; l < levels_; l++) {
+      std::uint64_t &w = words_[offset_[l] + (i >> 6)];
+      const std::uint64_t old = w;
+      w |= std::uint64_t{1} << (i & 63);
+      if (l == 0 && old != w) {
+        count_++;
+      }
+      if (old != 0) { // 上の段は既に1になっている
+        break;
+      }
+      i >>= 6;
+    }
+  }
+
+  /**< @brief i番目のビットを0にする. 計算量はΟ(段の数) */
+  void reset(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Bit index out of range.");
+    for (std::size_t l = 0; l < levels_; l++) {
+      std::uint64_t &w = words_[offset_[l] + (i >> 6)];
+      const std::uint64_t old = w;
+      w &= ~(std::uint64_t{1} << (i & 63));
+      if (l == 0 && old != w) {
+        count_--;
+      }
+      if (w != 0 || old == 0) { // 語が0になったときだけ上の段へ伝える
+        break;
+      }
+      i >>= 6;
+    }
+  }
+
+  /**< @brief i番目のビットをvalueにする */
+  void assign(std::size_t i, bool value) noexcept {
+    value ? set(i) : reset(i);
+  }
+
+  /**< @brief 全てのビットを1にする */
+  void set() noexcept { fill(true); }
+  /**< @brief 全てのビットを0にする */
+  void reset() noexcept { fill(false); }
+
+  /**
+   * @brief  最初の1のビットの位置を返す. 計算量はΟ(段の数)
+   * @return 1のビットの位置(無ければstd::nullopt)
+   */
+  std::optional<std::size_t> find_first() const noexcept {
+    if (count_ == 0) {
+      return std::nullopt;
+    }
+    std::size_t pos = 0;
+    for (std::size_t l = levels_; l-- > 0;) {
+      pos = (pos << 6) + ntz64(words_[offset_[l] + pos]);
+    }
+    return pos;
+  }
+
+  /**
+   * @brief  i番目以降で最初の1のビットの位置を返す. 計算量はΟ(段の数)
+   * @note   その段の語に無ければ上の段へ上がって次の0でない語を探し、見つかった語から降りる
+   * @return 1のビットの位置(無ければstd::nullopt)
+   */
+  std::optional<std::size_t> find_next(std::size_t i) const noexcept {
+    if (i >= n_) {
+      return std::nullopt;
+    }
+    std::size_t pos = i;
+    for (std::size_t l = 0; l < levels_; l++) {
+      const std::size_t wi = pos >> 6;
+      const std::uint64_t w =
+          words_[offset_[l] + wi] & (~std::uint64_t{0} << (pos & 63));
+      if (w != 0) {
+        pos = (wi << 6) + ntz64(w);
+        while (l-- > 0) {
+          pos = (pos << 6) + ntz64(words_[offset_[l] + pos]);
+        }
+        return pos;
+      }
+      pos = wi + 1; // 上の段での次の語の位置
+      if (pos >= offset_[l + 1] - offset_[l]) {
+        return std::nullopt;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief  1のビットの位置を昇順に巡回する
+   * @tparam class F std::size_tを引数に取る関数オブジェクトの型
+   */
+  template <class F> void for_each(F fn) const {
+    const std::size_t m = offset_[1];
+    for (std::size_t wi = 0; wi < m; wi++) {
+      for (std::uint64_t w = words_[wi]; w != 0; w &= w - 1) {
+        fn((wi << 6) + ntz64(w));
+      }
+    }
+  }
+
+  /**
+   * @brief ビット数をnにする. 増えたビットはvalueにする
+   * @note  段の構成が変わるので、上の段は最下段から作り直す. 計算量はΟ(n/64)
+   */
+  void resize(std::size_t n, bool value = false) {
+    const std::size_t old = n_;
+    std::vector<std::uint64_t, word_alloc> bottom(words_.get_allocator());
+    bottom.assign(words_.begin(), words_.begin() + offset_[1]);
+    layout(n);
+    std::copy(bottom.begin(),
+              bottom.begin() + std::min(bottom.size(), offset_[1]),
+              words_.begin());
+    if (n < old) {
+      clear_tail();
+    } else if (value) {
+      for (std::size_t i = old; i < n && (i & 63) != 0; i++) {
+        words_[i >> 6] |= std::uint64_t{1} << (i & 63);
+      }
+      for (std::size_t wi = (old + 63) >> 6; wi < offset_[1]; wi++) {
+        words_[wi] = ~std::uint64_t{0};
+      }
+      clear_tail();
+    }
+    rebuild();
+  }
+
+private:
+  /**< @brief n個のビットを持つ段の構成にする(全ての語は0になる) */
+  void layout(std::size_t n) {
+    n_ = n;
+    levels_ = 0;
+    offset_[0] = 0;
+    std::size_t words = (std::max<std::size_t>(n, 1) + 63) >> 6;
+    for (;;) {
+      BOOST_ASSERT_MSG(levels_ < max_levels, "Too many bits.");
+      offset_[levels_ + 1] = offset_[levels_] + words;
+      levels_++;
+      if (words == 1) {
+        break;
+      }
+      words = (words + 63) >> 6;
+    }
+    words_.assign(offset_[levels_], 0);
+  }
+
+  /**< @brief 最下段の末尾のn番目以降のビットを0にする */
+  void clear_tail() noexcept {
+    if ((n_ & 63) != 0) {
+      words_[n_ >> 6] &= (std::uint64_t{1} << (n_ & 63)) - 1;
+    }
+    for (std::size_t wi = (n_ + 63) >> 6; wi < offset_[1]; wi++) {
+      words_[wi] = 0;
+    }
+  }
+
+  /**< @brief 最下段から上の段と1のビットの数を作り直す */
+  void rebuild() noexcept {
+    count_ = 0;
+    for (std::size_t wi = 0; wi < offset_[1]; wi++) {
+      count_ += pop64(words_[wi]);
+    }
+    for (std::size_t l = 1; l < levels_; l++) {
+      std::fill(words_.begin() + offset_[l], words_.begin() + offset_[l + 1],
+                0);
+      for (std::size_t wi = offset_[l - 1]; wi < offset_[l]; wi++) {
+        if (words_[wi] != 0) {
+          const std::size_t j = wi - offset_[l - 1];
+          words_[offset_[l] + (j >> 6)] |= std::uint64_t{1} << (j & 63);
+        }
+      }
+    }
+  }
+
+  /**< @brief 最下段を全てvalueにする */
+  void fill(bool value) noexcept {
+    std::fill(words_.begin(), words_.begin() + offset_[1],
+              value ? ~std::uint64_t{0} : 0);
+    clear_tail();
+    rebuild();
+  }
+
+  std::vector<std::uint64_t, word_alloc> words_;     /**< 全ての段の語(最下段から順に並べる) */
+  std::array<std::size_t, max_levels + 1> offset_{}; /**< 各段の先頭の語の位置 */
+  std::size_t levels_ = 0;                           /**< 段の数 */
+  std::size_t n_ = 0;                                /**< ビット数 */
+  std::size_t count_ = 0;                            /**< 1のビットの数 */
+};
+
+/**
+ * @brief  階層ビットマップで空き番号を管理する番号の割り当て器
+ * @tparam Allocator アロケータの型
+ */
+template <class Allocator =
+              boost::container::pmr::polymorphic_allocator<std::uint64_t>>
+class bitmap_allocator {
+public:
+  /**< @brief 0〜n-1の番号を全て空きにする */
+  explicit bitmap_allocator(std::size_t n = 0,
+                            const Allocator &a = Allocator())
+      : free_(n, true, a) {}
+
+  /**
+   * @brief  最も小さい空き番号を割り当てる. 計算量はΟ(段の数)
+   * @return 割り当てた番号(空きが無ければstd::nullopt)
+   */
+  std::optional<std::size_t> allocate() noexcept {
+    const std::optional<std::size_t> i = free_.find_first();
+    if (i) {
+      free_.reset(*i);
+    }
+    return i;
+  }
+
+  /**< @brief 番号iを空きに戻す. 計算量はΟ(段の数) */
+  void deallocate(std::size_t i) noexcept {
+    BOOST_ASSERT_MSG(!free_.test(i), "Double free.");
+    free_.set(i);
+  }
+
+  /**< @brief 番号iが割り当て済みかどうか返す */
+  bool allocated(std::size_t i) const noexcept { return !free_.test(i); }
+
+  /**< @brief 番号の数をnに増やす(増えた番号は空きになる) */
+  void grow(std::size_t n) {
+    BOOST_ASSERT_MSG(n >= free_.size(), "bitmap_allocator cannot shrink.");
+    free_.resize(n, true);
+  }
+
+  /**< @brief 番号の数を返す */
+  std::size_t capacity() const noexcept { return free_.size(); }
+  /**< @brief 割り当て済みの番号の数を返す */
+  std::size_t live() const noexcept { return free_.size() - free_.count(); }
+  /**< @brief 空き番号の数を返す */
+  std::size_t free() const noexcept { return free_.count(); }
+
+private:
+  hierarchical_bitmap<Allocator> free_; /**< 空き番号を1で表すビットマップ */
+};
+
+} // namespace bit
+
+#endif // end of HIERARCHICAL_BITMAP_HPP
@@ -0,0 +1,223 @@
+/**
+ * @brief  空間索引に共通する軸平行境界箱(AABB)と問い合わせの部品
+ * @note   spatial_hash_gridとaabb_treeが使う. 次元Dは2(平面)か3(空間)を想定し、座標はfloatで持つ
+ * @note   レイとの交差はスラブ法で求める. 方向の逆数を先に求めておき、軸ごとの出入りの距離の最大・最小を取る
+ */
+
+#ifndef AABB_HPP
+#define AABB_HPP
+
+#include "task_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace container {
+
+/**< @brief D次元のベクトル */
+template <std::size_t D> using vec = std::array<float, D>;
+
+/**
+ * @brief  D次元の軸平行境界箱
+ * @tparam D 次元
+ */
+template <std::size_t D> struct aabb {
+  vec<D> lo; /**< 最小の角 */
+  vec<D> hi; /**< 最大の角 */
+
+  /**< @brief 空の箱(どの箱とmergeしても相手になる)を返す */
+  static constexpr aabb empty() noexcept {
+    aabb b;
+    b.lo.fill(std::numeric_limits<float>::max());
+    b.hi.fill(std::numeric_limits<float>::lowest());
+    return b;
+  }
+
+  /**< @brief 箱xと重なるかどうか返す(接する場合を含む) */
+  constexpr bool overlaps(const aabb &x) const noexcept {
+    for (std::size_t d = 0; d < D; d++) {
+      if (hi[d] < x.lo[d] || x.hi[d] < lo[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**< @brief 箱xを含むかどうか返す */
+  constexpr bool contains(const aabb &x) const noexcept {
+    for (std::size_t d = 0; d < D; d++) {
+      if (x.lo[d] < lo[d] || hi[d] < x.hi[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**< @brief 箱xとの和(両方を含む最小の箱)を返す */
+  constexpr aabb merge(const aabb &x) const noexcept {
+    aabb b;
+    for (std::size_t d = 0; d < D; d++) {
+      b.lo[d] = std::min(lo[d], x.lo[d]);
+      b.hi[d] = std::max(hi[d], x.hi[d]);
+    }
+    return b;
+  }
+
+  /**< @brief 箱xとの共通部分を返す(重なることが分かっているときに使う) */
+  constexpr aabb intersect(const aabb &x) const noexcept {
+    aabb b;
+    for (std::size_t d = 0; d < D; d++) {
+      b.lo[d] = std::max(lo[d], x.lo[d]);
+      b.hi[d] = std::min(hi[d], x.hi[d]);
+    }
+    return b;
+  }
+
+  /**< @brief 各辺をmだけ広げた箱を返す */
+  constexpr aabb expanded(float m) const noexcept {
+    aabb b;
+    for (std::size_t d = 0; d < D; d++) {
+      b.lo[d] = lo[d] - m;
+      b.hi[d] = hi[d] + m;
+    }
+    return b;
+  }
+
+  /**< @brief 表面積(2次元では周長)を返す. SAHの費用に使う */
+  constexpr float area() const noexcept {
+    if constexpr (D == 2) {
+      return 2 * ((hi[0] - lo[0]) + (hi[1] - lo[1]));
+    } else {
+      float s = 0;
+      for (std::size_t d = 0; d < D; d++) {
+        float p = 1;
+        for (std::size_t e = 0; e < D; e++) {
+          p *= e == d ? 1 : hi[e] - lo[e];
+        }
+        s += p;
+      }
+      return 2 * s;
+    }
+  }
+
+  /**< @brief 点cとの距離の2乗を返す(cが箱の中なら0) */
+  constexpr float distance2(const vec<D> &c) const noexcept {
+    float s = 0;
+    for (std::size_t d = 0; d < D; d++) {
+      const float v = std::max({lo[d] - c[d], 0.0f, c[d] - hi[d]});
+      s += v * v;
+    }
+    return s;
+  }
+};
+
+/**< @brief レイ(始点と、方向の逆数を先に求めたもの) */
+template <std::size_t D> struct ray {
+  vec<D> origin;  /**< 始点 */
+  vec<D> dir;     /**< 方向 */
+  vec<D> inv_dir; /**< 方向の逆数 */
+  float tmax;     /**< 調べる距離の上限(dirの長さを単位とする) */
+
+  ray(const vec<D> &o, const vec<D> &d, float t) noexcept
+      : origin(o), dir(d), tmax(t) {
+    for (std::size_t i = 0; i < D; i++) {
+      inv_dir[i] = 1.0f / d[i]; // 0の成分は±∞になり、スラブ法はそのまま働く
+    }
+  }
+
+  /**
+   * @brief  箱bとの交差をスラブ法で求める
+   * @return 箱に入る距離(tmax以内で交わらなければstd::nullopt)
+   */
+  std::optional<float> intersect(const aabb<D> &b) const noexcept {
+    float t0 = 0, t1 = tmax;
+    for (std::size_t d = 0; d < D; d++) {
+      float a = (b.lo[d] - origin[d]) * inv_dir[d];
+      float c = (b.hi[d] - origin[d]) * inv_dir[d];
+      if (a > c) {
+        std::swap(a, c);
+      }
+      t0 = std::max(t0, a); // NaN(0 * ∞)は比較で捨てられる
+      t1 = std::min(t1, c);
+    }
+    return t0 <= t1 ? std::make_optional(t0) : std::nullopt;
+  }
+};
+
+/**< @brief レイの交差の結果 */
+struct ray_hit {
+  std::uint32_t id; /**< 交わった物体の番号 */
+  float t;          /**< 交わった距離 */
+};
+
+/**< @brief 重なりを持つ物体の番号の組 */
+using overlap_pair = std::pair<std::uint32_t, std::uint32_t>;
+
+namespace impl {
+
+/**< @brief 並列に処理するタスクの数を返す(threadsが0のとき既定のタスクプールのワーカー数) */
+inline unsigned task_count(unsigned threads) {
+  return threads != 0
+             ? threads
+             : static_cast<unsigned>(container::default_task_pool().size());
+}
+
+/**
+ * @brief  [0, n)をchunk個ずつに分け、既定のタスクプールでthreads個のタスクからfn(begin, end, worker)を呼ぶ
+ * @note   タスクはチャンクを1つずつ取るので、チャンクの重さが偏っていても負荷が散る
+ *         workerはタスクの番号[0, task_count(threads))で、同じ番号のタスクが同時に走ることはない
+ *         呼び出しごとにスレッドを作らず、プールのワーカーを使い回す
+ */
+template <class F>
+void parallel_chunks(std::size_t n, std::size_t chunk, unsigned threads,
+                     F fn) {
+  const std::size_t chunks = (n + chunk - 1) / chunk;
+  const unsigned tasks = static_cast<unsigned>(std::min<std::size_t>(
+      task_count(threads), std::max<std::size_t>(chunks, 1)));
+  std::atomic<std::size_t> next = 0;
+  auto work = [&](unsigned worker) {
+    for (std::size_t c; (c = next.fetch_add(1)) < chunks;) {
+      fn(c * chunk, std::min(n, (c + 1) * chunk), worker);
+    }
+  };
+  if (tasks == 1) {
+    work(0);
+    return;
+  }
+  container::task_pool &pool = container::default_task_pool();
+  pool.run([&] {
+    container::task_group g;
+    for (unsigned t = 1; t < tasks; t++) {
+      pool.spawn(g, [&work, t] { work(t); });
+    }
+    work(0);
+    pool.wait(g);
+  });
+}
+
+/**< @brief スレッドごとに集めた組を1本にまとめる */
+inline std::vector<overlap_pair>
+concat(std::vector<std::vector<overlap_pair>> &parts) {
+  std::size_t n = 0;
+  for (const auto &p : parts) {
+    n += p.size();
+  }
+  std::vector<overlap_pair> out;
+  out.reserve(n);
+  for (const auto &p : parts) {
+    out.insert(out.end(), p.begin(), p.end());
+  }
+  return out;
+}
+
+} // namespace impl
+
+} // namespace container
+
+#endif // end of AABB_HPP
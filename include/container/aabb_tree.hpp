@@ -0,0 +1,537 @@
+/**
+ * @brief  動的AABB木による空間索引(ブロードフェーズ)
+ * @note   葉に物体の箱を、内部節点に子の箱の和を持つ2分木. 葉の箱は余白marginだけ広げた箱(fat AABB)にしておき、
+ *         物体が動いても広げた箱からはみ出さない限り木を変更しない
+ * @note   挿入は根から、兄弟にしたときの表面積の増分(SAH: surface area heuristic)の小さい側へ降りて兄弟を決める
+ *         挿入と削除の後は根へ向かって箱を直しながら、各節点で子と孫を入れ替える回転のうち
+ *         子の箱の表面積を最も減らすものを行い、木の質を保つ
+ * @note   節点は配列に置き、32ビットの添字で指す. 空いた節点は自由リストで再利用する
+ */
+
+#ifndef AABB_TREE_HPP
+#define AABB_TREE_HPP
+
+#include "aabb.hpp"
+#include <algorithm>
+#include <array>
+#include <boost/assert.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace container {
+
+namespace impl {
+
+/**< @brief 辿る節点のスタック(深さ64までは配列に置き、それを超えた分だけ動的に確保する) */
+class node_stack {
+public:
+  explicit node_stack(std::uint32_t x) noexcept { push(x); }
+
+  bool empty() const noexcept { return n_ == 0; }
+  void push(std::uint32_t x) {
+    if (n_ < buf_.size()) {
+      buf_[n_] = x;
+    } else {
+      spill_.push_back(x);
+    }
+    n_++;
+  }
+  std::uint32_t pop() noexcept {
+    if (--n_ < buf_.size()) {
+      return buf_[n_];
+    }
+    const std::uint32_t x = spill_.back();
+    spill_.pop_back();
+    return x;
+  }
+
+private:
+  std::array<std::uint32_t, 64> buf_;
+  std::vector<std::uint32_t> spill_;
+  std::size_t n_ = 0;
+};
+
+} // namespace impl
+
+/**
+ * @brief  動的AABB木
+ * @tparam D 次元
+ */
+template <std::size_t D> class aabb_tree {
+  static constexpr std::uint32_t nil =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /**< @brief 節点 */
+  struct node {
+    aabb<D> b;              /**< 箱(葉では広げた箱、内部節点では子の箱の和) */
+    std::uint32_t parent;   /**< 親(空きのときは自由リストの次) */
+    std::uint32_t child[2]; /**< 子(葉ではNIL) */
+    std::uint32_t height;   /**< 高さ(葉は0) */
+    std::uint32_t id;       /**< 物体の番号(葉のみ) */
+    bool leaf() const noexcept { return child[0] == nil; }
+  };
+
+public:
+  using box = aabb<D>;
+  using proxy = std::uint32_t; /**< 葉を指す添字 */
+
+  /**< @brief 全ての重なりの組を求めるときに1つのスレッドが一度に調べる葉の数 */
+  static constexpr std::size_t chunk_leaves = 256;
+
+  /**
+   * @param float margin  葉の箱を広げる余白
+   * @param float predict move()で変位をこの倍率だけ先読みして箱を広げる
+   */
+  explicit aabb_tree(float margin = 0.1f, float predict = 2.0f) noexcept
+      : margin_(margin), predict_(predict) {}
+
+  /**< @brief 葉の数を返す */
+  std::size_t size() const noexcept { return leaves_; }
+  /**< @brief 木の高さを返す(空のとき0) */
+  std::size_t height() const noexcept {
+    return root_ == nil ? 0 : nodes_[root_].height;
+  }
+  /**< @brief 物体の番号を返す */
+  std::uint32_t id(proxy p) const noexcept { return nodes_[p].id; }
+  /**< @brief 物体の箱を返す */
+  const box &tight_box(proxy p) const noexcept { return tight_[p]; }
+  /**< @brief 広げた箱を返す */
+  const box &fat_box(proxy p) const noexcept { return nodes_[p].b; }
+
+  /**
+   * @brief 内部節点の表面積の和を根の表面積で割った値を返す
+   * @note  問い合わせで訪れる節点数の目安(SAHの費用)で、小さいほど木の質が良い
+   */
+  float cost() const {
+    if (root_ == nil) {
+      return 0;
+    }
+    float s = 0;
+    for_each_node([&](std::uint32_t i) {
+      if (!nodes_[i].leaf()) {
+        s += nodes_[i].b.area();
+      }
+    });
+    return s / nodes_[root_].b.area();
+  }
+
+  /**
+   * @brief  箱bの物体idを挿入する. 計算量はΟ(木の高さ)
+   * @return 葉を指す添字(move, removeに使う)
+   */
+  proxy insert(const box &b, std::uint32_t id) {
+    const std::uint32_t leaf = allocate();
+    nodes_[leaf].b = b.expanded(margin_);
+    nodes_[leaf].id = id;
+    tight_[leaf] = b;
+    insert_leaf(leaf);
+    leaves_++;
+    return leaf;
+  }
+
+  /**< @brief 葉pを削除する. 計算量はΟ(木の高さ) */
+  void remove(proxy p) {
+    BOOST_ASSERT_MSG(p < nodes_.size() && nodes_[p].leaf(), "Bad proxy.");
+    remove_leaf(p);
+    deallocate(p);
+    leaves_--;
+  }
+
+  /**
+   * @brief  葉pの物体の箱をbにする
+   * @note   広げた箱にbが収まっていれば箱を記録するだけで木は変えない
+   *         はみ出したときは葉を外し、余白と変位displacementの先読みで広げた箱で挿入し直す
+   * @return 挿入し直したかどうか
+   */
+  bool move(proxy p, const box &b, const vec<D> &displacement = {}) {
+    tight_[p] = b;
+    if (nodes_[p].b.contains(b)) {
+      return false;
+    }
+    remove_leaf(p);
+    box f = b.expanded(margin_);
+    for (std::size_t d = 0; d < D; d++) {
+      const float v = predict_ * displacement[d];
+      (v < 0 ? f.lo[d] : f.hi[d]) += v;
+    }
+    nodes_[p].b = f;
+    insert_leaf(p);
+    return true;
+  }
+
+  /**
+   * @brief  箱qと重なる物体の番号を関数に渡す(順序は不定)
+   * @tparam class F std::uint32_tを引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_aabb(const box &q, F fn) const {
+    traverse([&](const box &b) { return b.overlaps(q); },
+             [&](std::uint32_t leaf) {
+               if (tight_[leaf].overlaps(q)) {
+                 fn(nodes_[leaf].id);
+               }
+             });
+  }
+
+  /**
+   * @brief  中心c、半径rの球(2次元では円)と重なる物体の番号を関数に渡す(順序は不定)
+   * @tparam class F std::uint32_tを引数に取る関数オブジェクトの型
+   */
+  template <class F>
+  void query_radius(const vec<D> &c, float r, F fn) const {
+    const float r2 = r * r;
+    traverse([&](const box &b) { return b.distance2(c) <= r2; },
+             [&](std::uint32_t leaf) {
+               if (tight_[leaf].distance2(c) <= r2) {
+                 fn(nodes_[leaf].id);
+               }
+             });
+  }
+
+  /**
+   * @brief  レイと最初に交わる物体を求める
+   * @note   箱に入る距離がそれまでの最も近い交差より遠い部分木は調べない
+   *         2つの子は近い方から調べる
+   * @return 最初に交わる物体と距離(交わらなければstd::nullopt)
+   */
+  std::optional<ray_hit> raycast(const vec<D> &origin, const vec<D> &dir,
+                                 float tmax) const {
+    ray<D> r(origin, dir, tmax);
+    std::optional<ray_hit> best;
+    if (root_ == nil || !r.intersect(nodes_[root_].b)) {
+      return best;
+    }
+    impl::node_stack stack(root_);
+    while (!stack.empty()) {
+      const std::uint32_t i = stack.pop();
+      const node &x = nodes_[i];
+      if (x.leaf()) {
+        const std::optional<float> t = r.intersect(tight_[i]);
+        if (t &&
+            (!best || *t < best->t || (*t == best->t && x.id < best->id))) {
+          best = ray_hit{x.id, *t};
+          r.tmax = *t; // これより遠い箱は調べない
+        }
+        continue;
+      }
+      const std::optional<float> t0 = r.intersect(nodes_[x.child[0]].b);
+      const std::optional<float> t1 = r.intersect(nodes_[x.child[1]].b);
+      if (t0 && t1) { // 遠い方を先に積み、近い方から調べる
+        const bool near0 = *t0 <= *t1;
+        stack.push(x.child[near0 ? 1 : 0]);
+        stack.push(x.child[near0 ? 0 : 1]);
+      } else if (t0) {
+        stack.push(x.child[0]);
+      } else if (t1) {
+        stack.push(x.child[1]);
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief  箱qs[i]と重なる物体の番号をまとめて求める
+   * @param  threads 並列に処理するタスクの数(0のとき既定のタスクプールのワーカー数)
+   * @return i番目の問い合わせの結果を番号の昇順に並べた配列
+   */
+  std::vector<std::vector<std::uint32_t>>
+  query_aabb(const std::vector<box> &qs, unsigned threads = 0) const {
+    std::vector<std::vector<std::uint32_t>> out(qs.size());
+    impl::parallel_chunks(
+        qs.size(), 64, threads, [&](std::size_t s, std::size_t e, unsigned) {
+          for (std::size_t i = s; i < e; i++) {
+            query_aabb(qs[i], [&](std::uint32_t id) { out[i].push_back(id); });
+            std::sort(out[i].begin(), out[i].end());
+          }
+        });
+    return out;
+  }
+
+  /**
+   * @brief  球(中心cs[i]、半径rs[i])と重なる物体の番号をまとめて求める
+   * @return i番目の問い合わせの結果を番号の昇順に並べた配列
+   */
+  std::vector<std::vector<std::uint32_t>>
+  query_radius(const std::vector<vec<D>> &cs, const std::vector<float> &rs,
+               unsigned threads = 0) const {
+    BOOST_ASSERT_MSG(cs.size() == rs.size(), "Query size mismatch.");
+    std::vector<std::vector<std::uint32_t>> out(cs.size());
+    impl::parallel_chunks(
+        cs.size(), 64, threads, [&](std::size_t s, std::size_t e, unsigned) {
+          for (std::size_t i = s; i < e; i++) {
+            query_radius(cs[i], rs[i],
+                         [&](std::uint32_t id) { out[i].push_back(id); });
+            std::sort(out[i].begin(), out[i].end());
+          }
+        });
+    return out;
+  }
+
+  /**< @brief レイ(始点origins[i]、方向dirs[i])と最初に交わる物体をまとめて求める */
+  std::vector<std::optional<ray_hit>>
+  raycast(const std::vector<vec<D>> &origins, const std::vector<vec<D>> &dirs,
+          float tmax, unsigned threads = 0) const {
+    BOOST_ASSERT_MSG(origins.size() == dirs.size(), "Query size mismatch.");
+    std::vector<std::optional<ray_hit>> out(origins.size());
+    impl::parallel_chunks(origins.size(), 64, threads,
+                          [&](std::size_t s, std::size_t e, unsigned) {
+                            for (std::size_t i = s; i < e; i++) {
+                              out[i] = raycast(origins[i], dirs[i], tmax);
+                            }
+                          });
+    return out;
+  }
+
+  /**
+   * @brief  重なりを持つ物体の組を全て求める
+   * @note   葉をスレッドで分け、各葉の箱で木を問い合わせる. 組は添字の大きい葉の側でだけ報告する
+   * @param  threads 並列に処理するタスクの数(0のとき既定のタスクプールのワーカー数)
+   * @return 組(番号の小さい方, 大きい方)の配列(順序は不定)
+   */
+  std::vector<overlap_pair> find_pairs(unsigned threads = 0) const {
+    threads = impl::task_count(threads);
+    std::vector<std::uint32_t> leaves;
+    leaves.reserve(leaves_);
+    for_each_node([&](std::uint32_t i) {
+      if (nodes_[i].leaf()) {
+        leaves.push_back(i);
+      }
+    });
+    std::vector<std::vector<overlap_pair>> parts(threads);
+    impl::parallel_chunks(
+        leaves.size(), chunk_leaves, threads,
+        [&](std::size_t s, std::size_t e, unsigned worker) {
+          auto &out = parts[worker];
+          for (std::size_t k = s; k < e; k++) {
+            const std::uint32_t p = leaves[k];
+            const box &q = tight_[p];
+            traverse([&](const box &b) { return b.overlaps(q); },
+                     [&](std::uint32_t leaf) {
+                       if (leaf < p && tight_[leaf].overlaps(q)) {
+                         const std::uint32_t a = nodes_[p].id;
+                         const std::uint32_t b = nodes_[leaf].id;
+                         out.emplace_back(std::min(a, b), std::max(a, b));
+                       }
+                     });
+          }
+        });
+    return impl::concat(parts);
+  }
+
+  /**< @brief 木の不変条件(親子の連結、箱の包含、高さ、葉の数)を満たすかどうか返す */
+  bool validate() const {
+    if (root_ == nil) {
+      return leaves_ == 0;
+    }
+    if (nodes_[root_].parent != nil) {
+      return false;
+    }
+    std::size_t leaves = 0;
+    bool ok = true;
+    for_each_node([&](std::uint32_t i) {
+      const node &x = nodes_[i];
+      if (x.leaf()) {
+        leaves++;
+        ok = ok && x.height == 0 && x.b.contains(tight_[i]);
+        return;
+      }
+      const node &l = nodes_[x.child[0]], &r = nodes_[x.child[1]];
+      ok = ok && l.parent == i && r.parent == i &&
+           x.height == 1 + std::max(l.height, r.height) &&
+           x.b.contains(l.b) && x.b.contains(r.b);
+    });
+    return ok && leaves == leaves_;
+  }
+
+private:
+  /**< @brief 節点を1つ割り当てる */
+  std::uint32_t allocate() {
+    std::uint32_t i = free_;
+    if (i == nil) {
+      i = static_cast<std::uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+      tight_.emplace_back();
+    } else {
+      free_ = nodes_[i].parent;
+    }
+    node &x = nodes_[i];
+    x.parent = x.child[0] = x.child[1] = nil;
+    x.height = 0;
+    return i;
+  }
+
+  /**< @brief 節点iを自由リストへ返す */
+  void deallocate(std::uint32_t i) noexcept {
+    nodes_[i].parent = free_;
+    free_ = i;
+  }
+
+  /**< @brief 全ての節点を前順に巡回する */
+  template <class F> void for_each_node(F fn) const {
+    traverse([](const box &) { return true; }, fn, fn);
+  }
+
+  /**
+   * @brief enter(箱)を満たす部分木を辿り、葉をvisitに、内部節点をinnerに渡す
+   */
+  template <class Enter, class Visit>
+  void traverse(Enter enter, Visit visit) const {
+    traverse(enter, visit, [](std::uint32_t) {});
+  }
+  template <class Enter, class Visit, class Inner>
+  void traverse(Enter enter, Visit visit, Inner inner) const {
+    if (root_ == nil) {
+      return;
+    }
+    impl::node_stack stack(root_);
+    while (!stack.empty()) {
+      const std::uint32_t i = stack.pop();
+      const node &x = nodes_[i];
+      if (!enter(x.b)) {
+        continue;
+      }
+      if (x.leaf()) {
+        visit(i);
+      } else {
+        inner(i);
+        stack.push(x.child[1]);
+        stack.push(x.child[0]);
+      }
+    }
+  }
+
+  /**
+   * @brief 葉leafを木に繋ぐ
+   * @note  各節点で、そこを兄弟にする費用(和の箱の表面積)と、子へ降りる費用(子の箱の表面積の増分と、
+   *        降りることで祖先の箱が広がる分)を比べて、最も安いところを兄弟にする
+   */
+  void insert_leaf(std::uint32_t leaf) {
+    if (root_ == nil) {
+      root_ = leaf;
+      nodes_[leaf].parent = nil;
+      return;
+    }
+    const box b = nodes_[leaf].b;
+    std::uint32_t s = root_;
+    while (!nodes_[s].leaf()) {
+      const node &x = nodes_[s];
+      const float area = x.b.area();
+      const float combined = x.b.merge(b).area();
+      const float here = 2 * combined;             /**< sを兄弟にする費用 */
+      const float inherit = 2 * (combined - area); /**< 降りると祖先が広がる分 */
+      float down[2];
+      for (int k = 0; k < 2; k++) {
+        const node &c = nodes_[x.child[k]];
+        const float grown = c.b.merge(b).area();
+        down[k] = (c.leaf() ? grown : grown - c.b.area()) + inherit;
+      }
+      if (here < down[0] && here < down[1]) {
+        break;
+      }
+      s = x.child[down[0] <= down[1] ? 0 : 1];
+    }
+    const std::uint32_t old = nodes_[s].parent;
+    const std::uint32_t p = allocate();
+    node &np = nodes_[p];
+    np.parent = old;
+    np.child[0] = s;
+    np.child[1] = leaf;
+    nodes_[s].parent = p;
+    nodes_[leaf].parent = p;
+    if (old == nil) {
+      root_ = p;
+    } else {
+      nodes_[old].child[nodes_[old].child[0] == s ? 0 : 1] = p;
+    }
+    refit(p);
+  }
+
+  /**< @brief 葉leafを木から外す(節点は解放しない) */
+  void remove_leaf(std::uint32_t leaf) {
+    if (leaf == root_) {
+      root_ = nil;
+      return;
+    }
+    const std::uint32_t p = nodes_[leaf].parent;
+    const std::uint32_t g = nodes_[p].parent;
+    const std::uint32_t s =
+        nodes_[p].child[nodes_[p].child[0] == leaf ? 1 : 0];
+    nodes_[s].parent = g;
+    if (g == nil) {
+      root_ = s;
+    } else {
+      nodes_[g].child[nodes_[g].child[0] == p ? 0 : 1] = s;
+    }
+    deallocate(p);
+    nodes_[leaf].parent = nil;
+    refit(g);
+  }
+
+  /**< @brief 内部節点iから根まで、回転を試しながら箱と高さを直す */
+  void refit(std::uint32_t i) {
+    for (; i != nil; i = nodes_[i].parent) {
+      rotate(i);
+      update(i);
+    }
+  }
+
+  /**< @brief 内部節点iの箱と高さを子から求める */
+  void update(std::uint32_t i) noexcept {
+    node &x = nodes_[i];
+    const node &l = nodes_[x.child[0]], &r = nodes_[x.child[1]];
+    x.b = l.b.merge(r.b);
+    x.height = 1 + std::max(l.height, r.height);
+  }
+
+  /**
+   * @brief 節点aで、子と反対側の孫を入れ替える回転のうち、入れ替え先の子の箱の表面積を最も減らすものを行う
+   * @note  子B, Cに対して、B <-> Cの子、C <-> Bの子の最大4通りを比べる(Kopta et al.)
+   */
+  void rotate(std::uint32_t a) {
+    const std::uint32_t b = nodes_[a].child[0], c = nodes_[a].child[1];
+    float best = 0;
+    std::uint32_t from = nil, to = nil; // fromとtoを入れ替える
+    auto consider = [&](std::uint32_t x, std::uint32_t y) {
+      if (nodes_[y].leaf()) {
+        return;
+      }
+      // xをyの子zと入れ替えると、yの箱はxとzの兄弟wの和になる
+      for (int k = 0; k < 2; k++) {
+        const std::uint32_t z = nodes_[y].child[k];
+        const std::uint32_t w = nodes_[y].child[1 - k];
+        const float gain =
+            nodes_[y].b.area() - nodes_[x].b.merge(nodes_[w].b).area();
+        if (gain > best) {
+          best = gain;
+          from = x;
+          to = z;
+        }
+      }
+    };
+    consider(b, c);
+    consider(c, b);
+    if (from == nil) {
+      return;
+    }
+    const std::uint32_t y = nodes_[to].parent;
+    nodes_[a].child[nodes_[a].child[0] == from ? 0 : 1] = to;
+    nodes_[y].child[nodes_[y].child[0] == to ? 0 : 1] = from;
+    nodes_[to].parent = a;
+    nodes_[from].parent = y;
+    update(y);
+  }
+
+  float margin_;             /**< 葉の箱を広げる余白 */
+  float predict_;            /**< 変位の先読みの倍率 */
+  std::vector<node> nodes_;  /**< 節点の配列 */
+  std::vector<box> tight_;   /**< 葉の物体の箱(節点と同じ添字) */
+  std::uint32_t root_ = nil; /**< 根 */
+  std::uint32_t free_ = nil; /**< 自由リストの先頭 */
+  std::size_t leaves_ = 0;   /**< 葉の数 */
+};
+
+} // namespace container
+
+#endif // end of AABB_TREE_HPP
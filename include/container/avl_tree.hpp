@@ -10,22 +10,42 @@
  *        n個のAVL木の高さはΟ(lgn)であることがわかる
  *
  * @note  今回は属性pを省略してコードの簡略化を図ることにする
+ *        親をたどる代わりに、根からたどったリンクを高さの上限分の固定長の経路スタックに積み、
+ *        挿入・削除・探索を再帰なしに行う
  */
 
 #ifndef AVL_TREE_HPP
 #define AVL_TREE_HPP
 
 #include "container.hpp"
+#include "node_pool.hpp"
 #include <algorithm>
 #include <boost/assert.hpp>
 #include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <future>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 namespace container {
 
-template <class Key, class T> struct avl_tree_node {
+/**< @brief 節点に付加情報を持たない(既定) */
+struct avl_no_augment {};
+/**< @brief 節点に部分木の節点数を持たせ、順位に関する問い合わせをΟ(lgn)で行う */
+struct avl_order_statistics {};
+
+/**< @brief 付加情報ごとの節点の基底(付加情報なしの場合は空の基底クラスとなり、大きさを取らない) */
+template <class Augment> struct avl_tree_node_base {};
+template <> struct avl_tree_node_base<avl_order_statistics> {
+  std::size_t s = 1; /**< xを根とする部分木の節点数 */
+};
+
+template <class Key, class T, class Augment = avl_no_augment>
+struct avl_tree_node : avl_tree_node_base<Augment> {
   using height_t = std::int32_t;
   union {
     struct {
@@ -44,25 +64,178 @@ template <class Key, class T> struct avl_tree_node {
 
 /**
  * @brief  AVL木
- * @tparam Key     キーの型
- * @tparam T       付属データの型
- * @tparam Compare キーを引数にとる比較述語の型
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Compare   キーを引数にとる比較述語の型
+ * @tparam Allocator アロケータの型
+ * @tparam Augment   節点の付加情報(avl_no_augmentまたはavl_order_statistics)
  */
 template <class Key, class T, class Compare = std::less<Key>,
           class Allocator = boost::container::pmr::polymorphic_allocator<
-              avl_tree_node<Key, T>>>
+              avl_tree_node<Key, T>>,
+          class Augment = avl_no_augment>
 struct avl_tree {
   static_assert(std::is_nothrow_constructible_v<Key> &&
                 std::is_nothrow_constructible_v<T>);
   using alloc = std::allocator_traits<Allocator>;
   using sides_t = std::int32_t;
   using pair_t = std::pair<const Key, T>;
-  using node = avl_tree_node<Key, T>;
+  using node = avl_tree_node<Key, T, Augment>;
   using height_t = typename node::height_t;
+  using pool_t = node_pool<node, Allocator>;
+
+  /**< @brief 部分木の節点数を管理するかどうか */
+  static constexpr bool order_statistics =
+      std::is_same_v<Augment, avl_order_statistics>;
+
+  /**
+   * @brief 木の高さの上限
+   * @note  節点数nのAVL木の高さは1.4405lg(n+2)-0.3277未満であり、
+   *        アドレス空間に収まる節点数では92を超えない
+   */
+  static constexpr std::size_t max_height = 92;
+  using path_t = node **[max_height]; /**< 根から節点までのリンクの列 */
+
+  /**
+   * @brief  中間順に節点を巡る双方向イテレータ
+   * @note   節点は親へのポインタを持たないので、根から現在の節点までの経路をスタックとして保持する
+   *         ++/--はならしΟ(1)、最悪Ο(lgn)で、k個の節点の巡回はΟ(lgn+k)で済む
+   * @note   挿入・削除を行うと木の形が変わるので、全てのイテレータは無効になる
+   *         (付属データへの参照は、その節点が削除されるまで有効)
+   * @tparam Const trueのとき付属データを読み取り専用で参照する
+   */
+  template <bool Const> class basic_iterator {
+    friend struct avl_tree;
+    using value_ref = std::conditional_t<Const, const T &, T &>;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = pair_t;
+    using reference = std::pair<const Key &, value_ref>;
+    /**< @brief operator->のための参照の入れ物 */
+    struct pointer {
+      reference ref;
+      const reference *operator->() const noexcept { return &ref; }
+    };
+
+    basic_iterator() noexcept = default;
+    /**< @brief 変更可能なイテレータから読み取り専用のイテレータへの変換 */
+    template <bool C, class = std::enable_if_t<Const && !C>>
+    basic_iterator(const basic_iterator<C> &it) noexcept
+        : root_(it.root_), n_(it.n_) {
+      std::copy(it.path_, it.path_ + it.n_, path_);
+    }
+
+    reference operator*() const noexcept {
+      node *x = path_[n_ - 1];
+      return reference(x->key, x->v);
+    }
+    pointer operator->() const noexcept { return pointer{**this}; }
+    /**< @brief 現在の節点のキーを返す */
+    const Key &key() const noexcept { return path_[n_ - 1]->key; }
+    /**< @brief 現在の節点の付属データを返す */
+    value_ref value() const noexcept { return path_[n_ - 1]->v; }
+
+    /**< @brief 中間順で次の節点へ進む */
+    basic_iterator &operator++() noexcept {
+      step(1);
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept {
+      basic_iterator it = *this;
+      step(1);
+      return it;
+    }
+    /**< @brief 中間順で前の節点へ戻る(end()からは最も右の節点へ戻る) */
+    basic_iterator &operator--() noexcept {
+      if (n_ == 0) {
+        for (node *x = root_; x != nullptr; x = x->r) {
+          path_[n_++] = x;
+        }
+      } else {
+        step(0);
+      }
+      return *this;
+    }
+    basic_iterator operator--(int) noexcept {
+      basic_iterator it = *this;
+      --*this;
+      return it;
+    }
+
+    template <bool C>
+    bool operator==(const basic_iterator<C> &it) const noexcept {
+      return current() == it.current();
+    }
+    template <bool C>
+    bool operator!=(const basic_iterator<C> &it) const noexcept {
+      return !(*this == it);
+    }
+
+  private:
+    explicit basic_iterator(node *root) noexcept : root_(root) {}
+
+    /**< @brief 現在の節点を返す(end()のときNIL) */
+    node *current() const noexcept { return n_ == 0 ? nullptr : path_[n_ - 1]; }
+
+    /**
+     * @brief 中間順でi側(1のとき次、0のとき前)の節点へ移る
+     * @note  i側の子があればその部分木の中で最も!i側の節点へ下り、
+     *        なければi側の子としてたどってきた祖先を抜けるまで経路を戻る
+     */
+    void step(sides_t i) noexcept {
+      node *x = path_[n_ - 1];
+      if (x->c[i] != nullptr) {
+        for (x = x->c[i]; x != nullptr; x = x->c[!i]) {
+          path_[n_++] = x;
+        }
+        return;
+      }
+      do {
+        x = path_[--n_];
+      } while (n_ > 0 && path_[n_ - 1]->c[i] == x);
+    }
+
+    node *root_ = nullptr;   /**< 木の根 */
+    node *path_[max_height]; /**< 根から現在の節点までの経路 */
+    std::size_t n_ = 0;      /**< 経路長(0のときend()) */
 
-  explicit avl_tree(std::size_t n = 32) { allocate_pool(n); }
+    template <bool> friend class basic_iterator;
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  explicit avl_tree(std::size_t n = 32) {
+    own_pool_.emplace(n, alloc_);
+    pool_ = &*own_pool_;
+  }
+  /**
+   * @brief 他のAVL木とメモリプールを共有する
+   * @note  同じプールを共有する木どうしのjoin/splitは節点の付け替えだけで済む
+   *        プールはスレッドセーフではないので、共有する木は同じスレッドから操作すること
+   */
+  explicit avl_tree(pool_t &pool) : pool_(&pool) {}
+  avl_tree(const avl_tree &) = delete;
+  avl_tree &operator=(const avl_tree &) = delete;
   ~avl_tree() noexcept { free_pool(); } // 確保した記憶領域の解放
 
+  /**< @brief AVL木の節点数を返す */
+  std::size_t size() const noexcept {
+    if constexpr (order_statistics) {
+      return weight(root_);
+    } else {
+      return size_;
+    }
+  }
+  /**< @brief AVL木が空かどうか返す */
+  bool empty() const noexcept { return root_ == nullptr; }
+  /**< @brief AVL木の高さを返す */
+  height_t height() const noexcept { return height(root_); }
+  /**< @brief 節点用メモリプールを返す(使用中、空き、最大使用数の確認用) */
+  const pool_t &pool() const noexcept { return *pool_; }
+  pool_t &pool() noexcept { return *pool_; }
+
   /**
    * @brief  AVL木からキーkに対応する付属データを返す
    * @note   実行時間はΟ(lgn)
@@ -70,10 +243,225 @@ struct avl_tree {
    * @return キーkに対応する付属データ
    */
   std::optional<T> find(const Key &k) const {
-    const node *x = find(root_, k);
+    const node *x = find_node(k);
     return x == nullptr ? std::nullopt : std::make_optional(x->v);
   }
 
+  /**
+   * @brief  AVL木からキーkに対応する付属データへのポインタを返す
+   * @note   実行時間はΟ(lgn). コピーを行わずにその場で読み書きできる
+   * @param  const Key& k キーk
+   * @return キーkに対応する付属データへのポインタ(存在しなければNIL)
+   */
+  T *get(const Key &k) {
+    node *x = find_node(k);
+    return x == nullptr ? nullptr : &x->v;
+  }
+  const T *get(const Key &k) const {
+    const node *x = find_node(k);
+    return x == nullptr ? nullptr : &x->v;
+  }
+
+  /**< @brief 中間順で最初の節点を指すイテレータを返す */
+  iterator begin() noexcept { return first<iterator>(); }
+  const_iterator begin() const noexcept { return first<const_iterator>(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  /**< @brief 最後の節点の次を指すイテレータを返す */
+  iterator end() noexcept { return iterator(root_); }
+  const_iterator end() const noexcept { return const_iterator(root_); }
+  const_iterator cend() const noexcept { return end(); }
+
+  /**
+   * @brief  キーk以上の最小のキーを持つ節点を指すイテレータを返す
+   * @note   実行時間はΟ(lgn)
+   */
+  iterator lower_bound(const Key &k) { return bound<iterator>(k, false); }
+  const_iterator lower_bound(const Key &k) const {
+    return bound<const_iterator>(k, false);
+  }
+
+  /**
+   * @brief  キーkより大きい最小のキーを持つ節点を指すイテレータを返す
+   * @note   実行時間はΟ(lgn)
+   */
+  iterator upper_bound(const Key &k) { return bound<iterator>(k, true); }
+  const_iterator upper_bound(const Key &k) const {
+    return bound<const_iterator>(k, true);
+  }
+
+  /**< @brief キーkを持つ節点の範囲[lower_bound(k), upper_bound(k))を返す */
+  std::pair<iterator, iterator> equal_range(const Key &k) {
+    return {lower_bound(k), upper_bound(k)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const Key &k) const {
+    return {lower_bound(k), upper_bound(k)};
+  }
+
+  /**
+   * @brief  キーがlo以上hi以下の節点を中間順に巡回する
+   * @note   実行時間はΟ(lgn+k)(kは巡回する節点数)
+   * @tparam class F const Key&, T&を引数に取る関数オブジェクトの型
+   * @param  const Key& lo 下限
+   * @param  const Key& hi 上限
+   * @param  F fn          const Key&, T&を引数に取る関数オブジェクト
+   */
+  template <class F> void range(const Key &lo, const Key &hi, F fn) {
+    for (iterator it = lower_bound(lo); it != end() && !cmp_(hi, it.key());
+         ++it) {
+      fn(it.key(), it.value());
+    }
+  }
+
+  /**
+   * @brief  キーkより小さいキーの個数(0から数えたキーkの順位)を返す
+   * @note   順序統計木のときのみ使える. 実行時間はΟ(lgn)
+   */
+  std::size_t rank(const Key &k) const {
+    static_assert(order_statistics, "rank requires avl_order_statistics.");
+    std::size_t r = 0;
+    for (node *x = root_; x != nullptr;) {
+      if (cmp_(x->key, k)) { // xとxの左の部分木はキーkより小さい
+        r += weight(x->l) + 1;
+        x = x->r;
+      } else {
+        x = x->l;
+      }
+    }
+    return r;
+  }
+
+  /**
+   * @brief  0から数えてi番目に小さいキーを持つ節点を指すイテレータを返す
+   * @note   順序統計木のときのみ使える. i >= size()のときend()を返す. 実行時間はΟ(lgn)
+   */
+  iterator select(std::size_t i) { return select<iterator>(i); }
+  const_iterator select(std::size_t i) const {
+    return select<const_iterator>(i);
+  }
+
+  /**
+   * @brief  キーがlo以上hi以下の節点の個数を返す
+   * @note   順序統計木のときのみ使える. 実行時間はΟ(lgn)
+   */
+  std::size_t count(const Key &lo, const Key &hi) const {
+    static_assert(order_statistics, "count requires avl_order_statistics.");
+    if (cmp_(hi, lo)) {
+      return 0;
+    }
+    std::size_t r = 0; // キーがhi以下の節点の個数
+    for (node *x = root_; x != nullptr;) {
+      if (cmp_(hi, x->key)) {
+        x = x->l;
+      } else {
+        r += weight(x->l) + 1;
+        x = x->r;
+      }
+    }
+    return r - rank(lo);
+  }
+
+  /**< @brief 全ての節点を削除する */
+  void clear() noexcept { free_pool(); }
+
+  /**
+   * @brief  キーの昇順に並んだ(キー, 付属データ)の列から、高さ平衡なAVL木をΟ(n)で構築する
+   * @note   既存の節点は全て削除される. キーは重複なく昇順に並んでいなければならない
+   * @tparam ForwardIt std::pairのような(キー, 付属データ)の組を指す前方向イテレータ
+   * @param  ForwardIt first 先頭イテレータ
+   * @param  ForwardIt last  末尾の次を指すイテレータ
+   */
+  template <class ForwardIt>
+  void build_from_sorted(ForwardIt first, ForwardIt last) {
+    BOOST_ASSERT_MSG(std::adjacent_find(first, last,
+                                        [this](const auto &a, const auto &b) {
+                                          return !cmp_(std::get<0>(a),
+                                                       std::get<0>(b));
+                                        }) == last,
+                     "Keys must be sorted and unique.");
+    clear();
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    pool_->reserve(pool_->live() + n);
+    root_ = build(first, n);
+    size_ = n;
+  }
+
+  /**
+   * @brief AVL木rightの全ての節点をこの木の後ろに連結する. rightは空になる
+   * @note  この木の全てのキーはrightの全てのキーより小さくなければならない
+   *        プールを共有していればΟ(lgn)、そうでなければrightの節点の複製にΟ(m)かかる
+   */
+  void join(avl_tree &right) {
+    BOOST_ASSERT_MSG(&right != this, "Cannot join a tree with itself.");
+    const std::size_t n = right.size_;
+    node *r = adopt(right);
+    root_ = join2(root_, r);
+    resized(n, true);
+  }
+
+  /**
+   * @brief キーk以上の節点を全て空のAVL木rightへ移し、この木にはキーkより小さい節点を残す
+   * @note  プールを共有していればΟ(lgn)、そうでなければ移す節点の複製にΟ(m)かかる
+   *        順序統計木でなければ、両側の節点数を求めるため小さい方の節点数mに対してΟ(m)かかる
+   */
+  void split(const Key &k, avl_tree &right) {
+    BOOST_ASSERT_MSG(&right != this && right.empty(),
+                     "Split target must be another empty tree.");
+    node *l, *m, *r;
+    split(root_, k, l, m, r);
+    if (m != nullptr) {
+      r = join(nullptr, m, r);
+    }
+    const std::size_t n = count(l, r, size_);
+    root_ = l;
+    right.root_ = r;
+    if (pool_ != right.pool_) { // 移す節点をrightのプールへ複製する
+      right.root_ = right.clone(r);
+      destroy_nodes(r);
+    }
+    right.size_ = size_ - n;
+    size_ = n;
+  }
+
+  /**
+   * @brief  和集合: otherの節点をこの木へ加える. 同じキーの付属データはotherのもので置き換える
+   * @note   otherの節点を複製してから、分割統治の左右を閾値以上の大きさなら並列に処理する
+   *         仕事量はΟ(m lg(n/m + 1))(m <= n)
+   */
+  void union_with(const avl_tree &other) {
+    const std::size_t m = other.size();
+    node *b = clone(other.root_);
+    node_list garbage;
+    root_ = union_(root_, b, parallel_depth(), garbage);
+    size_ = size_ + m - dispose(garbage); // 重複した節点は片方が捨てられる
+  }
+
+  /**
+   * @brief 積集合: otherに同じキーを持たない節点をこの木から削除する
+   * @note  仕事量はΟ(m lg(n/m + 1))で、分割統治の左右を閾値以上の大きさなら並列に処理する
+   */
+  void intersect(const avl_tree &other) {
+    if (&other == this) {
+      return;
+    }
+    node_list garbage;
+    root_ = intersect_(root_, other.root_, parallel_depth(), garbage);
+    size_ -= dispose(garbage);
+  }
+
+  /**
+   * @brief 差集合: otherに同じキーを持つ節点をこの木から削除する
+   * @note  仕事量はΟ(m lg(n/m + 1))で、分割統治の左右を閾値以上の大きさなら並列に処理する
+   */
+  void difference(const avl_tree &other) {
+    if (&other == this) {
+      clear();
+      return;
+    }
+    node_list garbage;
+    root_ = difference_(root_, other.root_, parallel_depth(), garbage);
+    size_ -= dispose(garbage);
+  }
+
   /**
    * @brief AVL木Tにキーkの挿入を行う
    * @note  実行時間はΟ(lgn)
@@ -82,114 +470,490 @@ struct avl_tree {
    * @return キーkに対応していた付属データ
    */
   std::optional<T> insert(const Key &k, const T &v) {
-    std::optional<T> opt = std::nullopt;
-    root_ = insert(root_, k, v, opt);
-    return opt;
+    path_t path;
+    std::size_t n = 0;
+    node **link = &root_;
+    node *y = nullptr; // yはキーk以上の最小の節点の候補
+    while (*link != nullptr) { // 根から葉まで、たどったリンクを記録しながら下る
+      node *x = *link;
+      path[n++] = link;
+      if (cmp_(x->key, k)) {
+        link = &x->r;
+      } else {
+        y = x;
+        link = &x->l;
+      }
+    }
+    if (y != nullptr && !cmp_(k, y->key)) { // キーkが既に存在するとき、
+      std::optional<T> opt = std::make_optional(y->v); // 付属データを置き換える
+      y->v = v;
+      return opt;
+    }
+    *link = create_node(k, v); // 新たな葉を挿入し、
+    rebalance(path, n);        // 挿入位置から根へ向かって高さ平衡にする
+    resized(1, true);
+    return std::nullopt;
   }
 
   /**
    * @brief AVL木Tからキーkを持つ節点の削除を行う
    * @note  実行時間はΟ(lgn)
-   * @param const Key&git  k キーk
+   * @param const Key&  k キーk
    * @return キーkに対応していた付属データ
    */
   std::optional<T> erase(const Key &k) {
-    std::optional<T> opt = std::nullopt;
-    root_ = erase(root_, k, opt);
+    path_t path;
+    std::size_t n = 0, m = 0;
+    node **link = &root_;
+    node *y = nullptr; // yはキーk以上の最小の節点の候補、mはyまでの経路長
+    while (*link != nullptr) {
+      node *x = *link;
+      path[n++] = link;
+      if (cmp_(x->key, k)) {
+        link = &x->r;
+      } else {
+        y = x;
+        m = n;
+        link = &x->l;
+      }
+    }
+    if (y == nullptr || cmp_(k, y->key)) {
+      return std::nullopt;
+    } // キーkはAVL木Tに存在しなかった
+    std::optional<T> opt = std::make_optional(y->v);
+    n = m - 1; // 経路をyの親までに切り詰める
+    node **ylink = path[n];
+    if (y->r == nullptr) {
+      *ylink = y->l; // yに右の子がなければ、yを左の子で置き換える
+    } else {
+      // yの右の部分木の中で最も左の節点sを取り外し、yの位置に付け替える
+      path[n++] = ylink;
+      const std::size_t i = n; // path[i]はyの右の子へのリンクになる
+      link = &y->r;
+      while ((*link)->l != nullptr) {
+        path[n++] = link;
+        link = &(*link)->l;
+      }
+      node *s = *link;
+      *link = s->r;
+      s->l = y->l;
+      s->r = y->r;
+      s->h = y->h; // sの部分木の節点数は経路をたどり直すときに更新される
+      *ylink = s;
+      if (i < n) {
+        path[i] = &s->r; // yの右の子へのリンクはsの右の子へのリンクになった
+      }
+    }
+    destroy_node(y);    // yを解放し、
+    rebalance(path, n); // 削除位置から根へ向かって高さ平衡にする
+    resized(1, false);
     return opt;
   }
 
   /**
    * @brief  中間順木巡回を行う
    * @note   n個の節点を持つ2分探索木の巡回はΘ(n)かかる
-   * @tparam class F const Key&を引数に取る関数オブジェクトの型
-   * @param F fn     const T&を引数に取る関数オブジェクト
+   * @tparam class F const Key&, T&を引数に取る関数オブジェクトの型
+   * @param F fn     const Key&, T&を引数に取る関数オブジェクト
    */
-  template <class F> void inorder(F fn) { inorder(root_, fn); }
+  template <class F> void inorder(F fn) {
+    node *stack[max_height];
+    std::size_t n = 0;
+    node *x = root_;
+    while (x != nullptr || n > 0) {
+      while (x != nullptr) { // 左の子をたどりながら祖先を積み、
+        stack[n++] = x;
+        x = x->l;
+      }
+      x = stack[--n]; // 最も左の節点を訪れ、その右の部分木へ進む
+      fn(x->key, x->v);
+      x = x->r;
+    }
+  }
 
 private:
+  /**< @brief 中間順で最初の節点を指すイテレータを作る */
+  template <class Iterator> Iterator first() const noexcept {
+    Iterator it(root_);
+    for (node *x = root_; x != nullptr; x = x->l) {
+      it.path_[it.n_++] = x;
+    }
+    return it;
+  }
+
   /**
-   * @brief  中間順木巡回を行う
-   * @note   n個の節点を持つ2分探索木の巡回はΘ(n)かかる
-   * @tparam class F const Key&を引数に取る関数の型
-   * @param F fn     const Key&を引数に取る関数
-   * @param node*x   巡回を行う部分木の根
+   * @brief  キーkより大きい(upperがfalseのときはk以上の)最小のキーを持つ節点を指すイテレータを作る
+   * @note   候補を見つけた深さを覚えておき、最後に経路をそこまで切り詰める
    */
-  template <class F> void inorder(node *x, F fn) {
+  template <class Iterator> Iterator bound(const Key &k, bool upper) const {
+    Iterator it(root_);
+    std::size_t m = 0;
+    for (node *x = root_; x != nullptr;) {
+      it.path_[it.n_++] = x;
+      if (upper ? cmp_(k, x->key) : !cmp_(x->key, k)) {
+        m = it.n_;
+        x = x->l;
+      } else {
+        x = x->r;
+      }
+    }
+    it.n_ = m;
+    return it;
+  }
+
+  /**< @brief 0から数えてi番目に小さいキーを持つ節点を指すイテレータを作る */
+  template <class Iterator> Iterator select(std::size_t i) const {
+    static_assert(order_statistics, "select requires avl_order_statistics.");
+    Iterator it(root_);
+    if (i >= weight(root_)) {
+      return it;
+    }
+    for (node *x = root_;;) {
+      it.path_[it.n_++] = x;
+      const std::size_t w = weight(x->l);
+      if (i == w) {
+        return it;
+      }
+      if (i < w) {
+        x = x->l;
+      } else {
+        i -= w + 1;
+        x = x->r;
+      }
+    }
+  }
+
+  /**
+   * @brief  列の先頭からn個の要素で、中間順がその並びになる高さ平衡な部分木を作る
+   * @note   左右の部分木の節点数の差は高々1なので、高さの差も高々1になる
+   */
+  template <class ForwardIt> node *build(ForwardIt &it, std::size_t n) {
+    if (n == 0) {
+      return nullptr;
+    }
+    node *l = build(it, n / 2);
+    node *x = create_node(std::get<0>(*it), std::get<1>(*it));
+    ++it;
+    x->l = l;
+    x->r = build(it, n - 1 - n / 2);
+    update(x);
+    return x;
+  }
+
+  /**< @brief 節点xを根とする部分木を形を保ったままこの木のプールへ複製する */
+  node *clone(const node *x) {
     if (x == nullptr) {
-      return;
-    } // xがNILを指すとき、再帰は底をつく
-    inorder(x->l, fn);
-    fn(x->key, x->v);
-    inorder(x->r,
-            fn); // xの左右の子を根とする部分木に対して中間順木巡回を行う
+      return nullptr;
+    }
+    node *y = create_node(x->key, x->v);
+    y->l = clone(x->l);
+    y->r = clone(x->r);
+    update(y);
+    return y;
+  }
+
+  /**< @brief 木fromの節点を全て取り出し、この木のプールの節点として返す */
+  node *adopt(avl_tree &from) {
+    node *x = from.root_;
+    from.root_ = nullptr;
+    if (pool_ != from.pool_) {
+      node *y = clone(x);
+      from.destroy_nodes(x);
+      x = y;
+    }
+    from.size_ = 0;
+    return x;
   }
 
   /**
-   * @brief  AVL木からキーkに対応する付属データを返す
-   * @note   実行時間はΟ(lgn)
-   * @param  const Key& k キーk
-   * @return キーkに対応する付属データへのポインタ
+   * @brief  lの全てのキー < kのキー < rの全てのキーのとき、これらを連結した高さ平衡な部分木を返す
+   * @note   高い方の木の背骨を、もう一方の高さ+1になるまで下ってkを差し込む
+   *         実行時間はΟ(|h(l) - h(r)| + 1)
+   */
+  static node *join(node *l, node *k, node *r) noexcept {
+    if (height(l) > height(r) + 1) {
+      return join_side(l, k, r, 1);
+    }
+    if (height(r) > height(l) + 1) {
+      return join_side(r, k, l, 0);
+    }
+    k->l = l;
+    k->r = r;
+    update(k);
+    return k;
+  }
+  /**
+   * @brief  高い方の木xのi側(1のとき右)の背骨を下り、kと低い方の木yを差し込んで高さ平衡にする
    */
-  node *find(node *x, const Key &k) const {
-    if (x == nullptr || eq(x->key, k)) {
-      return x;
+  static node *join_side(node *x, node *k, node *y, sides_t i) noexcept {
+    if (height(x->c[i]) <= height(y) + 1) {
+      k->c[!i] = x->c[i];
+      k->c[i] = y;
+      update(k);
+      x->c[i] = k;
     } else {
-      return find(cmp_(k, x->key) ? x->l : x->r, k);
+      x->c[i] = join_side(x->c[i], k, y, i);
     }
+    return balance(x);
+  }
+  /**< @brief lの全てのキー < rの全てのキーのとき、これらを連結した高さ平衡な部分木を返す */
+  static node *join2(node *l, node *r) noexcept {
+    if (l == nullptr) {
+      return r;
+    }
+    node *last;
+    l = split_last(l, last);
+    return join(l, last, r);
+  }
+  /**< @brief 節点xを根とする部分木から最も右の節点lastを取り外す */
+  static node *split_last(node *x, node *&last) noexcept {
+    if (x->r == nullptr) {
+      last = x;
+      return x->l;
+    }
+    x->r = split_last(x->r, last);
+    return balance(x);
   }
 
   /**
-   * @brief 節点xを根とする部分木にキーkの挿入を行う
-   * @param node*x       節点x
-   * @param node*z       キーkを持つ節点z
+   * @brief 節点xを根とする部分木を、キーkより小さい部分木l、キーkを持つ節点m、
+   *        キーkより大きい部分木rに分割する
+   * @note  実行時間はΟ(lgn)
    */
-  node *insert(node *x, const Key &k, const T &v, std::optional<T> &opt) {
+  void split(node *x, const Key &k, node *&l, node *&m, node *&r) const {
     if (x == nullptr) {
-      return create_node(k, v);
-    }                      // xがNILを指すとき、再帰は底をつく
-    if (cmp_(k, x->key)) { // xの適切な子に再帰し、
-      x->l = insert(x->l, k, v, opt);
+      l = m = r = nullptr;
+    } else if (cmp_(k, x->key)) {
+      node *xl;
+      split(x->l, k, l, m, xl);
+      r = join(xl, x, x->r);
     } else if (cmp_(x->key, k)) {
-      x->r = insert(x->r, k, v, opt);
+      node *xr;
+      split(x->r, k, xr, m, r);
+      l = join(x->l, x, xr);
     } else {
-      opt = x->v;
-      x->v = v;
-      return x;
+      l = x->l;
+      r = x->r;
+      m = x;
+      m->l = m->r = nullptr;
+      update(m);
     }
-    return balance(x); // xを根とする部分木を高さ平衡にする
+  }
+
+  /**< @brief 集合演算で取り除いた節点の連結リスト(左の子で連結する) */
+  struct node_list {
+    node *head = nullptr;
+    node *tail = nullptr;
+    void push(node *x) noexcept {
+      x->l = nullptr;
+      (head == nullptr ? head : tail->l) = x;
+      tail = x;
+    }
+    /**< @brief 節点xを根とする部分木の節点を全て加える */
+    void push_tree(node *x) noexcept {
+      while (x != nullptr) {
+        node *y = x->r;
+        if (x->l != nullptr) {
+          push_tree(x->l);
+        }
+        push(x);
+        x = y;
+      }
+    }
+    void splice(node_list &o) noexcept {
+      if (o.head == nullptr) {
+        return;
+      }
+      (head == nullptr ? head : tail->l) = o.head;
+      tail = o.tail;
+    }
+  };
+
+  /**< @brief 取り除いた節点を解放し、その数を返す */
+  std::size_t dispose(node_list &garbage) noexcept {
+    std::size_t n = 0;
+    for (node *x = garbage.head; x != nullptr; n++) {
+      node *y = x->l;
+      destroy_node(x);
+      x = y;
+    }
+    return n;
   }
 
   /**
-   * @brief 節点xを根とする部分木からキーkを削除する
-   * @param node*x       節点x
-   * @param const Key& k キーk
+   * @brief  節点数の合計がnの部分木a, bのうち、aの節点数を返す
+   * @note   順序統計木でなければ、両方を1節点ずつ交互に巡回し、先に尽きた方の節点数から
+   *         もう一方を求める. 実行時間はΟ(min(|a|, |b|) + lgn)
    */
-  node *erase(node *x, const Key &k, std::optional<T> &opt) {
-    if (x == nullptr) {
+  static std::size_t count(const node *a, const node *b,
+                           std::size_t n) noexcept {
+    if constexpr (order_statistics) {
+      return weight(a);
+    } else {
+      struct cursor { // 中間順の巡回の経路スタック
+        const node *stack[max_height];
+        std::size_t n = 0;
+        void push(const node *x) noexcept {
+          for (; x != nullptr; x = x->l) {
+            stack[n++] = x;
+          }
+        }
+        bool next() noexcept {
+          if (n == 0) {
+            return false;
+          }
+          push(stack[--n]->r);
+          return true;
+        }
+      } ca, cb;
+      ca.push(a);
+      cb.push(b);
+      for (std::size_t c = 0;; c++) {
+        if (!ca.next()) {
+          return c;
+        }
+        if (!cb.next()) {
+          return n - c;
+        }
+      }
+    }
+  }
+
+  /**< @brief 並列に処理する部分木の高さの下限(高さ13のAVL木は少なくとも609個の節点を持つ) */
+  static constexpr height_t parallel_height = 13;
+  /**< @brief 並列に処理する分割統治の段数(ハードウェアスレッド数を覆うだけ分岐する) */
+  static int parallel_depth() noexcept {
+    unsigned n = std::thread::hardware_concurrency();
+    int d = 0;
+    for (; n > 1; n >>= 1) {
+      d++;
+    }
+    return d + 1;
+  }
+  /**< @brief 部分木aとbに対する分割統治の左右を並列に処理するかどうか返す */
+  static bool parallel(int depth, const node *a, const node *b) noexcept {
+    return depth > 0 && std::max(height(a), height(b)) >= parallel_height;
+  }
+
+  /**
+   * @brief 分割統治の左右を(閾値以上の大きさなら並列に)処理し、結果を受け取る
+   * @note  並列に処理する側は自身の取り除いた節点のリストを持ち、終わってから連結する
+   */
+  template <class F>
+  static void fork(bool par, node *&lo, node *&hi, node_list &garbage, F f) {
+    if (par) {
+      node_list g;
+      auto future = std::async(std::launch::async, [&] { lo = f(0, g); });
+      hi = f(1, garbage);
+      future.get();
+      garbage.splice(g);
+    } else {
+      lo = f(0, garbage);
+      hi = f(1, garbage);
+    }
+  }
+
+  /**< @brief 同じプールの部分木aとbの和集合を返す(同じキーはbの節点を残す) */
+  node *union_(node *a, node *b, int depth, node_list &garbage) const {
+    if (a == nullptr) {
+      return b;
+    }
+    if (b == nullptr) {
+      return a;
+    }
+    const bool par = parallel(depth, a, b); // 分割でaは組み替わるので先に判定する
+    node *l, *m, *r;
+    split(a, b->key, l, m, r);
+    if (m != nullptr) {
+      garbage.push(m);
+    }
+    node *bl = b->l, *br = b->r, *lo, *hi;
+    fork(par, lo, hi, garbage, [&](int i, node_list &g) {
+      return i == 0 ? union_(l, bl, depth - 1, g) : union_(r, br, depth - 1, g);
+    });
+    return join(lo, b, hi);
+  }
+
+  /**< @brief 部分木aのうち、部分木bに同じキーを持つ節点だけを残す */
+  node *intersect_(node *a, const node *b, int depth,
+                   node_list &garbage) const {
+    if (a == nullptr) {
       return nullptr;
-    } // キーkはAVL木Tに存在しなかった
-    if (cmp_(k, x->key)) {
-      x->l = erase(x->l, k, opt);
-      return balance(x);
-    } // xの適切な子に再帰し、
-    if (cmp_(x->key, k)) {
-      x->r = erase(x->r, k, opt);
-      return balance(x);
-    } // xを根とする部分木を高さ平衡にする
-    opt = x->v;
-    node *y = x->l,
-         *z = x->r; // x.key == kのとき、yをxの左の子、zをxの右の子とし、
-    destroy_node(x); // xを解放する
-    if (z == nullptr) {
-      return y;
-    } // zがNILを指しているならば、新たな部分木の根としてyを返す
-    node *w = leftmost(
-        z); // zがNILを指していないならば、wをzを根とする部分木の中で最も左の子とする
-    w->r = erase__(
-        z); // zに対して再帰する.そして、wの右の子に新たな部分木を受け取る
-    w->l = y;          // yをwの左の子にする
-    return balance(w); // wを根とする部分木を高さ平衡にして戻る
+    }
+    if (b == nullptr) {
+      garbage.push_tree(a);
+      return nullptr;
+    }
+    const bool par = parallel(depth, a, b);
+    node *l, *m, *r;
+    split(a, b->key, l, m, r);
+    node *lo, *hi;
+    fork(par, lo, hi, garbage, [&](int i, node_list &g) {
+      return i == 0 ? intersect_(l, b->l, depth - 1, g)
+                    : intersect_(r, b->r, depth - 1, g);
+    });
+    return m != nullptr ? join(lo, m, hi) : join2(lo, hi);
+  }
+
+  /**< @brief 部分木aから、部分木bに同じキーを持つ節点を取り除く */
+  node *difference_(node *a, const node *b, int depth,
+                    node_list &garbage) const {
+    if (a == nullptr || b == nullptr) {
+      return a;
+    }
+    const bool par = parallel(depth, a, b);
+    node *l, *m, *r;
+    split(a, b->key, l, m, r);
+    if (m != nullptr) {
+      garbage.push(m);
+    }
+    node *lo, *hi;
+    fork(par, lo, hi, garbage, [&](int i, node_list &g) {
+      return i == 0 ? difference_(l, b->l, depth - 1, g)
+                    : difference_(r, b->r, depth - 1, g);
+    });
+    return join2(lo, hi);
+  }
+
+  /**
+   * @brief  AVL木からキーkを持つ節点を探す
+   * @note   各レベルで比較は1回だけ行い、最後にキーkと候補の同値判定を行う
+   * @param  const Key& k キーk
+   * @return キーkを持つ節点へのポインタ(存在しなければNIL)
+   */
+  node *find_node(const Key &k) const {
+    node *x = root_, *y = nullptr; // yはキーk以上の最小の節点の候補
+    while (x != nullptr) {
+      if (cmp_(x->key, k)) {
+        x = x->r;
+      } else {
+        y = x;
+        x = x->l;
+      }
+    }
+    return (y != nullptr && !cmp_(k, y->key)) ? y : nullptr;
+  }
+
+  /**
+   * @brief 経路上のリンクを葉側から根へ向かってたどり、各部分木を高さ平衡にする
+   * @note  部分木の高さが変化しなくなった時点で祖先は影響を受けないので打ち切る
+   * @param path_t& path  根からたどったリンクの列
+   * @param std::size_t n 経路長
+   */
+  static void rebalance(path_t &path, std::size_t n) {
+    while (n > 0) {
+      node **link = path[--n];
+      const height_t h = (*link)->h;
+      *link = balance(*link);
+      if ((*link)->h == h) {
+        break;
+      }
+    }
+    if constexpr (order_statistics) { // 部分木の節点数は根まで更新する
+      while (n > 0) {
+        update(*path[--n]);
+      }
+    }
   }
 
   /**
@@ -201,7 +965,7 @@ private:
    * @return 高さ平衡な部分木の根
    */
   static node *balance(node *x) {
-    x->h = reheight(x); // xの高さを更新する
+    update(x);          // xの高さを更新する
     if (bias(x) > 1) {  // 左に2つ分偏っている場合、left-l
                         // caseおよびleft-r caseが考えられる
       if (bias(x->l) < 0) {
@@ -234,100 +998,103 @@ private:
     node *y = x->c[j];  // yをxのjの子とする
     x->c[j] = y->c[i];  // yのi部分木をxのj部分木にする
     y->c[i] = x;        // xをyのiの子にする
-    x->h = reheight(x); // xの高さを更新する
-    y->h = reheight(y); // yの高さを更新する
+    update(x);          // xの高さを更新する
+    update(y);          // yの高さを更新する
     return y;           // 部分木の新しい根yを返す
   }
   static node *left_rotate(node *x) { return rotate(x, 0, 1); }
   static node *right_rotate(node *x) { return rotate(x, 1, 0); }
 
-  /**
-   * @brief 節点xを根とする部分木の中から最も左にある子を取得する
-   * @param node*x 節点x
-   */
-  static node *leftmost(node *x) { return x->l ? leftmost(x->l) : x; }
-
-  /**
-   * @brief xを根とする部分木の最も左の子を削除する補助関数
-   * @param node*x 節点x
-   */
-  static node *erase__(node *x) {
-    if (x->l == nullptr) {
-      return x->r;
-    }
-    x->l = erase__(x->l);
-    return balance(x);
-  }
-
 private:
   /**< @brief 節点xの高さを取得する  */
-  static constexpr height_t height(node *x) noexcept { return x ? x->h : 0; }
+  static constexpr height_t height(const node *x) noexcept {
+    return x ? x->h : 0;
+  }
   /**< @brief 節点xの更新される高さを返す */
-  static constexpr height_t reheight(node *x) noexcept {
+  static constexpr height_t reheight(const node *x) noexcept {
     return std::max(height(x->l), height(x->r)) + 1;
   }
+  /**< @brief 節点xを根とする部分木の節点数を取得する */
+  static constexpr std::size_t weight(const node *x) noexcept {
+    return x ? x->s : 0;
+  }
+  /**< @brief 節点xの高さ(と部分木の節点数)を子から計算し直す */
+  static constexpr void update(node *x) noexcept {
+    x->h = reheight(x);
+    if constexpr (order_statistics) {
+      x->s = weight(x->l) + weight(x->r) + 1;
+    }
+  }
   /**< @brief 節点xの左右の子の高さの差(x.l - x.r)を返す */
-  static constexpr height_t bias(node *x) noexcept {
+  static constexpr height_t bias(const node *x) noexcept {
     return height(x->l) - height(x->r);
   }
 
 private:
   /**< @brief 節点xの記憶領域の確保を行う */
   node *create_node(const Key &k, const T &v) {
-    BOOST_ASSERT_MSG(size_ < cap_, "AVL tree capacity over.");
-    node *x = pool_ + size_;
+    node *x = pool_->allocate();
     alloc::construct(alloc_, x, k, v);
-    size_++;
     return x;
   }
 
   /**< @brief 節点xの記憶領域の解放を行う */
   void destroy_node(node *x) noexcept {
     alloc::destroy(alloc_, x);
-    size_--;
+    pool_->deallocate(x);
   }
 
-  /**< @brief 節点xを根とした部分木を再帰的に解放する*/
-  void postorder_destroy_nodes(node *x) noexcept {
-    if (x == nullptr) {
-      return;
+  /**
+   * @brief 節点xを根とした部分木を解放する
+   * @note  左の子を右回転で持ち上げながら右へ進むので、補助領域なしにΘ(n)で済む
+   */
+  void destroy_nodes(node *x) noexcept {
+    while (x != nullptr) {
+      if (x->l != nullptr) {
+        node *y = x->l;
+        x->l = y->r;
+        y->r = x;
+        x = y;
+      } else {
+        node *y = x->r;
+        destroy_node(x);
+        x = y;
+      }
     }
-    postorder_destroy_nodes(x->l);
-    postorder_destroy_nodes(x->r);
-    destroy_node(x);
   }
 
-  /**< @brief メモリプールの解放 */
+  /**< @brief 全ての節点の破棄(記憶領域はメモリプールの破棄時に解放される) */
   void free_pool() noexcept {
-    postorder_destroy_nodes(root_);
-    alloc::deallocate(alloc_, pool_, cap_);
-    root_ = pool_ = nullptr;
-    size_ = cap_ = 0;
-  }
-
-  /**< @brief メモリプールの確保 */
-  void allocate_pool(std::size_t n) {
-    pool_ = alloc::allocate(alloc_, n);
-    cap_ = n;
+    destroy_nodes(root_);
+    root_ = nullptr;
+    size_ = 0;
   }
 
-private:
-  /**< ＠brief キーlとキーrの非同値判定を行う */
-  inline bool neq(const Key &l, const Key &r) const {
-    return (cmp_(l, r) || cmp_(r, l));
+  /**< @brief 節点数をn増やす(growがfalseのときは減らす) */
+  void resized(std::size_t n, bool grow) noexcept {
+    size_ = grow ? size_ + n : size_ - n;
   }
-  /**< ＠brief キーlとキーrの同値判定を行う */
-  inline bool eq(const Key &l, const Key &r) const { return !neq(l, r); }
 
 private:
-  node *root_ = nullptr; /**< AVL木の根 */
-  std::size_t cap_ = 0;  /**< AVL木のバッファサイズ    */
-  std::size_t size_ = 0; /**< AVL木のサイズ           */
-  node *pool_ = nullptr; /**< AVL木の節点用メモリプール */
-  Compare cmp_;          /**< 比較述語  */
-  Allocator alloc_;      /**< アロケータ */
+  node *root_ = nullptr;           /**< AVL木の根 */
+  std::size_t size_ = 0;           /**< AVL木のサイズ */
+  Compare cmp_;                    /**< 比較述語  */
+  Allocator alloc_;                /**< アロケータ */
+  std::optional<pool_t> own_pool_; /**< 自身で所有する節点用メモリプール */
+  pool_t *pool_ = nullptr;         /**< AVL木の節点用メモリプール */
 };
 
+/**
+ * @brief  順序統計木(部分木の節点数を持つAVL木)
+ * @note   rank、select、countをΟ(lgn)で行える
+ */
+template <class Key, class T, class Compare = std::less<Key>>
+using order_statistics_tree =
+    avl_tree<Key, T, Compare,
+             boost::container::pmr::polymorphic_allocator<
+                 avl_tree_node<Key, T, avl_order_statistics>>,
+             avl_order_statistics>;
+
 } // namespace container
 
 #endif // end of AVL_TREE_HPP
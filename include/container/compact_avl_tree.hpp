@@ -0,0 +1,342 @@
+/**
+ * @brief  添字で子を指すコンパクトなAVL木
+ * @note   avl_treeと同じ高さ平衡2分探索木だが、節点はindex_poolの連続領域に置き、
+ *         左右の子を64ビットのポインタではなく32ビットの添字で指す
+ *         右の子の添字の下位6ビットに高さを詰めるので、子と高さで8バイトしか使わない
+ *         (そのため節点数は2^26-1個までとなる)
+ * @note   SplitValuesがtrueのとき、付属データを節点とは別の配列に置く.
+ *         探索で触れるのは子・高さ・キーだけになるので、キャッシュラインに載る節点数が増える
+ * @note   節点は配列の確保し直しで再配置されるので、キーと付属データはトリビアルにコピー可能でなければならない
+ *         また、get()で得た付属データへのポインタは次の挿入まで有効
+ */
+
+#ifndef COMPACT_AVL_TREE_HPP
+#define COMPACT_AVL_TREE_HPP
+
+#include "index_pool.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace container {
+
+/**< @brief 子と高さだけを持つ節点の共通部分 */
+struct compact_avl_tree_link {
+  std::uint32_t l;  /**< 左の子の添字 */
+  std::uint32_t rh; /**< 右の子の添字(上位26ビット)と高さ(下位6ビット) */
+};
+
+template <class Key, class T, bool SplitValues = false>
+struct compact_avl_tree_node : compact_avl_tree_link {
+  Key key; /**< キー */
+  T v;     /**< 付属データ */
+};
+template <class Key, class T>
+struct compact_avl_tree_node<Key, T, true> : compact_avl_tree_link {
+  Key key; /**< キー(付属データは別の配列に置く) */
+};
+
+/**
+ * @brief  添字で子を指すコンパクトなAVL木
+ * @tparam Key         キーの型
+ * @tparam T           付属データの型
+ * @tparam Compare     キーを引数にとる比較述語の型
+ * @tparam Allocator   アロケータの型
+ * @tparam SplitValues trueのとき付属データを節点とは別の配列に置く
+ */
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              compact_avl_tree_node<Key, T>>,
+          bool SplitValues = false>
+struct compact_avl_tree {
+  static_assert(std::is_trivially_copyable_v<Key> &&
+                std::is_trivially_copyable_v<T>);
+  using node = compact_avl_tree_node<Key, T, SplitValues>;
+  using pool_t =
+      index_pool<node, Allocator, std::conditional_t<SplitValues, T, void>>;
+  using index_t = typename pool_t::index_t;
+  using height_t = std::int32_t;
+  using sides_t = std::int32_t;
+
+  static constexpr index_t nil = pool_t::nil;        /**< NIL */
+  static constexpr std::uint32_t height_bits = 6;    /**< 高さのビット数 */
+  static constexpr std::uint32_t height_mask = 0x3f; /**< 高さのマスク */
+  /**< @brief 添字の上限(右の子の添字に使える26ビットの最大値) */
+  static constexpr index_t max_index = (index_t(1) << (32 - height_bits)) - 1;
+  /**
+   * @brief 木の高さの上限
+   * @note  節点数が2^26未満なので高さは1.4405lg(n+2)-0.3277 < 38に収まる
+   */
+  static constexpr std::size_t max_height = 40;
+
+  explicit compact_avl_tree(std::size_t n = 32) : pool_(n, max_index) {}
+
+  /**< @brief AVL木の節点数を返す */
+  std::size_t size() const noexcept { return pool_.live(); }
+  /**< @brief AVL木が空かどうか返す */
+  bool empty() const noexcept { return root_ == nil; }
+  /**< @brief AVL木の高さを返す */
+  height_t height() const noexcept { return h(root_); }
+  /**< @brief 節点用メモリプールを返す(使用中、空き、最大使用数、バイト数の確認用) */
+  const pool_t &pool() const noexcept { return pool_; }
+
+  /**
+   * @brief  AVL木からキーkに対応する付属データを返す
+   * @note   実行時間はΟ(lgn)
+   */
+  std::optional<T> find(const Key &k) const {
+    const index_t x = find_node(k);
+    return x == nil ? std::nullopt : std::make_optional(value(x));
+  }
+
+  /**
+   * @brief  AVL木からキーkに対応する付属データへのポインタを返す
+   * @note   実行時間はΟ(lgn). ポインタは次の挿入まで有効
+   */
+  T *get(const Key &k) {
+    const index_t x = find_node(k);
+    return x == nil ? nullptr : &value(x);
+  }
+
+  /**
+   * @brief AVL木Tにキーkの挿入を行う
+   * @note  実行時間はΟ(lgn)
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> insert(const Key &k, const T &v) {
+    index_t path[max_height];
+    sides_t dir[max_height];
+    std::size_t n = 0;
+    index_t y = nil; // yはキーk以上の最小の節点の候補
+    for (index_t x = root_; x != nil;) {
+      path[n] = x;
+      if (cmp_(pool_[x].key, k)) {
+        dir[n++] = 1;
+        x = r(x);
+      } else {
+        dir[n++] = 0;
+        y = x;
+        x = l(x);
+      }
+    }
+    if (y != nil && !cmp_(k, pool_[y].key)) { // キーkが既に存在するとき、
+      std::optional<T> opt = std::make_optional(value(y)); // 付属データを置き換える
+      value(y) = v;
+      return opt;
+    }
+    const index_t z = pool_.allocate(); // 新たな葉を挿入し、
+    pool_[z].l = nil;
+    pool_[z].rh = 1;
+    pool_[z].key = k;
+    value(z) = v;
+    attach(path, dir, n, z);
+    rebalance(path, dir, n); // 挿入位置から根へ向かって高さ平衡にする
+    return std::nullopt;
+  }
+
+  /**
+   * @brief AVL木Tからキーkを持つ節点の削除を行う
+   * @note  実行時間はΟ(lgn)
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> erase(const Key &k) {
+    index_t path[max_height];
+    sides_t dir[max_height];
+    std::size_t n = 0, m = 0;
+    index_t y = nil; // yはキーk以上の最小の節点の候補、mはyまでの経路長
+    for (index_t x = root_; x != nil;) {
+      path[n] = x;
+      if (cmp_(pool_[x].key, k)) {
+        dir[n++] = 1;
+        x = r(x);
+      } else {
+        dir[n++] = 0;
+        y = x;
+        m = n;
+        x = l(x);
+      }
+    }
+    if (y == nil || cmp_(k, pool_[y].key)) {
+      return std::nullopt;
+    } // キーkはAVL木Tに存在しなかった
+    std::optional<T> opt = std::make_optional(value(y));
+    n = m - 1; // 経路をyの親までに切り詰める
+    if (r(y) == nil) {
+      attach(path, dir, n, l(y)); // yに右の子がなければ、yを左の子で置き換える
+    } else {
+      // yの右の部分木の中で最も左の節点sを取り外し、yの位置に付け替える
+      const std::size_t i = n;
+      path[n] = y;
+      dir[n++] = 1;
+      index_t s = r(y);
+      for (; l(s) != nil; s = l(s)) {
+        path[n] = s;
+        dir[n++] = 0;
+      }
+      set_child(path[n - 1], dir[n - 1], r(s));
+      set_l(s, l(y));
+      set_r(s, r(y));
+      set_h(s, h(y));
+      attach(path, dir, i, s);
+      path[i] = s;
+    }
+    pool_.deallocate(y);     // yを解放し、
+    rebalance(path, dir, n); // 削除位置から根へ向かって高さ平衡にする
+    return opt;
+  }
+
+  /**
+   * @brief  中間順木巡回を行う
+   * @tparam class F const Key&, T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void inorder(F fn) {
+    index_t stack[max_height];
+    std::size_t n = 0;
+    index_t x = root_;
+    while (x != nil || n > 0) {
+      for (; x != nil; x = l(x)) {
+        stack[n++] = x;
+      }
+      x = stack[--n];
+      fn(static_cast<const Key &>(pool_[x].key), value(x));
+      x = r(x);
+    }
+  }
+
+private:
+  /**< @brief キーkを持つ節点を、各レベル1回の比較で探す */
+  index_t find_node(const Key &k) const {
+    index_t x = root_, y = nil;
+    while (x != nil) {
+      const node &nx = pool_[x];
+      if (cmp_(nx.key, k)) {
+        x = nx.rh >> height_bits;
+      } else {
+        y = x;
+        x = nx.l;
+      }
+    }
+    return (y != nil && !cmp_(k, pool_[y].key)) ? y : nil;
+  }
+
+  /**< @brief 経路のn番目の位置(n == 0のとき根)に節点xを付ける */
+  void attach(const index_t *path, const sides_t *dir, std::size_t n,
+              index_t x) noexcept {
+    if (n == 0) {
+      root_ = x;
+    } else {
+      set_child(path[n - 1], dir[n - 1], x);
+    }
+  }
+
+  /**
+   * @brief 経路を葉側から根へ向かってたどり、各部分木を高さ平衡にする
+   * @note  部分木の高さが変化しなくなった時点で打ち切る
+   */
+  void rebalance(const index_t *path, const sides_t *dir,
+                 std::size_t n) noexcept {
+    while (n > 0) {
+      const index_t x = path[--n];
+      const height_t hx = h(x);
+      const index_t y = balance(x);
+      attach(path, dir, n, y);
+      if (h(y) == hx) {
+        break;
+      }
+    }
+  }
+
+  /**< @brief 節点xを根とする部分木を高さ平衡にする(avl_tree::balanceと同じ) */
+  index_t balance(index_t x) noexcept {
+    update(x);
+    if (bias(x) > 1) {
+      if (bias(l(x)) < 0) {
+        set_l(x, rotate(l(x), 0, 1));
+      }
+      return rotate(x, 1, 0);
+    }
+    if (bias(x) < -1) {
+      if (bias(r(x)) > 0) {
+        set_r(x, rotate(r(x), 1, 0));
+      }
+      return rotate(x, 0, 1);
+    }
+    return x;
+  }
+
+  /**< @brief 節点xからxのjの子yへのリンクをピボットとするi回転 */
+  index_t rotate(index_t x, sides_t i, sides_t j) noexcept {
+    const index_t y = child(x, j);
+    set_child(x, j, child(y, i));
+    set_child(y, i, x);
+    update(x);
+    update(y);
+    return y;
+  }
+
+private:
+  /**< @brief 節点xの左の子を返す */
+  index_t l(index_t x) const noexcept { return pool_[x].l; }
+  /**< @brief 節点xの右の子を返す */
+  index_t r(index_t x) const noexcept { return pool_[x].rh >> height_bits; }
+  /**< @brief 節点xのi側の子を返す */
+  index_t child(index_t x, sides_t i) const noexcept {
+    return i ? r(x) : l(x);
+  }
+  /**< @brief 節点xの高さを返す(NILの番兵は高さ0) */
+  height_t h(index_t x) const noexcept {
+    return static_cast<height_t>(pool_[x].rh & height_mask);
+  }
+  /**< @brief 節点xの左右の子の高さの差を返す */
+  height_t bias(index_t x) const noexcept { return h(l(x)) - h(r(x)); }
+
+  void set_l(index_t x, index_t y) noexcept { pool_[x].l = y; }
+  void set_r(index_t x, index_t y) noexcept {
+    pool_[x].rh = (y << height_bits) | (pool_[x].rh & height_mask);
+  }
+  void set_h(index_t x, height_t hx) noexcept {
+    pool_[x].rh = (pool_[x].rh & ~height_mask) | std::uint32_t(hx);
+  }
+  void set_child(index_t x, sides_t i, index_t y) noexcept {
+    i ? set_r(x, y) : set_l(x, y);
+  }
+  /**< @brief 節点xの高さを子から計算し直す */
+  void update(index_t x) noexcept { set_h(x, std::max(h(l(x)), h(r(x))) + 1); }
+
+  /**< @brief 節点xの付属データを返す */
+  T &value(index_t x) noexcept {
+    if constexpr (SplitValues) {
+      return pool_.side(x);
+    } else {
+      return pool_[x].v;
+    }
+  }
+  const T &value(index_t x) const noexcept {
+    if constexpr (SplitValues) {
+      return pool_.side(x);
+    } else {
+      return pool_[x].v;
+    }
+  }
+
+private:
+  index_t root_ = nil; /**< AVL木の根 */
+  Compare cmp_;        /**< 比較述語 */
+  pool_t pool_;        /**< 節点用メモリプール */
+};
+
+/**< @brief 付属データを節点とは別の配列に置くコンパクトなAVL木 */
+template <class Key, class T, class Compare = std::less<Key>>
+using split_compact_avl_tree =
+    compact_avl_tree<Key, T, Compare,
+                     boost::container::pmr::polymorphic_allocator<
+                         compact_avl_tree_node<Key, T, true>>,
+                     true>;
+
+} // namespace container
+
+#endif // end of COMPACT_AVL_TREE_HPP
@@ -0,0 +1,113 @@
+/**
+ * @brief  添字で子を指すコンパクトなねじれヒープ
+ * @note   skew_heapと同じねじれヒープだが、節点はindex_poolの連続領域に置き、
+ *         左右の子を64ビットのポインタではなく32ビットの添字で指す
+ * @note   節点は配列の確保し直しで再配置されるので、キーはトリビアルにコピー可能でなければならない
+ */
+
+#ifndef COMPACT_SKEW_HEAP_HPP
+#define COMPACT_SKEW_HEAP_HPP
+
+#include "index_pool.hpp"
+#include <algorithm>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace container {
+
+template <class Key> struct compact_skew_heap_node {
+  std::uint32_t l; /**< 左の子の添字 */
+  std::uint32_t r; /**< 右の子の添字 */
+  Key key;         /**< キー */
+};
+
+/**
+ * @brief  添字で子を指すコンパクトなねじれヒープ
+ * @tparam Key     キーの型
+ * @tparam Compare 比較述語の型
+ */
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              compact_skew_heap_node<Key>>>
+struct compact_skew_heap {
+public:
+  static_assert(std::is_trivially_copyable_v<Key>);
+  using node = compact_skew_heap_node<Key>;
+  using pool_t = index_pool<node, Allocator>;
+  using index_t = typename pool_t::index_t;
+  static constexpr index_t nil = pool_t::nil; /**< NIL */
+
+  explicit compact_skew_heap(std::size_t n = 32) : pool_(n) {}
+
+  /** @brief ねじれヒープHに要素xを挿入する @param const Key& key 要素xのキー */
+  void push(const Key &key) {
+    const index_t x = pool_.allocate();
+    pool_[x] = node{nil, nil, key};
+    root_ = merge(root_, x);
+  }
+
+  /**< @brief ねじれヒープHから先頭のキーを取り出し、要素を削除する */
+  std::optional<Key> pop() noexcept {
+    if (empty()) {
+      return std::nullopt;
+    }
+    const index_t x = root_;
+    const Key k = pool_[x].key;
+    root_ = merge(pool_[x].l, pool_[x].r);
+    pool_.deallocate(x);
+    return std::make_optional(k);
+  }
+
+  /**< @brief ねじれヒープHが空かどうか返す */
+  bool empty() const noexcept { return root_ == nil; }
+
+  /**< @brief ねじれヒープHの要素数を返す */
+  std::size_t size() const noexcept { return pool_.live(); }
+
+  /**< @brief 節点用メモリプールを返す(使用中、空き、最大使用数、バイト数の確認用) */
+  const pool_t &pool() const noexcept { return pool_; }
+
+private:
+  /**
+   * @brief  節点xとyをマージする
+   * @note   計算量はならし時間でΟ(lgn). skew_heap::mergeと同じく根から下へ向かう1回の走査で行う
+   * @return 新しい部分木の根
+   */
+  index_t merge(index_t x, index_t y) noexcept {
+    if (x == nil) {
+      return y;
+    } // xがNILならば、yを返す
+    if (y == nil) {
+      return x;
+    } // yがNILならば、xを返す
+    if (!cmp_(pool_[x].key, pool_[y].key)) {
+      std::swap(x, y);
+    } // x.key > y.keyならば、x.key < y.keyになるよう交換
+    const index_t root = x;
+    for (;;) {
+      index_t r = pool_[x].r;  // xの右の子とyをマージした結果を、
+      pool_[x].r = pool_[x].l; // xの左の子とする(leftist)
+      if (r == nil) {
+        pool_[x].l = y;
+        break;
+      }
+      if (!cmp_(pool_[r].key, pool_[y].key)) {
+        std::swap(r, y);
+      }
+      pool_[x].l = r;
+      x = r;
+    }
+    return root; // 新しい部分木の根を返す
+  }
+
+private:
+  index_t root_ = nil; /**< 木の根 */
+  Compare cmp_;        /**< 比較述語 */
+  pool_t pool_;        /**< 節点用メモリプール */
+};
+
+} // namespace container
+
+#endif // end of COMPACT_SKEW_HEAP_HPP
@@ -0,0 +1,411 @@
+/**
+ * @brief  ロックフリーなスキップリスト(並行順序付き連想配列)
+ * @note   findはロックを取らず、CASも使わずにリンクをたどるだけのロックフリーな操作
+ *         (並行する挿入でたどるリンクが増え続けうるので、wait-freeではない)
+ *         insert/eraseはCASだけで行うロックフリーな操作で、削除は次へのリンクの最下位ビットに印を付けて表す
+ *         印の付いた節点は、探索の途中で見つけたスレッドが取り外す
+ * @note   取り外した節点はepoch_domainで回収待ちにし、全てのスレッドが参照しなくなってから解放する
+ *         そのため全ての操作はドメインのピン留めの中で行う
+ *         同時に操作できるのは生存中の256スレッドまでで、それを超えるとstd::length_errorを送出する
+ * @note   avl_treeとは異なり、insertはキーが既に存在するとき付属データを置き換えず、既存の付属データを返す
+ *         (付属データは挿入後に変更されないので、findはそれを複製するだけでよい)
+ * @note   節点は複数のスレッドから確保・解放されるので、アロケータはスレッドセーフでなければならない
+ * @note   Reference: M. Herlihy and N. Shavit,
+ *         The Art of Multiprocessor Programming, Chapter 14
+ */
+
+#ifndef CONCURRENT_SKIP_LIST_HPP
+#define CONCURRENT_SKIP_LIST_HPP
+
+#include "../random/xorshift.hpp"
+#include "epoch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace container {
+
+/**
+ * @brief スキップリストの節点
+ * @note  高さhの節点は、直後にh本の次へのリンクを続けて確保する
+ */
+template <class Key, class T> struct concurrent_skip_list_node {
+  using link = std::atomic<std::uintptr_t>;
+  /**< @brief 節点の状態(挿入と削除のうち後に終えた側が回収待ちにする) */
+  enum : std::uint32_t { linked = 1, removed = 2 };
+
+  concurrent_skip_list_node(const Key &k, const T &v, std::uint32_t h)
+      : key(k), v(v), h(h) {}
+
+  /**< @brief 次へのリンクの配列を返す */
+  link *next() noexcept {
+    return reinterpret_cast<link *>(reinterpret_cast<unsigned char *>(this) +
+                                    offset);
+  }
+  const link *next() const noexcept {
+    return reinterpret_cast<const link *>(
+        reinterpret_cast<const unsigned char *>(this) + offset);
+  }
+
+  /**< @brief リンクの配列の先頭位置(バイト) */
+  static constexpr std::size_t offset =
+      (sizeof(concurrent_skip_list_node) + alignof(link) - 1) /
+      alignof(link) * alignof(link);
+
+  Key key;                              /**< キー */
+  T v;                                  /**< 付属データ */
+  std::uint32_t h;                      /**< 高さ */
+  std::atomic<std::uint32_t> state = 0; /**< 挿入・削除の完了状態 */
+};
+
+/**
+ * @brief  ロックフリーなスキップリスト
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Compare   キーを引数にとる比較述語の型
+ * @tparam Allocator アロケータの型
+ */
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              concurrent_skip_list_node<Key, T>>>
+class concurrent_skip_list : private boost::noncopyable {
+public:
+  using node = concurrent_skip_list_node<Key, T>;
+  using link = typename node::link;
+  /**< @brief 節点の高さの上限(2^32個程度までの節点を想定) */
+  static constexpr std::uint32_t max_level = 32;
+
+private:
+  /**< @brief 節点の記憶領域の単位 */
+  struct alignas(std::max_align_t) unit {
+    unsigned char b[alignof(std::max_align_t)];
+  };
+  static_assert(alignof(node) <= alignof(unit));
+  using unit_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<unit>;
+  using alloc = std::allocator_traits<unit_alloc>;
+
+public:
+  explicit concurrent_skip_list(const Allocator &a = Allocator())
+      : alloc_(a) {
+    for (link &l : head_) {
+      l.store(0, std::memory_order_relaxed);
+    }
+  }
+  ~concurrent_skip_list() noexcept {
+    epoch_.drain();
+    for (node *x = ptr(head_[0].load(std::memory_order_relaxed)); x;) {
+      node *y = ptr(x->next()[0].load(std::memory_order_relaxed));
+      destroy_node(x);
+      x = y;
+    }
+  }
+
+  /**
+   * @brief キーkに対応する付属データを返す
+   * @note  ロックを取らず、印の付いた節点を読み飛ばしながらたどる. 期待実行時間はΟ(lgn)
+   */
+  std::optional<T> find(const Key &k) const {
+    auto g = epoch_.pin();
+    const link *pred = head_;
+    const node *curr = nullptr;
+    for (std::uint32_t l = max_level; l-- > 0;) {
+      curr = ptr(pred[l].load(std::memory_order_acquire));
+      while (curr != nullptr) {
+        std::uintptr_t succ = curr->next()[l].load(std::memory_order_acquire);
+        while (marked(succ) && (curr = ptr(succ)) != nullptr) {
+          succ = curr->next()[l].load(std::memory_order_acquire);
+        } // 印の付いた節点を読み飛ばす
+        if (curr == nullptr || !cmp_(curr->key, k)) {
+          break;
+        }
+        pred = curr->next();
+        curr = ptr(succ);
+      }
+    }
+    if (curr != nullptr && !cmp_(k, curr->key)) {
+      return std::make_optional(curr->v);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief キーkが存在しなければ、キーkと付属データvを挿入する
+   * @note  下の段から順にCASで繋ぐ. 最下段に繋いだ時点で挿入が完了したとみなす
+   * @return キーkが既に存在したとき、その付属データ
+   */
+  std::optional<T> insert(const Key &k, const T &v) {
+    auto g = epoch_.pin();
+    link *preds[max_level];
+    node *succs[max_level];
+    node *x = nullptr;
+    for (;;) {
+      if (search(k, preds, succs)) {
+        if (x != nullptr) {
+          destroy_node(x); // 公開していないので、すぐに解放してよい
+        }
+        return std::make_optional(succs[0]->v);
+      }
+      if (x == nullptr) {
+        x = create_node(k, v, random_level());
+      }
+      for (std::uint32_t l = 0; l < x->h; l++) {
+        x->next()[l].store(word(succs[l]), std::memory_order_relaxed);
+      }
+      std::uintptr_t s = word(succs[0]);
+      if (preds[0][0].compare_exchange_strong(s, word(x),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    for (std::uint32_t l = 1; l < x->h; l++) {
+      if (!link_level(x, l, preds, succs)) {
+        break;
+      } // 繋いでいる途中で削除されたら、残りの段は繋がない
+    }
+    finish(x, node::linked);
+    return std::nullopt;
+  }
+
+  /**
+   * @brief キーkを持つ節点を削除する
+   * @note  上の段から順に次へのリンクに印を付け、最下段に印を付けた時点で削除が完了したとみなす
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> erase(const Key &k) {
+    auto g = epoch_.pin();
+    link *preds[max_level];
+    node *succs[max_level];
+    if (!search(k, preds, succs)) {
+      return std::nullopt;
+    }
+    node *x = succs[0];
+    for (std::uint32_t l = x->h; l-- > 1;) {
+      std::uintptr_t s = x->next()[l].load(std::memory_order_relaxed);
+      while (!marked(s) && !x->next()[l].compare_exchange_weak(
+                               s, s | 1, std::memory_order_acq_rel)) {
+      }
+    }
+    std::uintptr_t s = x->next()[0].load(std::memory_order_relaxed);
+    for (;;) {
+      if (marked(s)) {
+        return std::nullopt;
+      } // 他のスレッドが先に削除した
+      if (x->next()[0].compare_exchange_weak(s, s | 1,
+                                             std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+    std::optional<T> opt = std::make_optional(x->v);
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    finish(x, node::removed);
+    return opt;
+  }
+
+  /**
+   * @brief  キーの昇順に、範囲[lo, hi]のキーと付属データについてfnを呼び出す
+   * @note   走査中の挿入・削除が反映されるかどうかは不定(弱い一貫性)
+   * @tparam class F const Key&, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void range(const Key &lo, const Key &hi, F fn) const {
+    auto g = epoch_.pin();
+    for (const node *x = lower(lo); x != nullptr && !cmp_(hi, x->key);
+         x = ptr(x->next()[0].load(std::memory_order_acquire))) {
+      if (!marked(x->next()[0].load(std::memory_order_acquire))) {
+        fn(x->key, x->v);
+      }
+    }
+  }
+
+  /**
+   * @brief  キーの昇順に、全てのキーと付属データについてfnを呼び出す
+   * @tparam class F const Key&, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void inorder(F fn) const {
+    auto g = epoch_.pin();
+    for (const node *x = ptr(head_[0].load(std::memory_order_acquire));
+         x != nullptr; x = ptr(x->next()[0].load(std::memory_order_acquire))) {
+      if (!marked(x->next()[0].load(std::memory_order_acquire))) {
+        fn(x->key, x->v);
+      }
+    }
+  }
+
+  /**< @brief 要素数を返す(並行して更新中のときは近似値) */
+  std::size_t size() const noexcept {
+    const std::ptrdiff_t n = size_.load(std::memory_order_relaxed);
+    return n < 0 ? 0 : static_cast<std::size_t>(n);
+  }
+  /**< @brief 空かどうか返す(並行して更新中のときは近似値) */
+  bool empty() const noexcept { return size() == 0; }
+
+  /**< @brief メモリ回収のドメインを返す */
+  epoch_domain &epoch() const noexcept { return epoch_; }
+
+private:
+  /**
+   * @brief 各段でキーk未満の最後のリンクpredsと、その次の節点succsを求める
+   * @note  途中で見つけた印の付いた節点を取り外す. 取り外しに失敗したら先頭からやり直す
+   * @return キーkを持つ節点が最下段に存在するかどうか
+   */
+  bool search(const Key &k, link **preds, node **succs,
+              const node *target = nullptr) {
+  retry:
+    link *pred = head_;
+    node *curr = nullptr;
+    for (std::uint32_t l = max_level; l-- > 0;) {
+      curr = ptr(pred[l].load(std::memory_order_acquire));
+      while (curr != nullptr) {
+        std::uintptr_t succ = curr->next()[l].load(std::memory_order_acquire);
+        while (marked(succ)) { // currに印が付いていれば取り外す
+          std::uintptr_t c = word(curr);
+          if (!pred[l].compare_exchange_strong(c, succ & ~std::uintptr_t(1),
+                                               std::memory_order_acq_rel)) {
+            goto retry;
+          }
+          curr = ptr(succ);
+          if (curr == nullptr) {
+            break;
+          }
+          succ = curr->next()[l].load(std::memory_order_acquire);
+        }
+        if (curr == nullptr || !before(curr, k, target)) {
+          break;
+        }
+        pred = curr->next();
+        curr = ptr(succ);
+      }
+      preds[l] = pred;
+      succs[l] = curr;
+    }
+    return curr != nullptr && !cmp_(k, curr->key);
+  }
+
+  /**
+   * @brief 探索で節点xをキーkより前とみなすかどうか
+   * @note  targetを指定したときは、キーが等しい節点もtargetに達するまで読み飛ばす
+   */
+  bool before(const node *x, const Key &k, const node *target) const {
+    return cmp_(x->key, k) || (target != nullptr && x != target &&
+                               !cmp_(k, x->key));
+  }
+
+  /**
+   * @brief 節点xを第l段に繋ぐ
+   * @return 繋いだかどうか(xが削除されていれば繋がない)
+   */
+  bool link_level(node *x, std::uint32_t l, link **preds, node **succs) {
+    for (;;) {
+      std::uintptr_t s = x->next()[l].load(std::memory_order_acquire);
+      if (marked(s)) {
+        return false;
+      }
+      if (ptr(s) != succs[l] &&
+          !x->next()[l].compare_exchange_strong(s, word(succs[l]),
+                                                std::memory_order_acq_rel)) {
+        continue;
+      } // xの次を最新のsuccs[l]に合わせてから、
+      std::uintptr_t c = word(succs[l]);
+      if (preds[l][l].compare_exchange_strong(c, word(x),
+                                              std::memory_order_acq_rel)) {
+        return true;
+      } // predとsuccの間に繋ぐ
+      search(x->key, preds, succs, x);
+      if (succs[0] != x) {
+        return false;
+      } // 最下段から取り外されていれば、削除された
+    }
+  }
+
+  /**
+   * @brief 節点xの挿入または削除を終えたことを記録する
+   * @note  挿入と削除の両方を終えた側が、全ての段からxを取り外してから回収待ちにする
+   *        (挿入の途中で削除された節点が、取り外した後に上の段へ繋がれることがあるため)
+   */
+  void finish(node *x, std::uint32_t done) {
+    const std::uint32_t other = done == node::linked ? node::removed
+                                                     : node::linked;
+    if (x->state.fetch_or(done, std::memory_order_acq_rel) & other) {
+      link *preds[max_level];
+      node *succs[max_level];
+      search(x->key, preds, succs, x);
+      epoch_.retire(x, this, [](void *ctx, void *p) {
+        static_cast<concurrent_skip_list *>(ctx)->destroy_node(
+            static_cast<node *>(p));
+      });
+    }
+  }
+
+  /**< @brief キーk以上の最小の節点を返す(印の付いた節点も返しうる) */
+  const node *lower(const Key &k) const {
+    const link *pred = head_;
+    const node *curr = nullptr;
+    for (std::uint32_t l = max_level; l-- > 0;) {
+      curr = ptr(pred[l].load(std::memory_order_acquire));
+      while (curr != nullptr && cmp_(curr->key, k)) {
+        pred = curr->next();
+        curr = ptr(pred[l].load(std::memory_order_acquire));
+      }
+    }
+    return curr;
+  }
+
+  /**< @brief 高さhの節点を確保して構築する */
+  node *create_node(const Key &k, const T &v, std::uint32_t h) {
+    unit *p = alloc::allocate(alloc_, units(h));
+    node *x = ::new (static_cast<void *>(p)) node(k, v, h);
+    for (std::uint32_t l = 0; l < h; l++) {
+      ::new (static_cast<void *>(x->next() + l)) link(0);
+    }
+    return x;
+  }
+
+  /**< @brief 節点xを破棄して解放する */
+  void destroy_node(node *x) noexcept {
+    const std::uint32_t h = x->h;
+    x->~node();
+    alloc::deallocate(alloc_, reinterpret_cast<unit *>(x), units(h));
+  }
+
+  /**< @brief 高さhの節点に必要な記憶領域の単位数を返す */
+  static constexpr std::size_t units(std::uint32_t h) noexcept {
+    return (node::offset + sizeof(link) * h + sizeof(unit) - 1) /
+           sizeof(unit);
+  }
+
+  /**< @brief 確率1/2^(l-1)で高さl以上となるように節点の高さを決める */
+  static std::uint32_t random_level() {
+    thread_local xorshift rng(static_cast<std::uint32_t>(
+        impl::this_thread_id() * 0x9e3779b9U + 1));
+    const std::uint32_t r = rng() | (std::uint32_t(1) << (max_level - 1));
+    return static_cast<std::uint32_t>(std::countr_zero(r)) + 1;
+  }
+
+  static node *ptr(std::uintptr_t w) noexcept {
+    return reinterpret_cast<node *>(w & ~std::uintptr_t(1));
+  }
+  static std::uintptr_t word(const node *x) noexcept {
+    return reinterpret_cast<std::uintptr_t>(x);
+  }
+  static bool marked(std::uintptr_t w) noexcept { return w & 1; }
+
+private:
+  link head_[max_level];                 /**< 先頭の番兵のリンク */
+  Compare cmp_;                          /**< 比較述語 */
+  unit_alloc alloc_;                     /**< アロケータ */
+  std::atomic<std::ptrdiff_t> size_ = 0; /**< 要素数 */
+  mutable epoch_domain epoch_;           /**< メモリ回収のドメイン */
+};
+
+} // namespace container
+
+#endif // end of CONCURRENT_SKIP_LIST_HPP
@@ -0,0 +1,105 @@
+/**
+ * @brief  d分ヒープ
+ * @note   各節点がD個の子を持つ完全D分木を配列に詰めた2分ヒープの一般化
+ *         節点iの子は配列のDi+1, ..., Di+Dに並ぶので、兄弟が連続した領域に収まる
+ *         木の高さはlog_D nになり、削除では各段でD個の子から最小のものを選ぶ
+ *         Dを4や8にすると、2分ヒープより段数とキャッシュミスが減る
+ * @note   挿入・削除では要素を交換せず、穴を動かしてから最後に1回だけ書き込む
+ */
+
+#ifndef DARY_HEAP_HPP
+#define DARY_HEAP_HPP
+
+#include <algorithm>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace container {
+
+/**
+ * @brief  d分ヒープ
+ * @tparam Key     キーの型
+ * @tparam D       各節点の子の数
+ * @tparam Compare 比較述語の型
+ */
+template <class Key, std::size_t D = 4, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<Key>>
+struct dary_heap {
+public:
+  static_assert(D >= 2 && std::is_nothrow_constructible_v<Key>);
+
+  explicit dary_heap(std::size_t n = 32, const Allocator &a = Allocator())
+      : A_(a) {
+    A_.reserve(n);
+  }
+
+  /** @brief ヒープHに要素xを挿入する. 計算量はΟ(log_D n) */
+  template <class... Args> void push(Args &&... args) {
+    Key k(std::forward<Args>(args)...);
+    std::size_t i = A_.size();
+    A_.emplace_back();
+    while (i > 0) { // 穴を親の方へ動かす
+      const std::size_t p = (i - 1) / D;
+      if (!cmp_(k, A_[p])) {
+        break;
+      }
+      A_[i] = std::move(A_[p]);
+      i = p;
+    }
+    A_[i] = std::move(k);
+  }
+
+  /**< @brief ヒープHから先頭のキーを取り出し、要素を削除する. 計算量はΟ(D log_D n) */
+  std::optional<Key> pop() noexcept {
+    if (empty()) {
+      return std::nullopt;
+    }
+    std::optional<Key> top = std::make_optional(std::move(A_.front()));
+    Key k = std::move(A_.back());
+    A_.pop_back();
+    const std::size_t n = A_.size();
+    if (n > 0) {
+      std::size_t i = 0;
+      for (;;) { // 穴を最小の子の方へ動かす
+        const std::size_t c = D * i + 1;
+        if (c >= n) {
+          break;
+        }
+        const std::size_t e = std::min(c + D, n);
+        std::size_t m = c;
+        for (std::size_t j = c + 1; j < e; j++) {
+          if (cmp_(A_[j], A_[m])) {
+            m = j;
+          }
+        }
+        if (!cmp_(A_[m], k)) {
+          break;
+        }
+        A_[i] = std::move(A_[m]);
+        i = m;
+      }
+      A_[i] = std::move(k);
+    }
+    return top;
+  }
+
+  /**< @brief ヒープHが空かどうか返す */
+  bool empty() const noexcept { return A_.empty(); }
+
+  /**< @brief ヒープHの要素数を返す */
+  std::size_t size() const noexcept { return A_.size(); }
+
+  /**< @brief ヒープHが満杯(次の挿入で配列の確保し直しが必要)かどうか返す */
+  bool full() const noexcept { return A_.size() == A_.capacity(); }
+
+private:
+  std::vector<Key, Allocator> A_; /**< ヒープを詰めた配列 */
+  Compare cmp_;                   /**< 比較述語 */
+};
+
+} // namespace container
+
+#endif // end of DARY_HEAP_HPP
@@ -0,0 +1,231 @@
+/**
+ * @brief  エポックに基づくメモリ回収(EBR)
+ * @note   ロックフリーなデータ構造から取り外した節点を、他のスレッドが参照しなくなるまで解放を遅らせる
+ *         データ構造を触るスレッドはpin()で得たガードの生存期間の間だけ節点を参照してよい
+ *         取り外した節点はretire()に渡しておき、大域エポックが2つ進んだ後に解放する
+ * @note   大域エポックは、ピン留め中の全てのスレッドが現在のエポックを観測したときにだけ進む
+ *         エポックgで回収待ちにした節点を参照しうるのは、ローカルエポックがg以下のスレッドだけなので、
+ *         大域エポックがg+2になった時点でそれらは全てピン留めを外している
+ * @note   スレッドは小さな番号で識別し、番号はスレッドの終了時に再利用する
+ *         番号を持てるのは同時に生存している高々max_threads(256)個のスレッドまでで、
+ *         それを超えたスレッドが初めてピン留めしようとするとstd::length_errorを送出する
+ *         ドメインごとにスレッド番号で引くスロットを持ち、回収待ちの節点もスロットに置くので、
+ *         スレッドが終了しても回収待ちの節点は失われない
+ * @note   Reference: K. Fraser, Practical lock-freedom, 2004
+ */
+
+#ifndef EPOCH_HPP
+#define EPOCH_HPP
+
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace container {
+
+namespace impl {
+
+/**< @brief 同時に動作できるスレッド数の上限 */
+constexpr std::size_t max_threads = 256;
+
+/**< @brief スレッドに小さな番号を割り当てる登録簿 */
+class thread_registry : private boost::noncopyable {
+public:
+  /**
+   * @brief 空いている番号を1つ取得する
+   * @throw std::length_error 全ての番号が使用中のとき
+   */
+  std::size_t acquire() {
+    for (std::size_t i = 0; i < max_threads; i++) {
+      bool expected = false;
+      if (!used_[i].load(std::memory_order_relaxed) &&
+          used_[i].compare_exchange_strong(expected, true,
+                                           std::memory_order_acquire)) {
+        std::size_t h = high_.load(std::memory_order_relaxed);
+        while (h < i + 1 && !high_.compare_exchange_weak(
+                                h, i + 1, std::memory_order_release)) {
+        }
+        return i;
+      }
+    }
+    throw std::length_error("Too many threads.");
+  }
+  /**< @brief 番号iを返却する */
+  void release(std::size_t i) noexcept {
+    used_[i].store(false, std::memory_order_release);
+  }
+  /**< @brief これまでに割り当てた番号の上限を返す */
+  std::size_t high() const noexcept {
+    return high_.load(std::memory_order_acquire);
+  }
+
+private:
+  std::atomic<bool> used_[max_threads] = {}; /**< 番号の使用状況 */
+  std::atomic<std::size_t> high_ = 0;        /**< 割り当てた番号の上限 */
+};
+
+/**< @brief スレッド番号の登録簿を返す */
+inline thread_registry &registry() noexcept {
+  static thread_registry r;
+  return r;
+}
+
+/**< @brief スレッドの生存期間の間だけ番号を保持する */
+struct thread_id {
+  thread_id() : id(registry().acquire()) {}
+  ~thread_id() noexcept { registry().release(id); }
+  const std::size_t id; /**< スレッド番号 */
+};
+
+/**
+ * @brief 呼び出したスレッドの番号を返す
+ * @throw std::length_error 初めて呼び出したときに番号が残っていなければ
+ */
+inline std::size_t this_thread_id() {
+  thread_local thread_id t;
+  return t.id;
+}
+
+} // namespace impl
+
+/**< @brief エポックに基づくメモリ回収のドメイン */
+class epoch_domain : private boost::noncopyable {
+  /**< @brief 回収待ちの節点と、その解放関数 */
+  struct retired {
+    void *p;                        /**< 節点 */
+    void *ctx;                      /**< 解放関数に渡す文脈 */
+    void (*fn)(void *ctx, void *p); /**< 解放関数 */
+  };
+  /**< @brief スレッドごとの状態(キャッシュラインを共有しないように揃える) */
+  struct alignas(64) slot {
+    std::atomic<std::uint64_t> epoch = 0; /**< (ローカルエポック << 1) | ピン留め中 */
+    std::size_t depth = 0;                /**< ピン留めの入れ子の深さ */
+    std::size_t count = 0;                /**< 前回エポックを進めようとしてからの回収待ちの数 */
+    std::vector<retired> bags[3];         /**< エポックごとの回収待ちの節点 */
+    std::uint64_t tags[3] = {};           /**< 各袋のエポック */
+  };
+
+public:
+  /**< @brief 回収待ちがこの数だけたまるごとに大域エポックを進めようとする */
+  static constexpr std::size_t advance_interval = 64;
+
+  /**< @brief ピン留めの生存期間を表すガード */
+  class guard : private boost::noncopyable {
+  public:
+    explicit guard(epoch_domain &d) : d_(d) { d_.enter(); }
+    ~guard() noexcept { d_.leave(); }
+
+  private:
+    epoch_domain &d_; /**< ドメイン */
+  };
+
+  epoch_domain() = default;
+  ~epoch_domain() noexcept { drain(); }
+
+  /**
+   * @brief 呼び出したスレッドをピン留めし、そのガードを返す
+   * @throw std::length_error スレッド番号が残っていないとき
+   */
+  guard pin() { return guard(*this); }
+
+  /**
+   * @brief 取り外した節点pを回収待ちにする
+   * @note  ピン留め中に呼び出すこと. pは他のスレッドから新たに辿れないようになっていなければならない
+   * @param void (*fn)(void *ctx, void *p) pを解放する関数
+   */
+  void retire(void *p, void *ctx, void (*fn)(void *, void *)) {
+    slot &s = slots_[impl::this_thread_id()];
+    BOOST_ASSERT_MSG(s.depth > 0, "retire() requires a pinned thread.");
+    const std::uint64_t g = global_.load(std::memory_order_seq_cst);
+    const std::size_t b = g % 3;
+    if (s.tags[b] != g) { // 袋の中身は3つ前以前のエポックなので解放してよい
+      release(s.bags[b]);
+      s.tags[b] = g;
+    }
+    s.bags[b].push_back(retired{p, ctx, fn});
+    if (++s.count >= advance_interval) {
+      s.count = 0;
+      try_advance();
+      collect(s);
+    }
+  }
+
+  /**
+   * @brief 全ての回収待ちの節点を解放する
+   * @note  どのスレッドもピン留めしていないときにだけ呼び出すこと
+   */
+  void drain() noexcept {
+    for (slot &s : slots_) {
+      for (std::vector<retired> &bag : s.bags) {
+        release(bag);
+      }
+    }
+  }
+
+  /**< @brief 大域エポックを返す */
+  std::uint64_t epoch() const noexcept {
+    return global_.load(std::memory_order_relaxed);
+  }
+
+private:
+  /**< @brief ピン留めする(入れ子にできる) */
+  void enter() {
+    slot &s = slots_[impl::this_thread_id()];
+    if (s.depth++ == 0) {
+      const std::uint64_t g = global_.load(std::memory_order_relaxed);
+      s.epoch.store((g << 1) | 1, std::memory_order_release);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  /**< @brief ピン留めを外す */
+  void leave() noexcept {
+    slot &s = slots_[impl::this_thread_id()];
+    if (--s.depth == 0) {
+      s.epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  /**< @brief ピン留め中の全てのスレッドが現在のエポックにいれば、大域エポックを1つ進める */
+  void try_advance() noexcept {
+    std::uint64_t g = global_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::size_t n = impl::registry().high();
+    for (std::size_t i = 0; i < n; i++) {
+      const std::uint64_t e = slots_[i].epoch.load(std::memory_order_acquire);
+      if ((e & 1) && (e >> 1) != g) {
+        return;
+      }
+    }
+    global_.compare_exchange_strong(g, g + 1, std::memory_order_acq_rel);
+  }
+
+  /**< @brief スロットsの袋のうち、大域エポックより2つ以上前のものを解放する */
+  void collect(slot &s) {
+    const std::uint64_t g = global_.load(std::memory_order_acquire);
+    for (std::size_t b = 0; b < 3; b++) {
+      if (s.tags[b] + 2 <= g) {
+        release(s.bags[b]);
+      }
+    }
+  }
+
+  /**< @brief 袋の節点を全て解放する */
+  static void release(std::vector<retired> &bag) noexcept {
+    for (const retired &r : bag) {
+      r.fn(r.ctx, r.p);
+    }
+    bag.clear();
+  }
+
+private:
+  std::atomic<std::uint64_t> global_ = 0; /**< 大域エポック */
+  slot slots_[impl::max_threads];         /**< スレッドごとの状態 */
+};
+
+} // namespace container
+
+#endif // end of EPOCH_HPP
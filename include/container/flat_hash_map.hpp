@@ -0,0 +1,428 @@
+/**
+ * @brief  開番地法のハッシュ表
+ * @note   要素をスロットの配列に直接置き、スロットごとに1バイトの制御バイトを持つ(Swiss table)
+ *         制御バイトは空(最上位ビットが1)か、ハッシュ値から取った7ビット(H2)のどちらか
+ *         探索ではハッシュ値の上位ビット(H1)で決まる位置から16個の制御バイトをまとめて読み、
+ *         H2が一致するスロットのキーだけを比べる. 16個の中に空があればそこで探索を終える
+ * @note   衝突は線形探査で解決するので、キーは自身の位置から最初の空までの間に必ずある
+ *         削除では墓石を置かず、後続の要素を本来の位置を越えない範囲で1つずつ前へ詰める(後退シフト)
+ *         そのため削除を繰り返しても探索が長くならない
+ * @note   制御バイトの配列の末尾には先頭の15バイトの複製を置き、
+ *         末尾付近から読む16バイトが配列の先頭へ折り返した分も1回の読み込みで得られるようにする
+ * @note   Reference: M. Kulukundis, Designing a fast, efficient,
+ *         cache-friendly hash table, step by step, CppCon 2017
+ */
+
+#ifndef FLAT_HASH_MAP_HPP
+#define FLAT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace container {
+
+namespace impl {
+
+/**< @brief 制御バイトの群の大きさ */
+constexpr std::size_t group_width = 16;
+
+/**< @brief 空のスロットを表す制御バイト */
+constexpr std::uint8_t ctrl_empty = 0x80;
+
+/**< @brief 16個の制御バイトの群 */
+struct group {
+#if defined(__SSE2__)
+  explicit group(const std::uint8_t *p) noexcept
+      : v(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+  /**< @brief 制御バイトがh2に一致するスロットのビットマスクを返す */
+  unsigned match(std::uint8_t h2) const noexcept {
+    const __m128i x = _mm_set1_epi8(static_cast<char>(h2));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, x));
+  }
+  /**< @brief 空のスロットのビットマスクを返す */
+  unsigned match_empty() const noexcept { return _mm_movemask_epi8(v); }
+
+  __m128i v; /**< 制御バイト */
+#else
+  explicit group(const std::uint8_t *p) noexcept { std::memcpy(v, p, 16); }
+  unsigned match(std::uint8_t h2) const noexcept {
+    unsigned m = 0;
+    for (std::size_t i = 0; i < group_width; i++) {
+      m |= static_cast<unsigned>(v[i] == h2) << i;
+    }
+    return m;
+  }
+  unsigned match_empty() const noexcept {
+    unsigned m = 0;
+    for (std::size_t i = 0; i < group_width; i++) {
+      m |= static_cast<unsigned>(v[i] >> 7) << i;
+    }
+    return m;
+  }
+
+  std::uint8_t v[group_width]; /**< 制御バイト */
+#endif
+};
+
+/**< @brief ハッシュ関数と等価述語がどちらも異種のキーでの探索を許すかどうか */
+template <class Hash, class Eq>
+inline constexpr bool is_transparent_v = requires {
+  typename Hash::is_transparent;
+  typename Eq::is_transparent;
+};
+
+} // namespace impl
+
+/**
+ * @brief  開番地法のハッシュ表
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Hash      ハッシュ関数の型
+ * @tparam Eq        等価述語の型
+ * @tparam Allocator アロケータの型
+ */
+template <class Key, class T, class Hash = std::hash<Key>,
+          class Eq = std::equal_to<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              std::pair<Key, T>>>
+class flat_hash_map : private boost::noncopyable {
+public:
+  using value_type = std::pair<Key, T>;
+
+private:
+  static_assert(alignof(value_type) <= alignof(std::max_align_t));
+  static_assert(std::is_nothrow_move_constructible_v<value_type>);
+  static_assert(sizeof(std::size_t) == 8);
+  using byte_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<unsigned char>;
+  using byte_traits = std::allocator_traits<byte_alloc>;
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr std::size_t min_capacity = impl::group_width;
+  static constexpr bool transparent = impl::is_transparent_v<Hash, Eq>;
+
+public:
+  explicit flat_hash_map(std::size_t n = 0, const Hash &hash = Hash(),
+                         const Eq &eq = Eq(), const Allocator &a = Allocator())
+      : hash_(hash), eq_(eq), alloc_(a) {
+    reserve(n);
+  }
+  ~flat_hash_map() noexcept { release(); }
+
+  /**< @brief 要素数を返す */
+  std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうか返す */
+  bool empty() const noexcept { return size_ == 0; }
+  /**< @brief スロットの数を返す */
+  std::size_t capacity() const noexcept { return cap_; }
+  /**< @brief 負荷率を返す */
+  double load_factor() const noexcept {
+    return cap_ == 0 ? 0.0 : static_cast<double>(size_) / cap_;
+  }
+
+  /**
+   * @brief 再ハッシュなしでn個の要素を格納できるようにする
+   * @note  負荷率は7/8以下に保つ
+   */
+  void reserve(std::size_t n) {
+    std::size_t cap = min_capacity;
+    while (cap - cap / 8 < n) {
+      cap <<= 1;
+    }
+    if (cap > cap_) {
+      rehash(cap);
+    }
+  }
+
+  /**
+   * @brief  キーkに対応する付属データを返す
+   * @note   平均の実行時間はΟ(1)
+   */
+  std::optional<T> find(const Key &k) const {
+    const std::size_t i = lookup(k);
+    return i == npos ? std::nullopt : std::make_optional(S_[i].second);
+  }
+  template <class Q>
+    requires transparent
+  std::optional<T> find(const Q &k) const {
+    const std::size_t i = lookup(k);
+    return i == npos ? std::nullopt : std::make_optional(S_[i].second);
+  }
+
+  /**
+   * @brief  キーkに対応する付属データへのポインタを返す
+   * @note   コピーを行わずにその場で読み書きできる. 挿入か削除を行うと無効になる
+   * @return キーkに対応する付属データへのポインタ(存在しなければNIL)
+   */
+  T *get(const Key &k) { return get_impl(k); }
+  const T *get(const Key &k) const { return get_impl(k); }
+  template <class Q>
+    requires transparent
+  T *get(const Q &k) {
+    return get_impl(k);
+  }
+  template <class Q>
+    requires transparent
+  const T *get(const Q &k) const {
+    return get_impl(k);
+  }
+
+  /**< @brief キーkを持つ要素があるかどうか返す */
+  bool contains(const Key &k) const { return lookup(k) != npos; }
+  template <class Q>
+    requires transparent
+  bool contains(const Q &k) const {
+    return lookup(k) != npos;
+  }
+
+  /**
+   * @brief  キーkと付属データvを挿入する. キーkが既にあれば付属データを置き換える
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> insert(const Key &k, const T &v) {
+    auto [p, inserted] = try_emplace(k, v);
+    if (inserted) {
+      return std::nullopt;
+    }
+    std::optional<T> opt = std::make_optional(*p);
+    *p = v;
+    return opt;
+  }
+
+  /**
+   * @brief  キーkが無ければ、argsから構築した付属データと共に挿入する
+   * @return キーkに対応する付属データへのポインタと、挿入したかどうか
+   */
+  template <class K, class... Args>
+  std::pair<T *, bool> try_emplace(K &&k, Args &&... args) {
+    const std::uint64_t h = hash(k);
+    if (const std::size_t i = lookup(k, h); i != npos) {
+      return {&S_[i].second, false};
+    }
+    if (size_ + 1 > cap_ - cap_ / 8) {
+      rehash(std::max(2 * cap_, min_capacity));
+    }
+    const std::size_t i = find_empty(h);
+    ::new (static_cast<void *>(&S_[i]))
+        value_type(std::piecewise_construct,
+                   std::forward_as_tuple(std::forward<K>(k)),
+                   std::forward_as_tuple(std::forward<Args>(args)...));
+    set_ctrl(i, h2(h));
+    size_++;
+    return {&S_[i].second, true};
+  }
+
+  /**
+   * @brief  キーkを持つ要素を削除する
+   * @note   後続の要素を前へ詰めるので、他の要素へのポインタも無効になる
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> erase(const Key &k) { return erase_impl(k); }
+  template <class Q>
+    requires transparent
+  std::optional<T> erase(const Q &k) {
+    return erase_impl(k);
+  }
+
+  /**< @brief 全ての要素を削除する(スロットの配列は残す) */
+  void clear() noexcept {
+    for (std::size_t i = 0; i < cap_; i++) {
+      if (full(i)) {
+        std::destroy_at(&S_[i]);
+      }
+    }
+    if (cap_ > 0) {
+      std::memset(ctrl_, impl::ctrl_empty, cap_ + impl::group_width - 1);
+    }
+    size_ = 0;
+  }
+
+  /**
+   * @brief  全ての要素を巡回する(順序は不定)
+   * @tparam class F const Key&, T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void for_each(F fn) {
+    for (std::size_t i = 0; i < cap_; i++) {
+      if (full(i)) {
+        fn(std::as_const(S_[i].first), S_[i].second);
+      }
+    }
+  }
+
+private:
+  /**
+   * @brief キーkのハッシュ値を返す
+   * @note  std::hashは整数に対して恒等写像のことがあるので、黄金比の乗算で混ぜる
+   *        乗算の結果は上位ビットほどよく混ざるので、H1とH2は上位ビットから取る
+   */
+  template <class K> std::uint64_t hash(const K &k) const {
+    return static_cast<std::uint64_t>(hash_(k)) * 0x9e3779b97f4a7c15ULL;
+  }
+  /**< @brief ハッシュ値hから探索を始める位置(H1: 上位lg capビット)を返す */
+  std::size_t h1(std::uint64_t h) const noexcept { return h >> shift_; }
+  /**< @brief ハッシュ値hから制御バイト(H2: H1の次の7ビット)を返す */
+  std::uint8_t h2(std::uint64_t h) const noexcept {
+    return (h >> (shift_ - 7)) & 0x7f;
+  }
+
+  /**< @brief スロットiに要素があるかどうか返す */
+  bool full(std::size_t i) const noexcept {
+    return (ctrl_[i] & impl::ctrl_empty) == 0;
+  }
+
+  /**< @brief スロットiの制御バイトをcにする(先頭の15バイトは末尾の複製も書き換える) */
+  void set_ctrl(std::size_t i, std::uint8_t c) noexcept {
+    ctrl_[i] = c;
+    if (i < impl::group_width - 1) {
+      ctrl_[cap_ + i] = c;
+    }
+  }
+
+  /**< @brief キーkを持つスロットを返す(存在しなければnpos) */
+  template <class K> std::size_t lookup(const K &k) const {
+    return cap_ == 0 ? npos : lookup(k, hash(k));
+  }
+  template <class K>
+  std::size_t lookup(const K &k, std::uint64_t h) const {
+    if (cap_ == 0) {
+      return npos;
+    }
+    const std::uint8_t c = h2(h);
+    const std::size_t mask = cap_ - 1;
+    for (std::size_t pos = h1(h);; pos = (pos + impl::group_width) & mask) {
+      const impl::group g(ctrl_ + pos);
+      for (unsigned m = g.match(c); m != 0; m &= m - 1) {
+        const std::size_t i = (pos + std::countr_zero(m)) & mask;
+        if (eq_(S_[i].first, k)) {
+          return i;
+        }
+      }
+      if (g.match_empty() != 0) {
+        return npos;
+      }
+    }
+  }
+
+  /**< @brief ハッシュ値hの位置から最初の空のスロットを返す */
+  std::size_t find_empty(std::uint64_t h) const noexcept {
+    const std::size_t mask = cap_ - 1;
+    for (std::size_t pos = h1(h);; pos = (pos + impl::group_width) & mask) {
+      if (const unsigned m = impl::group(ctrl_ + pos).match_empty(); m != 0) {
+        return (pos + std::countr_zero(m)) & mask;
+      }
+    }
+  }
+
+  template <class K> T *get_impl(const K &k) const {
+    const std::size_t i = lookup(k);
+    return i == npos ? nullptr : &S_[i].second;
+  }
+
+  /**
+   * @brief キーkを持つ要素を後退シフトで削除する
+   * @note  空いたスロットiの後ろの要素jを順に見て、jの本来の位置がiより後ろ(iからjの間)でなければ
+   *        jをiへ移し、jを新たな空きとする. 空のスロットに着いたら終わる
+   */
+  template <class K> std::optional<T> erase_impl(const K &k) {
+    std::size_t i = lookup(k);
+    if (i == npos) {
+      return std::nullopt;
+    }
+    std::optional<T> opt = std::make_optional(std::move(S_[i].second));
+    std::destroy_at(&S_[i]);
+    const std::size_t mask = cap_ - 1;
+    for (std::size_t j = (i + 1) & mask; full(j); j = (j + 1) & mask) {
+      const std::size_t home = h1(hash(S_[j].first));
+      if (((j - home) & mask) >= ((j - i) & mask)) {
+        ::new (static_cast<void *>(&S_[i])) value_type(std::move(S_[j]));
+        std::destroy_at(&S_[j]);
+        set_ctrl(i, ctrl_[j]);
+        i = j;
+      }
+    }
+    set_ctrl(i, impl::ctrl_empty);
+    size_--;
+    return opt;
+  }
+
+  /**< @brief 制御バイトの配列のバイト数(スロットの配列の境界に揃える)を返す */
+  static std::size_t ctrl_bytes(std::size_t cap) noexcept {
+    const std::size_t n = cap + impl::group_width - 1;
+    const std::size_t a = alignof(value_type);
+    return (n + a - 1) / a * a;
+  }
+
+  /**< @brief スロットの数をcapにして、全ての要素を入れ直す */
+  void rehash(std::size_t cap) {
+    BOOST_ASSERT_MSG(std::has_single_bit(cap) && cap >= min_capacity,
+                     "Capacity must be a power of two.");
+    const std::size_t bytes = ctrl_bytes(cap) + cap * sizeof(value_type);
+    unsigned char *raw = byte_traits::allocate(alloc_, bytes);
+    std::uint8_t *old_ctrl = ctrl_;
+    value_type *old_S = S_;
+    const std::size_t old_cap = cap_;
+    const std::size_t old_bytes = bytes_;
+    ctrl_ = reinterpret_cast<std::uint8_t *>(raw);
+    S_ = reinterpret_cast<value_type *>(raw + ctrl_bytes(cap));
+    cap_ = cap;
+    shift_ = 64 - std::countr_zero(cap);
+    bytes_ = bytes;
+    std::memset(ctrl_, impl::ctrl_empty, cap + impl::group_width - 1);
+    for (std::size_t i = 0; i < old_cap; i++) {
+      if ((old_ctrl[i] & impl::ctrl_empty) == 0) {
+        const std::uint64_t h = hash(old_S[i].first);
+        const std::size_t j = find_empty(h);
+        ::new (static_cast<void *>(&S_[j])) value_type(std::move(old_S[i]));
+        std::destroy_at(&old_S[i]);
+        set_ctrl(j, h2(h));
+      }
+    }
+    if (old_ctrl != nullptr) {
+      byte_traits::deallocate(
+          alloc_, reinterpret_cast<unsigned char *>(old_ctrl), old_bytes);
+    }
+  }
+
+  /**< @brief 全ての要素を破棄し、配列を解放する */
+  void release() noexcept {
+    if (ctrl_ == nullptr) {
+      return;
+    }
+    clear();
+    byte_traits::deallocate(alloc_, reinterpret_cast<unsigned char *>(ctrl_),
+                            bytes_);
+    ctrl_ = nullptr;
+    S_ = nullptr;
+    cap_ = bytes_ = 0;
+  }
+
+private:
+  std::uint8_t *ctrl_ = nullptr; /**< 制御バイトの配列(末尾に先頭の複製を持つ) */
+  value_type *S_ = nullptr;      /**< スロットの配列 */
+  std::size_t cap_ = 0;          /**< スロットの数(2の冪) */
+  int shift_ = 64;               /**< H1を取り出すシフト量(64 - lg cap) */
+  std::size_t size_ = 0;         /**< 要素数 */
+  std::size_t bytes_ = 0;        /**< 確保したバイト数 */
+  Hash hash_;                    /**< ハッシュ関数 */
+  Eq eq_;                        /**< 等価述語 */
+  byte_alloc alloc_;             /**< アロケータ */
+};
+
+} // namespace container
+
+#endif // end of FLAT_HASH_MAP_HPP
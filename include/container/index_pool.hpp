@@ -0,0 +1,182 @@
+/**
+ * @brief  添字で節点を指す連続領域の節点用メモリプール
+ * @note   節点を1本の配列に詰めて置き、ポインタの代わりに32ビットの添字で指す
+ *         添字0は番兵(NIL)として予約し、その節点は0で初期化しておく.
+ *         これによりNILの子や高さを分岐なしに読み出せる
+ * @note   容量が足りなくなると配列ごと倍の大きさに確保し直す.
+ *         添字は変わらないが節点のアドレスは変わるので、確保の前後で参照を持ち越さないこと
+ *         再配置はmemcpyで行うため、節点(と付属配列の要素)はトリビアルにコピー可能でなければならない
+ */
+
+#ifndef INDEX_POOL_HPP
+#define INDEX_POOL_HPP
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace container {
+
+/**
+ * @brief  添字で節点を指す連続領域の節点用メモリプール
+ * @tparam Node      節点の型
+ * @tparam Allocator アロケータの型
+ * @tparam Side      節点と同じ添字で引く付属配列の要素の型(voidのとき付属配列を持たない)
+ */
+template <class Node,
+          class Allocator = boost::container::pmr::polymorphic_allocator<Node>,
+          class Side = void>
+class index_pool : private boost::noncopyable {
+  static_assert(std::is_trivially_copyable_v<Node> &&
+                    sizeof(Node) >= sizeof(std::uint32_t),
+                "index_pool requires trivially copyable nodes.");
+  static constexpr bool has_side = !std::is_void_v<Side>;
+  using side_t = std::conditional_t<has_side, Side, char>;
+  static_assert(std::is_trivially_copyable_v<side_t>,
+                "index_pool requires trivially copyable side values.");
+  using node_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using side_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<side_t>;
+  using node_traits = std::allocator_traits<node_alloc>;
+  using side_traits = std::allocator_traits<side_alloc>;
+
+public:
+  using index_t = std::uint32_t;
+  static constexpr index_t nil = 0; /**< 番兵の添字 */
+
+  /**
+   * @brief 番兵を含めてn+1個分の節点を確保する
+   * @param std::size_t n       最初に確保する節点数
+   * @param index_t     max     添字の上限(これ以上の添字は割り当てない)
+   * @param const Allocator& a  アロケータ
+   */
+  explicit index_pool(std::size_t n = 32,
+                      index_t max = std::numeric_limits<index_t>::max(),
+                      const Allocator &a = Allocator())
+      : nalloc_(a), salloc_(a), max_(max) {
+    grow(std::max<std::size_t>(std::min<std::size_t>(n, max_), 1) + 1);
+    std::memset(static_cast<void *>(nodes_), 0, sizeof(Node)); // 番兵
+    top_ = 1;
+  }
+  ~index_pool() noexcept { release(); }
+
+  /**
+   * @brief  節点1つ分を割り当て、その添字を返す
+   * @note   自由リストに空きがあればそれを再利用する. 配列の確保し直しを含めてならしΟ(1)
+   * @throw  std::bad_alloc 添字の上限まで使い切っているとき
+   */
+  index_t allocate() {
+    index_t i = free_;
+    if (i != nil) {
+      std::memcpy(&free_, &nodes_[i], sizeof(index_t));
+    } else {
+      if (top_ > max_) { // 上限を超える添字は詰めた添字のビットに収まらない
+        throw std::bad_alloc();
+      }
+      if (top_ == cap_) {
+        grow(std::min<std::size_t>(cap_ << 1, std::size_t(max_) + 1));
+      }
+      i = static_cast<index_t>(top_++);
+    }
+    high_water_ = std::max(high_water_, ++live_);
+    return i;
+  }
+
+  /**< @brief 添字iの節点を自由リストへ返す. 計算量はΟ(1) */
+  void deallocate(index_t i) noexcept {
+    BOOST_ASSERT_MSG(i != nil && live_ > 0, "Index pool underflow.");
+    std::memcpy(&nodes_[i], &free_, sizeof(index_t));
+    free_ = i;
+    live_--;
+  }
+
+  /**
+   * @brief 少なくともn個の節点を確保し直しなしに割り当てられるようにする
+   * @throw std::bad_alloc nが添字の上限を超えるとき
+   */
+  void reserve(std::size_t n) {
+    if (n > max_) {
+      throw std::bad_alloc();
+    }
+    if (n + 1 > cap_) {
+      grow(n + 1);
+    }
+  }
+
+  /**< @brief 添字iの節点を返す */
+  Node &operator[](index_t i) noexcept { return nodes_[i]; }
+  const Node &operator[](index_t i) const noexcept { return nodes_[i]; }
+  /**< @brief 添字iの付属配列の要素を返す */
+  side_t &side(index_t i) noexcept { return sides_[i]; }
+  const side_t &side(index_t i) const noexcept { return sides_[i]; }
+
+  /**< @brief 使用中の節点数を返す */
+  std::size_t live() const noexcept { return live_; }
+  /**< @brief 確保し直しなしに割り当てられる節点数を返す */
+  std::size_t free() const noexcept { return capacity() - live_; }
+  /**< @brief 使用中の節点数の最大値を返す */
+  std::size_t high_water() const noexcept { return high_water_; }
+  /**< @brief 確保済みの節点数を返す(番兵を除く) */
+  std::size_t capacity() const noexcept { return cap_ - 1; }
+  /**< @brief 確保済みの記憶領域の大きさ(バイト)を返す */
+  std::size_t bytes() const noexcept {
+    return cap_ * (sizeof(Node) + (has_side ? sizeof(side_t) : 0));
+  }
+
+private:
+  /**< @brief 配列をn個分の大きさに確保し直す */
+  void grow(std::size_t n) {
+    Node *nodes = node_traits::allocate(nalloc_, n);
+    side_t *sides = has_side ? side_traits::allocate(salloc_, n) : nullptr;
+    if (nodes_ != nullptr) {
+      std::memcpy(static_cast<void *>(nodes), nodes_, sizeof(Node) * top_);
+      node_traits::deallocate(nalloc_, nodes_, cap_);
+      if constexpr (has_side) {
+        std::memcpy(static_cast<void *>(sides), sides_,
+                    sizeof(side_t) * top_);
+        side_traits::deallocate(salloc_, sides_, cap_);
+      }
+    }
+    nodes_ = nodes;
+    sides_ = sides;
+    cap_ = n;
+  }
+
+  /**< @brief 配列を解放する */
+  void release() noexcept {
+    if (nodes_ != nullptr) {
+      node_traits::deallocate(nalloc_, nodes_, cap_);
+      if constexpr (has_side) {
+        side_traits::deallocate(salloc_, sides_, cap_);
+      }
+    }
+    nodes_ = nullptr;
+    sides_ = nullptr;
+    free_ = top_ = 0;
+    cap_ = live_ = 0;
+  }
+
+private:
+  node_alloc nalloc_;          /**< 節点のアロケータ */
+  side_alloc salloc_;          /**< 付属配列のアロケータ */
+  Node *nodes_ = nullptr;      /**< 節点の配列 */
+  side_t *sides_ = nullptr;    /**< 付属配列 */
+  index_t free_ = nil;         /**< 自由リストの先頭 */
+  std::size_t top_ = 0;        /**< 未使用領域の先頭 */
+  index_t max_ = 0;            /**< 添字の上限 */
+  std::size_t cap_ = 0;        /**< 配列の大きさ(番兵を含む) */
+  std::size_t live_ = 0;       /**< 使用中の節点数 */
+  std::size_t high_water_ = 0; /**< 使用中の節点数の最大値 */
+};
+
+} // namespace container
+
+#endif // end of INDEX_POOL_HPP
@@ -0,0 +1,254 @@
+/**
+ * @brief  多生産者・多消費者(MPMC)の有界なロックフリーキュー
+ * @note   各スロットが通し番号seqを持ち、位置posのスロットは
+ *         seq == posのとき書き込み可能、seq == pos + 1のとき読み出し可能になる
+ *         読み出した後はseq = pos + capとして、リングを1周した次の書き込みに備える
+ *         生産者と消費者は末尾と先頭の位置だけを奪い合い、スロット自体の受け渡しはseqで同期する
+ * @note   try_push/try_popはseqを見てから位置をCASで確保するので、空や満杯のときは待たずに失敗する
+ *         push/popとspin_push/spin_popは位置をfetch_addで先に確保し、そのスロットの番が来るまで待つ
+ *         push/popは少しスピンした後でstd::atomic::waitで眠り、spin_push/spin_popは眠らない
+ * @note   要素は位置を確保する前に構築しておくので、構築が例外を投げてもスロットが塞がらない
+ * @note   Reference: D. Vyukov, Bounded MPMC queue
+ */
+
+#ifndef MPMC_QUEUE_HPP
+#define MPMC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace container {
+
+namespace impl {
+
+/**< @brief スピン待ちの1回分の休止(ハイパースレッドの相方に実行資源を譲る) */
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#endif
+}
+
+} // namespace impl
+
+/**
+ * @brief  MPMCキュー
+ * @tparam T         キューの要素の型
+ * @tparam Allocator アロケータの型
+ */
+template <class T,
+          class Allocator = boost::container::pmr::polymorphic_allocator<T>>
+class mpmc_queue : private boost::noncopyable {
+  static_assert(std::is_nothrow_move_constructible_v<T> &&
+                std::is_nothrow_destructible_v<T>);
+  static constexpr std::size_t cache_line = 64; /**< キャッシュラインの大きさ */
+  static constexpr int spin_limit = 128;        /**< 眠る前にスピンする回数 */
+
+  /**< @brief スロット */
+  struct slot {
+    std::atomic<std::size_t> seq;                /**< 通し番号 */
+    alignas(T) unsigned char storage[sizeof(T)]; /**< 要素の記憶領域 */
+    T *get() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+  };
+  using slot_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+  using slot_traits = std::allocator_traits<slot_alloc>;
+
+public:
+  /**
+   * @brief 容量がn以上の最小の2の冪のキューを作る
+   */
+  explicit mpmc_queue(std::size_t n = 32, const Allocator &a = Allocator())
+      : alloc_(a), cap_(std::bit_ceil(std::max<std::size_t>(n, 2))),
+        mask_(cap_ - 1) {
+    S_ = slot_traits::allocate(alloc_, cap_);
+    for (std::size_t i = 0; i < cap_; i++) {
+      ::new (static_cast<void *>(&S_[i].seq)) std::atomic<std::size_t>(i);
+    }
+  }
+  ~mpmc_queue() noexcept {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    for (std::size_t h = head_.load(std::memory_order_relaxed); h < t; h++) {
+      slot &s = S_[h & mask_];
+      if (s.seq.load(std::memory_order_relaxed) == h + 1) {
+        std::destroy_at(s.get());
+      }
+    }
+    slot_traits::deallocate(alloc_, S_, cap_);
+  }
+
+  /**
+   * @brief  キューに要素xを挿入する. 満杯ならば待たない
+   * @return 満杯で挿入できなかったときfalse
+   */
+  template <class... Args> bool try_push(Args &&... args) {
+    T x(std::forward<Args>(args)...);
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      slot &s = S_[pos & mask_];
+      const std::size_t seq = s.seq.load(std::memory_order_acquire);
+      const std::intptr_t diff = static_cast<std::intptr_t>(seq - pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          construct(s, pos, std::move(x));
+          return true;
+        }
+      } else if (diff < 0) { // 1周前の要素がまだ読み出されていない
+        return false;
+      } else { // 他の生産者に先を越された
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief  キューの先頭の要素をxにムーブして削除する. 空ならば待たない
+   * @return 空で取り出せなかったときfalse
+   */
+  bool try_pop(T &x) noexcept {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      slot &s = S_[pos & mask_];
+      const std::size_t seq = s.seq.load(std::memory_order_acquire);
+      const std::intptr_t diff = static_cast<std::intptr_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          x = take(s, pos);
+          return true;
+        }
+      } else if (diff < 0) { // まだ書き込まれていない
+        return false;
+      } else { // 他の消費者に先を越された
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**< @brief キューの先頭の要素を取り出して削除する. 空ならば待たない */
+  std::optional<T> try_pop() noexcept {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      slot &s = S_[pos & mask_];
+      const std::size_t seq = s.seq.load(std::memory_order_acquire);
+      const std::intptr_t diff = static_cast<std::intptr_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          return std::make_optional(take(s, pos));
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**< @brief キューに要素xを挿入する. 満杯ならば空きができるまで眠って待つ */
+  template <class... Args> void push(Args &&... args) {
+    T x(std::forward<Args>(args)...);
+    const std::size_t pos = tail_.fetch_add(1, std::memory_order_relaxed);
+    slot &s = S_[pos & mask_];
+    wait_for(s, pos, true);
+    construct(s, pos, std::move(x));
+  }
+
+  /**< @brief キューの先頭の要素を取り出して削除する. 空ならば要素が来るまで眠って待つ */
+  T pop() noexcept {
+    const std::size_t pos = head_.fetch_add(1, std::memory_order_relaxed);
+    slot &s = S_[pos & mask_];
+    wait_for(s, pos + 1, true);
+    return take(s, pos);
+  }
+
+  /**< @brief キューに要素xを挿入する. 満杯ならば空きができるまでスピンして待つ */
+  template <class... Args> void spin_push(Args &&... args) {
+    T x(std::forward<Args>(args)...);
+    const std::size_t pos = tail_.fetch_add(1, std::memory_order_relaxed);
+    slot &s = S_[pos & mask_];
+    wait_for(s, pos, false);
+    construct(s, pos, std::move(x));
+  }
+
+  /**< @brief キューの先頭の要素を取り出して削除する. 空ならば要素が来るまでスピンして待つ */
+  T spin_pop() noexcept {
+    const std::size_t pos = head_.fetch_add(1, std::memory_order_relaxed);
+    slot &s = S_[pos & mask_];
+    wait_for(s, pos + 1, false);
+    return take(s, pos);
+  }
+
+  /**
+   * @brief キューの要素数を返す
+   * @note  他のスレッドが操作中ならば近似値. 待っている消費者がいる間は0を返す
+   */
+  std::size_t size() const noexcept {
+    const std::size_t h = head_.load(std::memory_order_acquire);
+    const std::size_t t = tail_.load(std::memory_order_acquire);
+    return static_cast<std::intptr_t>(t - h) > 0 ? t - h : 0;
+  }
+
+  /**< @brief キューが空かどうか判定(他のスレッドが操作中ならば近似値) */
+  bool empty() const noexcept { return size() == 0; }
+
+  /**< @brief キューの容量を返す */
+  std::size_t capacity() const noexcept { return cap_; }
+
+private:
+  /**< @brief スロットsの通し番号がseqになるまで待つ */
+  static void wait_for(slot &s, std::size_t seq, bool sleep) noexcept {
+    for (int i = 0;; i++) {
+      const std::size_t cur = s.seq.load(std::memory_order_acquire);
+      if (cur == seq) {
+        return;
+      }
+      if (sleep && i >= spin_limit) {
+        s.seq.wait(cur, std::memory_order_acquire);
+      } else {
+        impl::cpu_relax();
+      }
+    }
+  }
+
+  /**< @brief 位置posのスロットsに要素xをムーブして公開する */
+  void construct(slot &s, std::size_t pos, T &&x) noexcept {
+    ::new (static_cast<void *>(s.storage)) T(std::move(x));
+    s.seq.store(pos + 1, std::memory_order_release);
+    s.seq.notify_all();
+  }
+
+  /**< @brief 位置posのスロットsから要素を取り出し、1周後の書き込みに備える */
+  T take(slot &s, std::size_t pos) noexcept {
+    T *p = s.get();
+    T x = std::move(*p);
+    std::destroy_at(p);
+    s.seq.store(pos + cap_, std::memory_order_release);
+    s.seq.notify_all();
+    return x;
+  }
+
+private:
+  alignas(cache_line) std::atomic<std::size_t> head_ = 0; /**< 先頭 */
+  alignas(cache_line) std::atomic<std::size_t> tail_ = 0; /**< 末尾 */
+  alignas(cache_line) slot_alloc alloc_;                  /**< アロケータ */
+  const std::size_t cap_;                                 /**< キューの容量 */
+  const std::size_t mask_;                                /**< 添字のマスク */
+  slot *S_ = nullptr;                                     /**< スロットの配列 */
+};
+
+} // namespace container
+
+#endif // end of MPMC_QUEUE_HPP
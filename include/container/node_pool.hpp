@@ -0,0 +1,160 @@
+/**
+ * @brief  スラブ方式の節点用メモリプール
+ * @note   節点を固定長のスロットとしてチャンク(スラブ)単位で確保する
+ *         解放されたスロットは自由リストに繋がれ、次の確保でΟ(1)で再利用される
+ *         チャンクは追加で確保されるだけで再配置はされないので、
+ *         一度返した節点のアドレスは解放されるまで変わらない
+ * @note   プールは記憶領域の管理のみを行い、節点の構築・破棄は利用者が行う
+ */
+
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <memory>
+
+namespace container {
+
+/**
+ * @brief  スラブ方式の節点用メモリプール
+ * @tparam Node      節点の型
+ * @tparam Allocator アロケータの型(スロットの型へrebindして使う)
+ */
+template <class Node, class Allocator =
+                          boost::container::pmr::polymorphic_allocator<Node>>
+class node_pool : private boost::noncopyable {
+  /**< @brief 節点1つ分の記憶領域、自由リストの連結、チャンクの管理情報を兼ねる */
+  union slot {
+    slot *next; /**< 自由リストの次のスロット */
+    struct {
+      slot *link;    /**< 前に確保したチャンク */
+      std::size_t n; /**< チャンクのスロット数(管理情報を除く) */
+    } chunk;
+    alignas(Node) unsigned char storage[sizeof(Node)]; /**< 節点の記憶領域 */
+  };
+  using slot_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+  using alloc = std::allocator_traits<slot_allocator>;
+
+public:
+  /**
+   * @brief 最初のチャンクとしてn個分のスロットを確保する
+   * @param std::size_t n           最初のチャンクのスロット数
+   * @param const Allocator& a      アロケータ
+   */
+  explicit node_pool(std::size_t n = 32, const Allocator &a = Allocator())
+      : alloc_(a), next_chunk_(std::max<std::size_t>(n, 1)) {
+    grow(next_chunk_);
+  }
+  ~node_pool() noexcept { release(); }
+
+  /**
+   * @brief  節点1つ分の記憶領域を確保する
+   * @note   自由リストに空きがあればそれを再利用し、なければ現在のチャンクから切り出す
+   *         チャンクを使い切っている場合は新たなチャンクを確保する. ならし計算量はΟ(1)
+   * @return 未構築の節点へのポインタ
+   */
+  Node *allocate() {
+    slot *s = free_;
+    if (s != nullptr) {
+      free_ = s->next;
+    } else {
+      if (cur_ == end_) {
+        grow(next_chunk_);
+      }
+      s = cur_++;
+    }
+    high_water_ = std::max(high_water_, ++live_);
+    return reinterpret_cast<Node *>(s->storage);
+  }
+
+  /**
+   * @brief 節点xの記憶領域を自由リストへ返す
+   * @note  xは破棄済みでなければならない. 計算量はΟ(1)
+   */
+  void deallocate(Node *x) noexcept {
+    BOOST_ASSERT_MSG(live_ > 0, "Node pool underflow.");
+    slot *s = reinterpret_cast<slot *>(x);
+    s->next = free_;
+    free_ = s;
+    live_--;
+  }
+
+  /**< @brief 少なくともn個の節点を追加の確保なしに割り当てられるようにする */
+  void reserve(std::size_t n) {
+    if (n > capacity_) {
+      grow(n - capacity_);
+    }
+  }
+
+  /**< @brief 次の割り当てでチャンクの追加確保が必要かどうか返す */
+  bool full() const noexcept { return free_ == nullptr && cur_ == end_; }
+
+  /**< @brief 使用中の節点数を返す */
+  std::size_t live() const noexcept { return live_; }
+  /**< @brief 追加の確保なしに割り当てられる節点数を返す */
+  std::size_t free() const noexcept { return capacity_ - live_; }
+  /**< @brief 使用中の節点数の最大値を返す */
+  std::size_t high_water() const noexcept { return high_water_; }
+  /**< @brief 確保済みのスロット数を返す */
+  std::size_t capacity() const noexcept { return capacity_; }
+  /**< @brief 確保済みのチャンク数を返す */
+  std::size_t chunks() const noexcept { return chunks_; }
+
+  /**< @brief アロケータを返す */
+  Allocator get_allocator() const noexcept { return Allocator(alloc_); }
+
+private:
+  /**
+   * @brief n個分のスロットを持つチャンクを確保し、現在のチャンクにする
+   * @note  チャンクの先頭のスロットは管理情報に使う.
+   *        現在のチャンクの未使用領域は自由リストへ移してから切り替える.
+   *        次に確保するチャンクの大きさは倍々に増やす
+   */
+  void grow(std::size_t n) {
+    for (; cur_ != end_; ++cur_) {
+      cur_->next = free_;
+      free_ = cur_;
+    }
+    slot *c = alloc::allocate(alloc_, n + 1);
+    c->chunk.link = chunks_head_;
+    c->chunk.n = n;
+    chunks_head_ = c;
+    cur_ = c + 1;
+    end_ = c + 1 + n;
+    capacity_ += n;
+    chunks_++;
+    next_chunk_ = std::max(next_chunk_, n) << 1;
+  }
+
+  /**< @brief 確保したチャンクを全て解放する */
+  void release() noexcept {
+    while (chunks_head_ != nullptr) {
+      slot *c = chunks_head_;
+      chunks_head_ = c->chunk.link;
+      alloc::deallocate(alloc_, c, c->chunk.n + 1);
+    }
+    free_ = cur_ = end_ = nullptr;
+    live_ = capacity_ = chunks_ = 0;
+  }
+
+private:
+  slot_allocator alloc_;        /**< アロケータ */
+  slot *chunks_head_ = nullptr; /**< 最後に確保したチャンク */
+  slot *free_ = nullptr;        /**< 自由リストの先頭 */
+  slot *cur_ = nullptr;         /**< 現在のチャンクの未使用領域の先頭 */
+  slot *end_ = nullptr;         /**< 現在のチャンクの末尾 */
+  std::size_t next_chunk_ = 0;  /**< 次に確保するチャンクのスロット数 */
+  std::size_t live_ = 0;        /**< 使用中の節点数 */
+  std::size_t high_water_ = 0;  /**< 使用中の節点数の最大値 */
+  std::size_t capacity_ = 0;    /**< 確保済みのスロット数 */
+  std::size_t chunks_ = 0;      /**< 確保済みのチャンク数 */
+};
+
+} // namespace container
+
+#endif // end of NODE_POOL_HPP
@@ -0,0 +1,179 @@
+/**
+ * @brief  ペアリングヒープ
+ * @note   各節点は最左の子と右の兄弟へのリンクを持つ多分木で、根が最小のキーを持つ
+ *         挿入とマージは根同士を比べて一方を他方の最左の子にするだけなのでΟ(1)
+ *         削除は根の子を左から2つずつ組にしてマージし、その結果を右から順にマージする(2パス)
+ *         削除のならし計算量はΟ(lgn)
+ * @note   Reference: M. L. Fredman, R. Sedgewick, D. D. Sleator, R. E. Tarjan,
+ *         The pairing heap: A new form of self-adjusting heap
+ */
+
+#ifndef PAIRING_HEAP_HPP
+#define PAIRING_HEAP_HPP
+
+#include "node_pool.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <memory>
+#include <optional>
+
+namespace container {
+
+template <class Key> struct pairing_heap_node {
+  pairing_heap_node *child = nullptr;   /**< 最左の子 */
+  pairing_heap_node *sibling = nullptr; /**< 右の兄弟 */
+  Key key;                              /**< キー */
+  template <class... Args>
+  constexpr explicit pairing_heap_node(Args &&... args) noexcept
+      : key(std::forward<Args>(args)...) {}
+};
+
+/**
+ * @brief  ペアリングヒープ
+ * @tparam Key     キーの型
+ * @tparam Compare 比較述語の型
+ */
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              pairing_heap_node<Key>>>
+struct pairing_heap {
+public:
+  static_assert(std::is_nothrow_constructible_v<Key>);
+  using alloc = std::allocator_traits<Allocator>;
+  using node = pairing_heap_node<Key>;
+  using pool_t = node_pool<node, Allocator>;
+
+  explicit pairing_heap(std::size_t n = 32) : pool_(n, alloc_) {}
+  ~pairing_heap() noexcept { free_pool(); }
+
+  /** @brief ヒープHに要素xを挿入する. 計算量はΟ(1) */
+  template <class... Args> void push(Args &&... args) {
+    node *x = create_node(std::forward<Args>(args)...);
+    root_ = meld(root_, x);
+  }
+
+  /**< @brief ヒープHから先頭のキーを取り出し、要素を削除する */
+  std::optional<Key> pop() noexcept {
+    if (empty()) {
+      return std::nullopt;
+    }
+    Key k = std::move(root_->key);
+    node *x = root_;
+    root_ = two_pass(x->child);
+    destroy_node(x);
+    return k;
+  }
+
+  /**< @brief ヒープHが空かどうか返す */
+  constexpr bool empty() const noexcept { return root_ == nullptr; }
+
+  /**< @brief ヒープHが満杯(次の挿入でスラブの追加確保が必要)かどうか返す */
+  bool full() const noexcept { return pool_.full(); }
+
+  /**< @brief ヒープHの要素数を返す */
+  std::size_t size() const noexcept { return size_; }
+
+  /**< @brief 節点用メモリプールを返す(使用中、空き、最大使用数の確認用) */
+  const pool_t &pool() const noexcept { return pool_; }
+
+private:
+  /**
+   * @brief  根xとyをマージする
+   * @note   キーの大きい方の根を、小さい方の根の最左の子にする. 計算量はΟ(1)
+   * @return 新しい根
+   */
+  node *meld(node *x, node *y) noexcept {
+    if (x == nullptr) {
+      return y;
+    }
+    if (y == nullptr) {
+      return x;
+    }
+    if (cmp_(y->key, x->key)) {
+      std::swap(x, y);
+    }
+    y->sibling = x->child;
+    x->child = y;
+    return x;
+  }
+
+  /**
+   * @brief  兄弟の列xを2パスでマージする
+   * @note   1パス目で左から2つずつマージした結果を、兄弟のリンクを使って逆順のリストに積み、
+   *         2パス目でそのリストの先頭(元の列の右端)から順にマージする
+   * @return 新しい根
+   */
+  node *two_pass(node *x) noexcept {
+    node *pairs = nullptr;
+    while (x != nullptr) {
+      node *a = x, *b = x->sibling;
+      if (b == nullptr) {
+        a->sibling = pairs;
+        pairs = a;
+        break;
+      }
+      x = b->sibling;
+      a->sibling = b->sibling = nullptr;
+      node *m = meld(a, b);
+      m->sibling = pairs;
+      pairs = m;
+    }
+    node *root = nullptr;
+    while (pairs != nullptr) {
+      node *next = pairs->sibling;
+      pairs->sibling = nullptr;
+      root = meld(pairs, root);
+      pairs = next;
+    }
+    return root;
+  }
+
+  /**< @brief 節点xの記憶領域の確保を行う */
+  template <class... Args> node *create_node(Args &&... args) {
+    node *x = pool_.allocate();
+    alloc::construct(alloc_, x, std::forward<Args>(args)...);
+    size_++;
+    return x;
+  }
+
+  /**< @brief 節点xの記憶領域の解放を行う */
+  void destroy_node(node *x) noexcept {
+    alloc::destroy(alloc_, x);
+    pool_.deallocate(x);
+    size_--;
+  }
+
+  /**
+   * @brief 全ての節点の破棄(記憶領域はメモリプールの破棄時に解放される)
+   * @note  子の列を兄弟の列の先頭へ継ぎ足しながらたどるので、再帰を使わない
+   */
+  void free_pool() noexcept {
+    node *x = root_;
+    while (x != nullptr) {
+      if (node *c = x->child; c != nullptr) {
+        node *last = c;
+        for (; last->sibling != nullptr; last = last->sibling) {
+        }
+        last->sibling = x->sibling;
+        x->sibling = c;
+        x->child = nullptr;
+      }
+      node *next = x->sibling;
+      destroy_node(x);
+      x = next;
+    }
+    root_ = nullptr;
+  }
+
+private:
+  node *root_ = nullptr; /**< 根 */
+  std::size_t size_ = 0; /**< ヒープのサイズ */
+  Compare cmp_;          /**< 比較述語 */
+  Allocator alloc_;      /**< アロケータ */
+  pool_t pool_;          /**< 節点用メモリプール */
+};
+
+} // namespace container
+
+#endif // end of PAIRING_HEAP_HPP
@@ -0,0 +1,348 @@
+/**
+ * @brief  永続AVL木(経路複製)
+ * @note   節点は作成後に変更しない. 挿入・削除では根から変更位置までの経路上の節点だけを複製し、
+ *         それ以外の部分木は古い版と共有する. そのため1回の更新で確保する節点はΟ(lgn)個で済む
+ * @note   木の値(版)は根へのポインタだけなので、snapshot()やコピーはΟ(1)で行える
+ *         節点は参照カウントを持ち、最後に参照していた版が破棄された時点で解放される
+ * @note   共有する節点は変更されず、参照カウントはアトミックに増減するので、
+ *         異なる版(オブジェクト)は別々のスレッドから同時に読み書きしてよい
+ *         ただし同じオブジェクトを複数のスレッドから同時に更新してはならない
+ *         また節点は最後の版を破棄したスレッドで解放されるので、アロケータはスレッドセーフでなければならない
+ * @note   平衡化は部分木と節点から新たな節点を作る関数bal(OCamlのMapと同じ手法)で行う
+ */
+
+#ifndef PERSISTENT_AVL_TREE_HPP
+#define PERSISTENT_AVL_TREE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace container {
+
+template <class Key, class T> struct persistent_avl_tree_node {
+  using height_t = std::int32_t;
+
+  persistent_avl_tree_node(const Key &k, const T &v,
+                           const persistent_avl_tree_node *l,
+                           const persistent_avl_tree_node *r, height_t h)
+      : l(l), r(r), h(h), key(k), v(v) {}
+
+  const persistent_avl_tree_node *l;           /**< 左の子 */
+  const persistent_avl_tree_node *r;           /**< 右の子 */
+  height_t h;                                  /**< 高さ */
+  mutable std::atomic<std::uint32_t> refs = 1; /**< 参照カウント */
+  const Key key;                               /**< キー */
+  const T v;                                   /**< 付属データ */
+};
+
+/**
+ * @brief  永続AVL木
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Compare   キーを引数にとる比較述語の型
+ * @tparam Allocator アロケータの型
+ */
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              persistent_avl_tree_node<Key, T>>>
+class persistent_avl_tree {
+public:
+  using node = persistent_avl_tree_node<Key, T>;
+  using height_t = typename node::height_t;
+  using alloc = std::allocator_traits<Allocator>;
+  /**< @brief 木の高さの上限(avl_tree::max_heightと同じ) */
+  static constexpr std::size_t max_height = 92;
+
+  explicit persistent_avl_tree(const Allocator &a = Allocator())
+      : alloc_(a) {}
+  /**< @brief 版をコピーする. 根を共有するだけなのでΟ(1) */
+  persistent_avl_tree(const persistent_avl_tree &other) noexcept
+      : root_(retain(other.root_)), size_(other.size_), cmp_(other.cmp_),
+        alloc_(other.alloc_) {}
+  persistent_avl_tree(persistent_avl_tree &&other) noexcept
+      : root_(std::exchange(other.root_, nullptr)),
+        size_(std::exchange(other.size_, 0)), cmp_(other.cmp_),
+        alloc_(other.alloc_) {}
+  /**
+   * @brief 版を代入する
+   * @note  節点は確保したアロケータで解放しなければならないので、共有する節点と共にアロケータも受け継ぐ
+   */
+  persistent_avl_tree &operator=(const persistent_avl_tree &other) noexcept {
+    if (this != &other) {
+      const node *old = std::exchange(root_, retain(other.root_));
+      release(old); // 古い節点は元のアロケータで解放する
+      size_ = other.size_;
+      alloc_ = other.alloc_;
+    }
+    return *this;
+  }
+  persistent_avl_tree &operator=(persistent_avl_tree &&other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(alloc_, other.alloc_);
+    return *this;
+  }
+  ~persistent_avl_tree() noexcept { release(root_); }
+
+  /**
+   * @brief 現在の版のスナップショットを返す
+   * @note  実行時間はΟ(1). 巻き戻すときはスナップショットを代入すればよい
+   */
+  persistent_avl_tree snapshot() const noexcept { return *this; }
+
+  /**< @brief 節点数を返す */
+  std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうか返す */
+  bool empty() const noexcept { return root_ == nullptr; }
+  /**< @brief 木の高さを返す */
+  height_t height() const noexcept { return h(root_); }
+  /**< @brief 2つの版が同じ根を共有しているかどうか返す */
+  bool shares_root(const persistent_avl_tree &other) const noexcept {
+    return root_ == other.root_;
+  }
+
+  /**< @brief 全ての節点を取り除く(他の版は影響を受けない) */
+  void clear() noexcept {
+    release(std::exchange(root_, nullptr));
+    size_ = 0;
+  }
+
+  /**
+   * @brief キーkに対応する付属データを返す
+   * @note  実行時間はΟ(lgn)
+   */
+  std::optional<T> find(const Key &k) const {
+    const T *v = get(k);
+    return v == nullptr ? std::nullopt : std::make_optional(*v);
+  }
+
+  /**
+   * @brief キーkに対応する付属データへのポインタを返す(なければnullptr)
+   * @note  ポインタはこの版が更新・破棄されるまで有効
+   */
+  const T *get(const Key &k) const {
+    const node *x = root_, *y = nullptr;
+    while (x != nullptr) {
+      if (cmp_(x->key, k)) {
+        x = x->r;
+      } else {
+        y = x;
+        x = x->l;
+      }
+    }
+    return (y != nullptr && !cmp_(k, y->key)) ? &y->v : nullptr;
+  }
+
+  /**
+   * @brief キーkと付属データvを挿入する(キーkが存在すれば付属データを置き換える)
+   * @note  根からの経路上の節点を複製する. 実行時間と確保する節点数はΟ(lgn)
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> insert(const Key &k, const T &v) {
+    const node *path[max_height];
+    bool dir[max_height];
+    std::size_t n = 0;
+    const node *x = root_;
+    while (x != nullptr && (cmp_(k, x->key) || cmp_(x->key, k))) {
+      path[n] = x;
+      dir[n] = cmp_(x->key, k);
+      x = dir[n++] ? x->r : x->l;
+    }
+    std::optional<T> opt = std::nullopt;
+    const node *c;
+    if (x != nullptr) { // キーkが存在すれば、付属データを置き換えた複製を作る
+      opt = std::make_optional(x->v);
+      c = create(k, v, x->l, x->r);
+    } else {
+      c = create(k, v, nullptr, nullptr);
+      size_++;
+    }
+    replace(path, dir, n, c);
+    return opt;
+  }
+
+  /**
+   * @brief キーkを持つ節点を削除する
+   * @note  根からの経路上の節点を複製する. 実行時間と確保する節点数はΟ(lgn)
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> erase(const Key &k) {
+    const node *path[max_height];
+    bool dir[max_height];
+    std::size_t n = 0;
+    const node *y = root_;
+    while (y != nullptr && (cmp_(k, y->key) || cmp_(y->key, k))) {
+      path[n] = y;
+      dir[n] = cmp_(y->key, k);
+      y = dir[n++] ? y->r : y->l;
+    }
+    if (y == nullptr) {
+      return std::nullopt;
+    } // キーkは存在しなかった
+    std::optional<T> opt = std::make_optional(y->v);
+    const node *c;
+    if (y->l == nullptr || y->r == nullptr) {
+      c = retain(y->l == nullptr ? y->r : y->l);
+    } else {
+      // yの右の部分木から最小の節点sを取り除いた部分木を作り、sをyの位置に置く
+      const node *spine[max_height];
+      std::size_t m = 0;
+      const node *s = y->r;
+      for (; s->l != nullptr; s = s->l) {
+        spine[m++] = s;
+      }
+      c = retain(s->r);
+      while (m > 0) {
+        const node *p = spine[--m];
+        c = rebuild(p, c, p->r, c);
+      }
+      c = rebuild(s, y->l, c, c);
+    }
+    size_--;
+    replace(path, dir, n, c);
+    return opt;
+  }
+
+  /**
+   * @brief  中間順木巡回を行う
+   * @tparam class F const Key&, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void inorder(F fn) const {
+    const node *stack[max_height];
+    std::size_t n = 0;
+    const node *x = root_;
+    while (x != nullptr || n > 0) {
+      for (; x != nullptr; x = x->l) {
+        stack[n++] = x;
+      }
+      x = stack[--n];
+      fn(x->key, x->v);
+      x = x->r;
+    }
+  }
+
+private:
+  /**
+   * @brief 経路path[0, n)の末端の子をcで置き換えた版を作り、根とする
+   * @note  cの参照は引き継ぐ. 経路上の節点は複製し、平衡化しながら根へ向かう
+   */
+  void replace(const node *const *path, const bool *dir, std::size_t n,
+               const node *c) {
+    while (n > 0) {
+      const node *p = path[--n];
+      c = dir[n] ? rebuild(p, p->l, c, c) : rebuild(p, c, p->r, c);
+    }
+    release(std::exchange(root_, c));
+  }
+
+  /**
+   * @brief 節点pのキーと付属データ、部分木l, rから平衡した節点を作る
+   * @note  tmpは作業中に作った部分木で、その参照はここで手放す
+   */
+  const node *rebuild(const node *p, const node *l, const node *r,
+                      const node *tmp) {
+    const node *x = bal(p->key, p->v, l, r);
+    release(tmp);
+    return x;
+  }
+
+  /**
+   * @brief キーk、付属データvと、高さの差が2以下の部分木l, rから平衡した節点を作る
+   * @note  1回または2回の回転に相当する節点の組み替えを、新たな節点を作ることで行う
+   *        l, rの参照カウントは作った節点の分だけ増える
+   */
+  const node *bal(const Key &k, const T &v, const node *l, const node *r) {
+    const height_t hl = h(l), hr = h(r);
+    if (hl > hr + 1) {
+      if (h(l->l) >= h(l->r)) { // 右回転
+        const node *t = create(k, v, l->r, r);
+        const node *x = create(l->key, l->v, l->l, t);
+        release(t);
+        return x;
+      }
+      const node *lr = l->r; // 左右の2重回転
+      const node *a = create(l->key, l->v, l->l, lr->l);
+      const node *b = create(k, v, lr->r, r);
+      const node *x = create(lr->key, lr->v, a, b);
+      release(a);
+      release(b);
+      return x;
+    }
+    if (hr > hl + 1) {
+      if (h(r->r) >= h(r->l)) { // 左回転
+        const node *t = create(k, v, l, r->l);
+        const node *x = create(r->key, r->v, t, r->r);
+        release(t);
+        return x;
+      }
+      const node *rl = r->l; // 右左の2重回転
+      const node *a = create(k, v, l, rl->l);
+      const node *b = create(r->key, r->v, rl->r, r->r);
+      const node *x = create(rl->key, rl->v, a, b);
+      release(a);
+      release(b);
+      return x;
+    }
+    return create(k, v, l, r);
+  }
+
+  /**< @brief 子l, rを参照する新たな節点を作る */
+  const node *create(const Key &k, const T &v, const node *l, const node *r) {
+    node *x = alloc::allocate(alloc_, 1);
+    alloc::construct(alloc_, x, k, v, retain(l), retain(r),
+                     std::max(h(l), h(r)) + 1);
+    return x;
+  }
+
+  /**< @brief 節点xの参照カウントを増やす */
+  static const node *retain(const node *x) noexcept {
+    if (x != nullptr) {
+      x->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  /**
+   * @brief 節点xの参照カウントを減らし、0になれば解放する
+   * @note  解放した節点の子も同様に手放す. 連鎖は木の高さ以下の深さのスタックで行う
+   */
+  void release(const node *x) noexcept {
+    const node *stack[2 * max_height];
+    std::size_t n = 0;
+    for (;;) {
+      if (x != nullptr &&
+          x->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        stack[n++] = x->r;
+        const node *l = x->l;
+        node *p = const_cast<node *>(x);
+        alloc::destroy(alloc_, p);
+        alloc::deallocate(alloc_, p, 1);
+        x = l;
+        continue;
+      }
+      if (n == 0) {
+        return;
+      }
+      x = stack[--n];
+    }
+  }
+
+  static height_t h(const node *x) noexcept { return x ? x->h : 0; }
+
+private:
+  const node *root_ = nullptr; /**< 根 */
+  std::size_t size_ = 0;       /**< 節点数 */
+  Compare cmp_;                /**< 比較述語 */
+  Allocator alloc_;            /**< アロケータ */
+};
+
+} // namespace container
+
+#endif // end of PERSISTENT_AVL_TREE_HPP
@@ -1,10 +1,15 @@
 /**
  * @brief  ねじれヒープ
+ * @note   各節点は親へのリンクを持ち、pushが返すハンドルから節点を直接操作できる
+ *         キーの減少は節点を根とする部分木を親から切り離して根とマージし、
+ *         削除は節点の左右の子をマージした結果を節点の位置に繋ぎ直す
+ *         いずれもマージ1回分なので、計算量はならし時間でΟ(lgn)
  */
 
 #ifndef SKEW_HEAP_HPP
 #define SKEW_HEAP_HPP
 
+#include "node_pool.hpp"
 #include <algorithm>
 #include <boost/assert.hpp>
 #include <boost/container/pmr/polymorphic_allocator.hpp>
@@ -17,6 +22,7 @@ namespace container {
 template <class Key> struct skew_heap_node {
   skew_heap_node *l = nullptr; /**< 左の子 */
   skew_heap_node *r = nullptr; /**< 右の子 */
+  skew_heap_node *p = nullptr; /**< 親   */
   Key key;                     /**< キー */
   template <class... Args>
   constexpr explicit skew_heap_node(Args &&... args) noexcept
@@ -36,14 +42,92 @@ public:
   static_assert(std::is_nothrow_constructible_v<Key>);
   using alloc = std::allocator_traits<Allocator>;
   using node = skew_heap_node<Key>;
+  using pool_t = node_pool<node, Allocator>;
 
-  explicit skew_heap(std::size_t n = 32) { allocate_pool(n); }
+  /**
+   * @brief 挿入した要素を指すハンドル
+   * @note  要素がpopかeraseで削除されるまで有効
+   */
+  class handle {
+  public:
+    handle() = default;
+    /**< @brief 要素のキーを返す */
+    const Key &key() const noexcept { return x_->key; }
+    explicit operator bool() const noexcept { return x_ != nullptr; }
+    bool operator==(const handle &) const = default;
+
+  private:
+    explicit handle(node *x) noexcept : x_(x) {}
+    node *x_ = nullptr; /**< 要素の節点 */
+    friend struct skew_heap;
+  };
+
+  explicit skew_heap(std::size_t n = 32) {
+    own_pool_.emplace(n, alloc_);
+    pool_ = &*own_pool_;
+  }
+  /**
+   * @brief 他のねじれヒープとメモリプールを共有する
+   * @note  同じプールを共有するヒープどうしはmeldで節点を付け替えるだけでマージできる
+   *        プールを所有するヒープは、共有するヒープより後に破棄すること
+   */
+  explicit skew_heap(pool_t &pool) : pool_(&pool) {}
+  skew_heap(const skew_heap &) = delete;
+  skew_heap &operator=(const skew_heap &) = delete;
   ~skew_heap() noexcept { free_pool(); }
 
-  /** @brief ねじれヒープHに要素xを挿入する @param const Key& key 要素xのキー */
-  template <class... Args> void push(Args &&... args) {
+  /**
+   * @brief  ねじれヒープHに要素xを挿入する @param const Key& key 要素xのキー
+   * @return 挿入した要素のハンドル
+   */
+  template <class... Args> handle push(Args &&... args) {
     node *x = create_node(std::forward<Args>(args)...);
     root_ = merge(root_, x);
+    return handle(x);
+  }
+
+  /**
+   * @brief 要素hのキーをkeyに減らす
+   * @note  hを根とする部分木はkey以上のキーしか持たないので、
+   *        親から切り離して根とマージすればヒープ順序が保たれる
+   */
+  void decrease_key(handle h, const Key &key) noexcept {
+    node *x = h.x_;
+    BOOST_ASSERT_MSG(!cmp_(x->key, key),
+                     "New key is greater than current key.");
+    x->key = key;
+    if (x == root_) {
+      return;
+    }
+    replace(x, nullptr);
+    root_ = merge(root_, x);
+  }
+
+  /**
+   * @brief 要素hを削除する
+   * @note  hの左右の子をマージした部分木をhの位置に繋ぐ
+   *        hはこのヒープに挿入した要素でなければならない
+   */
+  void erase(handle h) noexcept {
+    node *x = h.x_;
+    replace(x, merge(x->l, x->r));
+    destroy_node(x);
+  }
+
+  /**
+   * @brief ねじれヒープotherの全ての要素をHに移す. 計算量はならし時間でΟ(lgn)
+   * @note  otherとHは同じメモリプールを共有していなければならない
+   *        otherの要素のハンドルは、移した後もHの要素として有効
+   */
+  void meld(skew_heap &other) noexcept {
+    BOOST_ASSERT_MSG(pool_ == other.pool_, "Heaps must share a node pool.");
+    if (this == &other) {
+      return;
+    }
+    root_ = merge(root_, other.root_);
+    size_ += other.size_;
+    other.root_ = nullptr;
+    other.size_ = 0;
   }
 
   /**< @brief ねじれヒープHから先頭のキーを取り出し、要素を削除する */
@@ -51,46 +135,91 @@ public:
     if (empty()) {
       return std::nullopt;
     }
-    decltype(auto) k = std::move(root_->key);
+    Key k = std::move(root_->key);
     node *x = root_;
     root_ = merge(x->l, x->r);
     destroy_node(x);
-    return std::make_optional(k);
+    return k;
   }
 
   /**< @brief ねじれヒープHが空かどうか返す */
   constexpr bool empty() const noexcept { return root_ == nullptr; }
 
-  /**< @brief ねじれヒープHが満杯かどうか返す */
-  constexpr bool full() const noexcept { return size_ >= cap_; }
+  /**< @brief ねじれヒープHが満杯(次の挿入でスラブの追加確保が必要)かどうか返す */
+  bool full() const noexcept { return pool_->full(); }
+
+  /**< @brief ねじれヒープHの要素数を返す */
+  std::size_t size() const noexcept { return size_; }
+
+  /**< @brief 節点用メモリプールを返す(使用中、空き、最大使用数の確認用) */
+  const pool_t &pool() const noexcept { return *pool_; }
+  pool_t &pool() noexcept { return *pool_; }
 
 private:
   /**
    * @brief  節点xとyをマージする
    * @note   計算量はならし時間でΟ(lgn)
+   * @note   再帰版(xの右の子とyをマージしてから左右の子を交換する)と同じ結果を、
+   *         根から下へ向かう1回の走査で作る. 各節点では元の左の子を右に移し、
+   *         空いた左の子の位置へ、元の右の子とyのうちキーの小さい方を繋いで降りていく
+   *         右の経路が長くなってもスタックを消費しない
    * @param  node* x  節点x
    * @param  node* y  節点y
    * @return 新しい部分木の根
    */
-  node *merge(node *x, node *y) {
+  node *merge(node *x, node *y) noexcept {
     if (x == nullptr) {
-      return y;
+      std::swap(x, y);
     } // xがNILならば、yを返す
+    if (x == nullptr) {
+      return nullptr;
+    }
+    x->p = nullptr;
     if (y == nullptr) {
       return x;
     } // yがNILならば、xを返す
     if (!cmp_(x->key, y->key)) {
       std::swap(x, y);
+      x->p = nullptr;
     } // x.key > y.keyならば、x.key < y.keyになるよう交換
-    x->r = merge(x->r, y); // xの右の子とyをマージし、
-    std::swap(x->l, x->r); // xの左の子と右の子を交換する(leftist)
-    return x;              // 新しい部分木の根xを返す
+    node *root = x;
+    for (;;) {
+      node *r = x->r; // xの右の子とyをマージした結果を、
+      x->r = x->l;    // xの左の子とする(leftist)
+      if (r == nullptr) {
+        x->l = y;
+        y->p = x;
+        break;
+      }
+      if (!cmp_(r->key, y->key)) {
+        std::swap(r, y);
+      }
+      x->l = r;
+      r->p = x;
+      x = r;
+    }
+    return root; // 新しい部分木の根を返す
+  }
+
+  /**< @brief 節点xの位置(親の子、または根)を部分木yで置き換える */
+  void replace(node *x, node *y) noexcept {
+    node *p = x->p;
+    if (p == nullptr) {
+      root_ = y;
+    } else if (p->l == x) {
+      p->l = y;
+    } else {
+      p->r = y;
+    }
+    if (y != nullptr) {
+      y->p = p;
+    }
+    x->p = nullptr;
   }
 
   /**< @brief 節点xの記憶領域の確保を行う */
   template <class... Args> node *create_node(Args &&... args) {
-    BOOST_ASSERT_MSG(!full(), "Skew heap capcity over.");
-    node *x = pool_ + size_;
+    node *x = pool_->allocate();
     alloc::construct(alloc_, x, std::forward<Args>(args)...);
     size_++;
     return x;
@@ -99,40 +228,42 @@ private:
   /**< @brief 節点xの記憶領域の解放を行う */
   void destroy_node(node *x) noexcept {
     alloc::destroy(alloc_, x);
+    pool_->deallocate(x);
     size_--;
   }
 
-  /**< @brief 節点xを根とした部分木を再帰的に解放する */
-  void postorder_destroy_nodes(node *x) noexcept {
-    if (x == nullptr) {
-      return;
+  /**
+   * @brief 節点xを根とした部分木を解放する
+   * @note  左の子があれば右回転して左の子をなくし、なければxを解放して右の子へ進む
+   *        再帰を使わないので、偏った木でもスタックを消費しない
+   */
+  void destroy_nodes(node *x) noexcept {
+    while (x != nullptr) {
+      if (node *l = x->l; l != nullptr) {
+        x->l = l->r;
+        l->r = x;
+        x = l;
+      } else {
+        node *r = x->r;
+        destroy_node(x);
+        x = r;
+      }
     }
-    postorder_destroy_nodes(x->l);
-    postorder_destroy_nodes(x->r);
-    destroy_node(x);
   }
 
-  /**< @brief メモリプールの解放 */
+  /**< @brief 全ての節点の破棄(記憶領域はメモリプールの破棄時に解放される) */
   void free_pool() noexcept {
-    postorder_destroy_nodes(root_);
-    alloc::deallocate(alloc_, pool_, cap_);
-    root_ = pool_ = nullptr;
-    size_ = cap_ = 0;
-  }
-
-  /**< @brief メモリプールの確保 */
-  void allocate_pool(std::size_t n) {
-    pool_ = alloc::allocate(alloc_, n);
-    cap_ = n;
+    destroy_nodes(root_);
+    root_ = nullptr;
   }
 
 private:
-  node *root_ = nullptr; /**< 木の根   */
-  std::size_t cap_ = 0;  /**< ねじれヒープのバッファサイズ */
-  std::size_t size_ = 0; /**< ねじれヒープのサイズ */
-  node *pool_ = nullptr; /**< メモリプールへのポインタ */
-  Compare cmp_;          /**< 比較述語 */
-  Allocator alloc_;      /**< アロケータ */
+  node *root_ = nullptr;           /**< 木の根   */
+  std::size_t size_ = 0;           /**< ねじれヒープのサイズ */
+  Compare cmp_;                    /**< 比較述語 */
+  Allocator alloc_;                /**< アロケータ */
+  std::optional<pool_t> own_pool_; /**< 自身で所有する節点用メモリプール */
+  pool_t *pool_ = nullptr;         /**< 節点用メモリプール */
 };
 
 } // namespace container
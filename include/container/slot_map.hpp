@@ -0,0 +1,247 @@
+/**
+ * @brief  世代付きハンドルで要素を参照するスロットマップ
+ * @note   要素は密な配列に詰めて置くので、全要素の巡回は配列を先頭から読むだけで済む
+ *         ハンドルはスロットの番号と世代を組にした64ビットの値で、スロットが密な配列での位置を指す
+ *         削除では密な配列の末尾の要素を空いた位置へ移し、そのスロットの指す位置を書き換える
+ * @note   スロットは削除のたびに世代を1つ進めて空きリストへ戻すので、
+ *         削除済みの要素のハンドル(古いハンドル)は世代の比較だけで検出できる
+ *         世代が上限に達したスロットは再利用しない
+ */
+
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include "container.hpp"
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace container {
+
+/**< @brief スロットマップの要素を指すハンドル */
+class slot_handle {
+public:
+  constexpr slot_handle() noexcept = default;
+  constexpr slot_handle(std::uint32_t index, std::uint32_t gen) noexcept
+      : v_((std::uint64_t{gen} << 32) | index) {}
+
+  /**< @brief スロットの番号を返す */
+  constexpr std::uint32_t index() const noexcept {
+    return static_cast<std::uint32_t>(v_);
+  }
+  /**< @brief 世代を返す */
+  constexpr std::uint32_t generation() const noexcept { return v_ >> 32; }
+  /**< @brief 64ビットの値を返す(ハッシュ表のキーなどに使う) */
+  constexpr std::uint64_t value() const noexcept { return v_; }
+  /**< @brief 空のハンドル(世代0)でないかどうか返す */
+  constexpr explicit operator bool() const noexcept {
+    return generation() != 0;
+  }
+  constexpr bool operator==(const slot_handle &) const noexcept = default;
+
+private:
+  std::uint64_t v_ = 0; /**< (世代 << 32) | スロットの番号 */
+};
+
+/**
+ * @brief  スロットマップ
+ * @tparam T         要素の型
+ * @tparam Allocator アロケータの型
+ */
+template <class T,
+          class Allocator = boost::container::pmr::polymorphic_allocator<T>>
+class slot_map : private boost::noncopyable {
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+
+  /**< @brief スロット */
+  struct slot {
+    std::uint32_t pos; /**< 密な配列での位置(空きのときは次の空きスロット) */
+    std::uint32_t gen; /**< 世代(使用中のスロットを指すハンドルの世代) */
+  };
+  using alloc = std::allocator_traits<Allocator>;
+  using slot_alloc = typename alloc::template rebind_alloc<slot>;
+  using index_alloc = typename alloc::template rebind_alloc<std::uint32_t>;
+  static constexpr std::uint32_t nil =
+      std::numeric_limits<std::uint32_t>::max();
+  static constexpr std::uint32_t max_gen = nil;
+
+public:
+  using handle = slot_handle;
+
+  explicit slot_map(std::size_t n = 32, const Allocator &a = Allocator())
+      : alloc_(a), slots_(slot_alloc(a)), owner_(index_alloc(a)) {
+    reserve(n);
+  }
+  ~slot_map() noexcept { free_values(); }
+
+  /**< @brief 要素数を返す */
+  std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうか返す */
+  bool empty() const noexcept { return size_ == 0; }
+  /**< @brief 密な配列の容量を返す */
+  std::size_t capacity() const noexcept { return cap_; }
+
+  /**< @brief n個の要素を再確保なしで格納できるようにする */
+  void reserve(std::size_t n) {
+    if (n > cap_) {
+      reallocate(n);
+    }
+    slots_.reserve(n);
+    owner_.reserve(n);
+  }
+
+  /**
+   * @brief  argsから構築した要素を挿入する. 計算量はΟ(1)(配列の拡張を除く)
+   * @note   配列を先に広げてから要素を構築するので、例外が起きてもスロットマップは変わらない
+   * @return 挿入した要素のハンドル
+   */
+  template <class... Args> handle insert(Args &&... args) {
+    if (size_ == cap_) {
+      reallocate(cap_ == 0 ? 32 : 2 * cap_);
+    }
+    if (free_ == nil) {
+      reserve_one(slots_);
+    }
+    reserve_one(owner_);
+    const std::uint32_t pos = static_cast<std::uint32_t>(size_);
+    container::construct(&V_[pos], std::forward<Args>(args)...);
+    std::uint32_t i = free_; // 以降のpush_backは容量の範囲内なので例外を投げない
+    if (i == nil) {
+      BOOST_ASSERT_MSG(slots_.size() < nil, "Too many slots.");
+      i = static_cast<std::uint32_t>(slots_.size());
+      slots_.push_back(slot{pos, 1});
+    } else {
+      free_ = slots_[i].pos;
+      slots_[i].pos = pos;
+    }
+    owner_.push_back(i);
+    size_++;
+    return handle(i, slots_[i].gen);
+  }
+
+  /**
+   * @brief  ハンドルhの要素を削除する. 計算量はΟ(1)
+   * @note   密な配列の末尾の要素を空いた位置へ移すので、要素へのポインタは無効になる
+   * @return 削除した要素(hが古いハンドルならばstd::nullopt)
+   */
+  std::optional<T> erase(handle h) noexcept {
+    if (!contains(h)) {
+      return std::nullopt;
+    }
+    slot &s = slots_[h.index()];
+    const std::uint32_t pos = s.pos, last = static_cast<std::uint32_t>(--size_);
+    std::optional<T> x = std::make_optional(std::move(V_[pos]));
+    container::destroy(&V_[pos]);
+    if (pos != last) { // 末尾の要素を空いた位置へ移す
+      container::construct(&V_[pos], std::move(V_[last]));
+      container::destroy(&V_[last]);
+      owner_[pos] = owner_[last];
+      slots_[owner_[pos]].pos = pos;
+    }
+    owner_.pop_back();
+    if (++s.gen != max_gen) { // 世代が上限に達したスロットは捨てる
+      s.pos = free_;
+      free_ = h.index();
+    }
+    return x;
+  }
+
+  /**< @brief ハンドルhの要素が存在するかどうか返す */
+  bool contains(handle h) const noexcept {
+    return h.index() < slots_.size() && slots_[h.index()].gen == h.generation();
+  }
+
+  /**
+   * @brief  ハンドルhの要素へのポインタを返す
+   * @return 要素へのポインタ(hが古いハンドルならばNIL)
+   */
+  T *get(handle h) noexcept {
+    return contains(h) ? &V_[slots_[h.index()].pos] : nullptr;
+  }
+  const T *get(handle h) const noexcept {
+    return contains(h) ? &V_[slots_[h.index()].pos] : nullptr;
+  }
+
+  /**< @brief 密な配列のi番目の要素を指すハンドルを返す */
+  handle handle_at(std::size_t i) const noexcept {
+    const std::uint32_t s = owner_[i];
+    return handle(s, slots_[s].gen);
+  }
+
+  /**< @brief 密な配列の先頭を返す */
+  T *begin() noexcept { return V_; }
+  const T *begin() const noexcept { return V_; }
+  /**< @brief 密な配列の末尾を返す */
+  T *end() noexcept { return V_ + size_; }
+  const T *end() const noexcept { return V_ + size_; }
+
+  /**
+   * @brief  全ての要素を密な配列の順に巡回する
+   * @tparam class F handle, T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void for_each(F fn) {
+    for (std::size_t i = 0; i < size_; i++) {
+      fn(handle_at(i), V_[i]);
+    }
+  }
+
+  /**< @brief 全ての要素を削除する. それまでのハンドルは全て古いハンドルになる */
+  void clear() noexcept {
+    while (size_ > 0) {
+      erase(handle_at(size_ - 1));
+    }
+  }
+
+private:
+  /**< @brief 配列vが満杯ならば容量を2倍にし、1要素のpush_backが再確保しないようにする */
+  template <class Vector> static void reserve_one(Vector &v) {
+    if (v.size() == v.capacity()) {
+      v.reserve(v.capacity() == 0 ? 32 : 2 * v.capacity());
+    }
+  }
+
+  /**< @brief 密な配列の容量をnにして要素を移す */
+  void reallocate(std::size_t n) {
+    T *V = alloc::allocate(alloc_, n);
+    for (std::size_t i = 0; i < size_; i++) {
+      container::construct(&V[i], std::move(V_[i]));
+      container::destroy(&V_[i]);
+    }
+    if (V_ != nullptr) {
+      alloc::deallocate(alloc_, V_, cap_);
+    }
+    V_ = V;
+    cap_ = n;
+  }
+
+  /**< @brief 全ての要素を破棄し、密な配列を解放する */
+  void free_values() noexcept {
+    for (std::size_t i = 0; i < size_; i++) {
+      container::destroy(&V_[i]);
+    }
+    if (V_ != nullptr) {
+      alloc::deallocate(alloc_, V_, cap_);
+    }
+    V_ = nullptr;
+    size_ = cap_ = 0;
+  }
+
+private:
+  Allocator alloc_;                               /**< アロケータ */
+  T *V_ = nullptr;                                /**< 要素の密な配列 */
+  std::size_t size_ = 0;                          /**< 要素数 */
+  std::size_t cap_ = 0;                           /**< 密な配列の容量 */
+  std::vector<slot, slot_alloc> slots_;           /**< スロットの配列 */
+  std::vector<std::uint32_t, index_alloc> owner_; /**< 密な配列の各要素を指すスロット */
+  std::uint32_t free_ = nil;                      /**< 空きリストの先頭のスロット */
+};
+
+} // namespace container
+
+#endif // end of SLOT_MAP_HPP
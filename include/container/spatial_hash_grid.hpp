@@ -0,0 +1,421 @@
+/**
+ * @brief  一様なハッシュ格子による空間索引(ブロードフェーズ)
+ * @note   空間を一辺cell_sizeの立方体(2次元では正方形)のセルに分け、各物体をその箱が重なる全てのセルに登録する
+ *         セルの整数座標はハッシュでバケットへ写し、バケットの数は物体数以上の2の冪にする
+ * @note   build()は毎フレーム全ての物体から作り直す. 登録はバケットごとの個数を数え、累積和で位置を決めて
+ *         並べる計数ソートで、バケット順に並んだ物体の番号と箱をSoA(軸ごとの配列)で持つ
+ *         問い合わせはバケットの区間を連続に読むだけで済み、箱の判定はSoAの配列を順に読む
+ * @note   セルの大きさは典型的な物体の大きさ程度にする. 物体がセルより大きいほど登録するセルが増える
+ *         重なるセルの数がバケット数以上の物体(地面や大きなトリガー領域など)は、セルを列挙せず全てのバケットに登録する
+ *         異なるセルが同じバケットに入ることがある(ハッシュの衝突)ので、結果は箱の判定で確かめる
+ * @note   全ての重なりの組は、同じバケットに入った物体どうしを調べ、重なりの最小の角を含むセルの
+ *         バケットでだけ報告することで、複数のセルにまたがる組の重複を除く. バケットはスレッドで分けて調べる
+ */
+
+#ifndef SPATIAL_HASH_GRID_HPP
+#define SPATIAL_HASH_GRID_HPP
+
+#include "aabb.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <boost/assert.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace container {
+
+/**
+ * @brief  一様なハッシュ格子
+ * @tparam D 次元
+ */
+template <std::size_t D> class spatial_hash_grid {
+  using cell_t = std::array<std::int32_t, D>;
+
+public:
+  using box = aabb<D>;
+
+  /**< @brief 全ての重なりの組を求めるときに1つのスレッドが一度に調べるバケット数 */
+  static constexpr std::size_t chunk_buckets = 1024;
+
+  /**< @brief 一辺cell_sizeのセルで空間を分ける */
+  explicit spatial_hash_grid(float cell_size) noexcept
+      : inv_cell_(1.0f / cell_size) {
+    BOOST_ASSERT_MSG(cell_size > 0, "Cell size must be positive.");
+  }
+
+  /**
+   * @brief 箱boxes[0, n)から作り直す. 物体の番号は配列の添字になる
+   * @note  1回目の走査で各物体が重なるセルのバケットを求めて個数を数え、2回目でその位置へ並べる
+   *        1つの物体の登録はバケット数で頭打ちになるので、計算量はΟ(n + 登録数 + バケット数)
+   */
+  void build(const box *boxes, std::size_t n) {
+    n_ = n;
+    bounds_ = box::empty();
+    const std::size_t m = std::bit_ceil(std::max<std::size_t>(n, 16));
+    mask_ = m - 1;
+    start_.assign(m + 1, 0);
+    keys_.clear();
+    first_.resize(n + 1);
+    std::vector<std::uint32_t> bs;
+    for (std::size_t i = 0; i < n; i++) { // バケットごとの個数を数える
+      bounds_ = bounds_.merge(boxes[i]);
+      buckets_of(boxes[i], bs);
+      first_[i] = static_cast<std::uint32_t>(keys_.size());
+      for (std::uint32_t b : bs) {
+        start_[b + 1]++;
+        keys_.push_back(b);
+      }
+    }
+    first_[n] = static_cast<std::uint32_t>(keys_.size());
+    for (std::size_t b = 0; b < m; b++) { // 累積和で位置を決める
+      start_[b + 1] += start_[b];
+    }
+    const std::size_t total = keys_.size();
+    ids_.resize(total);
+    for (std::size_t d = 0; d < D; d++) {
+      lo_[d].resize(total);
+      hi_[d].resize(total);
+    }
+    pos_.assign(start_.begin(), start_.end() - 1);
+    for (std::size_t i = 0; i < n; i++) { // バケット順に並べる
+      for (std::uint32_t k = first_[i]; k < first_[i + 1]; k++) {
+        const std::uint32_t p = pos_[keys_[k]]++;
+        ids_[p] = static_cast<std::uint32_t>(i);
+        for (std::size_t d = 0; d < D; d++) {
+          lo_[d][p] = boxes[i].lo[d];
+          hi_[d][p] = boxes[i].hi[d];
+        }
+      }
+    }
+  }
+  void build(const std::vector<box> &boxes) {
+    build(boxes.data(), boxes.size());
+  }
+
+  /**< @brief 物体の数を返す */
+  std::size_t size() const noexcept { return n_; }
+  /**< @brief バケットの数を返す */
+  std::size_t buckets() const noexcept { return mask_ + 1; }
+  /**< @brief 登録の総数(物体ごとの重なるセルの数の和)を返す */
+  std::size_t entries() const noexcept { return ids_.size(); }
+
+  /**
+   * @brief  箱qと重なる物体の番号を関数に渡す. 各物体は1度だけ渡す
+   * @tparam class F std::uint32_tを引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_aabb(const box &q, F fn) const {
+    std::vector<std::uint32_t> ids;
+    collect(q, [&](std::uint32_t p) { return overlaps(p, q); }, ids);
+    for (std::uint32_t id : ids) {
+      fn(id);
+    }
+  }
+
+  /**
+   * @brief  中心c、半径rの球(2次元では円)と重なる物体の番号を関数に渡す
+   * @tparam class F std::uint32_tを引数に取る関数オブジェクトの型
+   */
+  template <class F>
+  void query_radius(const vec<D> &c, float r, F fn) const {
+    box q;
+    for (std::size_t d = 0; d < D; d++) {
+      q.lo[d] = c[d] - r;
+      q.hi[d] = c[d] + r;
+    }
+    std::vector<std::uint32_t> ids;
+    collect(
+        q, [&](std::uint32_t p) { return distance2(p, c) <= r * r; }, ids);
+    for (std::uint32_t id : ids) {
+      fn(id);
+    }
+  }
+
+  /**
+   * @brief  レイと最初に交わる物体を求める
+   * @note   レイを全体の境界箱で切り取り、通過するセルを3次元DDA(Amanatides-Woo)で順に辿る
+   *         セルに入る距離がそれまでの最も近い交差より遠くなったら打ち切る
+   * @param  origin 始点
+   * @param  dir    方向
+   * @param  tmax   調べる距離の上限(dirの長さを単位とする)
+   * @return 最初に交わる物体と距離(交わらなければstd::nullopt)
+   */
+  std::optional<ray_hit> raycast(const vec<D> &origin, const vec<D> &dir,
+                                 float tmax) const {
+    const ray<D> r(origin, dir, tmax);
+    if (n_ == 0) {
+      return std::nullopt;
+    }
+    const std::optional<float> enter = r.intersect(bounds_);
+    if (!enter) {
+      return std::nullopt;
+    }
+    vec<D> p;
+    for (std::size_t d = 0; d < D; d++) {
+      p[d] = origin[d] + dir[d] * *enter;
+    }
+    cell_t c = cell_of(p), step;
+    const cell_t last = cell_of(bounds_.hi), first = cell_of(bounds_.lo);
+    vec<D> next, delta;
+    for (std::size_t d = 0; d < D; d++) {
+      c[d] = std::clamp(c[d], first[d], last[d]);
+      step[d] = dir[d] > 0 ? 1 : (dir[d] < 0 ? -1 : 0);
+      const float edge = (c[d] + (step[d] > 0 ? 1 : 0)) / inv_cell_;
+      next[d] = step[d] == 0 ? std::numeric_limits<float>::infinity()
+                             : (edge - origin[d]) * r.inv_dir[d];
+      delta[d] = step[d] == 0 ? std::numeric_limits<float>::infinity()
+                              : std::abs(r.inv_dir[d] / inv_cell_);
+    }
+    std::optional<ray_hit> best;
+    float t = *enter;
+    for (;;) {
+      const std::uint32_t b = bucket_of(c);
+      for (std::uint32_t q = start_[b]; q < start_[b + 1]; q++) {
+        const std::optional<float> h = r.intersect(box_at(q));
+        if (h && (!best || *h < best->t ||
+                  (*h == best->t && ids_[q] < best->id))) {
+          best = ray_hit{ids_[q], *h};
+        }
+      }
+      const std::size_t d = static_cast<std::size_t>(
+          std::min_element(next.begin(), next.end()) - next.begin());
+      t = next[d];
+      if ((best && best->t <= t) || t > tmax) {
+        break;
+      }
+      c[d] += step[d];
+      if (c[d] < first[d] || last[d] < c[d]) { // 全体の境界箱を出た
+        break;
+      }
+      next[d] += delta[d];
+    }
+    return best;
+  }
+
+  /**
+   * @brief  箱qs[i]と重なる物体の番号をまとめて求める
+   * @param  threads 並列に処理するタスクの数(0のとき既定のタスクプールのワーカー数)
+   * @return i番目の問い合わせの結果を番号の昇順に並べた配列
+   */
+  std::vector<std::vector<std::uint32_t>>
+  query_aabb(const std::vector<box> &qs, unsigned threads = 0) const {
+    std::vector<std::vector<std::uint32_t>> out(qs.size());
+    impl::parallel_chunks(
+        qs.size(), 64, threads, [&](std::size_t s, std::size_t e, unsigned) {
+          for (std::size_t i = s; i < e; i++) {
+            collect(
+                qs[i], [&](std::uint32_t p) { return overlaps(p, qs[i]); },
+                out[i]);
+          }
+        });
+    return out;
+  }
+
+  /**
+   * @brief  球(中心cs[i]、半径rs[i])と重なる物体の番号をまとめて求める
+   * @return i番目の問い合わせの結果を番号の昇順に並べた配列
+   */
+  std::vector<std::vector<std::uint32_t>>
+  query_radius(const std::vector<vec<D>> &cs, const std::vector<float> &rs,
+               unsigned threads = 0) const {
+    BOOST_ASSERT_MSG(cs.size() == rs.size(), "Query size mismatch.");
+    std::vector<std::vector<std::uint32_t>> out(cs.size());
+    impl::parallel_chunks(
+        cs.size(), 64, threads, [&](std::size_t s, std::size_t e, unsigned) {
+          for (std::size_t i = s; i < e; i++) {
+            query_radius(cs[i], rs[i],
+                         [&](std::uint32_t id) { out[i].push_back(id); });
+          }
+        });
+    return out;
+  }
+
+  /**< @brief レイ(始点origins[i]、方向dirs[i])と最初に交わる物体をまとめて求める */
+  std::vector<std::optional<ray_hit>>
+  raycast(const std::vector<vec<D>> &origins, const std::vector<vec<D>> &dirs,
+          float tmax, unsigned threads = 0) const {
+    BOOST_ASSERT_MSG(origins.size() == dirs.size(), "Query size mismatch.");
+    std::vector<std::optional<ray_hit>> out(origins.size());
+    impl::parallel_chunks(origins.size(), 64, threads,
+                          [&](std::size_t s, std::size_t e, unsigned) {
+                            for (std::size_t i = s; i < e; i++) {
+                              out[i] = raycast(origins[i], dirs[i], tmax);
+                            }
+                          });
+    return out;
+  }
+
+  /**
+   * @brief  重なりを持つ物体の組を全て求める
+   * @param  threads 並列に処理するタスクの数(0のとき既定のタスクプールのワーカー数)
+   * @return 組(番号の小さい方, 大きい方)の配列(順序は不定)
+   */
+  std::vector<overlap_pair> find_pairs(unsigned threads = 0) const {
+    threads = impl::task_count(threads);
+    std::vector<std::vector<overlap_pair>> parts(threads);
+    impl::parallel_chunks(
+        buckets(), chunk_buckets, threads,
+        [&](std::size_t s, std::size_t e, unsigned worker) {
+          auto &out = parts[worker];
+          for (std::size_t b = s; b < e; b++) {
+            for (std::uint32_t p = start_[b]; p < start_[b + 1]; p++) {
+              for (std::uint32_t q = p + 1; q < start_[b + 1]; q++) {
+                if (ids_[p] == ids_[q] || !overlaps(p, q)) {
+                  continue;
+                }
+                // 重なりの最小の角を含むセルのバケットでだけ報告する
+                const box x = box_at(p).intersect(box_at(q));
+                if (bucket_of(cell_of(x.lo)) == b) {
+                  out.emplace_back(std::min(ids_[p], ids_[q]),
+                                   std::max(ids_[p], ids_[q]));
+                }
+              }
+            }
+          }
+        });
+    return impl::concat(parts);
+  }
+
+private:
+  /**< @brief セルの座標の絶対値の上限(隣のセルへ進めても溢れない範囲に収める) */
+  static constexpr std::int32_t max_cell = std::int32_t(1) << 30;
+
+  /**< @brief 点pを含むセルを返す. 遠すぎる点は座標を±max_cellに切り詰める */
+  cell_t cell_of(const vec<D> &p) const noexcept {
+    constexpr float lim = static_cast<float>(max_cell);
+    cell_t c;
+    for (std::size_t d = 0; d < D; d++) {
+      const float v = std::floor(p[d] * inv_cell_);
+      c[d] = !(v < lim)    ? max_cell // NaNも上限に寄せる
+             : !(-lim < v) ? -max_cell
+                           : static_cast<std::int32_t>(v);
+    }
+    return c;
+  }
+
+  /**< @brief セルcのバケットを返す */
+  std::uint32_t bucket_of(const cell_t &c) const noexcept {
+    static constexpr std::uint64_t primes[] = {
+        0x9e3779b97f4a7c15, 0xc2b2ae3d27d4eb4f, 0x165667b19e3779f9};
+    std::uint64_t h = 0;
+    for (std::size_t d = 0; d < D; d++) {
+      h ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(c[d])) *
+           primes[d % 3];
+    }
+    return static_cast<std::uint32_t>((h ^ (h >> 29)) & mask_);
+  }
+
+  /**
+   * @brief 箱bが重なるセルのバケットを重複なく求める
+   * @note  セルの数がバケット数以上なら、セルを列挙せずに全てのバケットを返す
+   */
+  void buckets_of(const box &b, std::vector<std::uint32_t> &out) const {
+    out.clear();
+    const cell_t lo = cell_of(b.lo), hi = cell_of(b.hi);
+    double cells = 1;
+    for (std::size_t d = 0; d < D; d++) {
+      cells *= static_cast<double>(hi[d]) - lo[d] + 1;
+    }
+    if (cells >= static_cast<double>(buckets())) { // 全てのバケットを読む方が速い
+      out.resize(buckets());
+      for (std::uint32_t i = 0; i < out.size(); i++) {
+        out[i] = i;
+      }
+      return;
+    }
+    cell_t c = lo;
+    for (;;) {
+      out.push_back(bucket_of(c));
+      std::size_t d = 0;
+      for (; d < D; d++) { // 次のセルへ進む(繰り上がり)
+        if (++c[d] <= hi[d]) {
+          break;
+        }
+        c[d] = lo[d];
+      }
+      if (d == D) {
+        break;
+      }
+    }
+    if (out.size() > 1) {
+      std::sort(out.begin(), out.end());
+      out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+  }
+
+  /**
+   * @brief 箱qが重なるセルのバケットの登録のうちaccept(位置)を満たすものの番号を、
+   *        昇順に重複なくoutへ加える
+   */
+  template <class Accept>
+  void collect(const box &q, Accept accept,
+               std::vector<std::uint32_t> &out) const {
+    if (n_ == 0 || !q.overlaps(bounds_)) {
+      return;
+    }
+    std::vector<std::uint32_t> bs;
+    buckets_of(q.intersect(bounds_), bs);
+    const std::size_t first = out.size();
+    for (std::uint32_t b : bs) {
+      for (std::uint32_t p = start_[b]; p < start_[b + 1]; p++) {
+        if (accept(p)) {
+          out.push_back(ids_[p]);
+        }
+      }
+    }
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+  }
+
+  /**< @brief 位置pの箱を返す */
+  box box_at(std::uint32_t p) const noexcept {
+    box b;
+    for (std::size_t d = 0; d < D; d++) {
+      b.lo[d] = lo_[d][p];
+      b.hi[d] = hi_[d][p];
+    }
+    return b;
+  }
+
+  /**< @brief 位置pの箱が箱qと重なるかどうか返す */
+  bool overlaps(std::uint32_t p, const box &q) const noexcept {
+    for (std::size_t d = 0; d < D; d++) {
+      if (hi_[d][p] < q.lo[d] || q.hi[d] < lo_[d][p]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool overlaps(std::uint32_t p, std::uint32_t q) const noexcept {
+    return overlaps(p, box_at(q));
+  }
+
+  /**< @brief 位置pの箱と点cとの距離の2乗を返す */
+  float distance2(std::uint32_t p, const vec<D> &c) const noexcept {
+    float s = 0;
+    for (std::size_t d = 0; d < D; d++) {
+      const float v = std::max({lo_[d][p] - c[d], 0.0f, c[d] - hi_[d][p]});
+      s += v * v;
+    }
+    return s;
+  }
+
+  float inv_cell_;                       /**< セルの一辺の逆数 */
+  std::size_t n_ = 0;                    /**< 物体の数 */
+  std::size_t mask_ = 0;                 /**< バケット数 - 1 */
+  box bounds_ = box::empty();            /**< 全ての物体の境界箱 */
+  std::vector<std::uint32_t> start_;     /**< バケットごとの登録の先頭 */
+  std::vector<std::uint32_t> ids_;       /**< バケット順に並べた物体の番号 */
+  std::array<std::vector<float>, D> lo_; /**< バケット順に並べた箱の最小の角(軸ごと) */
+  std::array<std::vector<float>, D> hi_; /**< バケット順に並べた箱の最大の角(軸ごと) */
+  std::vector<std::uint32_t> keys_;      /**< build中の作業領域: 物体ごとのバケットを並べたもの */
+  std::vector<std::uint32_t> first_;     /**< build中の作業領域: 物体ごとのkeys_の先頭 */
+  std::vector<std::uint32_t> pos_;       /**< build中の作業領域: バケットごとの次に置く位置 */
+};
+
+} // namespace container
+
+#endif // end of SPATIAL_HASH_GRID_HPP
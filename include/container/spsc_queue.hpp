@@ -0,0 +1,188 @@
+/**
+ * @brief  単一生産者・単一消費者(SPSC)のロックフリーなキュー
+ * @note   1つのスレッドだけがpushし、別の1つのスレッドだけがpopするときに限りスレッドセーフ
+ *         容量Nを2の冪に限るので、添字は剰余ではなくN-1とのマスクで求める
+ *         先頭と末尾は単調に増える通し番号で持つので、空と満杯をtail - headで区別できる
+ * @note   生産者は末尾を、消費者は先頭を書き換える. 偽共有を避けるため両者を別のキャッシュラインに置き、
+ *         それぞれが相手の添字のキャッシュを自分の行に持つ. キャッシュで空きが足りないときだけ
+ *         相手の添字を読み直すので、相手の行を読む回数が減る
+ * @note   Reference: E. Rigtorp, Optimizing a ring buffer for throughput
+ */
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace container {
+
+/**
+ * @brief  SPSCキュー
+ * @tparam T キューの要素の型
+ * @tparam N キューの容量(2の冪)
+ */
+template <class T, std::size_t N,
+          class Allocator = boost::container::pmr::polymorphic_allocator<T>>
+class spsc_queue : private boost::noncopyable {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two.");
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+  static constexpr std::size_t mask = N - 1;    /**< 添字のマスク */
+  static constexpr std::size_t cache_line = 64; /**< キャッシュラインの大きさ */
+
+public:
+  using alloc = std::allocator_traits<Allocator>;
+
+  explicit spsc_queue(const Allocator &a = Allocator())
+      : alloc_(a), Q_(alloc::allocate(alloc_, N)) {}
+  ~spsc_queue() noexcept {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    for (std::size_t h = head_.load(std::memory_order_relaxed); h != t; h++) {
+      alloc::destroy(alloc_, &Q_[h & mask]);
+    }
+    alloc::deallocate(alloc_, Q_, N);
+  }
+
+  /**
+   * @brief  キューに要素xを挿入する(生産者のみ)
+   * @return 満杯で挿入できなかったときfalse
+   */
+  template <class... Args> bool try_push(Args &&... args) {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    if (t - head_cache_ == N) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (t - head_cache_ == N) {
+        return false;
+      }
+    }
+    alloc::construct(alloc_, &Q_[t & mask], std::forward<Args>(args)...);
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief  キューの先頭の要素をxにムーブして削除する(消費者のみ)
+   * @return 空で取り出せなかったときfalse
+   */
+  bool try_pop(T &x) noexcept {
+    const std::size_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (h == tail_cache_) {
+        return false;
+      }
+    }
+    T &front = Q_[h & mask];
+    x = std::move(front);
+    alloc::destroy(alloc_, &front);
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**< @brief キューの先頭の要素を取り出して削除する(消費者のみ) */
+  std::optional<T> try_pop() noexcept {
+    const std::size_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (h == tail_cache_) {
+        return std::nullopt;
+      }
+    }
+    T &front = Q_[h & mask];
+    std::optional<T> x = std::make_optional(std::move(front));
+    alloc::destroy(alloc_, &front);
+    head_.store(h + 1, std::memory_order_release);
+    return x;
+  }
+
+  /**
+   * @brief  配列[first, first + n)の要素を、入るだけまとめて挿入する(生産者のみ)
+   * @note   末尾の公開は1回だけなので、1要素ずつ挿入するより同期の回数が少ない
+   *         Tがトリビアルにコピー可能ならば、リングの折り返しで分かれる2つの区間をmemcpyで写す
+   * @return 挿入した要素数
+   */
+  std::size_t try_push_n(const T *first, std::size_t n) {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    if (N - (t - head_cache_) < n) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+    }
+    n = std::min(n, N - (t - head_cache_));
+    if (n == 0) {
+      return 0;
+    }
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      const std::size_t i = t & mask;
+      const std::size_t k = std::min(n, N - i); // 折り返すまでの要素数
+      std::memcpy(Q_ + i, first, k * sizeof(T));
+      std::memcpy(Q_, first + k, (n - k) * sizeof(T));
+    } else {
+      for (std::size_t j = 0; j < n; j++) {
+        alloc::construct(alloc_, &Q_[(t + j) & mask], first[j]);
+      }
+    }
+    tail_.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * @brief  キューの先頭から最大n個の要素をout[0, n)へムーブして削除する(消費者のみ)
+   * @note   先頭の公開は1回だけ. Tがトリビアルにコピー可能ならばmemcpyで写す
+   * @return 取り出した要素数
+   */
+  std::size_t try_pop_n(T *out, std::size_t n) noexcept {
+    const std::size_t h = head_.load(std::memory_order_relaxed);
+    if (tail_cache_ - h < n) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+    }
+    n = std::min(n, tail_cache_ - h);
+    if (n == 0) {
+      return 0;
+    }
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      const std::size_t i = h & mask;
+      const std::size_t k = std::min(n, N - i); // 折り返すまでの要素数
+      std::memcpy(out, Q_ + i, k * sizeof(T));
+      std::memcpy(out + k, Q_, (n - k) * sizeof(T));
+    } else {
+      for (std::size_t j = 0; j < n; j++) {
+        T &x = Q_[(h + j) & mask];
+        out[j] = std::move(x);
+        alloc::destroy(alloc_, &x);
+      }
+    }
+    head_.store(h + n, std::memory_order_release);
+    return n;
+  }
+
+  /**< @brief キューが空かどうか判定(他方のスレッドが操作中ならば近似値) */
+  bool empty() const noexcept { return size() == 0; }
+
+  /**< @brief キューの要素数を返す(他方のスレッドが操作中ならば近似値) */
+  std::size_t size() const noexcept {
+    const std::size_t h = head_.load(std::memory_order_acquire);
+    const std::size_t t = tail_.load(std::memory_order_acquire);
+    return t - h;
+  }
+
+  /**< @brief キューの容量を返す */
+  static constexpr std::size_t capacity() noexcept { return N; }
+
+private:
+  alignas(cache_line) std::atomic<std::size_t> head_ = 0; /**< 先頭(消費者が書く) */
+  std::size_t tail_cache_ = 0;                            /**< 消費者が最後に読んだ末尾 */
+  alignas(cache_line) std::atomic<std::size_t> tail_ = 0; /**< 末尾(生産者が書く) */
+  std::size_t head_cache_ = 0;                            /**< 生産者が最後に読んだ先頭 */
+  alignas(cache_line) Allocator alloc_;                   /**< アロケータ */
+  T *Q_;                                                  /**< キューQ */
+};
+
+} // namespace container
+
+#endif // end of SPSC_QUEUE_HPP
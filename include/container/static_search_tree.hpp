@@ -0,0 +1,465 @@
+/**
+ * @brief  キャッシュを意識した静的な探索木(暗黙的B木)
+ * @note   整列済みの範囲から一度だけ構築し、以後は探索のみを行う読み出し専用の表に使う
+ *         キーをB個(64バイト、キャッシュライン1本分)ずつのブロックに分け、
+ *         ブロックkのi番目の子をブロックk(B+1)+i+1とする暗黙的なB木の順に並べる
+ *         ポインタを持たず、1つのブロック内の探索はSIMDの比較1〜4回で済むので、
+ *         探索で起きるキャッシュミスは木の段数(log_{B+1}n)程度になる
+ * @note   キーが32/64ビットの整数または浮動小数点数で、比較述語がstd::lessのとき、
+ *         ブロック内の探索にAVX2(__AVX2__)またはSSE(__SSE2__, 64ビット整数は__SSE4_2__)を使う
+ *         それ以外の場合や、命令セットが使えない環境ではスカラー版に切り替わる
+ *         浮動小数点数のキーにNaNを含めてはならない
+ * @note   付属データは整列済みの配列に別に置き、ブロックの各位置からその配列の位置を引く
+ *         そのためイテレータは整列済みの配列のものになり、範囲の走査は連続領域をたどるだけでよい
+ * @note   Reference: P.-V. Khuong and P. Morin,
+ *         Array Layouts for Comparison-Based Searching
+ */
+
+#ifndef STATIC_SEARCH_TREE_HPP
+#define STATIC_SEARCH_TREE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace container {
+
+namespace impl {
+
+constexpr std::size_t cache_line = 64; /**< キャッシュラインの大きさ(バイト) */
+
+/**< @brief ブロック内の探索にSIMDを使えるキーの型と比較述語の組かどうか */
+template <class Key, class Compare>
+inline constexpr bool simd_searchable_v =
+    (std::is_same_v<Compare, std::less<Key>> ||
+     std::is_same_v<Compare, std::less<>>) &&
+    ((std::is_integral_v<Key> && !std::is_same_v<Key, bool> &&
+      (sizeof(Key) == 4 || sizeof(Key) == 8)) ||
+     std::is_same_v<Key, float> || std::is_same_v<Key, double>);
+
+#if defined(__AVX2__)
+/**
+ * @brief 64バイトのブロックbの中でxより小さいキーの数を数える(AVX2版)
+ * @note  符号なし整数は符号ビットを反転して符号付きの比較に置き換える
+ */
+template <class Key>
+inline std::size_t rank_avx2(const Key *b, Key x) noexcept {
+  unsigned m;
+  if constexpr (std::is_same_v<Key, float>) {
+    const __m256 v = _mm256_set1_ps(x);
+    const __m256 c0 = _mm256_cmp_ps(_mm256_loadu_ps(b), v, _CMP_LT_OQ);
+    const __m256 c1 = _mm256_cmp_ps(_mm256_loadu_ps(b + 8), v, _CMP_LT_OQ);
+    m = _mm256_movemask_ps(c0) | (_mm256_movemask_ps(c1) << 8);
+  } else if constexpr (std::is_same_v<Key, double>) {
+    const __m256d v = _mm256_set1_pd(x);
+    const __m256d c0 = _mm256_cmp_pd(_mm256_loadu_pd(b), v, _CMP_LT_OQ);
+    const __m256d c1 = _mm256_cmp_pd(_mm256_loadu_pd(b + 4), v, _CMP_LT_OQ);
+    m = _mm256_movemask_pd(c0) | (_mm256_movemask_pd(c1) << 4);
+  } else {
+    const __m256i *p = reinterpret_cast<const __m256i *>(b);
+    if constexpr (sizeof(Key) == 4) {
+      const __m256i s = _mm256_set1_epi32(
+          std::is_signed_v<Key> ? 0 : std::numeric_limits<std::int32_t>::min());
+      const __m256i v =
+          _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(x)), s);
+      const __m256i c0 =
+          _mm256_cmpgt_epi32(v, _mm256_xor_si256(_mm256_loadu_si256(p), s));
+      const __m256i c1 =
+          _mm256_cmpgt_epi32(v, _mm256_xor_si256(_mm256_loadu_si256(p + 1), s));
+      m = _mm256_movemask_ps(_mm256_castsi256_ps(c0)) |
+          (_mm256_movemask_ps(_mm256_castsi256_ps(c1)) << 8);
+    } else {
+      const __m256i s = _mm256_set1_epi64x(
+          std::is_signed_v<Key> ? 0 : std::numeric_limits<std::int64_t>::min());
+      const __m256i v =
+          _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(x)), s);
+      const __m256i c0 =
+          _mm256_cmpgt_epi64(v, _mm256_xor_si256(_mm256_loadu_si256(p), s));
+      const __m256i c1 =
+          _mm256_cmpgt_epi64(v, _mm256_xor_si256(_mm256_loadu_si256(p + 1), s));
+      m = _mm256_movemask_pd(_mm256_castsi256_pd(c0)) |
+          (_mm256_movemask_pd(_mm256_castsi256_pd(c1)) << 4);
+    }
+  }
+  return std::popcount(m);
+}
+#endif
+
+#if defined(__SSE2__)
+/**< @brief SSEでブロック内の探索ができるかどうか(64ビット整数の比較にはSSE4.2が要る) */
+template <class Key>
+inline constexpr bool sse_searchable_v =
+#if defined(__SSE4_2__)
+    true;
+#else
+    !(std::is_integral_v<Key> && sizeof(Key) == 8);
+#endif
+
+/**< @brief 64バイトのブロックbの中でxより小さいキーの数を数える(SSE版) */
+template <class Key> inline std::size_t rank_sse(const Key *b, Key x) noexcept {
+  unsigned m = 0;
+  if constexpr (std::is_same_v<Key, float>) {
+    const __m128 v = _mm_set1_ps(x);
+    for (int i = 0; i < 4; i++) {
+      m |= _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(b + 4 * i), v)) << 4 * i;
+    }
+  } else if constexpr (std::is_same_v<Key, double>) {
+    const __m128d v = _mm_set1_pd(x);
+    for (int i = 0; i < 4; i++) {
+      m |= _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(b + 2 * i), v)) << 2 * i;
+    }
+  } else {
+    const __m128i *p = reinterpret_cast<const __m128i *>(b);
+    if constexpr (sizeof(Key) == 4) {
+      const __m128i s = _mm_set1_epi32(
+          std::is_signed_v<Key> ? 0 : std::numeric_limits<std::int32_t>::min());
+      const __m128i v =
+          _mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(x)), s);
+      for (int i = 0; i < 4; i++) {
+        const __m128i c =
+            _mm_cmpgt_epi32(v, _mm_xor_si128(_mm_loadu_si128(p + i), s));
+        m |= _mm_movemask_ps(_mm_castsi128_ps(c)) << 4 * i;
+      }
+    } else {
+#if defined(__SSE4_2__)
+      const __m128i s = _mm_set1_epi64x(
+          std::is_signed_v<Key> ? 0 : std::numeric_limits<std::int64_t>::min());
+      const __m128i v =
+          _mm_xor_si128(_mm_set1_epi64x(static_cast<std::int64_t>(x)), s);
+      for (int i = 0; i < 4; i++) {
+        const __m128i c =
+            _mm_cmpgt_epi64(v, _mm_xor_si128(_mm_loadu_si128(p + i), s));
+        m |= _mm_movemask_pd(_mm_castsi128_pd(c)) << 2 * i;
+      }
+#endif
+    }
+  }
+  return std::popcount(m);
+}
+#endif
+
+/**
+ * @brief 大きさBのブロックbの中でxより小さいキーの数(xの下界の位置)を返す
+ * @note  SIMDが使えなければ先頭から順に比較する
+ */
+template <std::size_t B, class Key, class Compare>
+inline std::size_t block_rank(const Key *b, const Key &x,
+                              const Compare &cmp) noexcept {
+  if constexpr (simd_searchable_v<Key, Compare> && B * sizeof(Key) == 64) {
+#if defined(__AVX2__)
+    return rank_avx2(b, x);
+#elif defined(__SSE2__)
+    if constexpr (sse_searchable_v<Key>) {
+      return rank_sse(b, x);
+    }
+#endif
+  }
+  std::size_t i = 0;
+  while (i < B && cmp(b[i], x)) {
+    i++;
+  }
+  return i;
+}
+
+} // namespace impl
+
+/**
+ * @brief  キャッシュを意識した静的な探索木(暗黙的B木)
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Compare   キーを引数にとる比較述語の型
+ * @tparam Allocator アロケータの型
+ */
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              std::pair<Key, T>>>
+class static_search_tree {
+  static_assert(alignof(Key) <= impl::cache_line);
+  using byte_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<unsigned char>;
+  using rank_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::uint32_t>;
+  using byte_traits = std::allocator_traits<byte_alloc>;
+
+public:
+  using value_type = std::pair<Key, T>;
+  using items_t = std::vector<value_type, Allocator>;
+  using const_iterator = typename items_t::const_iterator;
+  using iterator = const_iterator;
+
+  /**< @brief 1ブロックあたりのキー数(キャッシュライン1本分) */
+  static constexpr std::size_t block_size =
+      std::max<std::size_t>(impl::cache_line / sizeof(Key), 4);
+  /**< @brief まとめて探索するときに並行してたどるキーの数 */
+  static constexpr std::size_t batch_size = 16;
+
+  explicit static_search_tree(const Allocator &a = Allocator())
+      : alloc_(a), items_(a), ranks_(a) {}
+
+  /**
+   * @brief 整列済みの範囲[first, last)から構築する
+   * @note  要素はstd::get<0>でキー、std::get<1>で付属データを取り出せること
+   */
+  template <class InputIterator>
+  static_search_tree(InputIterator first, InputIterator last,
+                     const Allocator &a = Allocator())
+      : static_search_tree(a) {
+    build(first, last);
+  }
+
+  static_search_tree(const static_search_tree &) = delete;
+  static_search_tree &operator=(const static_search_tree &) = delete;
+  static_search_tree(static_search_tree &&other) noexcept
+      : static_search_tree(other.alloc_) {
+    swap(other);
+  }
+  static_search_tree &operator=(static_search_tree &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~static_search_tree() noexcept { release(); }
+
+  /**
+   * @brief 整列済みの範囲[first, last)から作り直す
+   * @note  実行時間はΟ(n)
+   */
+  template <class InputIterator>
+  void build(InputIterator first, InputIterator last) {
+    release();
+    items_.clear();
+    for (; first != last; ++first) {
+      items_.emplace_back(std::get<0>(*first), std::get<1>(*first));
+    }
+    BOOST_ASSERT_MSG(std::is_sorted(items_.begin(), items_.end(),
+                                    [this](const auto &a, const auto &b) {
+                                      return cmp_(a.first, b.first);
+                                    }),
+                     "static_search_tree requires a sorted range.");
+    BOOST_ASSERT_MSG(
+        items_.size() < std::numeric_limits<std::uint32_t>::max(),
+        "static_search_tree size over.");
+    const std::size_t n = items_.size();
+    blocks_ = (n + block_size - 1) / block_size;
+    if (blocks_ == 0) {
+      return;
+    }
+    // キャッシュラインの境界に揃えるため、1本分余分に確保する
+    bytes_ = blocks_ * block_size * sizeof(Key) + impl::cache_line;
+    raw_ = byte_traits::allocate(alloc_, bytes_);
+    void *p = raw_;
+    std::size_t space = bytes_;
+    keys_ = static_cast<Key *>(std::align(
+        impl::cache_line, blocks_ * block_size * sizeof(Key), p, space));
+    ranks_.resize(blocks_ * block_size);
+    std::size_t t = 0;
+    fill(0, t);
+  }
+
+  /**< @brief 要素数を返す */
+  std::size_t size() const noexcept { return items_.size(); }
+  /**< @brief 空かどうか返す */
+  bool empty() const noexcept { return items_.empty(); }
+  /**< @brief 木の段数(探索でたどるブロック数の最大値)を返す */
+  std::size_t height() const noexcept {
+    std::size_t h = 0;
+    for (std::size_t k = 0; k < blocks_; k = child(k, 0)) {
+      h++;
+    }
+    return h;
+  }
+
+  /**< @brief 整列済みの要素の先頭を返す */
+  const_iterator begin() const noexcept { return items_.begin(); }
+  /**< @brief 整列済みの要素の末尾を返す */
+  const_iterator end() const noexcept { return items_.end(); }
+
+  /**
+   * @brief キーkに対応する付属データを返す
+   * @note  実行時間はΟ(log_{B+1}n)
+   */
+  std::optional<T> find(const Key &k) const {
+    const T *v = get(k);
+    return v == nullptr ? std::nullopt : std::make_optional(*v);
+  }
+
+  /**< @brief キーkに対応する付属データへのポインタを返す(なければnullptr) */
+  const T *get(const Key &k) const {
+    const std::size_t s = search(k);
+    if (s == npos || cmp_(k, keys_[s])) {
+      return nullptr;
+    }
+    return &items_[ranks_[s]].second;
+  }
+
+  /**< @brief キーk以上の最小の要素を指すイテレータを返す */
+  const_iterator lower_bound(const Key &k) const {
+    const std::size_t s = search(k);
+    return s == npos ? end() : begin() + ranks_[s];
+  }
+
+  /**< @brief キーkより大きい最小の要素を指すイテレータを返す */
+  const_iterator upper_bound(const Key &k) const {
+    const_iterator it = lower_bound(k);
+    while (it != end() && !cmp_(k, it->first)) {
+      ++it;
+    }
+    return it;
+  }
+
+  /**
+   * @brief 範囲[first, last)のキーそれぞれの下界をoutへ書き出す
+   * @note  batch_size個の探索を1段ずつ並行して進め、次に読むブロックを先読みしておく
+   *        これにより各探索のキャッシュミスの待ち時間が重なり合う
+   */
+  template <class InputIterator, class OutputIterator>
+  OutputIterator lower_bound(InputIterator first, InputIterator last,
+                             OutputIterator out) const {
+    Key x[batch_size];
+    std::size_t k[batch_size], s[batch_size];
+    while (first != last) {
+      std::size_t m = 0;
+      for (; m < batch_size && first != last; ++first) {
+        x[m] = *first;
+        k[m] = 0;
+        s[m++] = npos;
+      }
+      for (bool more = blocks_ > 0; more;) {
+        more = false;
+        for (std::size_t j = 0; j < m; j++) {
+          if (k[j] < blocks_) {
+            step(x[j], k[j], s[j]);
+            if (k[j] < blocks_) {
+              prefetch(k[j]);
+              more = true;
+            }
+          }
+        }
+      }
+      for (std::size_t j = 0; j < m; j++) {
+        *out++ = s[j] == npos ? end() : begin() + ranks_[s[j]];
+      }
+    }
+    return out;
+  }
+
+  /**< @brief 確保済みの記憶領域の大きさ(バイト)を返す */
+  std::size_t bytes() const noexcept {
+    return bytes_ + ranks_.capacity() * sizeof(std::uint32_t) +
+           items_.capacity() * sizeof(value_type);
+  }
+
+  void swap(static_search_tree &other) noexcept {
+    using std::swap;
+    swap(alloc_, other.alloc_);
+    swap(cmp_, other.cmp_);
+    items_.swap(other.items_);
+    ranks_.swap(other.ranks_);
+    swap(raw_, other.raw_);
+    swap(keys_, other.keys_);
+    swap(bytes_, other.bytes_);
+    swap(blocks_, other.blocks_);
+  }
+
+private:
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  /**< @brief ブロックkのi番目の子ブロックを返す */
+  static constexpr std::size_t child(std::size_t k, std::size_t i) noexcept {
+    return k * (block_size + 1) + i + 1;
+  }
+
+  /**
+   * @brief ブロックkを根とする部分木に、中間順にt番目以降のキーを詰める
+   * @note  要素数がブロックの倍数でないとき、末尾は最大のキーの複製で埋める
+   *        複製は中間順で本来のキーより後ろに来るので、探索結果には現れない
+   */
+  void fill(std::size_t k, std::size_t &t) {
+    if (k >= blocks_) {
+      return;
+    }
+    const std::size_t n = items_.size();
+    for (std::size_t i = 0; i < block_size; i++) {
+      fill(child(k, i), t);
+      const std::size_t s = k * block_size + i;
+      ::new (static_cast<void *>(keys_ + s))
+          Key(items_[std::min(t, n - 1)].first);
+      ranks_[s] = static_cast<std::uint32_t>(std::min(t, n));
+      t++;
+    }
+    fill(child(k, block_size), t);
+  }
+
+  /**
+   * @brief キーk以上の最小のキーを持つブロック内の位置を返す(なければnpos)
+   * @note  各ブロックでk以上の最初の位置を求め、その位置の子へ降りる
+   *        最後に見つかった位置が中間順で最初のk以上のキーになる
+   */
+  std::size_t search(const Key &x) const noexcept {
+    std::size_t s = npos;
+    for (std::size_t k = 0; k < blocks_;) {
+      step(x, k, s);
+    }
+    return s;
+  }
+
+  /**< @brief ブロックkの中でxの下界を求め、見つかれば位置sを更新し、子ブロックへ降りる */
+  void step(const Key &x, std::size_t &k, std::size_t &s) const noexcept {
+    const Key *b = keys_ + k * block_size;
+    const std::size_t i = impl::block_rank<block_size>(b, x, cmp_);
+    if (i < block_size) {
+      s = k * block_size + i;
+    }
+    k = child(k, i);
+  }
+
+  /**< @brief ブロックkを先読みする */
+  void prefetch(std::size_t k) const noexcept {
+#if defined(__GNUC__)
+    __builtin_prefetch(keys_ + k * block_size);
+#else
+    (void)k;
+#endif
+  }
+
+  /**< @brief ブロックの記憶領域を解放する */
+  void release() noexcept {
+    if (raw_ != nullptr) {
+      for (std::size_t s = 0; s < blocks_ * block_size; s++) {
+        std::destroy_at(keys_ + s);
+      }
+      byte_traits::deallocate(alloc_, raw_, bytes_);
+    }
+    raw_ = nullptr;
+    keys_ = nullptr;
+    bytes_ = blocks_ = 0;
+    ranks_.clear();
+  }
+
+private:
+  byte_alloc alloc_;                             /**< ブロックのアロケータ */
+  Compare cmp_;                                  /**< 比較述語 */
+  items_t items_;                                /**< 整列済みの要素 */
+  std::vector<std::uint32_t, rank_alloc> ranks_; /**< ブロックの各位置の整列順 */
+  unsigned char *raw_ = nullptr;                 /**< ブロックの記憶領域 */
+  Key *keys_ = nullptr;                          /**< 暗黙的B木の順に並べたキー */
+  std::size_t bytes_ = 0;                        /**< ブロックの記憶領域の大きさ */
+  std::size_t blocks_ = 0;                       /**< ブロック数 */
+};
+
+} // namespace container
+
+#endif // end of STATIC_SEARCH_TREE_HPP
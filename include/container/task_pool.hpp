@@ -0,0 +1,240 @@
+/**
+ * @brief  ワークスティーリングによるタスクプール
+ * @note   ワーカーごとにChase-Levの両端キュー(container::ws_deque)を持ち、タスクの中で生成した
+ *         子タスクは自分の両端キューの末尾に積む. 自分の両端キューが空になったワーカーは、
+ *         他のワーカーの両端キューの先頭から盗む. 先頭には大きな(分割の浅い)タスクが残っているので、
+ *         分割統治の再帰ではひと盗みで多くの仕事を持ち帰れる
+ * @note   runを呼んだスレッドはその間ワーカー0として働くので、プールが作るスレッドはthreads - 1本
+ *         waitはタスクの完了を待つ間も他のタスクを実行するので、タスクの中から入れ子にwaitしてよい
+ * @note   仕事の無いワーカーは少し回った後に眠り、タスクの生成で起こされる
+ *         タスクは例外を投げてはならない
+ */
+
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+#include "container/mpmc_queue.hpp"
+#include "container/ws_deque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace container {
+
+/**< @brief 完了を待つタスクの組 */
+class task_group : private boost::noncopyable {
+  friend class task_pool;
+
+public:
+  /**< @brief 完了していないタスクがあるかどうか返す */
+  bool busy() const noexcept {
+    return pending_.load(std::memory_order_acquire) != 0;
+  }
+
+private:
+  std::atomic<std::size_t> pending_ = 0; /**< 完了していないタスクの数 */
+};
+
+/**
+ * @brief ワークスティーリングによるタスクプール
+ */
+class task_pool : private boost::noncopyable {
+  /**< @brief タスク(関数オブジェクトを型消去して持つ) */
+  struct task {
+    explicit task(task_group &g) noexcept : group(&g) {}
+    virtual ~task() = default;
+    virtual void run() = 0;
+    task_group *group; /**< 所属する組 */
+  };
+  template <class F> struct task_impl final : task {
+    task_impl(task_group &g, F &&f) : task(g), fn(std::move(f)) {}
+    void run() override { fn(); }
+    F fn;
+  };
+
+  /**< @brief 現在のスレッドが働いているプールとワーカーの番号 */
+  struct context {
+    task_pool *pool;
+    std::size_t index;
+  };
+  static inline thread_local context current_{nullptr, 0};
+
+public:
+  /**
+   * @brief 呼び出し側を含めてthreads個のワーカーを持つプールを作る
+   * @param threads ワーカーの数(0のときハードウェアのスレッド数)
+   */
+  explicit task_pool(std::size_t threads = 0) {
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+      deques_.push_back(std::make_unique<ws_deque<task *>>(256));
+    }
+    for (std::size_t i = 1; i < threads; i++) {
+      threads_.emplace_back([this, i] { work(i); });
+    }
+  }
+  ~task_pool() {
+    stop_.store(true, std::memory_order_seq_cst);
+    wake();
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  /**< @brief ワーカーの数を返す */
+  std::size_t size() const noexcept { return deques_.size(); }
+
+  /**
+   * @brief 現在のスレッドのワーカーの番号を返す(プールの外では0)
+   * @note  ワーカーごとの作業領域を選ぶのに使う. 作業領域を使っている間にwaitすると、
+   *        同じワーカーが別のタスクを実行して作業領域を上書きすることに注意
+   */
+  static std::size_t worker_index() noexcept { return current_.index; }
+
+  /**
+   * @brief 呼び出したスレッドをワーカー0としてfn()を実行する
+   * @note  fnの中でspawnしたタスクは、fnの中でwaitしておくこと
+   *        別のスレッドからのrunは順番に実行する. このプールのタスクの中から呼んだときはそのまま実行する
+   */
+  template <class F> void run(F &&fn) {
+    if (current_.pool == this) {
+      fn();
+      return;
+    }
+    std::lock_guard<std::mutex> lock(run_m_);
+    const context saved = std::exchange(current_, context{this, 0});
+    fn();
+    current_ = saved;
+  }
+
+  /**
+   * @brief 組gにタスクfn()を加え、現在のワーカーの両端キューに積む
+   * @note  このプールのrunの中(タスクの中を含む)からだけ呼べる
+   */
+  template <class F> void spawn(task_group &g, F fn) {
+    BOOST_ASSERT_MSG(current_.pool == this, "Spawn outside of the pool.");
+    g.pending_.fetch_add(1, std::memory_order_relaxed);
+    deques_[current_.index]->push(new task_impl<F>(g, std::move(fn)));
+    std::atomic_thread_fence(std::memory_order_seq_cst); // 眠る側の再確認と対
+    if (sleepers_.load(std::memory_order_relaxed) != 0) {
+      wake();
+    }
+  }
+
+  /**
+   * @brief 組gのタスクが全て完了するまで、他のタスクを実行しながら待つ
+   * @note  このプールのrunの中(タスクの中を含む)からだけ呼べる
+   */
+  void wait(task_group &g) {
+    BOOST_ASSERT_MSG(current_.pool == this, "Wait outside of the pool.");
+    const std::size_t i = current_.index;
+    std::uint64_t rng = seed(i);
+    while (g.busy()) {
+      if (task *t = find(i, rng); t != nullptr) {
+        execute(t);
+      } else {
+        impl::cpu_relax();
+      }
+    }
+  }
+
+private:
+  /**< @brief ワーカーiの乱数の種 */
+  static std::uint64_t seed(std::size_t i) noexcept {
+    return 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+
+  /**< @brief ワーカーiが次に実行するタスクを探す(自分の末尾、無ければ他のワーカーの先頭) */
+  task *find(std::size_t i, std::uint64_t &rng) noexcept {
+    if (auto t = deques_[i]->pop(); t) {
+      return *t;
+    }
+    const std::size_t n = deques_.size();
+    rng ^= rng << 13; // xorshiftで盗む相手の最初を選ぶ
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    const std::size_t first = static_cast<std::size_t>(rng % n);
+    for (std::size_t k = 0; k < n; k++) {
+      const std::size_t v = (first + k) % n;
+      if (v == i) {
+        continue;
+      }
+      if (auto t = deques_[v]->steal(); t) {
+        return *t;
+      }
+    }
+    return nullptr;
+  }
+
+  /**< @brief タスクtを実行して破棄する */
+  static void execute(task *t) {
+    task_group *g = t->group;
+    t->run();
+    delete t;
+    g->pending_.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  /**< @brief いずれかの両端キューにタスクが残っているかどうか返す */
+  bool has_work() const noexcept {
+    return std::any_of(deques_.begin(), deques_.end(),
+                       [](const auto &d) { return !d->empty(); });
+  }
+
+  /**< @brief 眠っているワーカーを全て起こす */
+  void wake() noexcept {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.notify_all();
+  }
+
+  /**< @brief ワーカーiの本体 */
+  void work(std::size_t i) {
+    current_ = context{this, i};
+    std::uint64_t rng = seed(i);
+    constexpr int spins = 1 << 10; /**< 眠る前に回る回数 */
+    int idle = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+      if (task *t = find(i, rng); t != nullptr) {
+        execute(t);
+        idle = 0;
+      } else if (++idle < spins) {
+        impl::cpu_relax();
+      } else { // 眠る前に登録してから仕事を確かめ直し、spawnとの行き違いを防ぐ
+        const std::uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_work() && !stop_.load(std::memory_order_seq_cst)) {
+          epoch_.wait(e, std::memory_order_seq_cst);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<ws_deque<task *>>> deques_; /**< ワーカーごとの両端キュー */
+  std::vector<std::thread> threads_;                      /**< ワーカー1以降のスレッド */
+  std::mutex run_m_;                                      /**< runの排他 */
+  std::atomic<bool> stop_ = false;                        /**< 停止の要求 */
+  std::atomic<std::uint64_t> epoch_ = 0;                  /**< 起こすたびに進める番号 */
+  std::atomic<std::size_t> sleepers_ = 0;                 /**< 眠っているワーカーの数 */
+};
+
+/**< @brief ハードウェアのスレッド数のワーカーを持つ既定のプールを返す */
+inline task_pool &default_task_pool() {
+  static task_pool pool;
+  return pool;
+}
+
+} // namespace container
+
+#endif // end of TASK_POOL_HPP
@@ -0,0 +1,204 @@
+/**
+ * @brief  Chase-Levのワークスティーリング両端キュー
+ * @note   所有者のスレッドだけが末尾(bottom)でpush/popを行い、他のスレッド(盗み手)は先頭(top)からstealする
+ *         所有者の操作は、最後の1要素を盗み手と奪い合うときを除いてCASを使わない
+ *         盗み手どうし、および最後の1要素をめぐる所有者と盗み手はtopのCASで調停する
+ * @note   配列が満杯になると所有者が2倍の配列へ写して差し替える. 盗み手は古い配列を読んでいる
+ *         かもしれないので、古い配列はすぐには解放せず、差し替えた配列に繋いでおいて両端キューの破棄時に解放する
+ *         配列は2倍ずつ大きくなるので、残しておく古い配列の合計は現在の配列より小さい
+ * @note   盗み手は所有者が上書き中のスロットを読むことがある(そのときはCASに失敗して値を捨てる)ので、
+ *         スロットはstd::atomic<T>とし、Tはロックフリーに読み書きできるトリビアルにコピー可能な型に限る
+ * @note   Reference: D. Chase, Y. Lev,
+ *         Dynamic circular work-stealing deque, 2005
+ *         N. M. Le, A. Pop, A. Cohen, F. Zappa Nardelli,
+ *         Correct and efficient work-stealing for weak memory models, 2013
+ */
+
+#ifndef WS_DEQUE_HPP
+#define WS_DEQUE_HPP
+
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace container {
+
+/**
+ * @brief  ワークスティーリング両端キュー
+ * @tparam T         要素の型(タスクへのポインタなど)
+ * @tparam Allocator アロケータの型
+ */
+template <class T,
+          class Allocator = boost::container::pmr::polymorphic_allocator<T>>
+class ws_deque : private boost::noncopyable {
+  static_assert(std::is_trivially_copyable_v<T> &&
+                std::atomic<T>::is_always_lock_free);
+  static constexpr std::size_t cache_line = 64; /**< キャッシュラインの大きさ */
+
+  /**< @brief 循環配列(スロットは容量の分だけこのヘッダの直後に続く) */
+  struct alignas(std::atomic<T>) ring {
+    std::int64_t mask; /**< 添字のマスク(容量 - 1) */
+    ring *prev;        /**< 差し替える前の配列 */
+
+    std::int64_t capacity() const noexcept { return mask + 1; }
+    std::atomic<T> *slots() noexcept {
+      return reinterpret_cast<std::atomic<T> *>(this + 1);
+    }
+    const std::atomic<T> *slots() const noexcept {
+      return reinterpret_cast<const std::atomic<T> *>(this + 1);
+    }
+    T get(std::int64_t i) const noexcept {
+      return slots()[i & mask].load(std::memory_order_relaxed);
+    }
+    void put(std::int64_t i, T x) noexcept {
+      slots()[i & mask].store(x, std::memory_order_relaxed);
+    }
+  };
+  using ring_alloc =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<ring>;
+  using ring_traits = std::allocator_traits<ring_alloc>;
+
+public:
+  /**
+   * @brief 容量がn以上の最小の2の冪の両端キューを作る
+   */
+  explicit ws_deque(std::size_t n = 32, const Allocator &a = Allocator())
+      : alloc_(a) {
+    std::size_t cap = 2;
+    while (cap < n) {
+      cap <<= 1;
+    }
+    array_.store(create_ring(cap, nullptr), std::memory_order_relaxed);
+  }
+  ~ws_deque() noexcept {
+    for (ring *r = array_.load(std::memory_order_relaxed); r != nullptr;) {
+      ring *prev = r->prev;
+      destroy_ring(r);
+      r = prev;
+    }
+  }
+
+  /**
+   * @brief 末尾に要素xを挿入する(所有者のみ)
+   * @note  満杯ならば2倍の配列に差し替える
+   */
+  void push(T x) {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    const std::int64_t t = top_.load(std::memory_order_acquire);
+    ring *a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->mask) {
+      a = grow(a, t, b);
+    }
+    a->put(b, x);
+    bottom_.store(b + 1, std::memory_order_release); // スロットの書き込みを公開する
+  }
+
+  /**
+   * @brief 末尾の要素を取り出す(所有者のみ)
+   * @note  先にbottomを減らしてから、盗み手のtopと比べる. 残りが1要素のときはtopのCASで盗み手と奪い合う
+   */
+  std::optional<T> pop() noexcept {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    ring *a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) { // 空だった
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    std::optional<T> x = a->get(b);
+    if (t == b) { // 最後の1要素
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        x = std::nullopt; // 盗み手に取られた
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  /**
+   * @brief 先頭の要素を盗む(どのスレッドからでもよい)
+   * @note  空のとき、または他の盗み手か所有者との奪い合いに負けたときstd::nulloptを返す
+   */
+  std::optional<T> steal() noexcept {
+    std::int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return std::nullopt;
+    }
+    const ring *a = array_.load(std::memory_order_acquire);
+    const T x = a->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    return std::make_optional(x);
+  }
+
+  /**< @brief 要素数を返す(他のスレッドが操作中ならば近似値) */
+  std::size_t size() const noexcept {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    const std::int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<std::size_t>(b - t) : 0;
+  }
+
+  /**< @brief 空かどうか返す(他のスレッドが操作中ならば近似値) */
+  bool empty() const noexcept { return size() == 0; }
+
+  /**< @brief 現在の配列の容量を返す */
+  std::size_t capacity() const noexcept {
+    return array_.load(std::memory_order_relaxed)->capacity();
+  }
+
+private:
+  /**< @brief 配列aの要素[t, b)を2倍の配列へ写して差し替える(所有者のみ) */
+  ring *grow(ring *a, std::int64_t t, std::int64_t b) {
+    ring *r = create_ring(2 * a->capacity(), a);
+    for (std::int64_t i = t; i < b; i++) {
+      r->put(i, a->get(i));
+    }
+    array_.store(r, std::memory_order_release);
+    return r;
+  }
+
+  /**< @brief 容量capの配列を収めるのに要るヘッダ何個分の領域を返す(整列はヘッダに合わせる) */
+  static std::size_t ring_units(std::size_t cap) noexcept {
+    return 1 + (cap * sizeof(std::atomic<T>) + sizeof(ring) - 1) / sizeof(ring);
+  }
+
+  /**< @brief 容量capの配列を確保する */
+  ring *create_ring(std::size_t cap, ring *prev) {
+    ring *p = ring_traits::allocate(alloc_, ring_units(cap));
+    ring *r = ::new (static_cast<void *>(p))
+        ring{static_cast<std::int64_t>(cap - 1), prev};
+    for (std::size_t i = 0; i < cap; i++) {
+      ::new (static_cast<void *>(r->slots() + i)) std::atomic<T>();
+    }
+    return r;
+  }
+
+  /**< @brief 配列rを解放する */
+  void destroy_ring(ring *r) noexcept {
+    const std::size_t cap = r->capacity();
+    ring_traits::deallocate(alloc_, r, ring_units(cap));
+  }
+
+private:
+  alignas(cache_line) std::atomic<std::int64_t> top_ = 0;    /**< 先頭(盗み手がCASで進める) */
+  alignas(cache_line) std::atomic<std::int64_t> bottom_ = 0; /**< 末尾(所有者が書く) */
+  std::atomic<ring *> array_ = nullptr;                      /**< 現在の配列 */
+  ring_alloc alloc_;                                         /**< アロケータ */
+};
+
+} // namespace container
+
+#endif // end of WS_DEQUE_HPP
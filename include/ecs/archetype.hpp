@@ -0,0 +1,472 @@
+/**
+ * @brief  アーキタイプによる構成要素の格納
+ * @note   同じ構成要素の集合を持つエンティティを1つの表(アーキタイプ)にまとめ、
+ *         表の中では構成要素ごとの列に値を詰めて並べる(SoA)
+ *         巡回では条件に合う表の列を先頭から順に読むだけなので、キャッシュとSIMDを活かせる
+ * @note   構成要素の追加や削除は、エンティティの行を別の表へ移す(構造の変更)
+ *         表からの行の削除は末尾の行を空いた位置へ移すので、巡回中に構造を変えてはならない
+ *         巡回中の変更はcommand_bufferに記録しておき、巡回の後でまとめて適用する
+ * @note   par_for_eachは表をchunk_rows行ずつのチャンクに分け、既定のタスクプールのタスクがチャンクを1つずつ取って処理する
+ */
+
+#ifndef ECS_ARCHETYPE_HPP
+#define ECS_ARCHETYPE_HPP
+
+#include "container/flat_hash_map.hpp"
+#include "container/task_pool.hpp"
+#include "ecs/entity.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace ecs {
+
+/**< @brief 構成要素の集合を表すマスク(型番号のビットを立てる) */
+using component_mask = std::uint64_t;
+
+/**< @brief 構成要素Ts...のマスクを返す */
+template <class... Ts> component_mask mask_of() {
+  return ((component_mask{1} << component_id<Ts>()) | ... | 0);
+}
+
+/**< @brief 型を消した構成要素の操作 */
+struct component_info {
+  std::size_t size;                   /**< 大きさ */
+  std::size_t align;                  /**< 境界 */
+  bool trivial;                       /**< トリビアルにコピー可能かどうか */
+  void (*move)(void *dst, void *src); /**< dstへのムーブ構築 */
+  void (*destroy)(void *p);           /**< デストラクタ呼び出し */
+
+  template <class T> static const component_info &of() noexcept {
+    static_assert(std::is_nothrow_move_constructible_v<T>);
+    static const component_info info = {
+        sizeof(T), alignof(T), std::is_trivially_copyable_v<T>,
+        [](void *dst, void *src) {
+          ::new (dst) T(std::move(*static_cast<T *>(src)));
+        },
+        [](void *p) { static_cast<T *>(p)->~T(); }};
+    return info;
+  }
+};
+
+/**< @brief アーキタイプの1列(1種類の構成要素の値を詰めた配列) */
+class column : private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+public:
+  column(const component_info &info, memory_resource *mr) noexcept
+      : info_(&info), mr_(mr) {}
+  ~column() noexcept { release(); }
+
+  /**< @brief i行目の値を返す */
+  void *at(std::size_t i) noexcept { return data_ + i * info_->size; }
+  /**< @brief 列の先頭を返す */
+  template <class T> T *data() noexcept {
+    return std::launder(reinterpret_cast<T *>(data_));
+  }
+  const component_info &info() const noexcept { return *info_; }
+
+  /**< @brief 容量をcapにする(size行の値を移す) */
+  void reserve(std::size_t size, std::size_t cap) {
+    if (cap <= cap_) {
+      return;
+    }
+    auto *p = static_cast<unsigned char *>(
+        mr_->allocate(cap * info_->size, info_->align));
+    if (info_->trivial) {
+      if (size > 0) {
+        std::memcpy(p, data_, size * info_->size);
+      }
+    } else {
+      for (std::size_t i = 0; i < size; i++) {
+        info_->move(p + i * info_->size, at(i));
+        info_->destroy(at(i));
+      }
+    }
+    if (data_ != nullptr) {
+      mr_->deallocate(data_, cap_ * info_->size, info_->align);
+    }
+    data_ = p;
+    cap_ = cap;
+  }
+
+  /**< @brief i行目の値を破棄し、末尾のlast行目の値をそこへ移す */
+  void swap_remove(std::size_t i, std::size_t last) noexcept {
+    info_->destroy(at(i));
+    if (i != last) {
+      info_->move(at(i), at(last));
+      info_->destroy(at(last));
+    }
+  }
+
+  /**< @brief size行の値を破棄し、記憶領域を解放する */
+  void clear(std::size_t size) noexcept {
+    for (std::size_t i = 0; i < size; i++) {
+      info_->destroy(at(i));
+    }
+  }
+
+private:
+  void release() noexcept {
+    if (data_ != nullptr) {
+      mr_->deallocate(data_, cap_ * info_->size, info_->align);
+    }
+    data_ = nullptr;
+    cap_ = 0;
+  }
+
+  const component_info *info_;    /**< 構成要素の操作 */
+  memory_resource *mr_;           /**< メモリ資源 */
+  unsigned char *data_ = nullptr; /**< 値の配列 */
+  std::size_t cap_ = 0;           /**< 容量(行数) */
+};
+
+/**< @brief 同じ構成要素の集合を持つエンティティの表 */
+class archetype : private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+public:
+  archetype(component_mask mask, memory_resource *mr)
+      : mask_(mask), entities_(mr) {
+    index_.fill(-1);
+  }
+  ~archetype() noexcept {
+    for (auto &c : columns_) {
+      c->clear(entities_.size());
+    }
+  }
+
+  /**< @brief 型番号idの列を加える(表を作るときだけ呼ぶ) */
+  void add_column(std::size_t id, const component_info &info,
+                  memory_resource *mr) {
+    index_[id] = static_cast<std::int8_t>(columns_.size());
+    columns_.push_back(std::make_unique<column>(info, mr));
+  }
+
+  component_mask mask() const noexcept { return mask_; }
+  std::size_t size() const noexcept { return entities_.size(); }
+  const entity *entities() const noexcept { return entities_.data(); }
+
+  /**< @brief 型番号idの列を返す(無ければNIL) */
+  column *get(std::size_t id) noexcept {
+    return index_[id] < 0 ? nullptr : columns_[index_[id]].get();
+  }
+  /**< @brief 構成要素Tの列の先頭を返す */
+  template <class T> T *data() {
+    return get(component_id<T>())->template data<T>();
+  }
+
+  /**< @brief エンティティeの行を末尾に加える(値は呼び出し側が構築する) */
+  std::size_t push(entity e) {
+    const std::size_t n = entities_.size();
+    if (n == cap_) {
+      cap_ = std::max<std::size_t>(64, 2 * cap_);
+      for (auto &c : columns_) {
+        c->reserve(n, cap_);
+      }
+    }
+    entities_.push_back(e);
+    return n;
+  }
+
+  /**
+   * @brief  i行目を削除し、末尾の行をそこへ移す
+   * @return i行目へ移ったエンティティ(末尾の行を削除したときは空のハンドル)
+   */
+  entity swap_remove(std::size_t i) noexcept {
+    const std::size_t last = entities_.size() - 1;
+    for (auto &c : columns_) {
+      c->swap_remove(i, last);
+    }
+    entity moved;
+    if (i != last) {
+      moved = entities_[last];
+      entities_[i] = moved;
+    }
+    entities_.pop_back();
+    return moved;
+  }
+
+  /**< @brief 構成要素の追加・削除による移動先の表のキャッシュ */
+  container::flat_hash_map<component_mask, archetype *> edges;
+
+private:
+  component_mask mask_; /**< 構成要素の集合 */
+  std::vector<entity, boost::container::pmr::polymorphic_allocator<entity>>
+      entities_;                                  /**< 各行のエンティティ */
+  std::vector<std::unique_ptr<column>> columns_;  /**< 列 */
+  std::array<std::int8_t, max_components> index_; /**< 型番号から列の番号 */
+  std::size_t cap_ = 0;                           /**< 容量(行数) */
+};
+
+/**
+ * @brief アーキタイプで構成要素を格納するエンティティの集まり
+ */
+class world : private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+  /**< @brief エンティティの格納場所 */
+  struct location {
+    archetype *a = nullptr; /**< 表 */
+    std::size_t row = 0;    /**< 行 */
+  };
+
+public:
+  /**< @brief par_for_eachで1つのスレッドが一度に処理する行数 */
+  static constexpr std::size_t chunk_rows = 4096;
+
+  explicit world(memory_resource *mr =
+                     boost::container::pmr::get_default_resource())
+      : mr_(mr), entities_(mr), locations_(mr) {}
+
+  /**< @brief 構成要素を持たないエンティティを作る */
+  entity create() { return create<>(); }
+
+  /**< @brief 構成要素cs...を持つエンティティを作る(表の間の移動なしに1回で置く) */
+  template <class... Ts> entity create(Ts &&... cs) {
+    archetype *a = find_or_create<std::decay_t<Ts>...>();
+    const entity e = entities_.create();
+    const std::size_t row = a->push(e);
+    (::new (a->get(component_id<std::decay_t<Ts>>())->at(row))
+         std::decay_t<Ts>(std::forward<Ts>(cs)),
+     ...);
+    place(e, a, row);
+    return e;
+  }
+
+  /**< @brief エンティティeを全ての構成要素と共に破棄する */
+  void destroy(entity e) {
+    BOOST_ASSERT_MSG(alive(e), "Stale entity.");
+    const location l = locations_[e.index()];
+    erase_row(l.a, l.row);
+    entities_.destroy(e);
+  }
+
+  /**< @brief エンティティeが生存しているかどうか返す */
+  bool alive(entity e) const noexcept { return entities_.alive(e); }
+
+  /**< @brief 生存しているエンティティの数を返す */
+  std::size_t size() const noexcept { return entities_.size(); }
+
+  /**< @brief 表の数を返す */
+  std::size_t archetypes() const noexcept { return tables_.size(); }
+
+  /**
+   * @brief エンティティeに構成要素Tを追加する. 既に持っていれば置き換える
+   * @note  持っていなければ、Tを加えた集合の表へ行を移す
+   */
+  template <class T, class... Args> T &add(entity e, Args &&... args) {
+    BOOST_ASSERT_MSG(alive(e), "Stale entity.");
+    const std::size_t id = component_id<T>();
+    location &l = locations_[e.index()];
+    if (column *c = l.a->get(id); c != nullptr) {
+      T &x = *static_cast<T *>(c->at(l.row));
+      x = T(std::forward<Args>(args)...);
+      return x;
+    }
+    T x(std::forward<Args>(args)...);
+    archetype *to = neighbor(l.a, l.a->mask() | (component_mask{1} << id),
+                             component_info::of<T>());
+    const std::size_t row = move_row(e, to);
+    return *::new (to->get(id)->at(row)) T(std::move(x));
+  }
+
+  /**< @brief エンティティeから構成要素Tを削除する(Tを除いた集合の表へ行を移す) */
+  template <class T> void remove(entity e) {
+    BOOST_ASSERT_MSG(alive(e), "Stale entity.");
+    const std::size_t id = component_id<T>();
+    const location l = locations_[e.index()];
+    if (l.a->get(id) == nullptr) {
+      return;
+    }
+    archetype *to = neighbor(l.a, l.a->mask() & ~(component_mask{1} << id),
+                             component_info::of<T>());
+    move_row(e, to);
+  }
+
+  /**< @brief エンティティeの構成要素Tへのポインタを返す(持っていなければNIL) */
+  template <class T> T *get(entity e) {
+    if (!alive(e)) {
+      return nullptr;
+    }
+    const location &l = locations_[e.index()];
+    column *c = l.a->get(component_id<T>());
+    return c == nullptr ? nullptr : static_cast<T *>(c->at(l.row));
+  }
+
+  /**< @brief エンティティeが構成要素Tを持つかどうか返す */
+  template <class T> bool has(entity e) const {
+    return alive(e) && (locations_[e.index()].a->mask() & mask_of<T>()) != 0;
+  }
+
+  /**
+   * @brief  構成要素Ts...を全て持つエンティティを巡回する
+   * @note   巡回中にエンティティや構成要素を追加・削除してはならない(command_bufferに記録しておく)
+   * @tparam class F entity, Ts&...を引数に取る関数オブジェクトの型
+   */
+  template <class... Ts, class F> void for_each(F fn) {
+    const component_mask m = mask_of<Ts...>();
+    for (auto &a : tables_) {
+      if ((a->mask() & m) == m) {
+        run_rows<Ts...>(*a, 0, a->size(), fn);
+      }
+    }
+  }
+
+  /**
+   * @brief  構成要素Ts...を全て持つエンティティを既定のタスクプールで並列に巡回する
+   * @note   条件に合う表をchunk_rows行ずつのチャンクに分け、各タスクが共有の番号を進めてチャンクを取る
+   *         fnは異なるエンティティに対して同時に呼ばれる
+   * @param  threads 並列に処理するタスクの数(0のときプールのワーカー数)
+   */
+  template <class... Ts, class F>
+  void par_for_each(F fn, std::size_t threads = 0) {
+    const component_mask m = mask_of<Ts...>();
+    struct chunk {
+      archetype *a;
+      std::size_t first, last;
+    };
+    std::vector<chunk> chunks;
+    for (auto &a : tables_) {
+      if ((a->mask() & m) == m) {
+        for (std::size_t i = 0; i < a->size(); i += chunk_rows) {
+          chunks.push_back({a.get(), i, std::min(i + chunk_rows, a->size())});
+        }
+      }
+    }
+    container::task_pool &pool = container::default_task_pool();
+    if (threads == 0) {
+      threads = pool.size();
+    }
+    threads = std::min(threads, chunks.size());
+    std::atomic<std::size_t> next = 0;
+    auto work = [&] {
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) <
+                          chunks.size();) {
+        run_rows<Ts...>(*chunks[i].a, chunks[i].first, chunks[i].last, fn);
+      }
+    };
+    if (threads <= 1) {
+      work();
+      return;
+    }
+    pool.run([&] {
+      container::task_group g;
+      for (std::size_t t = 1; t < threads; t++) {
+        pool.spawn(g, work);
+      }
+      work(); // 呼び出したタスクも処理する
+      pool.wait(g);
+    });
+  }
+
+private:
+  /**< @brief 表aの[first, last)行をfnに渡す */
+  template <class... Ts, class F>
+  static void run_rows(archetype &a, std::size_t first, std::size_t last,
+                       F &fn) {
+    const entity *es = a.entities();
+    std::tuple<Ts *...> cols(a.data<Ts>()...);
+    for (std::size_t i = first; i < last; i++) {
+      fn(es[i], std::get<Ts *>(cols)[i]...);
+    }
+  }
+
+  /**< @brief 構成要素Ts...の集合の表を返す(無ければ作る) */
+  template <class... Ts> archetype *find_or_create() {
+    const component_mask m = mask_of<Ts...>();
+    if (archetype **a = by_mask_.get(m); a != nullptr) {
+      return *a;
+    }
+    archetype *a = new_table(m);
+    (a->add_column(component_id<Ts>(), component_info::of<Ts>(), mr_), ...);
+    return a;
+  }
+
+  /**
+   * @brief 表fromに構成要素を1つ足すか除いた集合mの表を返す(無ければ作る)
+   * @note  移動先は表ごとにキャッシュする. infoは足す構成要素の操作
+   */
+  archetype *neighbor(archetype *from, component_mask m,
+                      const component_info &info) {
+    if (archetype **to = from->edges.get(m); to != nullptr) {
+      return *to;
+    }
+    archetype *to;
+    if (archetype **a = by_mask_.get(m); a != nullptr) {
+      to = *a;
+    } else {
+      to = new_table(m);
+      for (component_mask r = m; r != 0; r &= r - 1) {
+        const std::size_t j = std::countr_zero(r);
+        column *c = from->get(j);
+        to->add_column(j, c != nullptr ? c->info() : info, mr_);
+      }
+    }
+    from->edges.insert(m, to);
+    return to;
+  }
+
+  /**< @brief 集合mの空の表を作る */
+  archetype *new_table(component_mask m) {
+    tables_.push_back(std::make_unique<archetype>(m, mr_));
+    archetype *a = tables_.back().get();
+    by_mask_.insert(m, a);
+    return a;
+  }
+
+  /**
+   * @brief  エンティティeの行を表toへ移し、共通の構成要素をムーブする
+   * @return 移動先の行
+   */
+  std::size_t move_row(entity e, archetype *to) {
+    const location l = locations_[e.index()];
+    const std::size_t row = to->push(e);
+    for (component_mask r = l.a->mask() & to->mask(); r != 0; r &= r - 1) {
+      const std::size_t j = std::countr_zero(r);
+      column *src = l.a->get(j);
+      src->info().move(to->get(j)->at(row), src->at(l.row));
+    }
+    erase_row(l.a, l.row);
+    place(e, to, row);
+    return row;
+  }
+
+  /**< @brief 表aのrow行を削除し、移ってきたエンティティの場所を直す */
+  void erase_row(archetype *a, std::size_t row) noexcept {
+    if (const entity moved = a->swap_remove(row); moved) {
+      locations_[moved.index()].row = row;
+    }
+  }
+
+  /**< @brief エンティティeの場所を記録する */
+  void place(entity e, archetype *a, std::size_t row) {
+    if (e.index() >= locations_.size()) {
+      locations_.resize(
+          std::max<std::size_t>(e.index() + 1, 2 * locations_.size()));
+    }
+    locations_[e.index()] = location{a, row};
+  }
+
+private:
+  memory_resource *mr_;  /**< メモリ資源 */
+  entity_pool entities_; /**< エンティティ */
+  std::vector<location, boost::container::pmr::polymorphic_allocator<location>>
+      locations_;                                                 /**< エンティティの番号ごとの場所 */
+  std::vector<std::unique_ptr<archetype>> tables_;                /**< 表 */
+  container::flat_hash_map<component_mask, archetype *> by_mask_; /**< 集合から表 */
+};
+
+} // namespace ecs
+
+#endif // end of ECS_ARCHETYPE_HPP
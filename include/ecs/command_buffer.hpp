@@ -0,0 +1,92 @@
+/**
+ * @brief  構造の変更を遅延させるコマンドバッファ
+ * @note   巡回中にエンティティの作成・破棄や構成要素の追加・削除を行うと、表や密な配列の並びが変わって
+ *         巡回が壊れる. 巡回中はこれらをコマンドとして記録しておき、巡回の後でflushしてまとめて適用する
+ * @note   記録は複数のスレッドから同時に行ってよい(par_for_eachの中から使える)
+ *         適用は記録した順に行い、その間に破棄されたエンティティへのコマンドは読み飛ばす
+ */
+
+#ifndef ECS_COMMAND_BUFFER_HPP
+#define ECS_COMMAND_BUFFER_HPP
+
+#include "ecs/entity.hpp"
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+/**
+ * @brief  コマンドバッファ
+ * @tparam World 適用先(registryかworld)の型
+ * @note   記録する構成要素の値はコピー可能でなければならない
+ */
+template <class World> class command_buffer {
+public:
+  /**< @brief 構成要素cs...を持つエンティティの作成を記録する */
+  template <class... Ts> void create(Ts &&... cs) {
+    record([... cs = std::forward<Ts>(cs)](World &w) mutable {
+      w.create(std::move(cs)...);
+    });
+  }
+
+  /**< @brief エンティティeの破棄を記録する */
+  void destroy(entity e) {
+    record([e](World &w) {
+      if (w.alive(e)) {
+        w.destroy(e);
+      }
+    });
+  }
+
+  /**< @brief エンティティeへの構成要素cの追加を記録する */
+  template <class T> void add(entity e, T &&c) {
+    record([e, c = std::forward<T>(c)](World &w) mutable {
+      if (w.alive(e)) {
+        w.template add<std::decay_t<T>>(e, std::move(c));
+      }
+    });
+  }
+
+  /**< @brief エンティティeからの構成要素Tの削除を記録する */
+  template <class T> void remove(entity e) {
+    record([e](World &w) {
+      if (w.alive(e)) {
+        w.template remove<T>(e);
+      }
+    });
+  }
+
+  /**< @brief 記録したコマンドの数を返す */
+  std::size_t size() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return commands_.size();
+  }
+
+  /**< @brief 記録したコマンドを順に適用し、バッファを空にする */
+  void flush(World &w) {
+    std::vector<std::function<void(World &)>> commands;
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      commands.swap(commands_);
+    }
+    for (auto &c : commands) {
+      c(w);
+    }
+  }
+
+private:
+  template <class F> void record(F &&f) {
+    std::lock_guard<std::mutex> lock(m_);
+    commands_.emplace_back(std::forward<F>(f));
+  }
+
+  mutable std::mutex m_;                               /**< 記録の排他 */
+  std::vector<std::function<void(World &)>> commands_; /**< 記録したコマンド */
+};
+
+} // namespace ecs
+
+#endif // end of ECS_COMMAND_BUFFER_HPP
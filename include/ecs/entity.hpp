@@ -0,0 +1,105 @@
+/**
+ * @brief  ECSのエンティティと構成要素の型番号
+ * @note   エンティティは番号と世代を組にした64ビットのハンドル(container::slot_handle)で表す
+ *         破棄したエンティティの番号は世代を進めて再利用するので、古いハンドルは世代の比較で検出できる
+ */
+
+#ifndef ECS_ENTITY_HPP
+#define ECS_ENTITY_HPP
+
+#include "container/slot_map.hpp"
+#include <atomic>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace ecs {
+
+/**< @brief エンティティ */
+using entity = container::slot_handle;
+
+/**< @brief 構成要素の型の数の上限(アーキタイプは型の集合を64ビットのマスクで表す) */
+constexpr std::size_t max_components = 64;
+
+namespace impl {
+
+/**< @brief 次に割り当てる構成要素の型番号 */
+inline std::atomic<std::size_t> next_component_id = 0;
+
+} // namespace impl
+
+/**
+ * @brief 構成要素の型Tの番号を返す(初めて呼ばれた順に0, 1, 2, ...)
+ * @throw std::length_error 型の数が上限(max_components)を超えたとき
+ */
+template <class T> std::size_t component_id() {
+  static const std::size_t id = impl::next_component_id++;
+  if (id >= max_components) {
+    throw std::length_error("Too many component types.");
+  }
+  return id;
+}
+
+/**
+ * @brief エンティティの番号と世代を管理する
+ * @note  空き番号はスタックに積み、後に破棄した番号から再利用する
+ */
+class entity_pool {
+  using memory_resource = boost::container::pmr::memory_resource;
+  template <class T>
+  using pmr_vector =
+      std::vector<T, boost::container::pmr::polymorphic_allocator<T>>;
+  static constexpr std::uint32_t max_gen =
+      std::numeric_limits<std::uint32_t>::max();
+
+public:
+  explicit entity_pool(memory_resource *mr =
+                           boost::container::pmr::get_default_resource())
+      : gens_(mr), free_(mr) {}
+
+  /**< @brief エンティティを作る */
+  entity create() {
+    if (!free_.empty()) {
+      const std::uint32_t i = free_.back();
+      free_.pop_back();
+      alive_++;
+      return entity(i, gens_[i]);
+    }
+    BOOST_ASSERT_MSG(gens_.size() < max_gen, "Too many entities.");
+    gens_.push_back(1);
+    alive_++;
+    return entity(static_cast<std::uint32_t>(gens_.size() - 1), 1);
+  }
+
+  /**< @brief エンティティeを破棄する. 世代が上限に達した番号は再利用しない */
+  void destroy(entity e) {
+    BOOST_ASSERT_MSG(alive(e), "Stale entity.");
+    if (++gens_[e.index()] != max_gen) {
+      free_.push_back(e.index());
+    }
+    alive_--;
+  }
+
+  /**< @brief エンティティeが生存しているかどうか返す */
+  bool alive(entity e) const noexcept {
+    return e.index() < gens_.size() && gens_[e.index()] == e.generation();
+  }
+
+  /**< @brief 生存しているエンティティの数を返す */
+  std::size_t size() const noexcept { return alive_; }
+
+  /**< @brief これまでに使った番号の上限を返す */
+  std::size_t extent() const noexcept { return gens_.size(); }
+
+private:
+  pmr_vector<std::uint32_t> gens_; /**< 番号ごとの現在の世代 */
+  pmr_vector<std::uint32_t> free_; /**< 空き番号 */
+  std::size_t alive_ = 0;          /**< 生存しているエンティティの数 */
+};
+
+} // namespace ecs
+
+#endif // end of ECS_ENTITY_HPP
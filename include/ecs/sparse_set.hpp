@@ -0,0 +1,235 @@
+/**
+ * @brief  疎集合による構成要素の格納
+ * @note   構成要素の型ごとに、エンティティの番号から密な配列での位置を引く疎な配列と、
+ *         エンティティと構成要素を詰めて並べた密な配列を持つ(sparse set)
+ *         追加・削除・参照はいずれもΟ(1)で、削除は密な配列の末尾の要素を空いた位置へ移す
+ * @note   複数の構成要素を持つエンティティを巡るビューは、最も要素の少ないプールの密な配列を巡り、
+ *         他のプールにも含まれるエンティティだけを関数に渡す
+ *         構成要素の追加や削除がアーキタイプ間の移動を伴わないので、頻繁に付け外しする構成要素に向く
+ */
+
+#ifndef ECS_SPARSE_SET_HPP
+#define ECS_SPARSE_SET_HPP
+
+#include "ecs/entity.hpp"
+#include <algorithm>
+#include <array>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace ecs {
+
+/**< @brief 構成要素のプールの基底(エンティティの破棄時に型を知らずに削除するため) */
+class pool_base : private boost::noncopyable {
+public:
+  virtual ~pool_base() = default;
+  /**< @brief エンティティeが構成要素を持っていれば削除する */
+  virtual void remove(entity e) = 0;
+  /**< @brief エンティティeが構成要素を持つかどうか返す */
+  virtual bool contains(entity e) const noexcept = 0;
+  /**< @brief 構成要素の数を返す */
+  virtual std::size_t size() const noexcept = 0;
+};
+
+/**
+ * @brief  構成要素Tの疎集合
+ * @tparam T 構成要素の型
+ */
+template <class T> class component_pool : public pool_base {
+  template <class U>
+  using pmr_vector =
+      std::vector<U, boost::container::pmr::polymorphic_allocator<U>>;
+  static constexpr std::uint32_t nil =
+      std::numeric_limits<std::uint32_t>::max();
+
+public:
+  explicit component_pool(boost::container::pmr::memory_resource *mr =
+                              boost::container::pmr::get_default_resource())
+      : sparse_(mr), dense_(mr), values_(mr) {}
+
+  /**
+   * @brief  エンティティeに構成要素を追加する. 既に持っていれば置き換える
+   * @return 構成要素への参照
+   */
+  template <class... Args> T &add(entity e, Args &&... args) {
+    if (T *p = get(e); p != nullptr) {
+      *p = T(std::forward<Args>(args)...);
+      return *p;
+    }
+    if (e.index() >= sparse_.size()) {
+      sparse_.resize(std::max<std::size_t>(e.index() + 1, 2 * sparse_.size()),
+                     nil);
+    }
+    values_.emplace_back(std::forward<Args>(args)...);
+    sparse_[e.index()] = static_cast<std::uint32_t>(dense_.size());
+    dense_.push_back(e);
+    return values_.back();
+  }
+
+  void remove(entity e) override {
+    if (!contains(e)) {
+      return;
+    }
+    const std::uint32_t pos = sparse_[e.index()];
+    const std::uint32_t last = static_cast<std::uint32_t>(dense_.size() - 1);
+    if (pos != last) { // 末尾の要素を空いた位置へ移す
+      values_[pos] = std::move(values_[last]);
+      dense_[pos] = dense_[last];
+      sparse_[dense_[pos].index()] = pos;
+    }
+    values_.pop_back();
+    dense_.pop_back();
+    sparse_[e.index()] = nil;
+  }
+
+  bool contains(entity e) const noexcept override {
+    if (e.index() >= sparse_.size()) {
+      return false;
+    }
+    const std::uint32_t pos = sparse_[e.index()];
+    return pos != nil && dense_[pos] == e; // 世代も比べる
+  }
+
+  std::size_t size() const noexcept override { return dense_.size(); }
+
+  /**< @brief エンティティeの構成要素へのポインタを返す(持っていなければNIL) */
+  T *get(entity e) noexcept {
+    return contains(e) ? &values_[sparse_[e.index()]] : nullptr;
+  }
+  const T *get(entity e) const noexcept {
+    return contains(e) ? &values_[sparse_[e.index()]] : nullptr;
+  }
+
+  /**< @brief 構成要素を持つことが分かっているエンティティeの構成要素を返す */
+  T &at(entity e) noexcept { return values_[sparse_[e.index()]]; }
+
+  /**< @brief 密な配列のエンティティを返す */
+  const entity *entities() const noexcept { return dense_.data(); }
+  /**< @brief 密な配列の構成要素を返す */
+  T *values() noexcept { return values_.data(); }
+
+private:
+  pmr_vector<std::uint32_t> sparse_; /**< エンティティの番号から密な配列での位置 */
+  pmr_vector<entity> dense_;         /**< 密な配列のエンティティ */
+  pmr_vector<T> values_;             /**< 密な配列の構成要素 */
+};
+
+/**
+ * @brief 疎集合で構成要素を格納するエンティティの登録簿
+ */
+class registry : private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+public:
+  explicit registry(memory_resource *mr =
+                        boost::container::pmr::get_default_resource())
+      : mr_(mr), entities_(mr) {}
+
+  /**< @brief 構成要素を持たないエンティティを作る */
+  entity create() { return entities_.create(); }
+
+  /**< @brief 構成要素cs...を持つエンティティを作る */
+  template <class... Ts> entity create(Ts &&... cs) {
+    (pool<std::decay_t<Ts>>(), ...); // 型番号の割り当てに失敗しても番号を使わないよう先に作る
+    const entity e = entities_.create();
+    (pool<std::decay_t<Ts>>().add(e, std::forward<Ts>(cs)), ...);
+    return e;
+  }
+
+  /**< @brief エンティティeを全ての構成要素と共に破棄する */
+  void destroy(entity e) {
+    for (auto &p : pools_) {
+      if (p != nullptr) {
+        p->remove(e);
+      }
+    }
+    entities_.destroy(e);
+  }
+
+  /**< @brief エンティティeが生存しているかどうか返す */
+  bool alive(entity e) const noexcept { return entities_.alive(e); }
+
+  /**< @brief 生存しているエンティティの数を返す */
+  std::size_t size() const noexcept { return entities_.size(); }
+
+  /**< @brief エンティティeに構成要素Tを追加する. 既に持っていれば置き換える */
+  template <class T, class... Args> T &add(entity e, Args &&... args) {
+    BOOST_ASSERT_MSG(alive(e), "Stale entity.");
+    return pool<T>().add(e, std::forward<Args>(args)...);
+  }
+
+  /**< @brief エンティティeから構成要素Tを削除する */
+  template <class T> void remove(entity e) { pool<T>().remove(e); }
+
+  /**< @brief エンティティeの構成要素Tへのポインタを返す(持っていなければNIL) */
+  template <class T> T *get(entity e) {
+    const auto &p = pools_[component_id<T>()];
+    return p == nullptr ? nullptr : static_cast<component_pool<T> &>(*p).get(e);
+  }
+
+  /**< @brief エンティティeが構成要素Tを持つかどうか返す */
+  template <class T> bool has(entity e) const {
+    const auto &p = pools_[component_id<T>()];
+    return p != nullptr && p->contains(e);
+  }
+
+  /**< @brief 構成要素Tのプールを返す(無ければ作る) */
+  template <class T> component_pool<T> &pool() {
+    auto &p = pools_[component_id<T>()];
+    if (p == nullptr) {
+      p = std::make_unique<component_pool<T>>(mr_);
+    }
+    return static_cast<component_pool<T> &>(*p);
+  }
+
+  /**
+   * @brief  構成要素Ts...を全て持つエンティティを巡回する
+   * @note   最も要素の少ないプールの密な配列を巡るので、計算量はそのプールの大きさに比例する
+   *         巡回中にエンティティや構成要素を追加・削除してはならない(command_bufferに記録しておく)
+   * @tparam class F entity, Ts&...を引数に取る関数オブジェクトの型
+   */
+  template <class... Ts, class F> void for_each(F fn) {
+    static_assert(sizeof...(Ts) > 0);
+    std::tuple<component_pool<Ts> &...> ps(pool<Ts>()...);
+    const pool_base *lead = nullptr;
+    std::apply(
+        [&](auto &... p) {
+          ((lead = lead == nullptr || p.size() < lead->size() ? &p : lead),
+           ...);
+        },
+        ps);
+    const entity *es = nullptr;
+    std::size_t n = 0;
+    std::apply( // 最も小さいプールの密な配列を取り出す
+        [&](auto &... p) {
+          (((&p == lead) ? (es = p.entities(), n = p.size(), 0) : 0), ...);
+        },
+        ps);
+    for (std::size_t i = 0; i < n; i++) {
+      const entity e = es[i];
+      std::apply(
+          [&](auto &... p) {
+            if ((p.contains(e) && ...)) {
+              fn(e, p.at(e)...);
+            }
+          },
+          ps);
+    }
+  }
+
+private:
+  memory_resource *mr_;                                          /**< メモリ資源 */
+  entity_pool entities_;                                         /**< エンティティ */
+  std::array<std::unique_ptr<pool_base>, max_components> pools_; /**< 型番号ごとのプール */
+};
+
+} // namespace ecs
+
+#endif // end of ECS_SPARSE_SET_HPP
@@ -0,0 +1,60 @@
+/**
+ * @brief  jemallocから記憶領域を確保するメモリ資源
+ * @note   frame_arenaやpool_resourceの上流に置くと、チャンクやブロックの確保がjemallocのスレッドキャッシュに乗る
+ *         整列の指定はMALLOCX_ALIGNで渡し、解放はサイズ付きのsdallocxで行う
+ * @note   jemallocは一つしかないので、このメモリ資源どうしは互いに交換可能である(どれで確保してもどれで解放してもよい)
+ */
+
+#ifndef JE_RESOURCE_HPP
+#define JE_RESOURCE_HPP
+
+#include "memory/memory_resource.hpp"
+#include <boost/noncopyable.hpp>
+#include <jemalloc/jemalloc.h>
+#include <new>
+
+namespace je {
+
+/**< @brief jemallocのメモリ資源 */
+class memory_resource : public boost::container::pmr::memory_resource,
+                        private boost::noncopyable {
+public:
+  /**< @brief 統計を返す */
+  memory::resource_stats stats() const noexcept { return stats_.load(); }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void *p = jemallocx(bytes == 0 ? 1 : bytes, MALLOCX_ALIGN(alignment));
+    if (p == nullptr) {
+      throw std::bad_alloc();
+    }
+    stats_.on_allocate(bytes);
+    stats_.upstream_bytes += bytes;
+    return p;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    stats_.on_deallocate(bytes);
+    stats_.upstream_bytes -= bytes;
+    jesdallocx(p, bytes == 0 ? 1 : bytes, MALLOCX_ALIGN(alignment));
+  }
+
+  bool do_is_equal(const boost::container::pmr::memory_resource &other)
+      const noexcept override {
+    return dynamic_cast<const memory_resource *>(&other) != nullptr;
+  }
+
+private:
+  memory::impl::atomic_stats_counter stats_; /**< 統計 */
+};
+
+/**< @brief プロセスで共有するjemallocのメモリ資源を返す */
+inline memory_resource *get_resource() noexcept {
+  static memory_resource r;
+  return &r;
+}
+
+} // namespace je
+
+#endif // end of JE_RESOURCE_HPP
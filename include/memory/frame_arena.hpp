@@ -0,0 +1,214 @@
+/**
+ * @brief  フレーム単位で使い捨てるバンプポインタ方式のアリーナ
+ * @note   確保はブロックの中でポインタを進めるだけで、個別の解放は何もしない
+ *         フレームの終わりにreset()を呼ぶと、ポインタを先頭のブロックへ戻すだけで全ての記憶領域を再利用できる(Ο(1))
+ *         ブロックは上流のメモリ資源から借りて連結リストで持ち続けるので、
+ *         フレームの使用量が落ち着けば上流(グローバルヒープなど)への要求は起きなくなる
+ * @note   double_frame_arenaは2つのアリーナを交互に使い、前のフレームで確保したデータを次のフレームまで残す
+ * @note   スレッドセーフではない. スレッドごとにアリーナを持つこと
+ */
+
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include "memory/memory_resource.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace memory {
+
+/**< @brief フレームアリーナ */
+class frame_arena : public boost::container::pmr::memory_resource,
+                    private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+  /**< @brief ブロックの管理情報(直後に記憶領域が続く) */
+  struct alignas(std::max_align_t) block {
+    block *next;      /**< 次のブロック */
+    std::size_t size; /**< 記憶領域のバイト数 */
+    char *data() noexcept { return reinterpret_cast<char *>(this + 1); }
+  };
+
+public:
+  /**
+   * @param std::size_t block_size    ブロックの記憶領域の既定のバイト数
+   * @param memory_resource* upstream ブロックを借りる上流のメモリ資源
+   */
+  explicit frame_arena(std::size_t block_size = 64 * 1024,
+                       memory_resource *upstream =
+                           boost::container::pmr::get_default_resource())
+      : upstream_(upstream),
+        block_size_(std::max<std::size_t>(block_size, 64)) {}
+  ~frame_arena() noexcept override { release(); }
+
+  /**
+   * @brief 全ての記憶領域を再利用できるようにする. 計算量はΟ(1)
+   * @note  それまでに確保した記憶領域を指すポインタは全て無効になる. ブロックは上流へ返さない
+   */
+  void reset() noexcept {
+    cur_ = head_;
+    ptr_ = head_ == nullptr ? nullptr : head_->data();
+    end_ = head_ == nullptr ? nullptr : ptr_ + head_->size;
+    used_ = 0;
+    stats_.deallocations = stats_.allocations;
+    stats_.bytes_deallocated = stats_.bytes_allocated;
+  }
+
+  /**< @brief 全てのブロックを上流へ返す */
+  void release() noexcept {
+    reset();
+    for (block *b = head_; b != nullptr;) {
+      block *next = b->next;
+      stats_.upstream_bytes -= sizeof(block) + b->size;
+      upstream_->deallocate(b, sizeof(block) + b->size, alignof(block));
+      b = next;
+    }
+    head_ = cur_ = nullptr;
+    ptr_ = end_ = nullptr;
+  }
+
+  /**< @brief 前回のreset()からこのフレームで確保したバイト数を返す(整列の詰め物を含む) */
+  std::size_t used() const noexcept { return used_; }
+  /**< @brief これまでのフレームでの最大の使用バイト数を返す */
+  std::size_t peak() const noexcept { return peak_; }
+  /**< @brief 持っているブロックの数を返す */
+  std::size_t blocks() const noexcept {
+    std::size_t n = 0;
+    for (const block *b = head_; b != nullptr; b = b->next) {
+      n++;
+    }
+    return n;
+  }
+  /**< @brief 統計を返す */
+  resource_stats stats() const noexcept { return stats_.load(); }
+  /**< @brief 上流のメモリ資源を返す */
+  memory_resource *upstream() const noexcept { return upstream_; }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    BOOST_ASSERT_MSG((alignment & (alignment - 1)) == 0,
+                     "Alignment must be a power of two.");
+    char *p = bump(bytes, alignment);
+    if (p == nullptr) {
+      next_block(bytes + alignment);
+      p = bump(bytes, alignment);
+    }
+    stats_.on_allocate(bytes);
+    return p;
+  }
+
+  void do_deallocate(void *, std::size_t bytes, std::size_t) override {
+    stats_.on_deallocate(bytes); // 記憶領域はreset()でまとめて再利用する
+  }
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  /**< @brief 現在のブロックから切り出す(足りなければNIL) */
+  char *bump(std::size_t bytes, std::size_t alignment) noexcept {
+    if (cur_ == nullptr) {
+      return nullptr;
+    }
+    char *p = reinterpret_cast<char *>(
+        impl::align_up(reinterpret_cast<std::uintptr_t>(ptr_), alignment));
+    if (p > end_ || static_cast<std::size_t>(end_ - p) < bytes) {
+      return nullptr;
+    }
+    used_ += static_cast<std::size_t>(p + bytes - ptr_);
+    peak_ = std::max(peak_, used_);
+    ptr_ = p + bytes;
+    return p;
+  }
+
+  /**
+   * @brief 少なくともneedバイトの記憶領域を持つブロックへ進む
+   * @note  前のフレームで使った次のブロックが十分に大きければそれを使い、
+   *        そうでなければ新しいブロックを上流から借りて現在のブロックの次に繋ぐ
+   */
+  void next_block(std::size_t need) {
+    block *next = cur_ == nullptr ? head_ : cur_->next;
+    if (next == nullptr || next->size < need) {
+      const std::size_t size = std::max(block_size_, need);
+      block *b = static_cast<block *>(
+          upstream_->allocate(sizeof(block) + size, alignof(block)));
+      stats_.upstream_bytes += sizeof(block) + size;
+      b->size = size;
+      b->next = next;
+      if (cur_ == nullptr) {
+        head_ = b;
+      } else {
+        cur_->next = b;
+      }
+      next = b;
+    }
+    if (cur_ != nullptr) { // 捨てる末尾も使ったことにする
+      used_ += static_cast<std::size_t>(end_ - ptr_);
+    }
+    cur_ = next;
+    ptr_ = cur_->data();
+    end_ = ptr_ + cur_->size;
+  }
+
+  memory_resource *upstream_; /**< 上流のメモリ資源 */
+  std::size_t block_size_;    /**< ブロックの記憶領域の既定のバイト数 */
+  block *head_ = nullptr;     /**< 先頭のブロック */
+  block *cur_ = nullptr;      /**< 現在のブロック */
+  char *ptr_ = nullptr;       /**< 現在のブロックの未使用の先頭 */
+  char *end_ = nullptr;       /**< 現在のブロックの末尾 */
+  std::size_t used_ = 0;      /**< このフレームの使用バイト数 */
+  std::size_t peak_ = 0;      /**< 最大の使用バイト数 */
+  impl::stats_counter stats_; /**< 統計 */
+};
+
+/**
+ * @brief 2つのフレームアリーナを交互に使うダブルバッファ
+ * @note  flip()で新しいフレームへ進むと、2つ前のフレームのアリーナをreset()して現在のアリーナにする
+ *        フレームNで確保したデータはフレームN+1の終わり(次の次のflip())まで有効である
+ */
+class double_frame_arena : private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+public:
+  explicit double_frame_arena(std::size_t block_size = 64 * 1024,
+                              memory_resource *upstream =
+                                  boost::container::pmr::get_default_resource())
+      : arenas_{frame_arena(block_size, upstream),
+                frame_arena(block_size, upstream)} {}
+
+  /**< @brief 次のフレームへ進む */
+  void flip() noexcept {
+    cur_ ^= 1;
+    arenas_[cur_].reset();
+  }
+
+  /**< @brief 現在のフレームのアリーナを返す */
+  frame_arena &current() noexcept { return arenas_[cur_]; }
+  /**< @brief 前のフレームのアリーナを返す */
+  frame_arena &previous() noexcept { return arenas_[cur_ ^ 1]; }
+
+  /**< @brief 2つのアリーナの統計を合わせて返す */
+  resource_stats stats() const noexcept {
+    resource_stats s = arenas_[0].stats();
+    const resource_stats t = arenas_[1].stats();
+    s.allocations += t.allocations;
+    s.deallocations += t.deallocations;
+    s.bytes_allocated += t.bytes_allocated;
+    s.bytes_deallocated += t.bytes_deallocated;
+    s.upstream_bytes += t.upstream_bytes;
+    return s;
+  }
+
+private:
+  frame_arena arenas_[2]; /**< フレームアリーナ */
+  std::size_t cur_ = 0;   /**< 現在のフレームのアリーナの番号 */
+};
+
+} // namespace memory
+
+#endif // end of FRAME_ARENA_HPP
@@ -0,0 +1,97 @@
+/**
+ * @brief  メモリ資源の共通部品
+ * @note   pmrのコンテナ(stack, queue, skew_heap, avl_treeなど)は既定でpolymorphic_allocatorを使うので、
+ *         メモリ資源を差し替えるだけで確保先を変えられる
+ *         ここではメモリ資源の統計と、既定のメモリ資源を一時的に差し替えるガードを定める
+ */
+
+#ifndef MEMORY_RESOURCE_HPP
+#define MEMORY_RESOURCE_HPP
+
+#include <atomic>
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace memory {
+
+/**< @brief メモリ資源の統計 */
+struct resource_stats {
+  std::size_t allocations = 0;       /**< 確保の回数 */
+  std::size_t deallocations = 0;     /**< 解放の回数 */
+  std::size_t bytes_allocated = 0;   /**< 確保したバイト数の累計 */
+  std::size_t bytes_deallocated = 0; /**< 解放したバイト数の累計 */
+  std::size_t upstream_bytes = 0;    /**< 上流から借りているバイト数 */
+
+  /**< @brief 使用中のバイト数を返す */
+  std::size_t bytes_in_use() const noexcept {
+    return bytes_allocated - bytes_deallocated;
+  }
+  /**< @brief 使用中の確保の数を返す */
+  std::size_t live() const noexcept { return allocations - deallocations; }
+};
+
+namespace impl {
+
+/**
+ * @brief  統計の計数器
+ * @tparam Count 計数の型(単一スレッド用ならstd::size_t、複数スレッド用ならstd::atomic<std::size_t>)
+ */
+template <class Count> struct basic_stats_counter {
+  Count allocations{0};
+  Count deallocations{0};
+  Count bytes_allocated{0};
+  Count bytes_deallocated{0};
+  Count upstream_bytes{0};
+
+  void on_allocate(std::size_t n) noexcept {
+    allocations += 1;
+    bytes_allocated += n;
+  }
+  void on_deallocate(std::size_t n) noexcept {
+    deallocations += 1;
+    bytes_deallocated += n;
+  }
+  resource_stats load() const noexcept {
+    return resource_stats{static_cast<std::size_t>(allocations),
+                          static_cast<std::size_t>(deallocations),
+                          static_cast<std::size_t>(bytes_allocated),
+                          static_cast<std::size_t>(bytes_deallocated),
+                          static_cast<std::size_t>(upstream_bytes)};
+  }
+};
+
+using stats_counter = basic_stats_counter<std::size_t>;
+using atomic_stats_counter = basic_stats_counter<std::atomic<std::size_t>>;
+
+/**< @brief pをaの倍数へ切り上げる(aは2の冪) */
+inline std::uintptr_t align_up(std::uintptr_t p, std::size_t a) noexcept {
+  return (p + a - 1) & ~static_cast<std::uintptr_t>(a - 1);
+}
+
+} // namespace impl
+
+/**
+ * @brief 既定のメモリ資源を寿命の間だけ差し替えるガード
+ * @note  アロケータを受け取らないコンテナ(stack, queueなど)を一時的なメモリ資源で作るときに使う
+ *        既定のメモリ資源はプロセス全体で共有されるので、他のスレッドが同時にコンテナを作る場面では使わない
+ */
+class scoped_default_resource : private boost::noncopyable {
+public:
+  explicit scoped_default_resource(
+      boost::container::pmr::memory_resource *r) noexcept
+      : prev_(boost::container::pmr::set_default_resource(r)) {}
+  ~scoped_default_resource() noexcept {
+    boost::container::pmr::set_default_resource(prev_);
+  }
+
+private:
+  boost::container::pmr::memory_resource *prev_; /**< 差し替える前の既定のメモリ資源 */
+};
+
+} // namespace memory
+
+#endif // end of MEMORY_RESOURCE_HPP
@@ -0,0 +1,271 @@
+/**
+ * @brief  スレッドごとの自由リストを持つサイズクラス方式のプール
+ * @note   要求を8, 16, 32, ..., 4096バイトのサイズクラスへ切り上げ、クラスごとの自由リストから確保する
+ *         自由リストはスレッドローカルに置くので、確保と解放にロックは要らない
+ *         自由リストが空になると、ロックを取って上流からチャンクを借り、そのクラスのブロックに切り分けて補充する
+ * @note   別のスレッドで確保したブロックを解放すると、解放したスレッドの自由リストへ繋がれる
+ *         チャンクはプール全体で持ち、release()かデストラクタでまとめて上流へ返す
+ * @note   スレッドローカルな自由リストは少数の枠をプールの通し番号で共有する. 同じ枠に入る別のプールを
+ *         同じスレッドで使うと、追い出された側の自由リストはそのプールの共有の自由リストへ返され、
+ *         次に自由リストが空になったスレッドがチャンクを借りる前にそこから補充する
+ *         スレッドが終了するときも、残った自由リストを同じように返す
+ * @note   4096バイトを超える要求と、max_align_tより大きな整列の要求は上流へそのまま渡す
+ *         上流の呼び出しはロックの中で行うので、上流はスレッドセーフでなくてもよい
+ */
+
+#ifndef POOL_RESOURCE_HPP
+#define POOL_RESOURCE_HPP
+
+#include "memory/memory_resource.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace memory {
+
+/**< @brief スレッドローカルなサイズクラスのプール */
+class pool_resource : public boost::container::pmr::memory_resource,
+                      private boost::noncopyable {
+  using memory_resource = boost::container::pmr::memory_resource;
+
+  static constexpr std::size_t min_shift = 3; /**< 最小のクラスは8バイト */
+  static constexpr std::size_t classes = 10;  /**< 8〜4096バイト */
+  static constexpr std::size_t ways = 4;      /**< スレッドローカルな枠の数 */
+  static constexpr std::size_t max_align = alignof(std::max_align_t);
+
+  /**< @brief 自由リストのブロック */
+  struct free_block {
+    free_block *next;
+  };
+
+  /**< @brief 自由リスト(空でないときtailは末尾のブロック) */
+  struct block_list {
+    free_block *head = nullptr; /**< 先頭のブロック */
+    free_block *tail = nullptr; /**< 末尾のブロック */
+  };
+
+  /**< @brief スレッドローカルな自由リスト */
+  struct local_cache {
+    std::uint64_t owner = 0;                   /**< 使っているプールの通し番号 */
+    pool_resource *pool = nullptr;             /**< 使っているプール */
+    std::array<block_list, classes> free_list; /**< クラスごとの自由リスト */
+  };
+
+  /**< @brief スレッドローカルな枠の一式(スレッドの終了時に自由リストをプールへ返す) */
+  struct local_caches {
+    std::array<local_cache, ways> slots;
+    ~local_caches() {
+      for (local_cache &c : slots) {
+        flush(c);
+      }
+    }
+  };
+
+  /**< @brief 生きているプールの一覧(追い出した自由リストの返し先を確かめる) */
+  struct registry {
+    std::mutex m;
+    std::vector<pool_resource *> pools;
+  };
+
+public:
+  /**< @brief 扱う最大のブロックのバイト数 */
+  static constexpr std::size_t max_block = std::size_t{1}
+                                           << (min_shift + classes - 1);
+
+  /**
+   * @param std::size_t chunk_size    上流から借りるチャンクのバイト数
+   * @param memory_resource* upstream 上流のメモリ資源
+   */
+  explicit pool_resource(std::size_t chunk_size = 64 * 1024,
+                         memory_resource *upstream =
+                             boost::container::pmr::get_default_resource())
+      : upstream_(upstream),
+        chunk_size_(std::max<std::size_t>(chunk_size, max_block)),
+        id_(next_id()) {
+    registry &r = pools();
+    std::lock_guard<std::mutex> lock(r.m);
+    r.pools.push_back(this);
+  }
+  ~pool_resource() noexcept override {
+    {
+      registry &r = pools();
+      std::lock_guard<std::mutex> lock(r.m);
+      r.pools.erase(std::find(r.pools.begin(), r.pools.end(), this));
+    }
+    release();
+  }
+
+  /**
+   * @brief 全てのチャンクを上流へ返す
+   * @note  確保した記憶領域は全て無効になる. 他のスレッドが使っている間に呼んではならない
+   *        通し番号を改めるので、各スレッドに残った自由リストは次の確保で捨てられる
+   */
+  void release() noexcept {
+    registry &r = pools(); // 追い出した自由リストが古い通し番号のまま返されないように
+    std::lock_guard<std::mutex> rlock(r.m);
+    std::lock_guard<std::mutex> lock(m_);
+    for (void *c : chunks_) {
+      upstream_->deallocate(c, chunk_size_, max_align);
+    }
+    stats_.upstream_bytes -= chunks_.size() * chunk_size_;
+    chunks_.clear();
+    shared_.fill(block_list{});
+    id_.store(next_id(), std::memory_order_relaxed);
+  }
+
+  /**< @brief 借りているチャンクの数を返す */
+  std::size_t chunks() const {
+    std::lock_guard<std::mutex> lock(m_);
+    return chunks_.size();
+  }
+  /**< @brief 統計を返す */
+  resource_stats stats() const noexcept { return stats_.load(); }
+  /**< @brief 上流のメモリ資源を返す */
+  memory_resource *upstream() const noexcept { return upstream_; }
+
+  /**< @brief bytesバイトの要求が属するクラスの番号を返す */
+  static std::size_t class_of(std::size_t bytes) noexcept {
+    if (bytes <= (std::size_t{1} << min_shift)) {
+      return 0;
+    }
+    return static_cast<std::size_t>(std::bit_width(bytes - 1)) - min_shift;
+  }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    stats_.on_allocate(bytes);
+    const std::size_t n = std::max(bytes, alignment);
+    if (n > max_block || alignment > max_align) {
+      stats_.upstream_bytes += bytes;
+      std::lock_guard<std::mutex> lock(m_);
+      return upstream_->allocate(bytes, alignment);
+    }
+    const std::size_t c = class_of(n);
+    block_list &l = local().free_list[c];
+    if (l.head == nullptr) {
+      l = refill(c);
+    }
+    free_block *b = l.head;
+    l.head = b->next;
+    return b;
+  }
+
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    stats_.on_deallocate(bytes);
+    const std::size_t n = std::max(bytes, alignment);
+    if (n > max_block || alignment > max_align) {
+      stats_.upstream_bytes -= bytes;
+      std::lock_guard<std::mutex> lock(m_);
+      upstream_->deallocate(p, bytes, alignment);
+      return;
+    }
+    block_list &l = local().free_list[class_of(n)];
+    l.head = ::new (p) free_block{l.head};
+    if (l.head->next == nullptr) {
+      l.tail = l.head;
+    }
+  }
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+private:
+  /**< @brief プールの通し番号を払い出す(0は未使用の枠を表す) */
+  static std::uint64_t next_id() noexcept {
+    static std::atomic<std::uint64_t> id = 0;
+    return ++id;
+  }
+
+  /**< @brief 生きているプールの一覧を返す */
+  static registry &pools() {
+    static registry r;
+    return r;
+  }
+
+  /**< @brief このスレッドでこのプールが使う自由リストを返す */
+  local_cache &local() noexcept {
+    thread_local local_caches caches;
+    const std::uint64_t id = id_.load(std::memory_order_relaxed);
+    local_cache &c = caches.slots[id % ways];
+    if (c.owner != id) { // 別のプールの自由リストを追い出し、そのプールへ返す
+      flush(c);
+      c.owner = id;
+      c.pool = this;
+    }
+    return c;
+  }
+
+  /**
+   * @brief 枠cの自由リストを持ち主のプールの共有の自由リストへ返し、枠を空にする
+   * @note  持ち主が既に破棄されたか、release()で通し番号を改めたときは返さずに捨てる
+   */
+  static void flush(local_cache &c) noexcept {
+    if (c.pool != nullptr) {
+      registry &r = pools();
+      std::lock_guard<std::mutex> rlock(r.m);
+      if (std::find(r.pools.begin(), r.pools.end(), c.pool) != r.pools.end() &&
+          c.pool->id_.load(std::memory_order_relaxed) == c.owner) {
+        std::lock_guard<std::mutex> lock(c.pool->m_);
+        for (std::size_t i = 0; i < classes; i++) {
+          block_list &from = c.free_list[i];
+          block_list &to = c.pool->shared_[i];
+          if (from.head != nullptr) { // 先頭につなぐ
+            from.tail->next = to.head;
+            to.tail = to.head == nullptr ? from.tail : to.tail;
+            to.head = from.head;
+          }
+        }
+      }
+    }
+    c = local_cache{};
+  }
+
+  /**
+   * @brief クラスcの自由リストを補充して返す
+   * @note  共有の自由リストにブロックがあれば全て引き取り、無ければ上流からチャンクを借りて切り分ける
+   */
+  block_list refill(std::size_t c) {
+    const std::size_t size = std::size_t{1} << (c + min_shift);
+    char *chunk = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      if (shared_[c].head != nullptr) {
+        return std::exchange(shared_[c], block_list{});
+      }
+      chunk = static_cast<char *>(upstream_->allocate(chunk_size_, max_align));
+      chunks_.push_back(chunk);
+    }
+    stats_.upstream_bytes += chunk_size_;
+    block_list l;
+    for (std::size_t off = chunk_size_ / size * size; off > 0;) {
+      off -= size;
+      l.head = ::new (chunk + off) free_block{l.head};
+      if (l.tail == nullptr) {
+        l.tail = l.head;
+      }
+    }
+    return l;
+  }
+
+  memory_resource *upstream_;              /**< 上流のメモリ資源 */
+  std::size_t chunk_size_;                 /**< チャンクのバイト数 */
+  std::atomic<std::uint64_t> id_;          /**< 通し番号 */
+  mutable std::mutex m_;                   /**< チャンクの一覧と共有の自由リストの排他 */
+  std::vector<void *> chunks_;             /**< 借りているチャンク */
+  std::array<block_list, classes> shared_; /**< スレッドから返されたクラスごとの自由リスト */
+  impl::atomic_stats_counter stats_;       /**< 統計 */
+};
+
+} // namespace memory
+
+#endif // end of POOL_RESOURCE_HPP
@@ -0,0 +1,55 @@
+/**
+ * @brief  ソートの実行ポリシー
+ * @note   std::executionに倣い、ソートの第1引数で逐次か並列かを選ぶ
+ *         並列ポリシーはワーカーの数か、使うタスクプールを指定できる
+ *         どちらも指定しなければ既定のプール(ハードウェアのスレッド数)を使う
+ */
+
+#ifndef SORT_EXECUTION_HPP
+#define SORT_EXECUTION_HPP
+
+#include "container/task_pool.hpp"
+#include <cstddef>
+
+namespace sort::execution {
+
+/**< @brief 逐次実行のポリシー */
+struct sequenced_policy {};
+
+/**< @brief 並列実行のポリシー */
+struct parallel_policy {
+  std::size_t threads = 0;              /**< ワーカーの数(0のとき既定) */
+  container::task_pool *pool = nullptr; /**< 使うタスクプール(NILのとき既定) */
+
+  /**< @brief ワーカーの数をnとしたポリシーを返す(ソートのたびにn個のワーカーのプールを作る) */
+  constexpr parallel_policy operator()(std::size_t n) const noexcept {
+    return parallel_policy{n, nullptr};
+  }
+  /**< @brief タスクプールpを使うポリシーを返す */
+  parallel_policy on(container::task_pool &p) const noexcept {
+    return parallel_policy{p.size(), &p};
+  }
+};
+
+inline constexpr sequenced_policy seq{}; /**< 逐次実行 */
+inline constexpr parallel_policy par{};  /**< 並列実行 */
+
+/**
+ * @brief 並列ポリシーpolicyが指すプールでfn(pool)を呼ぶ
+ * @note  プールの指定が無くワーカーの数だけが指定されていれば、その数のプールをその場で作る
+ *        どちらも無ければ既定のプールを使う
+ */
+template <class F> void with_pool(const parallel_policy &policy, F &&fn) {
+  if (policy.pool != nullptr) {
+    fn(*policy.pool);
+  } else if (policy.threads == 0) {
+    fn(container::default_task_pool());
+  } else {
+    container::task_pool pool(policy.threads);
+    fn(pool);
+  }
+}
+
+} // namespace sort::execution
+
+#endif // end of SORT_EXECUTION_HPP
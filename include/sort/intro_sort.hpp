@@ -1,281 +1,841 @@
-/**
- * @brief イントロソートの実装
- * @note  実際はSTLのsortを使えばよいです。
- * @note  なんらかの理由で使えない場合は使ってください。
- * @date  2016/05/09
- */
-
-//********************************************************************************
-// インクルードガード
-//********************************************************************************
-
-#ifndef INTRO_SORT_HPP
-#define INTRO_SORT_HPP
-
-//********************************************************************************
-// 必要なヘッダファイルのインクルード
-//********************************************************************************
-
-#include <algorithm>
-#include <functional>
-#include <iterator>
-#include <utility>
-
-//********************************************************************************
-// クラスの定義
-//********************************************************************************
-
-/**
- * @brief  イントロソートクラス
- * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
- * @tparam Compare              比較述語
- */
-template <class RandomAccessIterator, class Compare> class IntroSort {
-private:
-  using iter_t = RandomAccessIterator;
-  using cmp_t = Compare;
-  using val_t = typename std::iterator_traits<iter_t>::value_type;
-  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
-  using ref_t = typename std::iterator_traits<iter_t>::reference;
-  using pair_t = std::pair<iter_t, iter_t>;
-  using depth_t = std::size_t;
-
-  constexpr IntroSort(cmp_t cmp, dif_t k) : cmp_(cmp), k_(k) {}
-
-  template <class RAI, class Cmp>
-  friend void intro_sort(RAI a0, RAI aN, Cmp cmp);
-
-  static void sort(const iter_t a0, const iter_t aN, cmp_t cmp) {
-    intro_sort__(a0, aN, cmp);           // 最初はイントロソート
-    final_insertion_sort__(a0, aN, cmp); // 最後に挿入ソート
-  }
-
-  cmp_t cmp_; /**< 比較述語 */
-  const dif_t
-      k_; /**< 部分配列の要素数がk以下のとき、挿入ソートに切り替わります */
-
-  /**
-   * @brief  符号なし整数vの先頭から続くゼロの数を数える
-   * @note   IEEE 754形式をサポートしているアーキテクチャにのみ対応
-   * @note   エンディアンはリトル、ビッグどちらにも対応
-   * @param  std::uint32_t v 符号なし整数v
-   * @return vのゼロの数
-   */
-  static constexpr std::int32_t nlz(std::uint32_t v) {
-    union {
-      std::uint64_t asu64;
-      double asf64;
-    } u; // 無名共用体を準備
-    u.asf64 =
-        (double)v + 0.5; // 0は例外表現なので0.5(1.0 * 2^(-1))を加算しておく
-    return 1054 -
-           (u.asu64 >> 52); // 1054(ゲタ(bias)の数+32-1) - vの指数部を返す
-  }
-
-  /**
-   * @brief  3要素x, y, zの中央値(median-of-3)を取得する
-   * @tparam T              要素
-   * @param  const T& x     要素x
-   * @param  const T& y     要素y
-   * @param  const T& z     要素z
-   * @return 3要素x, y, zの中央値(median-of-3)
-   */
-  template <class T>
-  static constexpr T median_of_3(const T &x, const T &y, const T &z,
-                                 cmp_t cmp) {
-    if (cmp(x, y)) {
-      if (cmp(y, z)) {
-        return y;
-      } else {
-        if (cmp(z, x)) {
-          return x;
-        } else {
-          return z;
-        }
-      }
-    } else {
-      if (cmp(z, y)) {
-        return y;
-      } else {
-        if (cmp(x, z)) {
-          return x;
-        } else {
-          return z;
-        }
-      }
-    }
-  }
-
-  /**
-   * @brief 挿入ソートを行います
-   * @param iter_t a0  先頭イテレータ
-   * @param iter_t aN  末尾の次を指すイテレータ
-   */
-  static void final_insertion_sort__(const iter_t a0, const iter_t aN,
-                                     cmp_t cmp) {
-    iter_t j = a0;
-    // for文の各繰り返しが開始されるときには、部分配列A[0..j-1]には
-    // 開始時点でA[0..j-1]に格納されていた要素がソートされた状態で格納されている
-    for (++j; j != aN; ++j) {
-      const val_t key = *j; // 比較用のキーを取り出す
-      iter_t i = j;
-      --i;                              // i = j - 1
-      iter_t k = j;                     // k = i + 1
-      while (k != a0 && cmp(key, *i)) { // A[j]を入れるべき場所が見つかるまで
-        *k = *i;
-        --i;
-        --k;    // A[j-1], A[j-2],...をそれぞれ1つ
-      }         // 右に移し、開いた場所に
-      *k = key; // A[j]の値を挿入(insertion)する
-    }
-    // for文が停止するのはj >= A.length = nを満たすときである.
-    // ループの各繰り返しはjの値を1だけ増加させるから、 停止時にj = nが成立する.
-    // ループ不変式のjにnを代入すると、部分配列A[0..n-1]には、開始時点でA[0..n-1]に
-    // 格納されていた要素全体が格納されているが、これらの要素は既にソートされている.
-    // 部分配列A[0..n-1]が
-    // 全体配列であることに注意すると、配列全体がソート済みであると結論できる
-  }
-
-  /**
-   * @brief  ヒープソートを行います
-   * @note   イントロソートから呼び出されます
-   * @param  iter_t      a    先頭イテレータ
-   * @param  dif_t       n    ソート対象となる配列のサイズ
-   * @param  cmp_t       cmp  比較述語
-   */
-  void heap_sort__(const iter_t a, dif_t n) {
-    // if (n < 2) { return; }  // 要素数が1以下の配列はソートしません.
-    // 既にソート済みです
-
-    /**< @brief ヒープ構築関数 @param p 親の添字　@param heap_size
-     * ヒープのサイズ  */
-    auto heapify = [&](dif_t p, dif_t heap_size) {
-      dif_t c;
-      while ((c = (p << 1) + 1) < heap_size) {
-        if (c + 1 < heap_size && cmp_(a[c], a[c + 1])) {
-          ++c;
-        }
-        if (!(cmp_(a[p], a[c]))) {
-          break;
-        }
-        std::swap(a[p], a[c]);
-        p = c;
-      }
-    };
-
-    // ヒープの構築(節点iをヒープの根に修正していく)
-    for (dif_t i = n / 2; i >= 0; --i) {
-      heapify(i, n);
-    }
-
-    // ソート(swap呼び出しでヒープ条件に違反した可能性があるのでheapifyでヒープ条件を回復する)
-    for (dif_t i = n - 1; i > 0; --i) {
-      std::swap(a[0], a[i]);
-      heapify(0, i);
-    }
-  }
-
-  /**
-   * @brief イントロソートの本体呼び出し
-   * @param iter_t a0 先頭イテレータ
-   * @param iter_t aN 末尾の次を指すイテレータ
-   */
-  static void intro_sort__(const iter_t a0, const iter_t aN, cmp_t cmp) {
-    const dif_t n = std::distance(a0, aN);
-    const depth_t limit = (31 - nlz(n))
-                          << 1; // 再帰の深さの限界はfloor(lg(a.length)) * 2
-    const dif_t k = 16;         // ここは適当
-    IntroSort intro(cmp, k);
-    intro.sort__(a0, aN, limit);
-  }
-
-  /**
-   * @brief イントロソート
-   * @param iter_t  a0     先頭イテレータ
-   * @param iter_t  aN     末尾の次を指すイテレータ
-   * @param depth_t limit  再帰の深さ制限
-   */
-  void sort__(const iter_t a0, const iter_t aN, depth_t limit) {
-    // 要素数がk以下の部分配列上でイントロソートが呼ばれたときには、その配列をソートせず、そのまま返る
-    const dif_t d = std::distance(a0, aN);
-    if (d < k_) {
-      return;
-    }
-
-    // 再帰のレベルが限界に達したとき、ヒープソートに切り替わる
-    if (limit < 1) {
-      heap_sort__(a0, d);
-      return;
-    }
-
-    // 分割: ピボット値を2つの分割のどちらかに置く
-    const dif_t r = d - 1;
-    iter_t aR = std::prev(aN);
-    iter_t aP = partition__(a0, aR, r);
-
-    // 統治: 2つの部分配列をイントロソートを再帰的に呼び出すことでソートする
-    limit = limit - 1;
-    sort__(a0, aP, limit);
-    sort__(++aP, aN, limit);
-  }
-
-  /**
-   * @brief 部分配列Aをその場で再配置する
-   * @param const iter_t first 先頭イテレータ
-   * @param const iter_t last  末尾イテレータ
-   * @param dif_t  d     部分配列A先頭からの末尾までの距離
-   */
-  iter_t partition__(const iter_t first, const iter_t last, dif_t d) {
-    const iter_t &A = first;
-    const val_t pivot =
-        median_of_3(A[0], A[d >> 1], A[d], cmp_); // 3要素中央値を取得
-
-    iter_t i = first, j = last;
-    while (true) { // 以下、反復子iとjは部分配列Aの外側を参照しない
-      while (cmp_(*i, pivot)) {
-        ++i;
-      }
-      while (cmp_(pivot, *j)) {
-        --j;
-      }
-      if (i >= j) {
-        return j;
-      } // i >= jのとき、jを返す
-      std::swap(*i, *j);
-      ++i;
-      --j; // i < j のとき、iとjの値を交換する
-    }
-  }
-};
-
-//********************************************************************************
-// 関数の定義
-//********************************************************************************
-
-/**
- * @brief  イントロソートを行います
- * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
- * @tparam Compare                    比較述語
- * @param  RandomAccessIterator a0    先頭イテレータ
- * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
- * @param  Compare cmp                比較述語
- */
-template <class RandomAccessIterator, class Compare>
-inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN,
-                       Compare cmp) {
-  IntroSort<RandomAccessIterator, Compare>::sort(a0, aN, cmp);
-}
-
-/**
- * @brief  イントロソートを行います(第3引数を省略した場合、こちらが呼ばれます)
- * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
- * @param  RandomAccessIterator a0    先頭イテレータ
- * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
- */
-template <class RandomAccessIterator>
-inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN) {
-  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
-  intro_sort(a0, aN, std::less<val_t>());
-}
-
-#endif // endif INTRO_SORT_HPP
+/**
+ * @brief イントロソートの実装
+ * @note  実際はSTLのsortを使えばよいです。
+ * @note  なんらかの理由で使えない場合は使ってください。
+ * @date  2016/05/09
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef INTRO_SORT_HPP
+#define INTRO_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/execution.hpp"
+#include "sort/sorting_network.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sort::impl {
+template <class RandomAccessIterator, class Compare> class selection;
+} // namespace sort::impl
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  イントロソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare> class IntroSort {
+private:
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using ref_t = typename std::iterator_traits<iter_t>::reference;
+  using pair_t = std::pair<iter_t, iter_t>;
+  using depth_t = std::size_t;
+
+  constexpr IntroSort(cmp_t cmp, dif_t k) : cmp_(cmp), k_(k) {}
+
+  template <class RAI, class Cmp> friend class sort::impl::selection;
+  template <class RAI, class Cmp>
+  friend void intro_sort(RAI a0, RAI aN, Cmp cmp);
+  template <class RAI, class Cmp>
+  friend void intro_sort(const sort::execution::parallel_policy &policy,
+                         RAI a0, RAI aN, Cmp cmp);
+
+  static void sort(const iter_t a0, const iter_t aN, cmp_t cmp) {
+    if (a0 == aN) { // 空の配列はソートしません
+      return;
+    }
+    intro_sort__(a0, aN, cmp); // 最初はイントロソート
+    if constexpr (!use_network) {
+      final_insertion_sort__(a0, aN, cmp); // 最後に挿入ソート
+    }
+  }
+
+  cmp_t cmp_; /**< 比較述語 */
+  const dif_t
+      k_; /**< 部分配列の要素数がk以下のとき、挿入ソートに切り替わります */
+
+  /**
+   * @brief 小さな部分配列をソーティングネットワークで並べるかどうか
+   * @note  32ビットの数値の昇順で、SIMD命令が使えるときだけ. スカラーのネットワークは
+   *        最後の挿入ソートより速くならないので、そのときは従来どおり挿入ソートで仕上げます
+   */
+  static constexpr bool use_network =
+      sort::network::vectorized && sort::network::applicable_v<iter_t, cmp_t>;
+  /**< @brief 部分配列の要素数がこれ以下のとき、ソーティングネットワークで並べます */
+  static constexpr dif_t network_k = sort::network::max_size;
+  /**< @brief 部分配列の要素数がこれより大きいとき、9要素の擬似中央値をピボットにします */
+  static constexpr dif_t ninther_k = 128;
+  /**< @brief 既に分割済みだったとき、挿入ソートで動かしてよい距離の合計 */
+  static constexpr dif_t partial_k = 8;
+  /**< @brief 分岐の無い分割のブロックの要素数 */
+  static constexpr dif_t block_k = 64;
+  /**< @brief 分岐の無い分割を使うかどうか(比較が安く、比較結果の予測が当たりにくい算術型のとき) */
+  static constexpr bool use_block = std::is_arithmetic_v<val_t>;
+
+  /**
+   * @brief  符号なし整数vの先頭から続くゼロの数を数える
+   * @note   IEEE 754形式をサポートしているアーキテクチャにのみ対応
+   * @note   エンディアンはリトル、ビッグどちらにも対応
+   * @param  std::uint32_t v 符号なし整数v
+   * @return vのゼロの数
+   */
+  static constexpr std::int32_t nlz(std::uint32_t v) {
+    union {
+      std::uint64_t asu64;
+      double asf64;
+    } u; // 無名共用体を準備
+    u.asf64 =
+        (double)v + 0.5; // 0は例外表現なので0.5(1.0 * 2^(-1))を加算しておく
+    return 1054 -
+           (u.asu64 >> 52); // 1054(ゲタ(bias)の数+32-1) - vの指数部を返す
+  }
+
+  /**
+   * @brief  3要素x, y, zの中央値(median-of-3)を取得する
+   * @tparam T              要素
+   * @param  const T& x     要素x
+   * @param  const T& y     要素y
+   * @param  const T& z     要素z
+   * @return 3要素x, y, zの中央値(median-of-3)
+   */
+  template <class T>
+  static constexpr T median_of_3(const T &x, const T &y, const T &z,
+                                 cmp_t cmp) {
+    if (cmp(x, y)) {
+      if (cmp(y, z)) {
+        return y;
+      } else {
+        if (cmp(z, x)) {
+          return x;
+        } else {
+          return z;
+        }
+      }
+    } else {
+      if (cmp(z, y)) {
+        return y;
+      } else {
+        if (cmp(x, z)) {
+          return x;
+        } else {
+          return z;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief 挿入ソートを行います
+   * @param iter_t a0  先頭イテレータ
+   * @param iter_t aN  末尾の次を指すイテレータ
+   */
+  static void final_insertion_sort__(const iter_t a0, const iter_t aN,
+                                     cmp_t cmp) {
+    iter_t j = a0;
+    // for文の各繰り返しが開始されるときには、部分配列A[0..j-1]には
+    // 開始時点でA[0..j-1]に格納されていた要素がソートされた状態で格納されている
+    for (++j; j != aN; ++j) {
+      const val_t key = *j; // 比較用のキーを取り出す
+      iter_t i = j;
+      --i;                              // i = j - 1
+      iter_t k = j;                     // k = i + 1
+      while (k != a0 && cmp(key, *i)) { // A[j]を入れるべき場所が見つかるまで
+        *k = *i;
+        --i;
+        --k;    // A[j-1], A[j-2],...をそれぞれ1つ
+      }         // 右に移し、開いた場所に
+      *k = key; // A[j]の値を挿入(insertion)する
+    }
+    // for文が停止するのはj >= A.length = nを満たすときである.
+    // ループの各繰り返しはjの値を1だけ増加させるから、 停止時にj = nが成立する.
+    // ループ不変式のjにnを代入すると、部分配列A[0..n-1]には、開始時点でA[0..n-1]に
+    // 格納されていた要素全体が格納されているが、これらの要素は既にソートされている.
+    // 部分配列A[0..n-1]が
+    // 全体配列であることに注意すると、配列全体がソート済みであると結論できる
+  }
+
+  /**
+   * @brief  ヒープソートを行います
+   * @note   イントロソートから呼び出されます
+   * @param  iter_t      a    先頭イテレータ
+   * @param  dif_t       n    ソート対象となる配列のサイズ
+   * @param  cmp_t       cmp  比較述語
+   */
+  void heap_sort__(const iter_t a, dif_t n) {
+    // if (n < 2) { return; }  // 要素数が1以下の配列はソートしません.
+    // 既にソート済みです
+
+    // ヒープの構築(節点iをヒープの根に修正していく)
+    for (dif_t i = n / 2; i >= 0; --i) {
+      sift_down__(a, i, n);
+    }
+
+    // ソート(swap呼び出しでヒープ条件に違反した可能性があるのでsift_down__でヒープ条件を回復する)
+    for (dif_t i = n - 1; i > 0; --i) {
+      std::swap(a[0], a[i]);
+      sift_down__(a, 0, i);
+    }
+  }
+
+  /**
+   * @brief ヒープ構築関数(節点pを根とする部分木をヒープに修正する)
+   * @param iter_t a         先頭イテレータ
+   * @param dif_t  p         親の添字
+   * @param dif_t  heap_size ヒープのサイズ
+   */
+  void sift_down__(const iter_t a, dif_t p, dif_t heap_size) {
+    dif_t c;
+    while ((c = (p << 1) + 1) < heap_size) {
+      if (c + 1 < heap_size && cmp_(a[c], a[c + 1])) {
+        ++c;
+      }
+      if (!(cmp_(a[p], a[c]))) {
+        break;
+      }
+      std::swap(a[p], a[c]);
+      p = c;
+    }
+  }
+
+  /**
+   * @brief イントロソートの本体呼び出し
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   */
+  static void intro_sort__(const iter_t a0, const iter_t aN, cmp_t cmp) {
+    const dif_t n = std::distance(a0, aN);
+    const depth_t limit = (31 - nlz(n))
+                          << 1; // 再帰の深さの限界はfloor(lg(a.length)) * 2
+    const dif_t k = 16;         // ここは適当
+    IntroSort intro(cmp, k);
+    intro.sort__(a0, aN, limit);
+  }
+
+  /**
+   * @brief イントロソート
+   * @note  ピボットの選び方と分割の結果から入力のパターンを見つけて手を抜く(pattern-defeating quicksort)
+   *        - 左隣の要素(この部分配列の要素以下)とピボット値が等しければ、ピボット値と等しい要素を
+   *          左に集めて取り除く. 同じ値が多い配列は、値の種類の数に比例する回数の分割で済む
+   *        - 分割で1度も交換が起きなければ(既に分割済みならば)、両側を少しだけ挿入ソートしてみて、
+   *          ソート済みと分かればそこで終える. 昇順の配列は線形時間で済む
+   *        - 分割が大きく偏ったときは、両側の何要素かを入れ替えてパターンを崩す
+   * @note  再帰の深さ制限は、偏った分割の回数に対する制限として数える. 制限に達したとき、ヒープソートに切り替わる
+   * @param iter_t  a0       先頭イテレータ
+   * @param iter_t  aN       末尾の次を指すイテレータ
+   * @param depth_t limit    再帰の深さ制限
+   * @param bool    leftmost 配列全体の左端の部分配列かどうか(偽ならばa0[-1]はこの部分配列の要素以下)
+   */
+  void sort__(iter_t a0, const iter_t aN, depth_t limit, bool leftmost = true) {
+    for (;;) {
+      // 要素数がk以下の部分配列上でイントロソートが呼ばれたときには、その配列をソートせず、そのまま返る
+      // ソーティングネットワークが使えるときは、その場で並べてから返る
+      const dif_t d = std::distance(a0, aN);
+      if constexpr (use_network) {
+        if (d <= network_k) {
+          sort::network::sort(std::to_address(a0), static_cast<std::size_t>(d));
+          return;
+        }
+      } else if (d < k_) {
+        return;
+      }
+
+      // 再帰のレベルが限界に達したとき、ヒープソートに切り替わる
+      if (limit < 1) {
+        heap_sort__(a0, d);
+        return;
+      }
+
+      choose_pivot__(a0, aN);
+
+      // 左隣の要素がピボット値と等しければ、ピボット値と等しい要素を左に集めて飛ばす
+      if (!leftmost && !cmp_(a0[-1], *a0)) {
+        a0 = partition_left__(a0, aN) + 1;
+        continue;
+      }
+
+      // 分割: A[0..p-1]はピボット値より小さく、A[p+1..d-1]はピボット値以上
+      const auto [aP, partitioned] = partition__(a0, aN);
+      const dif_t l = std::distance(a0, aP);
+      const dif_t r = std::distance(aP + 1, aN);
+      if (l < d / 8 || r < d / 8) { // 偏った分割
+        if (--limit == 0) {
+          heap_sort__(a0, d);
+          return;
+        }
+        shuffle__(a0, aP);
+        shuffle__(aP + 1, aN);
+      } else if (partitioned && partial_insertion_sort__(a0, aP) &&
+                 partial_insertion_sort__(aP + 1, aN)) {
+        return; // 既にソート済みだった
+      }
+
+      // 統治: 左の部分配列は再帰的に、右の部分配列はこのままループでソートする
+      sort__(a0, aP, limit, leftmost);
+      a0 = aP + 1;
+      leftmost = false;
+    }
+  }
+
+  /**
+   * @brief 3要素中央値(大きな部分配列では9要素の擬似中央値)をピボットとしてA[0]に置く
+   * @note  A[1..d-1]にピボット値以上の要素が残るので、partition__の番兵になる
+   */
+  void choose_pivot__(const iter_t a0, const iter_t aN) {
+    const dif_t d = std::distance(a0, aN);
+    const dif_t h = d >> 1;
+    if (d > ninther_k) {
+      sort3__(a0, a0 + h, aN - 1);
+      sort3__(a0 + 1, a0 + (h - 1), aN - 2);
+      sort3__(a0 + 2, a0 + (h + 1), aN - 3);
+      sort3__(a0 + (h - 1), a0 + h, a0 + (h + 1));
+      std::iter_swap(a0, a0 + h);
+    } else {
+      sort3__(a0 + h, a0, aN - 1);
+    }
+  }
+
+  /**< @brief 3要素A[a], A[b], A[c]をその場でソートする */
+  void sort3__(iter_t a, iter_t b, iter_t c) {
+    if (cmp_(*b, *a)) {
+      std::iter_swap(a, b);
+    }
+    if (cmp_(*c, *b)) {
+      std::iter_swap(b, c);
+      if (cmp_(*b, *a)) {
+        std::iter_swap(a, b);
+      }
+    }
+  }
+
+  /**
+   * @brief 偏った分割の片側[first, last)の何要素かを四分位の位置の要素と入れ替え、次のピボットの選び方を変える
+   */
+  static void shuffle__(const iter_t first, const iter_t last) {
+    const dif_t n = std::distance(first, last);
+    if (n < 16) {
+      return;
+    }
+    const dif_t q = n / 4;
+    std::iter_swap(first, first + q);
+    std::iter_swap(last - 1, last - q);
+    if (n > ninther_k) {
+      std::iter_swap(first + 1, first + (q + 1));
+      std::iter_swap(first + 2, first + (q + 2));
+      std::iter_swap(last - 2, last - (q + 1));
+      std::iter_swap(last - 3, last - (q + 2));
+    }
+  }
+
+  /**
+   * @brief  部分配列[first, last)を挿入ソートする. ただし要素を動かした距離の合計がpartial_kを超えたら諦める
+   * @return ソートし終えたときtrue
+   */
+  bool partial_insertion_sort__(const iter_t first, const iter_t last) {
+    if (first == last) {
+      return true;
+    }
+    dif_t moved = 0;
+    for (iter_t j = first + 1; j != last; ++j) {
+      if (cmp_(*j, *(j - 1))) {
+        val_t key = std::move(*j);
+        iter_t i = j;
+        do {
+          *i = std::move(*(i - 1));
+          --i;
+        } while (i != first && cmp_(key, *(i - 1)));
+        *i = std::move(key);
+        moved += std::distance(i, j);
+      }
+      if (moved > partial_k) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief  A[0]をピボットとして、部分配列[first, last)をピボット値より小さい要素とそれ以外に分ける
+   * @note   ピボットは両者の間の最終的な位置に置く. A[1..d-1]にピボット値以上の要素があること
+   *         算術型の要素はブロック単位の分岐の無い分割(BlockQuicksort)で行う
+   * @note   Reference: S. Edelkamp, A. Weiß,
+   *         BlockQuicksort: How Branch Mispredictions don't affect Quicksort,
+   *         2016
+   *         O. R. L. Peters, Pattern-defeating Quicksort, 2021
+   * @return ピボットの位置と、1度も交換せずに済んだ(既に分割済みだった)かどうか
+   */
+  std::pair<iter_t, bool> partition__(const iter_t a0, const iter_t aN) {
+    val_t pivot = std::move(*a0);
+    iter_t first = a0, last = aN;
+
+    // ピボット値以上の最初の要素と、ピボット値より小さい最後の要素を探す
+    while (cmp_(*++first, pivot)) {
+    }
+    if (first - 1 == a0) {
+      while (first < last && !cmp_(*--last, pivot)) {
+      }
+    } else { // A[1..first-1]にピボット値より小さい要素があるので番兵になる
+      while (!cmp_(*--last, pivot)) {
+      }
+    }
+    const bool partitioned = first >= last;
+    if (!partitioned) {
+      std::iter_swap(first, last);
+      ++first;
+      if constexpr (use_block) {
+        block_partition__(first, last, pivot);
+      } else {
+        for (;;) {
+          while (cmp_(*first, pivot)) {
+            ++first;
+          }
+          while (!cmp_(*--last, pivot)) {
+          }
+          if (first >= last) {
+            break;
+          }
+          std::iter_swap(first, last);
+          ++first;
+        }
+      }
+    }
+
+    // ピボットを最終的な位置に置く
+    const iter_t aP = first - 1;
+    *a0 = std::move(*aP);
+    *aP = std::move(pivot);
+    return {aP, partitioned};
+  }
+
+  /**
+   * @brief 分割の残りの区間[first, last)を分岐無しで分ける
+   * @note  両端からblock_k要素ずつ比較し、誤った側にある要素の位置を比較結果で進める添字で
+   *        配列に書き出してから、まとめて入れ替える. 終了時にfirstは境界を指す
+   */
+  void block_partition__(iter_t &first, iter_t &last, const val_t &pivot) {
+    alignas(64) unsigned char offsets_l[block_k];
+    alignas(64) unsigned char offsets_r[block_k];
+    iter_t base_l = first, base_r = last;
+    dif_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (first < last) {
+      // 片方のブロックが空いていれば、残りの区間からブロックを取る
+      const dif_t unknown = std::distance(first, last);
+      const dif_t split_l =
+          num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+      const dif_t split_r = num_r == 0 ? unknown - split_l : 0;
+      const dif_t size_l = std::min(split_l, block_k);
+      const dif_t size_r = std::min(split_r, block_k);
+      for (dif_t i = 0; i < size_l; i++) {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !cmp_(*first, pivot);
+        ++first;
+      }
+      for (dif_t i = 0; i < size_r;) {
+        offsets_r[num_r] = static_cast<unsigned char>(++i);
+        num_r += cmp_(*--last, pivot);
+      }
+
+      // 誤った側にある要素を入れ替える
+      const dif_t num = std::min(num_l, num_r);
+      swap_offsets__(base_l, base_r, offsets_l + start_l, offsets_r + start_r,
+                     num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        base_l = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        base_r = last;
+      }
+    }
+
+    // 片方のブロックに残った要素を境界へ寄せる
+    if (num_l != 0) {
+      while (num_l-- != 0) {
+        std::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+      }
+      first = last;
+    }
+    if (num_r != 0) {
+      while (num_r-- != 0) {
+        std::iter_swap(base_r - offsets_r[start_r + num_r], first);
+        ++first;
+      }
+    }
+  }
+
+  /**
+   * @brief 左のブロックの要素base_l[offsets_l[i]]と右のブロックの要素base_r[-offsets_r[i]]を入れ替える
+   * @note  個数が等しいときは交換で、そうでなければ1時変数を使った巡回で入れ替える
+   *        (前者は降順の配列で分割を線形時間に保つために要る)
+   */
+  static void swap_offsets__(const iter_t base_l, const iter_t base_r,
+                             const unsigned char *offsets_l,
+                             const unsigned char *offsets_r, dif_t num,
+                             bool use_swaps) {
+    if (use_swaps) {
+      for (dif_t i = 0; i < num; i++) {
+        std::iter_swap(base_l + offsets_l[i], base_r - offsets_r[i]);
+      }
+    } else if (num > 0) {
+      iter_t l = base_l + offsets_l[0];
+      iter_t r = base_r - offsets_r[0];
+      val_t tmp = std::move(*l);
+      *l = std::move(*r);
+      for (dif_t i = 1; i < num; i++) {
+        l = base_l + offsets_l[i];
+        *r = std::move(*l);
+        r = base_r - offsets_r[i];
+        *l = std::move(*r);
+      }
+      *r = std::move(tmp);
+    }
+  }
+
+  /**
+   * @brief  A[0]をピボットとして、部分配列[first, last)をピボット値以下の要素とそれより大きい要素に分ける
+   * @note   左隣の要素がピボット値と等しいときに使う. このときピボット値以下の要素はピボット値と等しい
+   * @return ピボットの位置(ピボット値と等しい要素の末尾)
+   */
+  iter_t partition_left__(const iter_t a0, const iter_t aN) {
+    val_t pivot = std::move(*a0);
+    iter_t first = a0, last = aN;
+    while (cmp_(pivot, *--last)) {
+    }
+    if (last + 1 == aN) {
+      while (first < last && !cmp_(pivot, *++first)) {
+      }
+    } else {
+      while (!cmp_(pivot, *++first)) {
+      }
+    }
+    while (first < last) {
+      std::iter_swap(first, last);
+      while (cmp_(pivot, *--last)) {
+      }
+      while (!cmp_(pivot, *++first)) {
+      }
+    }
+    *a0 = std::move(*last);
+    *last = std::move(pivot);
+    return last;
+  }
+
+  //******************************************************************************
+  // 並列イントロソート
+  //******************************************************************************
+
+  static constexpr dif_t par_cutoff = 1 << 14; /**< これ以下の部分配列はタスクの中で逐次にソートします */
+  static constexpr dif_t par_partition_min = 1 << 16; /**< これ未満の部分配列は逐次に分割します */
+
+  /**
+   * @brief 並列イントロソートを行います
+   * @note  要素数がpar_cutoffより大きい部分配列を分割し、小さい方をタスクとしてプールに積み、
+   *        大きい方はそのまま分割を続けます. 盗まれなかったタスクは積んだワーカー自身が処理します
+   * @note  上の方の(ワーカー1つ分より大きい)部分配列の分割は、それ自体をワーカーの数だけの
+   *        区間に分けて並列に行います
+   * @param task_pool& pool プール
+   * @param iter_t     a0   先頭イテレータ
+   * @param iter_t     aN   末尾の次を指すイテレータ
+   * @param cmp_t      cmp  比較述語
+   */
+  static void par_sort(container::task_pool &pool, const iter_t a0,
+                       const iter_t aN, cmp_t cmp) {
+    const dif_t n = std::distance(a0, aN);
+    if (pool.size() < 2 || n <= par_cutoff) {
+      sort(a0, aN, cmp);
+      return;
+    }
+    const depth_t limit = (31 - nlz(static_cast<std::uint32_t>(n)))
+                          << 1; // 再帰の深さの限界は逐次の場合と同じ
+    const dif_t wide = std::max<dif_t>(
+        par_partition_min, n / static_cast<dif_t>(pool.size()));
+    pool.run([&] {
+      container::task_group g;
+      par_sort__(pool, g, a0, aN, limit, wide, cmp);
+      pool.wait(g);
+    });
+  }
+
+  /**
+   * @brief 並列イントロソートの本体
+   * @param task_pool&  pool  プール
+   * @param task_group& g     タスクの組
+   * @param iter_t      a0    先頭イテレータ
+   * @param iter_t      aN    末尾の次を指すイテレータ
+   * @param depth_t     limit 再帰の深さ制限
+   * @param dif_t       wide  これ以上の部分配列は並列に分割します
+   * @param cmp_t       cmp   比較述語
+   */
+  static void par_sort__(container::task_pool &pool, container::task_group &g,
+                         iter_t a0, iter_t aN, depth_t limit, dif_t wide,
+                         cmp_t cmp) {
+    for (;;) {
+      const dif_t d = std::distance(a0, aN);
+      if (d <= par_cutoff) { // 葉は逐次のイントロソートと挿入ソートで仕上げる
+        if (d > 1) {
+          IntroSort intro(cmp, 16);
+          intro.sort__(a0, aN, limit);
+          if constexpr (!use_network) {
+            final_insertion_sort__(a0, aN, cmp);
+          }
+        }
+        return;
+      }
+      if (limit < 1) { // 再帰のレベルが限界に達したとき、ヒープソートに切り替わる
+        IntroSort intro(cmp, 16);
+        intro.heap_sort__(a0, d);
+        return;
+      }
+      limit = limit - 1;
+
+      // 9要素の中央値(3要素中央値の3要素中央値)をピボット値とする
+      const dif_t s = d >> 3;
+      const val_t pivot =
+          median_of_3(median_of_3(a0[0], a0[s], a0[2 * s], cmp),
+                      median_of_3(a0[3 * s], a0[4 * s], a0[5 * s], cmp),
+                      median_of_3(a0[6 * s], a0[7 * s], a0[d - 1], cmp), cmp);
+      auto split = [&](auto pred) {
+        return d >= wide ? par_partition__(pool, a0, d, pred)
+                         : std::distance(a0, partition_by__(a0, aN, pred));
+      };
+
+      // 分割: ピボット値より小さい要素を前に集める
+      const dif_t m = split([&](const val_t &x) { return cmp(x, pivot); });
+      if (m == 0) { // ピボット値が最小のとき、それと等しい要素を前に集めて取り除く
+        a0 += split([&](const val_t &x) { return !cmp(pivot, x); });
+        continue;
+      }
+
+      // 統治: 小さい方の部分配列をタスクにし、大きい方は続けて分割する
+      const iter_t aM = a0 + m;
+      const iter_t l = m < d - m ? a0 : aM;
+      const iter_t r = m < d - m ? aM : aN;
+      pool.spawn(g, [&pool, &g, l, r, limit, wide, cmp] {
+        par_sort__(pool, g, l, r, limit, wide, cmp);
+      });
+      if (l == a0) {
+        a0 = aM;
+      } else {
+        aN = aM;
+      }
+    }
+  }
+
+  /**
+   * @brief  部分配列[first, last)を述語predを満たす要素と満たさない要素に分ける
+   * @return 述語を満たさない最初の要素を指すイテレータ
+   */
+  template <class Pred>
+  static iter_t partition_by__(iter_t first, iter_t last, Pred pred) {
+    for (;;) {
+      while (first != last && pred(*first)) {
+        ++first;
+      }
+      do {
+        if (first == last) {
+          return first;
+        }
+        --last;
+      } while (!pred(*last));
+      std::iter_swap(first, last);
+      ++first;
+    }
+  }
+
+  /**
+   * @brief  部分配列A[0..d-1]を述語predを満たす要素と満たさない要素に並列に分ける
+   * @note   ワーカーの数の区間をそれぞれ逐次に分けた後、満たす要素の総数mを境に
+   *         誤った側に残った要素(前半の満たさない要素と後半の満たす要素)を並列に交換する
+   * @return 述語を満たす要素の数m
+   */
+  template <class Pred>
+  static dif_t par_partition__(container::task_pool &pool, const iter_t a0,
+                               dif_t d, Pred pred) {
+    using range = std::pair<dif_t, dif_t>;
+    const dif_t t = static_cast<dif_t>(pool.size());
+    auto bound = [&](dif_t c) { return d / t * c + std::min(d % t, c); };
+    std::vector<dif_t> mid(t);
+    {
+      container::task_group g;
+      for (dif_t c = 1; c < t; c++) {
+        pool.spawn(g, [&, c] {
+          mid[c] = std::distance(
+              a0, partition_by__(a0 + bound(c), a0 + bound(c + 1), pred));
+        });
+      }
+      mid[0] = std::distance(a0, partition_by__(a0, a0 + bound(1), pred));
+      pool.wait(g);
+    }
+    dif_t m = 0;
+    for (dif_t c = 0; c < t; c++) {
+      m += mid[c] - bound(c);
+    }
+
+    // 誤った側に残った区間を集める(両者の要素数は等しい)
+    std::vector<range> ls, rs;
+    dif_t k = 0;
+    for (dif_t c = 0; c < t; c++) {
+      const dif_t l = std::max(bound(c), m), r = std::min(bound(c + 1), m);
+      if (l < mid[c]) {
+        ls.emplace_back(l, mid[c]);
+        k += mid[c] - l;
+      }
+      if (mid[c] < r) {
+        rs.emplace_back(mid[c], r);
+      }
+    }
+
+    // 誤った要素の通し番号[b, e)の分を交換する
+    auto len = [](const range &x) { return x.second - x.first; };
+    auto exchange = [&](dif_t b, dif_t e) {
+      std::size_t i = 0, j = 0;
+      dif_t oi = b, oj = b; // 区間ls[i], rs[j]の中での位置
+      for (; b < e && oi >= len(ls[i]); i++) {
+        oi -= len(ls[i]);
+      }
+      for (; b < e && oj >= len(rs[j]); j++) {
+        oj -= len(rs[j]);
+      }
+      while (b < e) {
+        const dif_t w =
+            std::min({e - b, len(ls[i]) - oi, len(rs[j]) - oj});
+        std::swap_ranges(a0 + ls[i].first + oi, a0 + ls[i].first + oi + w,
+                         a0 + rs[j].first + oj);
+        b += w;
+        oi += w;
+        oj += w;
+        if (oi == len(ls[i])) {
+          i++;
+          oi = 0;
+        }
+        if (oj == len(rs[j])) {
+          j++;
+          oj = 0;
+        }
+      }
+    };
+    if (k < par_cutoff) {
+      exchange(0, k);
+      return m;
+    }
+    container::task_group g;
+    for (dif_t c = 1; c < t; c++) {
+      pool.spawn(g, [&, c] { exchange(k / t * c, k / t * (c + 1)); });
+    }
+    exchange(0, k / t);
+    exchange(k / t * t, k); // 割り切れなかった残り
+    pool.wait(g);
+    return m;
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  イントロソートを行います
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                       Compare cmp) {
+  IntroSort<RandomAccessIterator, Compare>::sort(a0, aN, cmp);
+}
+
+/**
+ * @brief  イントロソートを行います(第3引数を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  intro_sort(a0, aN, std::less<val_t>());
+}
+
+/**
+ * @brief  実行ポリシーを指定してイントロソートを行います(逐次)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void intro_sort(const sort::execution::sequenced_policy &,
+                       RandomAccessIterator a0, RandomAccessIterator aN,
+                       Compare cmp) {
+  intro_sort(a0, aN, cmp);
+}
+
+/**
+ * @brief  実行ポリシーを指定してイントロソートを行います(並列)
+ * @note   比較述語は複数のスレッドから同時に呼ばれます
+ * @note   ポリシーがプールを指定していればそれを、ワーカーの数だけを指定していればその数のプールを
+ *         その場で作って使います. どちらも無ければ既定のプールを使います
+ * @tparam RandomAccessIterator                  (ランダムアクセス)イテレータ
+ * @tparam Compare                               比較述語
+ * @param  const parallel_policy& policy         実行ポリシー
+ * @param  RandomAccessIterator a0               先頭イテレータ
+ * @param  RandomAccessIterator aN               末尾の次を指すイテレータ
+ * @param  Compare cmp                           比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void intro_sort(const sort::execution::parallel_policy &policy,
+                       RandomAccessIterator a0, RandomAccessIterator aN,
+                       Compare cmp) {
+  sort::execution::with_pool(policy, [&](container::task_pool &pool) {
+    IntroSort<RandomAccessIterator, Compare>::par_sort(pool, a0, aN, cmp);
+  });
+}
+
+/**
+ * @brief  実行ポリシーを指定してイントロソートを行います(第4引数を省略した場合、こちらが呼ばれます)
+ * @tparam ExecutionPolicy            実行ポリシー
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  ExecutionPolicy&& policy   実行ポリシー
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class ExecutionPolicy, class RandomAccessIterator,
+          class = std::enable_if_t<
+              std::is_same_v<std::decay_t<ExecutionPolicy>,
+                             sort::execution::sequenced_policy> ||
+              std::is_same_v<std::decay_t<ExecutionPolicy>,
+                             sort::execution::parallel_policy>>>
+inline void intro_sort(ExecutionPolicy &&policy, RandomAccessIterator a0,
+                       RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  intro_sort(policy, a0, aN, std::less<val_t>());
+}
+
+#endif // endif INTRO_SORT_HPP
@@ -0,0 +1,416 @@
+/**
+ * @brief  基数ソート
+ * @note   要素から取り出した鍵(整数か浮動小数点数)を、順序を保つ符号なし整数に変換して
+ *         下位の桁から順に数え上げソートを行う(LSD). 安定なソートである
+ * @note   桁の幅は8, 11, 16ビットから選べる. 既定では要素数が2^16未満(か鍵が8ビット)のとき8ビット、
+ *         2^20未満のとき11ビット(32ビットの鍵で3パス)、それ以上は16ビット(同じく2パス)とする
+ *         ヒストグラムが大きくなっても、要素が多ければパスを減らす方が速い
+ *         全ての桁のヒストグラムは最初の1回の走査でまとめて数え、全ての要素で同じ値を持つ桁のパスは飛ばす
+ * @note   ピンポン用の作業領域とヒストグラムは呼び出し側が渡すメモリ資源から借りる
+ *         作業領域の要素は既定構築するので、要素の型は既定構築可能でなければならない
+ * @note   並列版は最上位の桁で各ワーカーが受け持つ区間を作業領域へ振り分け(MSD)、
+ *         桁ごとのバケットを残りの桁のLSDでタスクとしてソートする
+ *         最上位の桁は、最初に並列に集めた鍵の違うビットのうち最も上のビットから取る. 値の範囲が狭い鍵
+ *         (エンティティのIDや2^21未満の深度など)でも、全ての要素が1つのバケットに入らない
+ */
+
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include "sort/execution.hpp"
+#include <algorithm>
+#include <bit>
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace sort {
+
+/**
+ * @brief  鍵を順序を保つ符号なし整数に変換する
+ * @tparam K 鍵の型(整数、float、double)
+ */
+template <class K, class = void> struct radix_traits;
+
+/**< @brief 符号なし整数はそのまま */
+template <class K>
+struct radix_traits<K, std::enable_if_t<std::is_integral_v<K> &&
+                                        std::is_unsigned_v<K>>> {
+  using unsigned_type = K;
+  static constexpr unsigned_type encode(K k) noexcept { return k; }
+};
+
+/**< @brief 符号付き整数は符号ビットを反転する */
+template <class K>
+struct radix_traits<K, std::enable_if_t<std::is_integral_v<K> &&
+                                        std::is_signed_v<K>>> {
+  using unsigned_type = std::make_unsigned_t<K>;
+  static constexpr unsigned_type encode(K k) noexcept {
+    constexpr int shift = std::numeric_limits<unsigned_type>::digits - 1;
+    return static_cast<unsigned_type>(k) ^ (unsigned_type(1) << shift);
+  }
+};
+
+/**
+ * @brief 浮動小数点数は、負ならば全ビットを、非負ならば符号ビットだけを反転する
+ * @note  -0.0は+0.0の前に、符号ビットの立ったNaNは-∞の前に、それ以外のNaNは+∞の後に並ぶ
+ */
+template <class K>
+struct radix_traits<K, std::enable_if_t<std::is_floating_point_v<K>>> {
+  static_assert(sizeof(K) == 4 || sizeof(K) == 8);
+  using unsigned_type =
+      std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+  static constexpr unsigned_type encode(K k) noexcept {
+    constexpr int shift = std::numeric_limits<unsigned_type>::digits - 1;
+    const unsigned_type u = std::bit_cast<unsigned_type>(k);
+    const unsigned_type mask =
+        (unsigned_type(0) - (u >> shift)) | (unsigned_type(1) << shift);
+    return u ^ mask;
+  }
+};
+
+namespace impl {
+
+using memory_resource = boost::container::pmr::memory_resource;
+
+/**< @brief 鍵のビット数bitsを桁の幅bで整列するのに要るパス数 */
+constexpr unsigned radix_passes(unsigned bits, unsigned b) noexcept {
+  return (bits + b - 1) / b;
+}
+
+/**< @brief これより少ない要素は挿入ソートで並べる */
+constexpr std::size_t radix_small = 64;
+
+/**< @brief これより少ない要素は並列にしない */
+constexpr std::size_t radix_par_min = 1 << 17;
+
+/**
+ * @brief  メモリ資源から借りる配列
+ * @note   要素は既定構築する(トリビアルな型では何もしない)
+ */
+template <class T> class radix_buffer {
+public:
+  radix_buffer(std::size_t n, memory_resource *mr) : n_(n), mr_(mr) {
+    p_ = static_cast<T *>(mr_->allocate(n_ * sizeof(T), alignof(T)));
+    std::uninitialized_default_construct_n(p_, n_);
+  }
+  ~radix_buffer() {
+    std::destroy_n(p_, n_);
+    mr_->deallocate(p_, n_ * sizeof(T), alignof(T));
+  }
+  radix_buffer(const radix_buffer &) = delete;
+  radix_buffer &operator=(const radix_buffer &) = delete;
+
+  T *data() const noexcept { return p_; }
+
+private:
+  std::size_t n_;       /**< 要素数 */
+  memory_resource *mr_; /**< メモリ資源 */
+  T *p_;                /**< 配列 */
+};
+
+/**< @brief a[0..n)を鍵の順に並べる安定な挿入ソート(小さな配列用) */
+template <class It, class Enc>
+void radix_insertion_sort(It a, std::size_t n, Enc enc) {
+  for (std::size_t j = 1; j < n; j++) {
+    auto x = std::move(a[j]);
+    const auto k = enc(x);
+    std::size_t i = j;
+    for (; i > 0 && k < enc(a[i - 1]); i--) {
+      a[i] = std::move(a[i - 1]);
+    }
+    a[i] = std::move(x);
+  }
+}
+
+/**
+ * @brief  a[0..n)を鍵の下位bitsビットで安定に並べる(LSD)
+ * @tparam B        桁の幅
+ * @param  b        aと同じ大きさの作業領域
+ * @param  enc      要素から符号なし整数の鍵を求める関数
+ * @param  counts   radix_passes(bits, B) << B 個のヒストグラムの作業領域
+ * @return 結果がbの側にあるときtrue
+ */
+template <unsigned B, class It, class Jt, class Enc>
+bool radix_lsd(It a, Jt b, std::size_t n, Enc enc, unsigned bits,
+               std::size_t *counts) {
+  constexpr std::size_t radix = std::size_t(1) << B;
+  constexpr std::size_t mask = radix - 1;
+  const unsigned passes = radix_passes(bits, B);
+  std::fill(counts, counts + (std::size_t(passes) << B), 0);
+  for (std::size_t i = 0; i < n; i++) { // 全ての桁のヒストグラムを1回の走査で数える
+    const auto k = enc(a[i]);
+    for (unsigned p = 0; p < passes; p++) {
+      counts[(std::size_t(p) << B) + ((k >> (p * B)) & mask)]++;
+    }
+  }
+
+  bool swapped = false;
+  auto scatter = [&](auto src, auto dst, unsigned shift, std::size_t *c) {
+    for (std::size_t i = 0; i < n; i++) {
+      auto &x = src[i];
+      dst[c[(enc(x) >> shift) & mask]++] = std::move(x);
+    }
+  };
+  for (unsigned p = 0; p < passes; p++) {
+    std::size_t *c = counts + (std::size_t(p) << B);
+    const auto k0 = enc(swapped ? b[0] : a[0]);
+    if (c[(k0 >> (p * B)) & mask] == n) { // 全ての要素で同じ桁は飛ばす
+      continue;
+    }
+    std::size_t sum = 0;
+    for (std::size_t d = 0; d < radix; d++) { // 各値の書き込み開始位置に変える
+      sum += std::exchange(c[d], sum);
+    }
+    if (swapped) {
+      scatter(b, a, p * B, c);
+    } else {
+      scatter(a, b, p * B, c);
+    }
+    swapped = !swapped;
+  }
+  return swapped;
+}
+
+/**< @brief 桁の幅bに応じてradix_lsdを呼び分ける */
+template <class It, class Jt, class Enc>
+bool radix_lsd(unsigned b, It a, Jt buf, std::size_t n, Enc enc, unsigned bits,
+               std::size_t *counts) {
+  switch (b) {
+  case 8:
+    return radix_lsd<8>(a, buf, n, enc, bits, counts);
+  case 11:
+    return radix_lsd<11>(a, buf, n, enc, bits, counts);
+  default:
+    return radix_lsd<16>(a, buf, n, enc, bits, counts);
+  }
+}
+
+/**< @brief 桁の幅を選ぶ(Bitsが0ならば鍵の大きさと要素数から決める) */
+template <unsigned Bits, class U> constexpr unsigned radix_bits(std::size_t n) {
+  static_assert(Bits == 0 || Bits == 8 || Bits == 11 || Bits == 16,
+                "Radix digit must be 8, 11 or 16 bits.");
+  if constexpr (Bits != 0) {
+    return Bits;
+  } else {
+    if (sizeof(U) == 1 || n < (std::size_t(1) << 16)) {
+      return 8;
+    }
+    return n < (std::size_t(1) << 20) ? 11 : 16;
+  }
+}
+
+/**< @brief 逐次の基数ソートの本体 */
+template <unsigned Bits, class RAI, class Enc>
+void radix_sort(RAI first, std::size_t n, Enc enc, memory_resource *mr) {
+  using val_t = typename std::iterator_traits<RAI>::value_type;
+  using U = decltype(enc(*first));
+  if (n < radix_small) {
+    radix_insertion_sort(first, n, enc);
+    return;
+  }
+  constexpr unsigned bits = std::numeric_limits<U>::digits;
+  const unsigned b = radix_bits<Bits, U>(n);
+  radix_buffer<val_t> buf(n, mr);
+  radix_buffer<std::size_t> counts(std::size_t(radix_passes(bits, b)) << b, mr);
+  if (radix_lsd(b, first, buf.data(), n, enc, bits, counts.data())) {
+    std::move(buf.data(), buf.data() + n, first);
+  }
+}
+
+/**< @brief 並列の基数ソートの本体 */
+template <unsigned Bits, class RAI, class Enc>
+void radix_par_sort(container::task_pool &pool, RAI first, std::size_t n,
+                    Enc enc, memory_resource *mr) {
+  using val_t = typename std::iterator_traits<RAI>::value_type;
+  using U = decltype(enc(*first));
+  const std::size_t t = pool.size();
+  if (t < 2 || n < radix_par_min) {
+    radix_sort<Bits>(first, n, enc, mr);
+    return;
+  }
+  // 自動のときは最上位の桁もバケットの桁も11ビットまでとし、ヒストグラムを小さく保つ
+  constexpr unsigned b_max = Bits != 0 ? Bits : 11;
+  auto digit_bits = [&](std::size_t m) {
+    return std::min(radix_bits<Bits, U>(m), b_max);
+  };
+  auto bound = [&](std::size_t w) { return n / t * w + std::min(n % t, w); };
+
+  pool.run([&] {
+    auto for_each_worker = [&](auto fn) {
+      container::task_group g;
+      for (std::size_t w = 1; w < t; w++) {
+        pool.spawn(g, [&fn, w] { fn(w); });
+      }
+      fn(0);
+      pool.wait(g);
+    };
+
+    // 先頭の要素の鍵と異なるビットを集め、全ての要素で同じ上位のビットを飛ばす
+    const U k0 = enc(first[0]);
+    radix_buffer<U> diffs(t, mr);
+    for_each_worker([&](std::size_t w) {
+      U d = 0;
+      for (std::size_t i = bound(w); i < bound(w + 1); i++) {
+        d |= enc(first[i]) ^ k0;
+      }
+      diffs.data()[w] = d;
+    });
+    U diff = 0;
+    for (std::size_t w = 0; w < t; w++) {
+      diff |= diffs.data()[w];
+    }
+    if (diff == 0) { // 全ての鍵が等しい
+      return;
+    }
+    const unsigned bits = static_cast<unsigned>(std::bit_width(diff));
+    const unsigned top = std::min(bits, digit_bits(n)); // 最上位の桁の幅
+    const unsigned rest = bits - top;                   // 残りのビット数
+    const std::size_t radix = std::size_t(1) << top;
+    const std::size_t mask = radix - 1;
+
+    // バケットのLSDに使うヒストグラムはワーカーごとに確保しておく
+    std::size_t stride = 0;
+    for (const unsigned b : {8u, 11u, 16u}) {
+      if (b <= b_max) {
+        stride = std::max(stride, std::size_t(radix_passes(rest, b)) << b);
+      }
+    }
+    radix_buffer<val_t> buf(n, mr);
+    radix_buffer<std::size_t> hist(t * radix, mr); // ワーカーwの桁dの数
+    radix_buffer<std::size_t> bucket(radix + 1, mr);
+    radix_buffer<std::size_t> scratch(rest == 0 ? 1 : t * stride, mr);
+    auto digit = [&](const val_t &x) { return (enc(x) >> rest) & mask; };
+
+    // 各ワーカーの区間で最上位の桁を数える
+    for_each_worker([&](std::size_t w) {
+      std::size_t *h = hist.data() + w * radix;
+      std::fill(h, h + radix, 0);
+      for (std::size_t i = bound(w); i < bound(w + 1); i++) {
+        h[digit(first[i])]++;
+      }
+    });
+
+    // 桁の順、同じ桁の中ではワーカーの順に書き込み開始位置を割り当てる
+    std::size_t sum = 0;
+    for (std::size_t d = 0; d < radix; d++) {
+      bucket.data()[d] = sum;
+      for (std::size_t w = 0; w < t; w++) {
+        sum += std::exchange(hist.data()[w * radix + d], sum);
+      }
+    }
+    bucket.data()[radix] = n;
+
+    // 作業領域へ振り分ける(区間の順を保つので安定)
+    for_each_worker([&](std::size_t w) {
+      std::size_t *h = hist.data() + w * radix;
+      for (std::size_t i = bound(w); i < bound(w + 1); i++) {
+        auto &x = first[i];
+        buf.data()[h[digit(x)]++] = std::move(x);
+      }
+    });
+
+    // バケットごとに残りの桁を並べ、元の配列へ戻す
+    container::task_group g;
+    for (std::size_t d = 0; d < radix; d++) {
+      const std::size_t lo = bucket.data()[d];
+      const std::size_t m = bucket.data()[d + 1] - lo;
+      if (m == 0) {
+        continue;
+      }
+      pool.spawn(g, [&, lo, m] {
+        val_t *src = buf.data() + lo;
+        const RAI dst = first + lo;
+        bool back = true; // 結果が作業領域の側にあるか
+        if (m < radix_small) {
+          radix_insertion_sort(src, m, enc);
+        } else if (rest > 0) {
+          const unsigned b = digit_bits(m);
+          std::size_t *c = scratch.data() +
+                           container::task_pool::worker_index() * stride;
+          back = !radix_lsd(b, src, dst, m, enc, rest, c);
+        }
+        if (back) {
+          std::move(src, src + m, dst);
+        }
+      });
+    }
+    pool.wait(g);
+  });
+}
+
+} // namespace impl
+
+/**
+ * @brief  [first, last)を要素から取り出した鍵の昇順に安定に並べる
+ * @tparam Bits  桁の幅(8, 11, 16. 0のとき自動で選ぶ)
+ * @param  key   要素から鍵(整数か浮動小数点数)を取り出す関数
+ * @param  mr    作業領域を借りるメモリ資源
+ */
+template <unsigned Bits = 0, class RandomAccessIterator, class KeyFn>
+void radix_sort(RandomAccessIterator first, RandomAccessIterator last,
+                KeyFn key,
+                boost::container::pmr::memory_resource *mr =
+                    boost::container::pmr::get_default_resource()) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  using key_t = std::decay_t<std::invoke_result_t<KeyFn &, const val_t &>>;
+  auto enc = [&key](const val_t &x) {
+    return radix_traits<key_t>::encode(key(x));
+  };
+  impl::radix_sort<Bits>(first, static_cast<std::size_t>(last - first), enc,
+                         mr);
+}
+
+/**
+ * @brief  整数か浮動小数点数の[first, last)を昇順に並べる
+ * @tparam Bits 桁の幅(8, 11, 16. 0のとき自動で選ぶ)
+ */
+template <unsigned Bits = 0, class RandomAccessIterator>
+void radix_sort(RandomAccessIterator first, RandomAccessIterator last) {
+  radix_sort<Bits>(first, last, [](const auto &x) { return x; });
+}
+
+/**
+ * @brief  [first, last)を要素から取り出した鍵の昇順に、並列に安定に並べる
+ * @note   最上位の桁で振り分けた後、バケットごとの残りの桁のソートをタスクにする
+ *         keyは複数のスレッドから同時に呼ばれる. mrはソートを呼んだスレッドだけが使う
+ * @tparam Bits   桁の幅(8, 11, 16. 0のとき自動で選ぶ)
+ * @param  policy 並列実行のポリシー
+ * @param  key    要素から鍵(整数か浮動小数点数)を取り出す関数
+ * @param  mr     作業領域を借りるメモリ資源
+ */
+template <unsigned Bits = 0, class RandomAccessIterator, class KeyFn>
+void radix_sort(const execution::parallel_policy &policy,
+                RandomAccessIterator first, RandomAccessIterator last,
+                KeyFn key,
+                boost::container::pmr::memory_resource *mr =
+                    boost::container::pmr::get_default_resource()) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  using key_t = std::decay_t<std::invoke_result_t<KeyFn &, const val_t &>>;
+  auto enc = [&key](const val_t &x) {
+    return radix_traits<key_t>::encode(key(x));
+  };
+  execution::with_pool(policy, [&](container::task_pool &pool) {
+    impl::radix_par_sort<Bits>(pool, first,
+                               static_cast<std::size_t>(last - first), enc, mr);
+  });
+}
+
+/**< @brief 逐次のポリシーを指定したときは逐次の基数ソートを行う */
+template <unsigned Bits = 0, class RandomAccessIterator, class KeyFn>
+void radix_sort(const execution::sequenced_policy &, RandomAccessIterator first,
+                RandomAccessIterator last, KeyFn key,
+                boost::container::pmr::memory_resource *mr =
+                    boost::container::pmr::get_default_resource()) {
+  radix_sort<Bits>(first, last, key, mr);
+}
+
+} // namespace sort
+
+#endif // end of RADIX_SORT_HPP
@@ -0,0 +1,413 @@
+/**
+ * @brief  選択アルゴリズム
+ * @note   nth_elementはイントロソートのピボットの選び方と分割(IntroSort::choose_pivot__,
+ *         partition__)を使い、nが入っている側だけを分割し続ける(introselect). 平均Ο(n)
+ *         偏った分割の回数がイントロソートと同じ制限に達したら、ヒープによる選択に切り替わる
+ *         ので、最悪でもΟ(n log n)である
+ * @note   partial_sortは先頭からm番目の要素を選んでから、前のm - 1要素をイントロソートで並べる
+ *         平均Ο(n + m log m)なので、mが大きいときはヒープによるstd::partial_sort(Ο(n log m))より速い
+ *         mが小さいときは、ほとんどの要素を根との1回の比較で捨てられるヒープを使う
+ * @note   top_kは要素を1つずつ受け取り、比較述語の順で先頭からk個の要素を残す有界ヒープである
+ *         配列全体が手元に無くてもよく、要素を動かさない. 並列版は区間をワーカーの数に分けて
+ *         それぞれのtop_kに集め、最後に1つにまとめる
+ */
+
+#ifndef SORT_SELECTION_HPP
+#define SORT_SELECTION_HPP
+
+#include "sort/execution.hpp"
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace sort {
+
+namespace impl {
+
+/**
+ * @brief  イントロソートの分割を使った選択
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare> class selection {
+  using intro_t = IntroSort<RandomAccessIterator, Compare>;
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using depth_t = typename intro_t::depth_t;
+
+  static constexpr dif_t select_k = 16;   /**< これ以下の部分配列は挿入ソートで並べます */
+  static constexpr dif_t heap_ratio = 64; /**< partial_sortで並べる要素がn / heap_ratio以下のときヒープを使います */
+
+public:
+  /**
+   * @brief A[nth]にソートしたときと同じ要素を置き、その前にそれ以下、後ろにそれ以上の要素を集める
+   */
+  static void nth_element(const iter_t a0, const iter_t nth, const iter_t aN,
+                          cmp_t cmp) {
+    if (nth == aN) {
+      return;
+    }
+    const dif_t n = std::distance(a0, aN);
+    const depth_t limit =
+        (31 - intro_t::nlz(static_cast<std::uint32_t>(n)))
+        << 1; // 偏った分割の回数の限界はイントロソートと同じ
+    intro_t intro(cmp, select_k);
+    select__(intro, a0, nth, aN, limit);
+  }
+
+  /**
+   * @brief 先頭からm番目までの要素をソートしたときと同じ順に[a0, aM)に並べる
+   * @note  mが小さいときは、A[0..m-1]のヒープに残りの要素を通して先頭からm個を残す
+   *        ほとんどの要素が根との1回の比較で捨てられるので、選択で分割するより速い
+   */
+  static void partial_sort(const iter_t a0, const iter_t aM, const iter_t aN,
+                           cmp_t cmp) {
+    if (a0 == aM) {
+      return;
+    }
+    if (std::distance(a0, aM) <= std::distance(a0, aN) / heap_ratio) {
+      intro_t intro(cmp, select_k);
+      heap_top__(intro, a0, aM, aN);
+      intro_t::sort(a0, aM, cmp);
+      return;
+    }
+    nth_element(a0, aM - 1, aN, cmp);
+    intro_t::sort(a0, aM - 1, cmp); // A[m-1]は既に最終的な位置にある
+  }
+
+private:
+  /**
+   * @brief introselectの本体
+   * @param intro_t& intro    分割に使うイントロソート
+   * @param iter_t   a0       先頭イテレータ
+   * @param iter_t   nth      選ぶ位置
+   * @param iter_t   aN       末尾の次を指すイテレータ
+   * @param depth_t  limit    偏った分割の回数の制限
+   */
+  static void select__(intro_t &intro, iter_t a0, const iter_t nth, iter_t aN,
+                       depth_t limit) {
+    bool leftmost = true; // 偽ならばa0[-1]はこの部分配列の要素以下
+    for (;;) {
+      const dif_t d = std::distance(a0, aN);
+      if (d <= select_k) {
+        intro_t::final_insertion_sort__(a0, aN, intro.cmp_);
+        return;
+      }
+      if (limit < 1) {
+        heap_select__(intro, a0, nth, aN);
+        return;
+      }
+
+      intro.choose_pivot__(a0, aN);
+
+      // 左隣の要素がピボット値と等しければ、ピボット値と等しい要素を左に集める
+      if (!leftmost && !intro.cmp_(a0[-1], *a0)) {
+        const iter_t aP = intro.partition_left__(a0, aN);
+        if (nth <= aP) { // A[0..p]は全てピボット値と等しい
+          return;
+        }
+        a0 = aP + 1;
+        continue;
+      }
+
+      const iter_t aP = intro.partition__(a0, aN).first;
+      const dif_t l = std::distance(a0, aP);
+      const dif_t r = std::distance(aP + 1, aN);
+      if (l < d / 8 || r < d / 8) { // 偏った分割
+        if (--limit == 0) {
+          heap_select__(intro, a0, nth, aN);
+          return;
+        }
+        intro_t::shuffle__(a0, aP);
+        intro_t::shuffle__(aP + 1, aN);
+      }
+
+      // nthが入っている側だけを続けて分割する
+      if (nth == aP) {
+        return;
+      }
+      if (nth < aP) {
+        aN = aP;
+      } else {
+        a0 = aP + 1;
+        leftmost = false;
+      }
+    }
+  }
+
+  /**
+   * @brief ヒープによる選択(Ο(n log n))
+   * @note  A[0..nth]に先頭からnth + 1個の要素を集め、その根(先頭からnth番目の要素)をA[nth]に置く
+   */
+  static void heap_select__(intro_t &intro, const iter_t a0, const iter_t nth,
+                            const iter_t aN) {
+    heap_top__(intro, a0, nth + 1, aN);
+    std::iter_swap(a0, nth);
+  }
+
+  /**
+   * @brief 先頭からm個の要素を、最も後ろの要素を根に持つヒープとして[a0, aM)に集める(Ο(n log m))
+   * @note  A[0..m-1]でヒープを作り、残りの要素のうち根より前に来るものと根を入れ替えていく
+   */
+  static void heap_top__(intro_t &intro, const iter_t a0, const iter_t aM,
+                         const iter_t aN) {
+    const dif_t m = std::distance(a0, aM);
+    for (dif_t i = m / 2; i >= 0; --i) {
+      intro.sift_down__(a0, i, m);
+    }
+    for (iter_t j = aM; j != aN; ++j) {
+      if (intro.cmp_(*j, *a0)) {
+        std::iter_swap(a0, j);
+        intro.sift_down__(a0, 0, m);
+      }
+    }
+  }
+};
+
+} // namespace impl
+
+/**
+ * @brief  先頭からnth番目の要素を選ぶ(introselect)
+ * @note   A[nth]にソートしたときと同じ要素が入り、その前にはそれ以下の要素、
+ *         後ろにはそれ以上の要素が(順不同で)並ぶ. 平均Ο(n)、最悪Ο(n log n)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator first 先頭イテレータ
+ * @param  RandomAccessIterator nth   選ぶ位置
+ * @param  RandomAccessIterator last  末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                        RandomAccessIterator last, Compare cmp) {
+  impl::selection<RandomAccessIterator, Compare>::nth_element(first, nth, last,
+                                                              cmp);
+}
+
+/**
+ * @brief  先頭からnth番目の要素を選ぶ(第4引数を省略した場合、こちらが呼ばれます)
+ */
+template <class RandomAccessIterator>
+inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth,
+                        RandomAccessIterator last) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  sort::nth_element(first, nth, last, std::less<val_t>());
+}
+
+/**
+ * @brief  ソートしたときに[first, middle)に入る要素を、順に並べてそこに置く
+ * @note   残りの要素の順は不定. 平均Ο(n + m log m)(m = middle - first)
+ * @tparam RandomAccessIterator         (ランダムアクセス)イテレータ
+ * @tparam Compare                      比較述語
+ * @param  RandomAccessIterator first   先頭イテレータ
+ * @param  RandomAccessIterator middle  並べる範囲の末尾の次を指すイテレータ
+ * @param  RandomAccessIterator last    末尾の次を指すイテレータ
+ * @param  Compare cmp                  比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void partial_sort(RandomAccessIterator first,
+                         RandomAccessIterator middle, RandomAccessIterator last,
+                         Compare cmp) {
+  impl::selection<RandomAccessIterator, Compare>::partial_sort(first, middle,
+                                                               last, cmp);
+}
+
+/**
+ * @brief  ソートしたときに[first, middle)に入る要素を並べる(第4引数を省略した場合、こちらが呼ばれます)
+ */
+template <class RandomAccessIterator>
+inline void partial_sort(RandomAccessIterator first,
+                         RandomAccessIterator middle,
+                         RandomAccessIterator last) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  sort::partial_sort(first, middle, last, std::less<val_t>());
+}
+
+/**
+ * @brief  比較述語の順で先頭からk個の要素を残す有界ヒープ(ストリーミングtop-k)
+ * @note   残した要素のうち最も後ろの要素を根に持つ2分ヒープを保つ. 根より前に来ない要素は
+ *         1回の比較で捨て、そうでなければ根と置き換えてΟ(log k)で直す
+ *         大きい方からk個残すときは、比較述語にstd::greaterを渡す
+ * @note   作業領域は構築時にk要素分だけ確保するので、要素を加えるときは確保しない
+ * @tparam T         要素の型
+ * @tparam Compare   比較述語の型
+ * @tparam Allocator アロケータの型
+ */
+template <class T, class Compare = std::less<T>,
+          class Allocator = boost::container::pmr::polymorphic_allocator<T>>
+class top_k {
+public:
+  explicit top_k(std::size_t k, Compare cmp = Compare(),
+                 const Allocator &a = Allocator())
+      : k_(k), cmp_(cmp), A_(a) {
+    A_.reserve(k);
+  }
+
+  /**< @brief 残す要素の数kを返す */
+  std::size_t capacity() const noexcept { return k_; }
+  /**< @brief 残している要素の数を返す */
+  std::size_t size() const noexcept { return A_.size(); }
+  /**< @brief 残している要素が無いかどうか返す */
+  bool empty() const noexcept { return A_.empty(); }
+
+  /**
+   * @brief 残している要素のうち、比較述語の順で最も後ろの要素を返す
+   * @note  k個残しているとき、これより前に来ない要素は加えても捨てられる
+   */
+  const T &threshold() const noexcept {
+    BOOST_ASSERT_MSG(!empty(), "Top-k is empty.");
+    return A_.front();
+  }
+
+  /**< @brief 要素xを加える. 先頭からk個に入らなければ捨てる */
+  template <class U> void push(U &&x) {
+    if (A_.size() < k_) {
+      A_.emplace_back(std::forward<U>(x));
+      sift_up(A_.size() - 1);
+    } else if (k_ != 0 && cmp_(x, A_.front())) {
+      A_.front() = std::forward<U>(x);
+      sift_down(0, A_.size());
+    }
+  }
+
+  /**< @brief 区間[first, last)の要素を加える */
+  template <class InputIterator>
+  void push(InputIterator first, InputIterator last) {
+    for (; first != last && A_.size() < k_; ++first) {
+      push(*first);
+    }
+    if (k_ == 0) {
+      return;
+    }
+    for (; first != last; ++first) { // k個残した後は根との比較だけで捨てる
+      if (cmp_(*first, A_.front())) {
+        A_.front() = *first;
+        sift_down(0, k_);
+      }
+    }
+  }
+
+  /**
+   * @brief 区間[first, last)の要素を並列に加える
+   * @note  区間をワーカーの数に分け、それぞれをワーカーごとのtop_kに集めてからまとめる
+   *        比較述語は複数のスレッドから同時に呼ばれる. 作業領域はこのスレッドで確保する
+   */
+  template <class RandomAccessIterator>
+  void push(const execution::parallel_policy &policy,
+            RandomAccessIterator first, RandomAccessIterator last) {
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    if (n < par_min) {
+      push(first, last);
+      return;
+    }
+    execution::with_pool(policy, [&](container::task_pool &pool) {
+      const std::size_t t = pool.size();
+      auto bound = [&](std::size_t c) {
+        return first + static_cast<std::ptrdiff_t>(n / t * c +
+                                                   std::min(n % t, c));
+      };
+      std::vector<top_k> local;
+      local.reserve(t);
+      for (std::size_t c = 0; c < t; c++) {
+        local.emplace_back(k_, cmp_, A_.get_allocator());
+      }
+      pool.run([&] {
+        container::task_group g;
+        for (std::size_t c = 1; c < t; c++) {
+          pool.spawn(g, [&, c] { local[c].push(bound(c), bound(c + 1)); });
+        }
+        local[0].push(bound(0), bound(1));
+        pool.wait(g);
+      });
+      for (auto &l : local) {
+        merge(std::move(l));
+      }
+    });
+  }
+
+  /**< @brief 区間[first, last)の要素を加える(逐次) */
+  template <class InputIterator>
+  void push(const execution::sequenced_policy &, InputIterator first,
+            InputIterator last) {
+    push(first, last);
+  }
+
+  /**< @brief otherが残している要素を加え、otherを空にする */
+  void merge(top_k &&other) {
+    for (auto &x : other.A_) {
+      push(std::move(x));
+    }
+    other.A_.clear();
+  }
+
+  /**
+   * @brief 残している要素を比較述語の順に並べて返し、空にする
+   * @note  その場でヒープソートして配列ごと渡す. 続けて使うときは作業領域を確保し直す
+   */
+  std::vector<T, Allocator> take() {
+    for (std::size_t i = A_.size(); i > 1; i--) {
+      std::swap(A_[0], A_[i - 1]);
+      sift_down(0, i - 1);
+    }
+    std::vector<T, Allocator> out(A_.get_allocator());
+    out.swap(A_);
+    A_.reserve(k_);
+    return out;
+  }
+
+  /**< @brief 残している要素を全て捨てる */
+  void clear() noexcept { A_.clear(); }
+
+private:
+  static constexpr std::size_t par_min = 1 << 16; /**< これ未満の区間は逐次に加えます */
+
+  /**< @brief 節点iの要素を根の方へ動かす(穴を動かして最後に1回だけ書き込む) */
+  void sift_up(std::size_t i) {
+    T x = std::move(A_[i]);
+    while (i > 0) {
+      const std::size_t p = (i - 1) / 2;
+      if (!cmp_(A_[p], x)) {
+        break;
+      }
+      A_[i] = std::move(A_[p]);
+      i = p;
+    }
+    A_[i] = std::move(x);
+  }
+
+  /**< @brief 節点iの要素を大きさnのヒープの葉の方へ動かす(穴を動かして最後に1回だけ書き込む) */
+  void sift_down(std::size_t i, std::size_t n) {
+    T x = std::move(A_[i]);
+    for (;;) {
+      std::size_t c = 2 * i + 1;
+      if (c >= n) {
+        break;
+      }
+      if (c + 1 < n && cmp_(A_[c], A_[c + 1])) {
+        ++c;
+      }
+      if (!cmp_(x, A_[c])) {
+        break;
+      }
+      A_[i] = std::move(A_[c]);
+      i = c;
+    }
+    A_[i] = std::move(x);
+  }
+
+  std::size_t k_;               /**< 残す要素の数 */
+  Compare cmp_;                 /**< 比較述語 */
+  std::vector<T, Allocator> A_; /**< 残している要素のヒープ */
+};
+
+} // namespace sort
+
+#endif // end of SORT_SELECTION_HPP
@@ -0,0 +1,328 @@
+/**
+ * @brief  小さな配列のためのバイトニックソーティングネットワーク
+ * @note   8, 16, 32, 64要素のバイトニックソートを、レジスタに載せたまま比較交換で行う
+ *         距離がレーン数以上の比較交換はレジスタどうしのmin/max、レーン数未満はレジスタ内の
+ *         並べ替え(shuffle/permute)とmin/maxとblendで行うので、分岐が無い
+ * @note   AVX2(__AVX2__)が使えるときは8レーン、SSE4.1(__SSE4_1__)が使えるときは4レーンで処理し、
+ *         どちらも無いときは同じネットワークをスカラーのmin/maxで行う(コンパイル時に選ぶ)
+ * @note   対象はstd::int32_t, std::uint32_t, floatの昇順だけ. 要素数nは2の冪に切り上げ、
+ *         余りを型の最大値(floatは+∞)で埋めてから並べる. NaNを含む配列は扱わない
+ * @note   Reference: K. E. Batcher,
+ *         Sorting networks and their applications, 1968
+ *         H. Inoue, K. Taura, SIMD- and cache-friendly algorithm for sorting
+ *         an array of structures, 2015
+ */
+
+#ifndef SORTING_NETWORK_HPP
+#define SORTING_NETWORK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace sort::network {
+
+/**< @brief ネットワークで並べられる最大の要素数 */
+constexpr std::size_t max_size = 64;
+
+/**< @brief SIMD命令でネットワークを処理するかどうか(偽のときはスカラー) */
+#if defined(__AVX2__) || defined(__SSE4_1__)
+constexpr bool vectorized = true;
+#else
+constexpr bool vectorized = false;
+#endif
+
+/**< @brief ネットワークで並べられる要素の型かどうか */
+template <class T>
+inline constexpr bool supported_v = std::is_same_v<T, std::int32_t> ||
+                                    std::is_same_v<T, std::uint32_t> ||
+                                    std::is_same_v<T, float>;
+
+/**
+ * @brief 連続したイテレータItの範囲を比較述語Cmpで並べるのにネットワークが使えるかどうか
+ * @note  Cmpがstd::less<T>かstd::less<>のときだけ使える
+ */
+template <class It, class Cmp>
+inline constexpr bool applicable_v =
+    std::contiguous_iterator<It> &&
+    supported_v<std::iter_value_t<It>> &&
+    (std::is_same_v<Cmp, std::less<std::iter_value_t<It>>> ||
+     std::is_same_v<Cmp, std::less<>>);
+
+namespace impl {
+
+/**
+ * @brief  レーンの操作(スカラー版: 1レーン)
+ * @note   min(a, b)とmax(a, b)は、aとbが等しいとき別々の方を返す(minはa、maxはb)
+ *         -0.0と+0.0のように等しくても異なる値の片方を失わないためで、SIMD版も同じにする
+ *         (_mm_min_psと_mm_max_psは等しいとき共にbを返すので、minの引数を入れ替える)
+ * @tparam T 要素の型
+ */
+template <class T> struct scalar_lanes {
+  using vec = T;
+  static constexpr std::size_t width = 1;
+  static vec load(const T *p) noexcept { return *p; }
+  static void store(T *p, vec v) noexcept { *p = v; }
+  static vec min(vec a, vec b) noexcept { return b < a ? b : a; }
+  static vec max(vec a, vec b) noexcept { return b < a ? a : b; }
+};
+
+#if defined(__AVX2__)
+
+template <class T> struct simd_lanes;
+
+/**< @brief 8レーンの32ビット整数(AVX2) */
+template <class T> struct avx2_int_lanes {
+  using vec = __m256i;
+  static constexpr std::size_t width = 8;
+  static vec load(const T *p) noexcept {
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(T *p, vec v) noexcept {
+    _mm256_store_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  /**< @brief 距離jのレーンを入れ替える */
+  template <std::size_t J> static vec swap(vec v) noexcept {
+    if constexpr (J == 1) {
+      return _mm256_shuffle_epi32(v, 0xB1);
+    } else if constexpr (J == 2) {
+      return _mm256_shuffle_epi32(v, 0x4E);
+    } else {
+      return _mm256_permute2x128_si256(v, v, 0x01);
+    }
+  }
+  /**< @brief ビットの立ったレーンはbから、それ以外はaから取る */
+  template <int Imm> static vec blend(vec a, vec b) noexcept {
+    return _mm256_blend_epi32(a, b, Imm);
+  }
+};
+
+template <> struct simd_lanes<std::int32_t> : avx2_int_lanes<std::int32_t> {
+  static vec min(vec a, vec b) noexcept { return _mm256_min_epi32(a, b); }
+  static vec max(vec a, vec b) noexcept { return _mm256_max_epi32(a, b); }
+};
+
+template <> struct simd_lanes<std::uint32_t> : avx2_int_lanes<std::uint32_t> {
+  static vec min(vec a, vec b) noexcept { return _mm256_min_epu32(a, b); }
+  static vec max(vec a, vec b) noexcept { return _mm256_max_epu32(a, b); }
+};
+
+/**< @brief 8レーンの単精度浮動小数点数(AVX) */
+template <> struct simd_lanes<float> {
+  using vec = __m256;
+  static constexpr std::size_t width = 8;
+  static vec load(const float *p) noexcept { return _mm256_load_ps(p); }
+  static void store(float *p, vec v) noexcept { _mm256_store_ps(p, v); }
+  static vec min(vec a, vec b) noexcept { // 等しいときaを返すよう入れ替える
+    return _mm256_min_ps(b, a);
+  }
+  static vec max(vec a, vec b) noexcept { return _mm256_max_ps(a, b); }
+  template <std::size_t J> static vec swap(vec v) noexcept {
+    if constexpr (J == 1) {
+      return _mm256_permute_ps(v, 0xB1);
+    } else if constexpr (J == 2) {
+      return _mm256_permute_ps(v, 0x4E);
+    } else {
+      return _mm256_permute2f128_ps(v, v, 0x01);
+    }
+  }
+  template <int Imm> static vec blend(vec a, vec b) noexcept {
+    return _mm256_blend_ps(a, b, Imm);
+  }
+};
+
+template <class T> using lanes = simd_lanes<T>;
+
+#elif defined(__SSE4_1__)
+
+template <class T> struct simd_lanes;
+
+/**< @brief 4レーンの32ビット整数(SSE4.1) */
+template <class T> struct sse_int_lanes {
+  using vec = __m128i;
+  static constexpr std::size_t width = 4;
+  static vec load(const T *p) noexcept {
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(T *p, vec v) noexcept {
+    _mm_store_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  template <std::size_t J> static vec swap(vec v) noexcept {
+    return _mm_shuffle_epi32(v, J == 1 ? 0xB1 : 0x4E);
+  }
+  template <int Imm> static vec blend(vec a, vec b) noexcept {
+    return _mm_castps_si128(
+        _mm_blend_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), Imm));
+  }
+};
+
+template <> struct simd_lanes<std::int32_t> : sse_int_lanes<std::int32_t> {
+  static vec min(vec a, vec b) noexcept { return _mm_min_epi32(a, b); }
+  static vec max(vec a, vec b) noexcept { return _mm_max_epi32(a, b); }
+};
+
+template <> struct simd_lanes<std::uint32_t> : sse_int_lanes<std::uint32_t> {
+  static vec min(vec a, vec b) noexcept { return _mm_min_epu32(a, b); }
+  static vec max(vec a, vec b) noexcept { return _mm_max_epu32(a, b); }
+};
+
+/**< @brief 4レーンの単精度浮動小数点数(SSE4.1) */
+template <> struct simd_lanes<float> {
+  using vec = __m128;
+  static constexpr std::size_t width = 4;
+  static vec load(const float *p) noexcept { return _mm_load_ps(p); }
+  static void store(float *p, vec v) noexcept { _mm_store_ps(p, v); }
+  static vec min(vec a, vec b) noexcept { // 等しいときaを返すよう入れ替える
+    return _mm_min_ps(b, a);
+  }
+  static vec max(vec a, vec b) noexcept { return _mm_max_ps(a, b); }
+  template <std::size_t J> static vec swap(vec v) noexcept {
+    return _mm_shuffle_ps(v, v, J == 1 ? 0xB1 : 0x4E);
+  }
+  template <int Imm> static vec blend(vec a, vec b) noexcept {
+    return _mm_blend_ps(a, b, Imm);
+  }
+};
+
+template <class T> using lanes = simd_lanes<T>;
+
+#else
+
+template <class T> using lanes = scalar_lanes<T>;
+
+#endif
+
+/**< @brief レーンlのうち、距離jの相手との比較で大きい方を取るもののビット(昇順のレジスタ) */
+template <std::size_t W, std::size_t K, std::size_t J>
+constexpr int max_lanes() noexcept {
+  int imm = 0;
+  for (std::size_t l = 0; l < W; l++) {
+    const bool upper = (l & J) != 0;         // 組の上側のレーン
+    const bool desc = K < W && (l & K) != 0; // レジスタ内で向きが変わる段
+    if (upper != desc) {
+      imm |= 1 << l;
+    }
+  }
+  return imm;
+}
+
+/**
+ * @brief 大きさKのバイトニック列を距離Jで比較交換する段
+ * @note  要素iの向きは(i & K) == 0のとき昇順
+ */
+template <class L, std::size_t N, std::size_t K, std::size_t J>
+inline void stage(typename L::vec *v) noexcept {
+  constexpr std::size_t w = L::width;
+  constexpr std::size_t regs = N / w;
+  if constexpr (J >= w) { // レジスタどうし
+    constexpr std::size_t jr = J / w;
+    for (std::size_t r = 0; r < regs; r++) {
+      if ((r & jr) != 0) {
+        continue;
+      }
+      const auto lo = L::min(v[r], v[r + jr]);
+      const auto hi = L::max(v[r], v[r + jr]);
+      const bool asc = ((r * w) & K) == 0;
+      v[r] = asc ? lo : hi;
+      v[r + jr] = asc ? hi : lo;
+    }
+  } else { // レジスタ内
+    constexpr int imm = max_lanes<w, K, J>();
+    constexpr int all = (1 << w) - 1;
+    for (std::size_t r = 0; r < regs; r++) {
+      const auto p = L::template swap<J>(v[r]);
+      const auto lo = L::min(v[r], p); // 等しいとき両方のレーンが自分の値を残すよう、
+      const auto hi = L::max(p, v[r]); // maxは引数を逆にする
+      if (K < w || ((r * w) & K) == 0) {
+        v[r] = L::template blend<imm>(lo, hi);
+      } else {
+        v[r] = L::template blend<all ^ imm>(lo, hi);
+      }
+    }
+  }
+}
+
+/**< @brief 大きさKのバイトニック列を併合する(距離J, J/2, ..., 1の段) */
+template <class L, std::size_t N, std::size_t K, std::size_t J>
+inline void merge(typename L::vec *v) noexcept {
+  stage<L, N, K, J>(v);
+  if constexpr (J > 1) {
+    merge<L, N, K, J / 2>(v);
+  }
+}
+
+/**< @brief 大きさ2, 4, ..., Nのバイトニック列を順に作って併合する */
+template <class L, std::size_t N, std::size_t K = 2>
+inline void bitonic(typename L::vec *v) noexcept {
+  merge<L, N, K, K / 2>(v);
+  if constexpr (K < N) {
+    bitonic<L, N, 2 * K>(v);
+  }
+}
+
+/**< @brief レジスタの幅に揃えたN要素のバッファpを並べる */
+template <class T, std::size_t N> inline void sort_n(T *p) noexcept {
+  using L = lanes<T>;
+  typename L::vec v[N / L::width];
+  for (std::size_t r = 0; r < N / L::width; r++) {
+    v[r] = L::load(p + r * L::width);
+  }
+  bitonic<L, N>(v);
+  for (std::size_t r = 0; r < N / L::width; r++) {
+    L::store(p + r * L::width, v[r]);
+  }
+}
+
+/**< @brief 余りを埋める値(並べると必ず末尾に来る) */
+template <class T> constexpr T padding() noexcept {
+  if constexpr (std::numeric_limits<T>::has_infinity) {
+    return std::numeric_limits<T>::infinity();
+  } else {
+    return std::numeric_limits<T>::max();
+  }
+}
+
+} // namespace impl
+
+/**
+ * @brief  p[0..n)を昇順に並べる
+ * @tparam T 要素の型(std::int32_t, std::uint32_t, float)
+ * @param  n 要素数(max_size以下)
+ */
+template <class T> void sort(T *p, std::size_t n) noexcept {
+  static_assert(supported_v<T>);
+  if (n < 2) {
+    return;
+  }
+  alignas(32) T buf[max_size];
+  std::copy(p, p + n, buf);
+  const std::size_t m = n <= 8 ? 8 : n <= 16 ? 16 : n <= 32 ? 32 : 64;
+  std::fill(buf + n, buf + m, impl::padding<T>());
+  switch (m) {
+  case 8:
+    impl::sort_n<T, 8>(buf);
+    break;
+  case 16:
+    impl::sort_n<T, 16>(buf);
+    break;
+  case 32:
+    impl::sort_n<T, 32>(buf);
+    break;
+  default:
+    impl::sort_n<T, 64>(buf);
+    break;
+  }
+  std::copy(buf, buf + n, p);
+}
+
+} // namespace sort::network
+
+#endif // end of SORTING_NETWORK_HPP
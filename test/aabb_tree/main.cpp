@@ -0,0 +1,148 @@
+#include "container/aabb_tree.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+using tree = container::aabb_tree<2>;
+using box = tree::box;
+using vec = container::vec<2>;
+
+box random_box(float world, float size, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> pos(0, world), ext(0.1f, size);
+  box b;
+  for (std::size_t d = 0; d < 2; d++) {
+    b.lo[d] = pos(rng);
+    b.hi[d] = b.lo[d] + ext(rng);
+  }
+  return b;
+}
+
+} // namespace
+
+TEST_CASE("AABB Tree Insert Remove Test 1") {
+  std::mt19937 rng(1);
+  tree t(0.5f);
+  std::vector<box> bs;
+  std::vector<tree::proxy> ps;
+  for (std::uint32_t i = 0; i < 2000; i++) {
+    bs.push_back(random_box(1000, 10, rng));
+    ps.push_back(t.insert(bs.back(), i));
+  }
+  REQUIRE(t.size() == 2000);
+  REQUIRE(t.validate());
+  REQUIRE(t.height() < 40);
+  for (std::uint32_t i = 0; i < 2000; i += 2) {
+    t.remove(ps[i]);
+  }
+  REQUIRE(t.size() == 1000);
+  REQUIRE(t.validate());
+
+  const box q{{100, 100}, {400, 300}};
+  std::vector<std::uint32_t> got, expect;
+  t.query_aabb(q, [&](std::uint32_t id) { got.push_back(id); });
+  for (std::uint32_t i = 1; i < 2000; i += 2) {
+    if (bs[i].overlaps(q)) {
+      expect.push_back(i);
+    }
+  }
+  std::sort(got.begin(), got.end());
+  REQUIRE(got == expect);
+
+  for (std::uint32_t i = 1; i < 2000; i += 2) {
+    t.remove(ps[i]);
+  }
+  REQUIRE(t.size() == 0);
+  REQUIRE(t.validate());
+  REQUIRE(t.height() == 0);
+}
+
+TEST_CASE("AABB Tree Move Test 1") {
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<float> step(-2, 2);
+  tree t(1.0f);
+  std::vector<box> bs;
+  std::vector<tree::proxy> ps;
+  for (std::uint32_t i = 0; i < 1000; i++) {
+    bs.push_back(random_box(300, 5, rng));
+    ps.push_back(t.insert(bs.back(), i));
+  }
+  std::size_t reinserted = 0;
+  for (int frame = 0; frame < 20; frame++) {
+    for (std::uint32_t i = 0; i < bs.size(); i++) {
+      const vec v{step(rng), step(rng)};
+      for (std::size_t d = 0; d < 2; d++) {
+        bs[i].lo[d] += v[d];
+        bs[i].hi[d] += v[d];
+      }
+      reinserted += t.move(ps[i], bs[i], v);
+      REQUIRE(t.tight_box(ps[i]).lo == bs[i].lo);
+    }
+  }
+  REQUIRE(t.validate());
+  REQUIRE(reinserted < 20 * bs.size()); // 広げた箱に収まる移動は木を変えない
+
+  // 全ての重なりの組を総当たりと比べる
+  std::vector<container::overlap_pair> got = t.find_pairs(4), expect;
+  for (std::uint32_t i = 0; i < bs.size(); i++) {
+    for (std::uint32_t j = i + 1; j < bs.size(); j++) {
+      if (bs[i].overlaps(bs[j])) {
+        expect.emplace_back(i, j);
+      }
+    }
+  }
+  std::sort(got.begin(), got.end());
+  REQUIRE(got == expect);
+}
+
+TEST_CASE("AABB Tree Query Test 1") {
+  std::mt19937 rng(3);
+  tree t;
+  std::vector<box> bs;
+  for (std::uint32_t i = 0; i < 3000; i++) {
+    bs.push_back(random_box(500, 8, rng));
+    t.insert(bs.back(), i);
+  }
+  std::vector<box> qs;
+  std::vector<vec> cs, os, ds;
+  std::vector<float> rs;
+  std::uniform_real_distribution<float> u(-1, 1);
+  for (int i = 0; i < 200; i++) {
+    qs.push_back(random_box(500, 50, rng));
+    cs.push_back(vec{float(rng() % 500), float(rng() % 500)});
+    rs.push_back(1.0f + rng() % 30);
+    os.push_back(vec{float(rng() % 500), -5});
+    ds.push_back(vec{u(rng), 1});
+  }
+  ds[0] = vec{0, 1};
+  const auto ra = t.query_aabb(qs, 2);
+  const auto rr = t.query_radius(cs, rs, 2);
+  const auto rh = t.raycast(os, ds, 1000, 2);
+  bool ok = true;
+  for (std::size_t i = 0; i < qs.size(); i++) {
+    std::vector<std::uint32_t> ea, er;
+    std::optional<container::ray_hit> eh;
+    const container::ray<2> r(os[i], ds[i], 1000);
+    for (std::uint32_t j = 0; j < bs.size(); j++) {
+      if (bs[j].overlaps(qs[i])) {
+        ea.push_back(j);
+      }
+      if (bs[j].distance2(cs[i]) <= rs[i] * rs[i]) {
+        er.push_back(j);
+      }
+      const auto h = r.intersect(bs[j]);
+      if (h && (!eh || *h < eh->t)) {
+        eh = container::ray_hit{j, *h};
+      }
+    }
+    ok = ok && ra[i] == ea && rr[i] == er &&
+         rh[i].has_value() == eh.has_value() &&
+         (!eh || (rh[i]->id == eh->id && rh[i]->t == eh->t));
+  }
+  REQUIRE(ok);
+  REQUIRE(t.cost() > 0);
+}
@@ -1,5 +1,11 @@
 #include "container/avl_tree.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
 #include <string>
+#include <vector>
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
@@ -21,3 +27,286 @@ TEST_CASE("AVL trees Insert Find Erase Test 1") {
   REQUIRE(t.erase("green") == std::make_optional(0x00ff00));
   REQUIRE(t.erase("green") == std::nullopt);
 }
+
+TEST_CASE("AVL trees Insert Erase Churn Test 1") {
+  container::avl_tree<int, int> t(4);
+  for (int round = 0; round < 8; round++) {
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(t.insert(i, i * 2) == std::nullopt);
+    }
+    for (int i = 0; i < 100; i += 2) {
+      REQUIRE(t.erase(i) == std::make_optional(i * 2));
+    }
+    for (int i = 1; i < 100; i += 2) {
+      REQUIRE(t.find(i) == std::make_optional(i * 2));
+    }
+    for (int i = 1; i < 100; i += 2) {
+      REQUIRE(t.erase(i) == std::make_optional(i * 2));
+    }
+    REQUIRE(t.empty());
+  }
+  REQUIRE(t.pool().live() == 0);
+  REQUIRE(t.pool().high_water() == 100);
+  REQUIRE(t.pool().free() == t.pool().capacity());
+}
+
+TEST_CASE("AVL trees Random Insert Erase Test 1") {
+  container::avl_tree<int, int> t;
+  std::map<int, int> m;
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 20000; i++) {
+    const int k = static_cast<int>(rng() % 2000);
+    if (rng() % 3 == 0) {
+      auto it = m.find(k);
+      REQUIRE(t.erase(k) == (it == m.end() ? std::nullopt
+                                            : std::make_optional(it->second)));
+      m.erase(k);
+    } else {
+      auto it = m.find(k);
+      REQUIRE(t.insert(k, i) ==
+              (it == m.end() ? std::nullopt : std::make_optional(it->second)));
+      m[k] = i;
+    }
+  }
+  REQUIRE(t.size() == m.size());
+  REQUIRE(t.height() <= 1.4405 * std::log2(t.size() + 2));
+  auto it = m.begin();
+  t.inorder([&](const int &k, const int &v) {
+    REQUIRE(it != m.end());
+    REQUIRE(k == it->first);
+    REQUIRE(v == it->second);
+    ++it;
+  });
+  REQUIRE(it == m.end());
+}
+
+TEST_CASE("AVL trees Iterator Bound Test 1") {
+  container::avl_tree<int, int> t;
+  for (int i = 0; i < 100; i += 2) {
+    t.insert(i, i * 10);
+  }
+  int expected = 0;
+  for (auto [k, v] : t) {
+    REQUIRE(k == expected);
+    REQUIRE(v == expected * 10);
+    expected += 2;
+  }
+  REQUIRE(expected == 100);
+
+  auto it = t.end();
+  for (int i = 98; i >= 0; i -= 2) {
+    --it;
+    REQUIRE(it->first == i);
+  }
+  REQUIRE(it == t.begin());
+
+  REQUIRE(t.lower_bound(10).key() == 10);
+  REQUIRE(t.lower_bound(11).key() == 12);
+  REQUIRE(t.upper_bound(10).key() == 12);
+  REQUIRE(t.lower_bound(-5) == t.begin());
+  REQUIRE(t.lower_bound(99) == t.end());
+  REQUIRE(t.upper_bound(98) == t.end());
+  auto [lo, hi] = t.equal_range(40);
+  REQUIRE(lo.key() == 40);
+  REQUIRE(std::next(lo) == hi);
+  auto [lo2, hi2] = t.equal_range(41);
+  REQUIRE(lo2 == hi2);
+
+  std::vector<int> keys;
+  t.range(15, 30, [&](const int &k, int &v) {
+    keys.push_back(k);
+    v = -k;
+  });
+  REQUIRE(keys == std::vector<int>{16, 18, 20, 22, 24, 26, 28, 30});
+  REQUIRE(t.find(20) == std::make_optional(-20));
+
+  *t.get(50) = 7; // その場で付属データを書き換える
+  REQUIRE(t.find(50) == std::make_optional(7));
+  REQUIRE(t.get(51) == nullptr);
+  t.lower_bound(52)->second = 8;
+  REQUIRE(t.find(52) == std::make_optional(8));
+
+  const auto &ct = t;
+  container::avl_tree<int, int>::const_iterator cit = t.begin();
+  REQUIRE(cit == ct.begin());
+  REQUIRE(std::distance(ct.begin(), ct.end()) == 50);
+}
+
+TEST_CASE("AVL trees Order Statistics Test 1") {
+  struct plain_node { // 付加情報なしの節点は元の配置と同じ大きさになる
+    void *l, *r;
+    std::int32_t h;
+    int key, v;
+  };
+  STATIC_REQUIRE(sizeof(container::avl_tree_node<int, int>) ==
+                 sizeof(plain_node));
+
+  container::order_statistics_tree<int, int> t;
+  std::vector<int> sorted;
+  std::mt19937 rng(99);
+  for (int i = 0; i < 3000; i++) {
+    const int k = static_cast<int>(rng() % 5000);
+    if (rng() % 4 == 0) {
+      t.erase(k);
+      auto it = std::lower_bound(sorted.begin(), sorted.end(), k);
+      if (it != sorted.end() && *it == k) {
+        sorted.erase(it);
+      }
+    } else {
+      t.insert(k, -k);
+      auto it = std::lower_bound(sorted.begin(), sorted.end(), k);
+      if (it == sorted.end() || *it != k) {
+        sorted.insert(it, k);
+      }
+    }
+  }
+  REQUIRE(t.size() == sorted.size());
+  for (std::size_t i = 0; i < sorted.size(); i += 7) {
+    REQUIRE(t.select(i).key() == sorted[i]);
+    REQUIRE(t.select(i).value() == -sorted[i]);
+    REQUIRE(t.rank(sorted[i]) == i);
+  }
+  REQUIRE(t.select(sorted.size()) == t.end());
+  for (int lo = -10; lo < 5100; lo += 137) {
+    const int hi = lo + 400;
+    const auto expected = std::upper_bound(sorted.begin(), sorted.end(), hi) -
+                          std::lower_bound(sorted.begin(), sorted.end(), lo);
+    REQUIRE(t.count(lo, hi) == static_cast<std::size_t>(expected));
+  }
+  REQUIRE(t.count(10, 5) == 0);
+
+  // 100位から200位までを取り出す
+  std::vector<int> page;
+  for (auto it = t.select(100); it != t.select(200); ++it) {
+    page.push_back(it.key());
+  }
+  REQUIRE(page == std::vector<int>(sorted.begin() + 100, sorted.begin() + 200));
+}
+
+namespace {
+template <class Tree> std::vector<int> keys_of(const Tree &t) {
+  std::vector<int> keys;
+  for (auto it = t.begin(); it != t.end(); ++it) {
+    keys.push_back(it.key());
+  }
+  return keys;
+}
+template <class Tree> bool balanced(const Tree &t) {
+  return t.height() <= 1.4405 * std::log2(t.size() + 2);
+}
+template <class Tree> void build_keys(Tree &t, const std::vector<int> &keys) {
+  std::vector<std::pair<int, int>> kv;
+  for (int k : keys) {
+    kv.emplace_back(k, k);
+  }
+  t.build_from_sorted(kv.begin(), kv.end());
+}
+std::vector<int> random_keys(std::mt19937 &rng, std::size_t n, int range) {
+  std::set<int> s;
+  while (s.size() < n) {
+    s.insert(static_cast<int>(rng() % range));
+  }
+  return std::vector<int>(s.begin(), s.end());
+}
+} // namespace
+
+TEST_CASE("AVL trees Build Join Split Test 1") {
+  std::vector<std::pair<int, int>> kv;
+  for (int i = 0; i < 1000; i++) {
+    kv.emplace_back(i * 3, i);
+  }
+  container::order_statistics_tree<int, int> t;
+  t.insert(-1, -1); // 既存の節点は置き換えられる
+  t.build_from_sorted(kv.begin(), kv.end());
+  REQUIRE(t.size() == 1000);
+  REQUIRE(t.height() == 10);
+  REQUIRE(t.find(-1) == std::nullopt);
+  REQUIRE(t.find(300) == std::make_optional(100));
+  REQUIRE(t.select(500).key() == 1500);
+
+  SECTION("Shared pool") {
+    container::order_statistics_tree<int, int> u(t.pool());
+    t.split(1500, u);
+    REQUIRE(t.size() == 500);
+    REQUIRE(u.size() == 500);
+    REQUIRE(std::prev(t.end()).key() == 1497);
+    REQUIRE(u.begin().key() == 1500);
+    REQUIRE(balanced(t));
+    REQUIRE(balanced(u));
+    t.join(u);
+    REQUIRE(u.empty());
+    REQUIRE(t.size() == 1000);
+    REQUIRE(balanced(t));
+    REQUIRE(t.rank(1500) == 500);
+    REQUIRE(t.pool().live() == 1000);
+  }
+  SECTION("Separate pools") {
+    container::order_statistics_tree<int, int> u;
+    t.split(1501, u);
+    REQUIRE(t.size() == 501);
+    REQUIRE(u.size() == 499);
+    REQUIRE(u.begin().key() == 1503);
+    REQUIRE(t.pool().live() == 501);
+    REQUIRE(u.pool().live() == 499);
+    t.join(u);
+    REQUIRE(t.size() == 1000);
+    REQUIRE(balanced(t));
+    REQUIRE(u.pool().live() == 0);
+  }
+}
+
+TEST_CASE("AVL trees Build Join Split Test 2") {
+  // 順序統計木でなくても、分割した両側の節点数を数え直さずに返す
+  std::mt19937 rng(3);
+  const auto ks = random_keys(rng, 5000, 20000);
+  for (int k : {-1, ks[0], ks[100], ks[2500], ks[4999], 20000}) {
+    container::avl_tree<int, int> t, u;
+    build_keys(t, ks);
+    t.split(k, u);
+    const std::size_t n = static_cast<std::size_t>(
+        std::lower_bound(ks.begin(), ks.end(), k) - ks.begin());
+    const auto &ct = t;
+    REQUIRE(ct.size() == n);
+    REQUIRE(static_cast<std::size_t>(std::distance(ct.begin(), ct.end())) == n);
+    REQUIRE(u.size() == ks.size() - n);
+    REQUIRE(u.pool().live() == ks.size() - n);
+    t.join(u);
+    REQUIRE(t.size() == ks.size());
+    REQUIRE(keys_of(t) == ks);
+  }
+}
+
+TEST_CASE("AVL trees Set Operations Test 1") {
+  std::mt19937 rng(7);
+  const auto as = random_keys(rng, 40000, 100000);
+  const auto bs = random_keys(rng, 30000, 100000);
+  container::avl_tree<int, int> a, b;
+  build_keys(a, as);
+  build_keys(b, bs);
+  for (int k : bs) {
+    *b.get(k) = -k; // 和集合ではotherの付属データが残る
+  }
+
+  std::vector<int> expected;
+  SECTION("Union") {
+    std::set_union(as.begin(), as.end(), bs.begin(), bs.end(),
+                   std::back_inserter(expected));
+    a.union_with(b);
+    REQUIRE(a.find(bs[0]) == std::make_optional(-bs[0]));
+  }
+  SECTION("Intersection") {
+    std::set_intersection(as.begin(), as.end(), bs.begin(), bs.end(),
+                          std::back_inserter(expected));
+    a.intersect(b);
+  }
+  SECTION("Difference") {
+    std::set_difference(as.begin(), as.end(), bs.begin(), bs.end(),
+                        std::back_inserter(expected));
+    a.difference(b);
+  }
+  REQUIRE(keys_of(a) == expected);
+  REQUIRE(a.size() == expected.size());
+  REQUIRE(a.pool().live() == expected.size());
+  REQUIRE(balanced(a));
+  REQUIRE(b.size() == bs.size());
+}
@@ -0,0 +1,195 @@
+//
+// avl_tree の反復版(経路スタック)と、以前の再帰版との比較ベンチマーク
+//
+// 再帰版は以前の avl_tree の find/insert/erase をそのまま移したもので、
+// 節点の確保には同じ node_pool を使うのでエンジン部分の差だけを測る
+//
+// usage: avl_tree_bench [最大キー数(既定 1e7)]
+//
+
+#include "container/avl_tree.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <class Key, class T, class Compare = std::less<Key>>
+struct recursive_avl_tree {
+  using node = container::avl_tree_node<Key, T>;
+  using sides_t = std::int32_t;
+  using height_t = typename node::height_t;
+
+  explicit recursive_avl_tree(std::size_t n) : pool_(n) {}
+  ~recursive_avl_tree() noexcept { destroy(root_); }
+
+  std::optional<T> find(const Key &k) const {
+    const node *x = find(root_, k);
+    return x == nullptr ? std::nullopt : std::make_optional(x->v);
+  }
+  std::optional<T> insert(const Key &k, const T &v) {
+    std::optional<T> opt = std::nullopt;
+    root_ = insert(root_, k, v, opt);
+    return opt;
+  }
+  std::optional<T> erase(const Key &k) {
+    std::optional<T> opt = std::nullopt;
+    root_ = erase(root_, k, opt);
+    return opt;
+  }
+
+private:
+  node *find(node *x, const Key &k) const {
+    if (x == nullptr || eq(x->key, k)) {
+      return x;
+    } else {
+      return find(cmp_(k, x->key) ? x->l : x->r, k);
+    }
+  }
+  node *insert(node *x, const Key &k, const T &v, std::optional<T> &opt) {
+    if (x == nullptr) {
+      return ::new (pool_.allocate()) node(k, v);
+    }
+    if (cmp_(k, x->key)) {
+      x->l = insert(x->l, k, v, opt);
+    } else if (cmp_(x->key, k)) {
+      x->r = insert(x->r, k, v, opt);
+    } else {
+      opt = x->v;
+      x->v = v;
+      return x;
+    }
+    return balance(x);
+  }
+  node *erase(node *x, const Key &k, std::optional<T> &opt) {
+    if (x == nullptr) {
+      return nullptr;
+    }
+    if (cmp_(k, x->key)) {
+      x->l = erase(x->l, k, opt);
+      return balance(x);
+    }
+    if (cmp_(x->key, k)) {
+      x->r = erase(x->r, k, opt);
+      return balance(x);
+    }
+    opt = x->v;
+    node *y = x->l, *z = x->r;
+    x->~node();
+    pool_.deallocate(x);
+    if (z == nullptr) {
+      return y;
+    }
+    node *w = leftmost(z);
+    w->r = erase__(z);
+    w->l = y;
+    return balance(w);
+  }
+  static node *balance(node *x) {
+    x->h = reheight(x);
+    if (bias(x) > 1) {
+      if (bias(x->l) < 0) {
+        x->l = rotate(x->l, 0, 1);
+      }
+      return rotate(x, 1, 0);
+    }
+    if (bias(x) < -1) {
+      if (bias(x->r) > 0) {
+        x->r = rotate(x->r, 1, 0);
+      }
+      return rotate(x, 0, 1);
+    }
+    return x;
+  }
+  static node *rotate(node *x, sides_t i, sides_t j) {
+    node *y = x->c[j];
+    x->c[j] = y->c[i];
+    y->c[i] = x;
+    x->h = reheight(x);
+    y->h = reheight(y);
+    return y;
+  }
+  static node *leftmost(node *x) { return x->l ? leftmost(x->l) : x; }
+  static node *erase__(node *x) {
+    if (x->l == nullptr) {
+      return x->r;
+    }
+    x->l = erase__(x->l);
+    return balance(x);
+  }
+  static height_t height(node *x) noexcept { return x ? x->h : 0; }
+  static height_t reheight(node *x) noexcept {
+    return std::max(height(x->l), height(x->r)) + 1;
+  }
+  static height_t bias(node *x) noexcept { return height(x->l) - height(x->r); }
+  bool eq(const Key &l, const Key &r) const {
+    return !(cmp_(l, r) || cmp_(r, l));
+  }
+  void destroy(node *x) noexcept {
+    if (x == nullptr) {
+      return;
+    }
+    destroy(x->l);
+    destroy(x->r);
+    x->~node();
+    pool_.deallocate(x);
+  }
+
+  node *root_ = nullptr;
+  Compare cmp_;
+  container::node_pool<node> pool_;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+template <class F> double measure_ns(std::size_t n, F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::nano>(e - s).count() / n;
+}
+
+template <class Tree>
+void run(const char *name, const std::vector<std::uint64_t> &keys) {
+  const std::size_t n = keys.size();
+  Tree t(n);
+  std::uint64_t sum = 0;
+  const double ins = measure_ns(n, [&] {
+    for (std::uint64_t k : keys) {
+      t.insert(k, k);
+    }
+  });
+  const double fnd = measure_ns(n, [&] {
+    for (std::uint64_t k : keys) {
+      sum += *t.find(k);
+    }
+  });
+  const double ers = measure_ns(n, [&] {
+    for (std::uint64_t k : keys) {
+      sum += *t.erase(k);
+    }
+  });
+  std::printf("%-10s %10zu %10.1f %10.1f %10.1f   (%llu)\n", name, n, ins, fnd,
+              ers, static_cast<unsigned long long>(sum & 0xff));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  std::mt19937_64 rng(42);
+  std::printf("%-10s %10s %10s %10s %10s  [ns/op]\n", "engine", "keys",
+              "insert", "find", "erase");
+  for (std::size_t n = 1000; n <= max_n; n *= 10) {
+    std::vector<std::uint64_t> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    run<recursive_avl_tree<std::uint64_t, std::uint64_t>>("recursive", keys);
+    run<container::avl_tree<std::uint64_t, std::uint64_t>>("iterative", keys);
+  }
+  return 0;
+}
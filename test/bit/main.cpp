@@ -34,3 +34,25 @@ TEST_CASE("Number of Leading Zero (NLZ)") {
   REQUIRE(bit::nlz(0b0000'0000'0000'0000'1000'0000'0000'1000) ==
           bit::nlz(0b1000'0000'0000'1000));
 }
+
+TEST_CASE("Number of Leading Zero 64 (NLZ64)") {
+  REQUIRE(bit::nlz64(0) == 64);
+  REQUIRE(bit::nlz64(1) == 63);
+  REQUIRE(bit::nlz64(std::uint64_t{1} << 40) == 23);
+  REQUIRE(bit::nlz64(~std::uint64_t{0}) == 0);
+  // 32ビットに収まる値はnlzより32だけ多い
+  REQUIRE(bit::nlz64(0b1000'0000'0000'1000) ==
+          bit::nlz(0b1000'0000'0000'1000) + 32);
+}
+
+TEST_CASE("Number of Trailing Zero (NTZ)") {
+  REQUIRE(bit::ntz(0) == 32);
+  REQUIRE(bit::ntz(1) == 0);
+  REQUIRE(bit::ntz(0b1000'0000'0000'1000) == 3);
+  REQUIRE(bit::ntz64(0) == 64);
+  REQUIRE(bit::ntz64(std::uint64_t{1} << 63) == 63);
+  REQUIRE(bit::ntz64(0b1010'0000) == 5);
+  REQUIRE(bit::pop64(0) == 0);
+  REQUIRE(bit::pop64(~std::uint64_t{0}) == 64);
+  REQUIRE(bit::pop64(0b1011'0110) == 5);
+}
@@ -0,0 +1,103 @@
+//
+// 階層ビットマップとビット集合のベンチマーク
+//
+// n 個の番号がほぼ埋まった状態で、空き番号の割り当てと解放を繰り返す1操作あたりの時間を、
+// dynamic_bitsetの線形走査と、hierarchical_bitmap(bitmap_allocator)とで比べる
+// あわせて、dynamic_bitsetの論理積と1のビットの計数の1語あたりの時間を測る(-mavx2の有無で比べる)
+//
+// usage: bitset_bench [番号数(既定 1000000)]
+//
+
+#include "bit/dynamic_bitset.hpp"
+#include "bit/hierarchical_bitmap.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+template <class F> double measure_ns(std::size_t n, F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::nano>(e - s).count() / n;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  const std::size_t ops = 100'000;
+  std::mt19937_64 rng(1);
+  std::vector<std::size_t> victims(ops);
+  for (std::size_t &v : victims) {
+    v = rng() % n;
+  }
+  std::uint64_t sink = 0;
+
+  // 全て割り当て済みの状態から、ランダムな番号を解放しては最も小さい空き番号を割り当て直す
+  {
+    bit::dynamic_bitset<> free(n);
+    const double t = measure_ns(ops, [&] {
+      for (std::size_t v : victims) {
+        free.set(v);
+        const std::size_t i = *free.find_first();
+        free.reset(i);
+        sink += i;
+      }
+    });
+    std::printf("%-28s %10.1f ns/op\n", "dynamic_bitset (scan)", t);
+  }
+  {
+    bit::bitmap_allocator<> a(n);
+    for (std::size_t i = 0; i < n; i++) {
+      a.allocate();
+    }
+    const double t = measure_ns(ops, [&] {
+      for (std::size_t v : victims) {
+        a.deallocate(v);
+        sink += *a.allocate();
+      }
+    });
+    std::printf("%-28s %10.1f ns/op\n", "bitmap_allocator", t);
+  }
+
+  // 語単位の演算
+  {
+    bit::dynamic_bitset<> x(n), y(n);
+    for (std::size_t i = 0; i < n; i++) {
+      x.set(i, rng() & 1);
+      y.set(i, rng() & 1);
+    }
+    constexpr int rounds = 100;
+    const std::size_t words = x.num_words() * rounds;
+    const double a = measure_ns(words, [&] {
+      for (int r = 0; r < rounds; r++) {
+        x &= y;
+        x |= y;
+      }
+    });
+    const double c = measure_ns(words, [&] {
+      for (int r = 0; r < rounds; r++) {
+        sink += x.count();
+      }
+    });
+    const double ca = measure_ns(words, [&] {
+      for (int r = 0; r < rounds; r++) {
+        sink += x.count_and(y);
+      }
+    });
+    std::printf("%-28s %10.3f ns/word\n", "and + or", a);
+    std::printf("%-28s %10.3f ns/word\n", "count", c);
+    std::printf("%-28s %10.3f ns/word\n", "count_and", ca);
+  }
+
+  std::printf("(%llu)\n", static_cast<unsigned long long>(sink & 0xff));
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include "container/compact_avl_tree.hpp"
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Compact AVL trees Insert Find Erase Test 1") {
+  container::compact_avl_tree<int, int> t;
+  REQUIRE(t.insert(3, 0xff0000) == std::nullopt);
+  REQUIRE(t.insert(1, 0x0000ff) == std::nullopt);
+  REQUIRE(t.insert(2, 0x00ff00) == std::nullopt);
+  REQUIRE(t.find(1) == std::make_optional(0x0000ff));
+  REQUIRE(t.find(3) == std::make_optional(0xff0000));
+  REQUIRE(t.find(2) == std::make_optional(0x00ff00));
+  REQUIRE(t.find(4) == std::nullopt);
+  REQUIRE(t.insert(1, 0x0000fe) == std::make_optional(0x0000ff));
+  REQUIRE(t.erase(3) == std::make_optional(0xff0000));
+  REQUIRE(t.erase(5) == std::nullopt);
+  REQUIRE(t.erase(3) == std::nullopt);
+  REQUIRE(t.erase(1) == std::make_optional(0x0000fe));
+  REQUIRE(t.erase(2) == std::make_optional(0x00ff00));
+  REQUIRE(t.erase(2) == std::nullopt);
+  REQUIRE(t.empty());
+}
+
+TEST_CASE("Compact AVL trees Node Size Test 1") {
+  using node = container::compact_avl_tree_node<std::uint64_t, std::uint64_t>;
+  using split_node =
+      container::compact_avl_tree_node<std::uint64_t, std::uint64_t, true>;
+  REQUIRE(sizeof(node) == 24);
+  REQUIRE(sizeof(split_node) == 16);
+}
+
+template <class Tree> void random_test() {
+  Tree t(4);
+  std::map<int, int> m;
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 20000; i++) {
+    const int k = static_cast<int>(rng() % 2000);
+    auto it = m.find(k);
+    const auto expected =
+        it == m.end() ? std::nullopt : std::make_optional(it->second);
+    if (rng() % 3 == 0) {
+      REQUIRE(t.erase(k) == expected);
+      m.erase(k);
+    } else {
+      REQUIRE(t.insert(k, i) == expected);
+      m[k] = i;
+    }
+  }
+  REQUIRE(t.size() == m.size());
+  REQUIRE(t.height() <= 1.4405 * std::log2(t.size() + 2));
+  auto it = m.begin();
+  t.inorder([&](const int &k, int &v) {
+    REQUIRE(it != m.end());
+    REQUIRE(k == it->first);
+    REQUIRE(v == it->second);
+    ++it;
+  });
+  REQUIRE(it == m.end());
+  for (int k = 0; k < 2000; k++) {
+    auto mi = m.find(k);
+    REQUIRE(t.find(k) ==
+            (mi == m.end() ? std::nullopt : std::make_optional(mi->second)));
+  }
+  for (auto [k, v] : m) {
+    REQUIRE(t.erase(k) == std::make_optional(v));
+  }
+  REQUIRE(t.empty());
+  REQUIRE(t.pool().live() == 0);
+}
+
+TEST_CASE("Compact AVL trees Random Insert Erase Test 1") {
+  random_test<container::compact_avl_tree<int, int>>();
+}
+
+TEST_CASE("Compact AVL trees Random Insert Erase Test 2") {
+  random_test<container::split_compact_avl_tree<int, int>>();
+}
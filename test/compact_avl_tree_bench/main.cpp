@@ -0,0 +1,80 @@
+//
+// avl_tree(ポインタ版)と compact_avl_tree(添字版)の比較ベンチマーク
+//
+// 節点1つあたりのバイト数と、ランダムなキーの探索時間を測る
+// split は付属データを節点とは別の配列に置く split_compact_avl_tree
+//
+// usage: compact_avl_tree_bench [最大キー数(既定 1e7)]
+//
+
+#include "container/avl_tree.hpp"
+#include "container/compact_avl_tree.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+using key_type = std::uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+template <class F> double measure_ns(std::size_t n, F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::nano>(e - s).count() / n;
+}
+
+/**< @brief 節点1つあたりの記憶領域の大きさ(バイト)を返す */
+template <class Tree> double bytes_per_node(const Tree &t) {
+  if constexpr (std::is_same_v<Tree, container::avl_tree<key_type, key_type>>) {
+    return static_cast<double>(sizeof(typename Tree::node));
+  } else {
+    return static_cast<double>(t.pool().bytes()) / t.pool().capacity();
+  }
+}
+
+template <class Tree>
+void run(const char *name, const std::vector<key_type> &keys,
+         const std::vector<key_type> &queries) {
+  const std::size_t n = keys.size();
+  Tree t(n);
+  for (key_type k : keys) {
+    t.insert(k, k);
+  }
+  key_type sum = 0;
+  const double fnd = measure_ns(queries.size(), [&] {
+    for (key_type k : queries) {
+      sum += *t.find(k);
+    }
+  });
+  std::printf("%-10s %10zu %10.1f %10.1f   (%llu)\n", name, n,
+              bytes_per_node(t), fnd,
+              static_cast<unsigned long long>(sum & 0xff));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  std::mt19937_64 rng(42);
+  std::printf("%-10s %10s %10s %10s\n", "layout", "keys", "bytes/node",
+              "find[ns]");
+  for (std::size_t n = 1'000'000; n <= max_n; n *= 10) {
+    std::vector<key_type> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<key_type> queries(keys);
+    std::shuffle(queries.begin(), queries.end(), rng);
+    run<container::avl_tree<key_type, key_type>>("pointer", keys, queries);
+    run<container::compact_avl_tree<key_type, key_type>>("compact", keys,
+                                                         queries);
+    run<container::split_compact_avl_tree<key_type, key_type>>("split", keys,
+                                                               queries);
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+#include "container/compact_skew_heap.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Compact Skew Heap Push Pop Test 1") {
+  container::compact_skew_heap<int> h(2);
+  std::vector<int> v(1000);
+  std::mt19937 rng(1234);
+  for (int &x : v) {
+    x = static_cast<int>(rng() % 500);
+    h.push(x);
+  }
+  REQUIRE(h.size() == v.size());
+  std::sort(v.begin(), v.end());
+  for (int x : v) {
+    REQUIRE(h.pop() == std::make_optional(x));
+  }
+  REQUIRE(h.pop() == std::nullopt);
+  REQUIRE(h.empty());
+  REQUIRE(h.pool().live() == 0);
+  REQUIRE(h.pool().high_water() == v.size());
+}
@@ -0,0 +1,149 @@
+#include "container/concurrent_skip_list.hpp"
+#include <atomic>
+#include <map>
+#include <latch>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Concurrent Skip List Insert Find Erase Test 1") {
+  container::concurrent_skip_list<int, int> t;
+  REQUIRE(t.insert(3, 30) == std::nullopt);
+  REQUIRE(t.insert(1, 10) == std::nullopt);
+  REQUIRE(t.insert(2, 20) == std::nullopt);
+  REQUIRE(t.insert(2, 21) == std::make_optional(20));
+  REQUIRE(t.find(1) == std::make_optional(10));
+  REQUIRE(t.find(2) == std::make_optional(20));
+  REQUIRE(t.find(4) == std::nullopt);
+  REQUIRE(t.erase(2) == std::make_optional(20));
+  REQUIRE(t.erase(2) == std::nullopt);
+  REQUIRE(t.find(2) == std::nullopt);
+  REQUIRE(t.size() == 2);
+}
+
+TEST_CASE("Concurrent Skip List Random Insert Erase Test 1") {
+  container::concurrent_skip_list<int, int> t;
+  std::map<int, int> m;
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 20000; i++) {
+    const int k = static_cast<int>(rng() % 2000);
+    auto it = m.find(k);
+    const auto expected =
+        it == m.end() ? std::nullopt : std::make_optional(it->second);
+    if (rng() % 3 == 0) {
+      REQUIRE(t.erase(k) == expected);
+      m.erase(k);
+    } else {
+      REQUIRE(t.insert(k, i) == expected);
+      m.emplace(k, i);
+    }
+  }
+  REQUIRE(t.size() == m.size());
+  auto it = m.begin();
+  t.inorder([&](const int &k, const int &v) {
+    REQUIRE(it != m.end());
+    REQUIRE(k == it->first);
+    REQUIRE(v == it->second);
+    ++it;
+  });
+  REQUIRE(it == m.end());
+  std::vector<int> keys;
+  t.range(100, 200, [&](const int &k, const int &) { keys.push_back(k); });
+  REQUIRE(keys.size() == static_cast<std::size_t>(std::distance(
+                             m.lower_bound(100), m.upper_bound(200))));
+}
+
+TEST_CASE("Concurrent Skip List Multi Thread Test 1") {
+  constexpr int threads = 8, n = 20000;
+  container::concurrent_skip_list<int, int> t;
+  std::vector<std::thread> ts;
+  for (int i = 0; i < threads; i++) {
+    ts.emplace_back([&t, i] {
+      for (int k = i; k < n * threads; k += threads) {
+        t.insert(k, k);
+      }
+      for (int k = i; k < n * threads; k += 2 * threads) {
+        t.erase(k);
+      }
+    });
+  }
+  for (auto &th : ts) {
+    th.join();
+  }
+  REQUIRE(t.size() == static_cast<std::size_t>(n * threads / 2));
+  int prev = -1;
+  std::size_t count = 0;
+  t.inorder([&](const int &k, const int &v) {
+    REQUIRE(k > prev);
+    REQUIRE(k == v);
+    REQUIRE((k / threads) % 2 == 1);
+    prev = k;
+    count++;
+  });
+  REQUIRE(count == t.size());
+}
+
+TEST_CASE("Concurrent Skip List Contention Test 1") {
+  constexpr int threads = 8, ops = 50000, keys = 64;
+  container::concurrent_skip_list<int, int> t;
+  std::atomic<long> balance = 0, mismatches = 0;
+  std::vector<std::thread> ts;
+  for (int i = 0; i < threads; i++) {
+    ts.emplace_back([&, i] {
+      std::mt19937 rng(i);
+      long local = 0;
+      for (int j = 0; j < ops; j++) {
+        const int k = static_cast<int>(rng() % keys);
+        switch (rng() % 3) {
+        case 0:
+          local += t.insert(k, k) == std::nullopt;
+          break;
+        case 1:
+          local -= t.erase(k) != std::nullopt;
+          break;
+        default:
+          if (auto v = t.find(k); v && *v != k) {
+            mismatches++;
+          }
+        }
+      }
+      balance += local;
+    });
+  }
+  for (auto &th : ts) {
+    th.join();
+  }
+  REQUIRE(mismatches == 0);
+  std::size_t count = 0;
+  t.inorder([&](const int &, const int &) { count++; });
+  REQUIRE(count == static_cast<std::size_t>(balance.load()));
+  REQUIRE(t.size() == count);
+}
+
+TEST_CASE("Concurrent Skip List Thread Limit Test 1") {
+  // 同時に生存するスレッドが番号の上限を超えると、超えた分は例外で失敗する
+  constexpr int threads = static_cast<int>(container::impl::max_threads) + 16;
+  container::concurrent_skip_list<int, int> t;
+  std::atomic<int> failed = 0;
+  std::latch done(threads);
+  std::vector<std::thread> ts;
+  for (int i = 0; i < threads; i++) {
+    ts.emplace_back([&, i] {
+      try {
+        t.insert(i, i);
+      } catch (const std::length_error &) {
+        failed++;
+      }
+      done.arrive_and_wait(); // 全員が試すまで番号を手放さない
+    });
+  }
+  for (auto &th : ts) {
+    th.join();
+  }
+  REQUIRE(failed >= 16);
+  REQUIRE(t.size() == static_cast<std::size_t>(threads - failed));
+}
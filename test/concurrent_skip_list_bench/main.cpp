@@ -0,0 +1,97 @@
+//
+// concurrent_skip_list と、mutex で保護した avl_tree のスレッド数に対するスケーリングの比較ベンチマーク
+//
+// 各スレッドがランダムなキーに対して find 90%、insert 5%、erase 5% の操作を行い、
+// 全スレッド合計のスループット(Mops/s)を測る
+//
+// usage: concurrent_skip_list_bench [最大スレッド数(既定 hardware_concurrency)]
+//
+
+#include "container/avl_tree.hpp"
+#include "container/concurrent_skip_list.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using key_type = std::uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t keys = 1'000'000;           /**< キーの範囲 */
+constexpr std::size_t ops_per_thread = 1'000'000; /**< スレッドあたりの操作数 */
+
+/**< @brief mutexで保護したavl_tree */
+struct locked_avl_tree {
+  std::optional<key_type> find(key_type k) {
+    std::lock_guard<std::mutex> lock(m);
+    return t.find(k);
+  }
+  std::optional<key_type> insert(key_type k, key_type v) {
+    std::lock_guard<std::mutex> lock(m);
+    return t.insert(k, v);
+  }
+  std::optional<key_type> erase(key_type k) {
+    std::lock_guard<std::mutex> lock(m);
+    return t.erase(k);
+  }
+  std::mutex m;
+  container::avl_tree<key_type, key_type> t{keys};
+};
+
+std::atomic<std::uint64_t> sink = 0; /**< 探索結果を捨てられないように集める */
+
+template <class Map> double run(std::size_t threads) {
+  Map map;
+  for (key_type k = 0; k < keys; k += 2) {
+    map.insert(k, k);
+  }
+  std::vector<std::thread> ts;
+  const auto s = clock_type::now();
+  for (std::size_t i = 0; i < threads; i++) {
+    ts.emplace_back([&map, i] {
+      std::mt19937_64 rng(i);
+      std::uint64_t sum = 0;
+      for (std::size_t j = 0; j < ops_per_thread; j++) {
+        const key_type k = rng() % keys;
+        const std::uint64_t op = rng() % 100;
+        if (op < 90) {
+          sum += map.find(k).value_or(0);
+        } else if (op < 95) {
+          map.insert(k, k);
+        } else {
+          map.erase(k);
+        }
+      }
+      sink += sum;
+    });
+  }
+  for (auto &t : ts) {
+    t.join();
+  }
+  const auto e = clock_type::now();
+  const double sec = std::chrono::duration<double>(e - s).count();
+  return threads * ops_per_thread / sec / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_threads =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+               : std::max(1U, std::thread::hardware_concurrency());
+  std::printf("%8s %12s %12s  [Mops/s]\n", "threads", "skip_list",
+              "locked_avl");
+  for (std::size_t n = 1; n <= max_threads; n *= 2) {
+    const double a =
+        run<container::concurrent_skip_list<key_type, key_type>>(n);
+    const double b = run<locked_avl_tree>(n);
+    std::printf("%8zu %12.2f %12.2f\n", n, a, b);
+  }
+  return 0;
+}
@@ -0,0 +1,37 @@
+#include "container/dary_heap.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("D-ary Heap Push Pop Test 1") {
+  container::dary_heap<int, 4> h;
+  h.push(3);
+  h.push(5);
+  h.push(1);
+  REQUIRE(h.pop() == std::make_optional(1));
+  REQUIRE(h.pop() == std::make_optional(3));
+  REQUIRE(h.pop() == std::make_optional(5));
+  REQUIRE(h.pop() == std::nullopt);
+}
+
+TEST_CASE("D-ary Heap Random Push Pop Test 1") {
+  container::dary_heap<int, 4> h(2);
+  std::vector<int> v;
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 100000; i++) {
+    if (v.empty() || rng() % 3 != 0) {
+      const int k = static_cast<int>(rng() % 1000);
+      h.push(k);
+      v.push_back(k);
+      std::push_heap(v.begin(), v.end(), std::greater<>());
+    } else {
+      std::pop_heap(v.begin(), v.end(), std::greater<>());
+      REQUIRE(h.pop() == std::make_optional(v.back()));
+      v.pop_back();
+    }
+    REQUIRE(h.size() == v.size());
+  }
+}
@@ -0,0 +1,79 @@
+#include "bit/dynamic_bitset.hpp"
+#include <bitset>
+#include <random>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+constexpr std::size_t bits = 1000;
+
+template <class Bitset>
+bool same(const Bitset &x, const std::bitset<bits> &y) {
+  for (std::size_t i = 0; i < bits; i++) {
+    if (x.test(i) != y.test(i)) {
+      return false;
+    }
+  }
+  return x.count() == y.count();
+}
+
+} // namespace
+
+TEST_CASE("Dynamic Bitset Test 1") {
+  bit::dynamic_bitset<> b(70);
+  REQUIRE(b.size() == 70);
+  REQUIRE(b.num_words() == 2);
+  REQUIRE(b.none());
+  b.set(0).set(69).set(64);
+  REQUIRE(b.count() == 3);
+  REQUIRE(b[69]);
+  REQUIRE(b.find_first() == 0);
+  REQUIRE(b.find_next(1) == 64);
+  REQUIRE(b.find_next(65) == 69);
+  REQUIRE_FALSE(b.find_next(70));
+  b.flip();
+  REQUIRE(b.count() == 67); // 末尾の語の余りは0のまま
+  b.set();
+  REQUIRE(b.all());
+  b.reset(5);
+  REQUIRE_FALSE(b.all());
+  b.resize(130, true);
+  REQUIRE(b.count() == 129);
+  b.resize(65);
+  REQUIRE(b.count() == 64);
+  b.resize(128);
+  REQUIRE(b.count() == 64);
+}
+
+TEST_CASE("Dynamic Bitset Operation Test 1") {
+  std::mt19937_64 rng(1);
+  bit::dynamic_bitset<> x(bits), y(bits);
+  std::bitset<bits> sx, sy;
+  for (std::size_t i = 0; i < bits; i++) {
+    const bool a = rng() % 3 == 0, b = rng() % 2 == 0;
+    x.set(i, a);
+    y.set(i, b);
+    sx[i] = a;
+    sy[i] = b;
+  }
+  REQUIRE(same(x, sx));
+  REQUIRE(same(x & y, sx & sy));
+  REQUIRE(same(x | y, sx | sy));
+  REQUIRE(same(x ^ y, sx ^ sy));
+  REQUIRE(same(x - y, sx & ~sy));
+  REQUIRE(x.count_and(y) == (sx & sy).count());
+  REQUIRE(x.intersects(y));
+  REQUIRE_FALSE((x - y).intersects(y));
+  REQUIRE(x == x);
+  REQUIRE_FALSE(x == y);
+  std::size_t n = 0;
+  bool ordered = true;
+  x.for_each([&](std::size_t i) {
+    ordered = ordered && sx.test(i);
+    n++;
+  });
+  REQUIRE(ordered);
+  REQUIRE(n == sx.count());
+}
@@ -0,0 +1,186 @@
+#include "ecs/archetype.hpp"
+#include "ecs/command_buffer.hpp"
+#include "ecs/sparse_set.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+struct position {
+  float x, y;
+};
+struct velocity {
+  float dx, dy;
+};
+struct name {
+  std::string s;
+};
+template <std::size_t I> struct tag {};
+
+template <std::size_t... Is>
+std::size_t register_tags(std::index_sequence<Is...>) {
+  std::size_t n = 0;
+  auto f = [&](auto id) {
+    try {
+      id();
+      n++;
+    } catch (const std::length_error &) {
+    }
+  };
+  (f([] { return ecs::component_id<tag<Is>>(); }), ...);
+  return n;
+}
+
+} // namespace
+
+TEST_CASE("ECS Registry Test 1") {
+  ecs::registry r;
+  const ecs::entity a = r.create(position{0, 0}, velocity{1, 2});
+  const ecs::entity b = r.create(position{5, 5});
+  const ecs::entity c = r.create();
+  r.add<velocity>(c, 3.0f, 4.0f);
+  r.add<position>(c, 1.0f, 1.0f);
+  REQUIRE(r.size() == 3);
+  REQUIRE(r.has<velocity>(a));
+  REQUIRE_FALSE(r.has<velocity>(b));
+  int n = 0;
+  r.for_each<position, velocity>(
+      [&](ecs::entity, position &p, const velocity &v) {
+        p.x += v.dx;
+        p.y += v.dy;
+        n++;
+      });
+  REQUIRE(n == 2);
+  REQUIRE(r.get<position>(a)->x == 1);
+  REQUIRE(r.get<position>(c)->y == 5);
+  REQUIRE(r.get<position>(b)->x == 5);
+  r.remove<position>(a);
+  REQUIRE(r.get<position>(a) == nullptr);
+  REQUIRE(r.get<position>(c)->y == 5); // 末尾の要素が移っても引ける
+  r.destroy(c);
+  REQUIRE_FALSE(r.alive(c));
+  REQUIRE_FALSE(r.has<velocity>(c));
+  const ecs::entity d = r.create(velocity{0, 0});
+  REQUIRE(d.index() == c.index()); // 番号は再利用されるが世代が違う
+  REQUIRE(r.get<velocity>(c) == nullptr);
+  REQUIRE(r.get<velocity>(d) != nullptr);
+}
+
+TEST_CASE("ECS World Test 1") {
+  ecs::world w;
+  const ecs::entity a = w.create(position{0, 0}, velocity{1, 2});
+  const ecs::entity b = w.create(position{5, 5}, name{"b"});
+  const ecs::entity c = w.create(position{1, 1});
+  w.add<velocity>(c, 3.0f, 4.0f); // cは{position, velocity}の表へ移る
+  w.add<name>(a, name{"a"});      // aは{position, velocity, name}の表へ移る
+  REQUIRE(w.size() == 3);
+  int n = 0;
+  w.for_each<position, velocity>([&](ecs::entity, position &p, velocity &v) {
+    p.x += v.dx;
+    p.y += v.dy;
+    n++;
+  });
+  REQUIRE(n == 2);
+  REQUIRE(w.get<position>(a)->x == 1);
+  REQUIRE(w.get<position>(c)->y == 5);
+  REQUIRE(w.get<name>(a)->s == "a");
+  REQUIRE(w.get<name>(b)->s == "b");
+  w.remove<velocity>(a);
+  REQUIRE_FALSE(w.has<velocity>(a));
+  REQUIRE(w.get<name>(a)->s == "a"); // 残りの構成要素は移動先へ移る
+  REQUIRE(w.get<position>(a)->x == 1);
+  w.destroy(b);
+  REQUIRE_FALSE(w.alive(b));
+  REQUIRE(w.get<name>(b) == nullptr);
+  n = 0;
+  w.for_each<name>([&](ecs::entity, name &) { n++; });
+  REQUIRE(n == 1);
+}
+
+TEST_CASE("ECS World Parallel Test 1") {
+  constexpr int n = 100'000;
+  ecs::world w;
+  for (int i = 0; i < n; i++) {
+    if (i % 2 == 0) {
+      w.create(position{0, 0}, velocity{1, 1});
+    } else {
+      w.create(position{0, 0}, velocity{1, 1}, name{});
+    }
+  }
+  std::atomic<int> visited = 0;
+  w.par_for_each<position, velocity>(
+      [&](ecs::entity, position &p, const velocity &v) {
+        p.x += v.dx;
+        visited.fetch_add(1, std::memory_order_relaxed);
+      },
+      4);
+  REQUIRE(visited == n);
+  float sum = 0;
+  w.for_each<position>([&](ecs::entity, position &p) { sum += p.x; });
+  REQUIRE(sum == n);
+}
+
+TEST_CASE("ECS Command Buffer Test 1") {
+  ecs::world w;
+  for (int i = 0; i < 1000; i++) {
+    w.create(position{static_cast<float>(i), 0});
+  }
+  ecs::command_buffer<ecs::world> cmds;
+  // 巡回中の構造の変更は記録だけして、巡回の後で適用する
+  w.par_for_each<position>(
+      [&](ecs::entity e, position &p) {
+        if (static_cast<int>(p.x) % 2 == 0) {
+          cmds.destroy(e);
+        } else {
+          cmds.add(e, velocity{1, 0});
+          cmds.create(name{"spawned"});
+        }
+      },
+      2);
+  REQUIRE(w.size() == 1000);
+  REQUIRE(cmds.size() == 1500);
+  cmds.flush(w);
+  REQUIRE(cmds.size() == 0);
+  REQUIRE(w.size() == 1000);
+  int moving = 0, spawned = 0;
+  w.for_each<position, velocity>([&](ecs::entity, position &p, velocity &) {
+    REQUIRE(static_cast<int>(p.x) % 2 == 1);
+    moving++;
+  });
+  w.for_each<name>([&](ecs::entity, name &x) {
+    REQUIRE(x.s == "spawned");
+    spawned++;
+  });
+  REQUIRE(moving == 500);
+  REQUIRE(spawned == 500);
+
+  ecs::registry r;
+  ecs::command_buffer<ecs::registry> rc;
+  const ecs::entity e = r.create(position{0, 0});
+  rc.destroy(e);
+  rc.add(e, velocity{1, 1}); // 破棄済みのエンティティへのコマンドは読み飛ばす
+  rc.flush(r);
+  REQUIRE_FALSE(r.alive(e));
+  REQUIRE(r.pool<velocity>().size() == 0);
+}
+
+TEST_CASE("ECS Component Limit Test 1") {
+  // 上限を超えた型の登録はリリースビルドでも例外で失敗する
+  const std::size_t n = register_tags(
+      std::make_index_sequence<ecs::max_components + 1>());
+  REQUIRE(n < ecs::max_components + 1);
+  ecs::registry r;
+  const ecs::entity e = r.create();
+  REQUIRE_THROWS_AS(r.add<tag<ecs::max_components>>(e), std::length_error);
+  REQUIRE_THROWS_AS(r.has<tag<ecs::max_components>>(e), std::length_error);
+  REQUIRE_THROWS_AS(r.create(tag<ecs::max_components>{}), std::length_error);
+  REQUIRE(r.size() == 1);
+  ecs::world w;
+  REQUIRE_THROWS_AS(w.create(tag<ecs::max_components>{}), std::length_error);
+  REQUIRE(w.size() == 0);
+}
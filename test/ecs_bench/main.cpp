@@ -0,0 +1,141 @@
+//
+// ECSの構成要素の格納方式の比較ベンチマーク
+//
+// 位置・速度・質量の3つの構成要素を持つエンティティ n 個について、
+// 全てを巡回して位置と速度を更新する1エンティティあたりの時間を測る
+// 比較するのは、構成要素ごとの std::unordered_map、疎集合(registry)、
+// アーキタイプ(world)の逐次巡回と並列巡回
+//
+// usage: ecs_bench [エンティティ数(既定 1000000)] [スレッド数(既定 ハードウェアの並列数)]
+//
+
+#include "ecs/archetype.hpp"
+#include "ecs/sparse_set.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct position {
+  float x, y, z;
+};
+struct velocity {
+  float dx, dy, dz;
+};
+struct mass {
+  float m;
+};
+
+constexpr float dt = 1.0f / 60.0f;
+constexpr int rounds = 10;
+
+/**< @brief 1エンティティの更新 */
+inline void update(position &p, velocity &v, const mass &m) {
+  const float k = dt / m.m;
+  v.dy -= 9.8f * k;
+  p.x += v.dx * dt;
+  p.y += v.dy * dt;
+  p.z += v.dz * dt;
+}
+
+/**< @brief 全エンティティの更新をrounds回行い、1エンティティあたりの時間を表示する */
+template <class F> void run(const char *name, std::size_t n, F f) {
+  f(); // 暖機
+  const auto s = clock_type::now();
+  for (int r = 0; r < rounds; r++) {
+    f();
+  }
+  const auto e = clock_type::now();
+  std::printf("%-24s %10.2f\n", name,
+              std::chrono::duration<double, std::nano>(e - s).count() /
+                  (static_cast<double>(n) * rounds));
+}
+
+position pos_of(std::size_t i) {
+  return position{static_cast<float>(i), 0, 0};
+}
+velocity vel_of(std::size_t i) {
+  return velocity{1, static_cast<float>(i % 7), 0};
+}
+mass mass_of(std::size_t i) { return mass{1.0f + static_cast<float>(i % 3)}; }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  const unsigned threads =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  float sink = 0;
+  std::printf("%-24s %10s (ns/entity)\n", "storage", "update");
+
+  {
+    std::unordered_map<std::uint32_t, position> ps;
+    std::unordered_map<std::uint32_t, velocity> vs;
+    std::unordered_map<std::uint32_t, mass> ms;
+    for (std::uint32_t i = 0; i < n; i++) {
+      ps.emplace(i, pos_of(i));
+      vs.emplace(i, vel_of(i));
+      ms.emplace(i, mass_of(i));
+    }
+    run("unordered_map", n, [&] {
+      for (auto &[e, p] : ps) {
+        auto v = vs.find(e);
+        auto m = ms.find(e);
+        if (v != vs.end() && m != ms.end()) {
+          update(p, v->second, m->second);
+        }
+      }
+    });
+    sink += ps[0].x;
+  }
+
+  {
+    ecs::registry r;
+    for (std::size_t i = 0; i < n; i++) {
+      r.create(pos_of(i), vel_of(i), mass_of(i));
+    }
+    run("registry (sparse set)", n, [&] {
+      r.for_each<position, velocity, mass>(
+          [](ecs::entity, position &p, velocity &v, const mass &m) {
+            update(p, v, m);
+          });
+    });
+    sink += r.pool<position>().values()[0].x;
+  }
+
+  {
+    ecs::world w;
+    for (std::size_t i = 0; i < n; i++) {
+      w.create(pos_of(i), vel_of(i), mass_of(i));
+    }
+    run("world (archetype)", n, [&] {
+      w.for_each<position, velocity, mass>(
+          [](ecs::entity, position &p, velocity &v, const mass &m) {
+            update(p, v, m);
+          });
+    });
+    char name[32];
+    std::snprintf(name, sizeof(name), "world par_for_each x%u", threads);
+    run(name, n, [&] {
+      w.par_for_each<position, velocity, mass>(
+          [](ecs::entity, position &p, velocity &v, const mass &m) {
+            update(p, v, m);
+          },
+          threads);
+    });
+    w.for_each<position>([&](ecs::entity, position &p) { sink += p.x; });
+  }
+
+  std::printf("(%d)\n", static_cast<int>(sink) & 0xff);
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "container/flat_hash_map.hpp"
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Flat Hash Map Insert Find Erase Test 1") {
+  container::flat_hash_map<int, int> m;
+  REQUIRE(m.empty());
+  REQUIRE(m.find(1) == std::nullopt);
+  REQUIRE(m.insert(1, 10) == std::nullopt);
+  REQUIRE(m.insert(2, 20) == std::nullopt);
+  REQUIRE(m.insert(1, 11) == std::make_optional(10));
+  REQUIRE(m.size() == 2);
+  REQUIRE(m.find(1) == std::make_optional(11));
+  REQUIRE(m.contains(2));
+  *m.get(2) += 1;
+  REQUIRE(m.find(2) == std::make_optional(21));
+  REQUIRE(m.erase(1) == std::make_optional(11));
+  REQUIRE(m.erase(1) == std::nullopt);
+  REQUIRE_FALSE(m.contains(1));
+  REQUIRE(m.size() == 1);
+  auto [p, inserted] = m.try_emplace(2, 0);
+  REQUIRE_FALSE(inserted);
+  REQUIRE(*p == 21);
+  m.clear();
+  REQUIRE(m.empty());
+  REQUIRE(m.find(2) == std::nullopt);
+}
+
+TEST_CASE("Flat Hash Map Random Test 1") {
+  // 削除で後退シフトを繰り返しても、std::unordered_mapと同じ内容を保つ
+  std::mt19937_64 rng(11);
+  container::flat_hash_map<std::uint64_t, std::uint64_t> m;
+  std::unordered_map<std::uint64_t, std::uint64_t> ref;
+  for (int step = 0; step < 200'000; step++) {
+    const std::uint64_t k = rng() % 4096 * 64; // 下位ビットが揃ったキー
+    const std::uint64_t op = rng() % 3;
+    if (op == 0) {
+      const std::optional<std::uint64_t> old = m.insert(k, step);
+      auto it = ref.find(k);
+      REQUIRE(old == (it == ref.end() ? std::nullopt
+                                      : std::make_optional(it->second)));
+      ref[k] = step;
+    } else if (op == 1) {
+      const std::optional<std::uint64_t> old = m.erase(k);
+      auto it = ref.find(k);
+      REQUIRE(old == (it == ref.end() ? std::nullopt
+                                      : std::make_optional(it->second)));
+      if (it != ref.end()) {
+        ref.erase(it);
+      }
+    } else {
+      auto it = ref.find(k);
+      REQUIRE(m.find(k) == (it == ref.end() ? std::nullopt
+                                            : std::make_optional(it->second)));
+    }
+    REQUIRE(m.size() == ref.size());
+  }
+  REQUIRE(m.load_factor() <= 0.875);
+  std::size_t n = 0;
+  m.for_each([&](const std::uint64_t &k, std::uint64_t &v) {
+    REQUIRE(ref.at(k) == v);
+    n++;
+  });
+  REQUIRE(n == ref.size());
+}
+
+TEST_CASE("Flat Hash Map Reserve Test 1") {
+  container::flat_hash_map<int, int> m(1000);
+  const std::size_t cap = m.capacity();
+  REQUIRE(cap * 7 / 8 >= 1000);
+  for (int i = 0; i < 1000; i++) {
+    m.insert(i, i);
+  }
+  REQUIRE(m.capacity() == cap); // 再ハッシュが起きていない
+  for (int i = 0; i < 1000; i += 2) {
+    m.erase(i);
+  }
+  for (int i = 0; i < 1000; i++) {
+    REQUIRE(m.contains(i) == (i % 2 == 1));
+  }
+}
+
+namespace {
+
+/**< @brief std::string_viewでも探索できるハッシュ関数 */
+struct string_hash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+} // namespace
+
+TEST_CASE("Flat Hash Map Heterogeneous Lookup Test 1") {
+  container::flat_hash_map<std::string, int, string_hash, std::equal_to<>> m;
+  for (int i = 0; i < 100; i++) {
+    m.try_emplace("key" + std::to_string(i), i);
+  }
+  // std::stringを作らずにstd::string_viewや文字列リテラルで探せる
+  REQUIRE(m.find(std::string_view("key42")) == std::make_optional(42));
+  REQUIRE(m.contains("key99"));
+  REQUIRE_FALSE(m.contains("key100"));
+  REQUIRE(m.erase(std::string_view("key0")) == std::make_optional(0));
+  REQUIRE(m.size() == 99);
+  REQUIRE(*m.get(std::string("key7")) == 7);
+}
@@ -0,0 +1,116 @@
+//
+// flat_hash_map と std::unordered_map の比較ベンチマーク
+//
+// 8バイトの整数キーと、16〜32文字の文字列キーのそれぞれについて、
+// n 個の挿入、存在するキーの探索、存在しないキーの探索、全ての削除にかかる1操作あたりの時間を測る
+//
+// usage: flat_hash_map_bench [キー数(既定 1000000)]
+//
+
+#include "container/flat_hash_map.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+template <class F> double measure_ns(std::size_t n, F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::nano>(e - s).count() / n;
+}
+
+/**< @brief flat_hash_mapへの操作 */
+template <class Key> struct flat_ops {
+  container::flat_hash_map<Key, std::uint64_t> m;
+  void insert(const Key &k, std::uint64_t v) { m.insert(k, v); }
+  std::uint64_t find(const Key &k) const {
+    const std::uint64_t *p = m.get(k);
+    return p == nullptr ? 0 : *p;
+  }
+  void erase(const Key &k) { m.erase(k); }
+};
+
+/**< @brief std::unordered_mapへの操作 */
+template <class Key> struct std_ops {
+  std::unordered_map<Key, std::uint64_t> m;
+  void insert(const Key &k, std::uint64_t v) { m.insert_or_assign(k, v); }
+  std::uint64_t find(const Key &k) const {
+    auto it = m.find(k);
+    return it == m.end() ? 0 : it->second;
+  }
+  void erase(const Key &k) { m.erase(k); }
+};
+
+/**< @brief keysを挿入してから、hitsとmissesを探索し、keysを削除する */
+template <class Ops, class Key>
+void run(const char *name, const std::vector<Key> &keys,
+         const std::vector<Key> &hits, const std::vector<Key> &misses) {
+  Ops ops;
+  std::uint64_t sum = 0;
+  const double insert = measure_ns(keys.size(), [&] {
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      ops.insert(keys[i], i);
+    }
+  });
+  const double hit = measure_ns(hits.size(), [&] {
+    for (const Key &k : hits) {
+      sum += ops.find(k);
+    }
+  });
+  const double miss = measure_ns(misses.size(), [&] {
+    for (const Key &k : misses) {
+      sum += ops.find(k);
+    }
+  });
+  const double erase = measure_ns(keys.size(), [&] {
+    for (const Key &k : keys) {
+      ops.erase(k);
+    }
+  });
+  std::printf("%-22s %10.1f %10.1f %10.1f %10.1f   (%llu)\n", name, insert,
+              hit, miss, erase, static_cast<unsigned long long>(sum & 0xff));
+}
+
+template <class Key, class Gen>
+void run_all(const char *flat, const char *std, std::size_t n, Gen gen) {
+  std::mt19937_64 rng(1);
+  std::vector<Key> keys, misses;
+  for (std::size_t i = 0; i < n; i++) {
+    keys.push_back(gen(rng));
+    misses.push_back(gen(rng));
+  }
+  std::vector<Key> hits = keys;
+  std::shuffle(hits.begin(), hits.end(), rng);
+  run<flat_ops<Key>>(flat, keys, hits, misses);
+  run<std_ops<Key>>(std, keys, hits, misses);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  std::printf("%-22s %10s %10s %10s %10s (ns/op)\n", "map", "insert", "hit",
+              "miss", "erase");
+  run_all<std::uint64_t>("flat_hash_map<u64>", "unordered_map<u64>", n,
+                         [](std::mt19937_64 &rng) { return rng(); });
+  run_all<std::string>("flat_hash_map<string>", "unordered_map<string>", n,
+                       [](std::mt19937_64 &rng) {
+                         std::string s(16 + rng() % 17, ' ');
+                         for (char &c : s) {
+                           c = 'a' + rng() % 26;
+                         }
+                         return s;
+                       });
+  return 0;
+}
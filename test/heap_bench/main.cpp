@@ -0,0 +1,150 @@
+//
+// skew_heap, pairing_heap, dary_heap の比較ベンチマーク
+//
+// dijkstra : 頂点数 n、各頂点から4本の辺を持つランダムなグラフでの最短経路(遅延削除)
+// astar    : 辺の重みがランダムな sqrt(n) x sqrt(n) の格子での A* 探索(マンハッタン距離)
+// 操作数(push + pop)がおよそ 1e4 から 1e7 になるよう n を変える
+//
+// usage: heap_bench [最大頂点数(既定 2e6)]
+//
+
+#include "container/dary_heap.hpp"
+#include "container/pairing_heap.hpp"
+#include "container/skew_heap.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using dist_t = std::uint64_t;
+using clock_type = std::chrono::steady_clock;
+
+constexpr dist_t inf = std::numeric_limits<dist_t>::max();
+
+/**< @brief ヒープの要素(推定距離と頂点) */
+struct item_t {
+  dist_t f = 0;        /**< 始点からの距離 + 終点までの距離の下界 */
+  std::uint32_t u = 0; /**< 頂点 */
+  bool operator<(const item_t &rhs) const noexcept { return f < rhs.f; }
+};
+
+struct edge {
+  std::uint32_t to; /**< 行き先 */
+  dist_t w;         /**< 重み */
+};
+using graph_t = std::vector<std::vector<edge>>;
+
+/**< @brief 頂点数n、各頂点から出る辺がd本のランダムなグラフを作る */
+graph_t random_graph(std::size_t n, std::size_t d, std::mt19937 &rng) {
+  graph_t g(n);
+  for (std::size_t u = 0; u < n; u++) {
+    for (std::size_t i = 0; i < d; i++) {
+      g[u].push_back(edge{static_cast<std::uint32_t>(rng() % n), rng() % 1000});
+    }
+  }
+  return g;
+}
+
+/**< @brief w x wの格子で、隣り合う頂点を重み1〜9の辺で結んだグラフを作る */
+graph_t grid_graph(std::size_t w, std::mt19937 &rng) {
+  graph_t g(w * w);
+  for (std::size_t y = 0; y < w; y++) {
+    for (std::size_t x = 0; x < w; x++) {
+      const std::size_t u = y * w + x;
+      auto add = [&](std::size_t v) {
+        g[u].push_back(edge{static_cast<std::uint32_t>(v), 1 + rng() % 9});
+      };
+      if (x > 0) add(u - 1);
+      if (x + 1 < w) add(u + 1);
+      if (y > 0) add(u - w);
+      if (y + 1 < w) add(u + w);
+    }
+  }
+  return g;
+}
+
+/**
+ * @brief 始点sから終点tへの最短距離を求める(t == 頂点数なら全頂点)
+ * @param h 頂点vの終点までの距離の下界(Dijkstraなら0)
+ * @param ops push, popの回数を加算する
+ */
+template <class Heap, class H>
+dist_t search(const graph_t &g, std::uint32_t s, std::uint32_t t, H h,
+              std::size_t &ops) {
+  std::vector<dist_t> d(g.size(), inf);
+  Heap q(g.size());
+  d[s] = 0;
+  q.push(item_t{h(s), s});
+  ops++;
+  while (auto top = q.pop()) {
+    ops++;
+    const auto [f, u] = *top;
+    if (f - h(u) != d[u]) {
+      continue;
+    } // 古い項目は読み飛ばす(遅延削除)
+    if (u == t) {
+      break;
+    }
+    for (const edge &e : g[u]) {
+      if (d[u] + e.w < d[e.to]) {
+        d[e.to] = d[u] + e.w;
+        q.push(item_t{d[e.to] + h(e.to), e.to});
+        ops++;
+      }
+    }
+  }
+  return t < g.size() ? d[t] : d[g.size() - 1];
+}
+
+template <class Heap, class H>
+void run(const char *name, const char *workload, const graph_t &g,
+         std::uint32_t s, std::uint32_t t, H h) {
+  std::size_t ops = 0;
+  const auto b = clock_type::now();
+  const dist_t r = search<Heap>(g, s, t, h, ops);
+  const auto e = clock_type::now();
+  const double ms = std::chrono::duration<double, std::milli>(e - b).count();
+  std::printf("%-10s %-8s %10zu %10zu %10.2f %8.1f   (%llu)\n", workload, name,
+              g.size(), ops, ms, ms * 1e6 / ops,
+              static_cast<unsigned long long>(r));
+}
+
+template <class H>
+void run_all(const char *workload, const graph_t &g, std::uint32_t s,
+             std::uint32_t t, H h) {
+  run<container::skew_heap<item_t>>("skew", workload, g, s, t, h);
+  run<container::pairing_heap<item_t>>("pairing", workload, g, s, t, h);
+  run<container::dary_heap<item_t, 2>>("binary", workload, g, s, t, h);
+  run<container::dary_heap<item_t, 4>>("4-ary", workload, g, s, t, h);
+  run<container::dary_heap<item_t, 8>>("8-ary", workload, g, s, t, h);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+  std::mt19937 rng(42);
+  std::printf("%-10s %-8s %10s %10s %10s %8s\n", "workload", "heap",
+              "vertices", "ops", "[ms]", "[ns/op]");
+  for (std::size_t n = 2000; n <= max_n; n *= 10) {
+    const graph_t g = random_graph(n, 4, rng);
+    run_all("dijkstra", g, 0, static_cast<std::uint32_t>(n),
+            [](std::uint32_t) { return dist_t(0); });
+
+    const std::size_t w = static_cast<std::size_t>(std::sqrt(n));
+    const graph_t grid = grid_graph(w, rng);
+    const std::uint32_t t = static_cast<std::uint32_t>(w * w - 1);
+    run_all("astar", grid, 0, t, [w, t](std::uint32_t v) {
+      const std::size_t x = v % w, y = v / w;
+      return dist_t((w - 1 - x) + (w - 1 - y)); // 辺の重みは1以上なので下界
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "bit/hierarchical_bitmap.hpp"
+#include <random>
+#include <set>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Hierarchical Bitmap Test 1") {
+  bit::hierarchical_bitmap<> b(100);
+  REQUIRE(b.levels() == 2);
+  REQUIRE(b.none());
+  REQUIRE_FALSE(b.find_first());
+  b.set(70);
+  b.set(3);
+  b.set(3);
+  REQUIRE(b.count() == 2);
+  REQUIRE(b.test(70));
+  REQUIRE_FALSE(b.test(71));
+  REQUIRE(b.find_first() == 3);
+  REQUIRE(b.find_next(4) == 70);
+  REQUIRE(b.find_next(70) == 70);
+  REQUIRE_FALSE(b.find_next(71));
+  b.reset(3);
+  b.reset(3);
+  REQUIRE(b.count() == 1);
+  REQUIRE(b.find_first() == 70);
+  b.set();
+  REQUIRE(b.count() == 100);
+  REQUIRE_FALSE(b.find_next(100));
+  b.reset();
+  REQUIRE(b.none());
+}
+
+TEST_CASE("Hierarchical Bitmap Test 2") {
+  constexpr std::size_t n = 300'000; // 4段
+  bit::hierarchical_bitmap<> b(n);
+  REQUIRE(b.levels() == 4);
+  std::set<std::size_t> s;
+  std::mt19937 rng(1);
+  for (int i = 0; i < 20000; i++) {
+    const std::size_t x = rng() % n;
+    if (rng() % 3 == 0) {
+      b.reset(x);
+      s.erase(x);
+    } else {
+      b.set(x);
+      s.insert(x);
+    }
+    if (i % 100 == 0) {
+      const std::size_t y = rng() % n;
+      auto it = s.lower_bound(y);
+      if (it == s.end()) {
+        REQUIRE_FALSE(b.find_next(y));
+      } else {
+        REQUIRE(b.find_next(y) == *it);
+      }
+    }
+  }
+  REQUIRE(b.count() == s.size());
+  REQUIRE(b.find_first() == *s.begin());
+  std::size_t k = 0;
+  auto it = s.begin();
+  bool same = true;
+  b.for_each([&](std::size_t i) {
+    same = same && it != s.end() && *it++ == i;
+    k++;
+  });
+  REQUIRE(same);
+  REQUIRE(k == s.size());
+  for (std::size_t x : s) { // 全て消すと上の段も空になる
+    b.reset(x);
+  }
+  REQUIRE_FALSE(b.find_first());
+  REQUIRE_FALSE(b.find_next(0));
+}
+
+TEST_CASE("Hierarchical Bitmap Resize Test 1") {
+  bit::hierarchical_bitmap<> b(10, true);
+  REQUIRE(b.count() == 10);
+  b.resize(5000, true);
+  REQUIRE(b.count() == 5000);
+  REQUIRE(b.levels() == 3);
+  b.reset(4999);
+  b.resize(100);
+  REQUIRE(b.count() == 100);
+  REQUIRE(b.levels() == 2);
+  b.resize(200);
+  REQUIRE(b.count() == 100);
+  REQUIRE_FALSE(b.find_next(100));
+}
+
+TEST_CASE("Bitmap Allocator Test 1") {
+  bit::bitmap_allocator<> a(130);
+  for (std::size_t i = 0; i < 130; i++) {
+    REQUIRE(a.allocate() == i); // 小さい番号から割り当てる
+  }
+  REQUIRE_FALSE(a.allocate());
+  REQUIRE(a.live() == 130);
+  a.deallocate(100);
+  a.deallocate(7);
+  a.deallocate(64);
+  REQUIRE(a.free() == 3);
+  REQUIRE(a.allocate() == 7);
+  REQUIRE(a.allocate() == 64);
+  REQUIRE(a.allocate() == 100);
+  REQUIRE_FALSE(a.allocate());
+  a.grow(200);
+  REQUIRE(a.allocate() == 130);
+  REQUIRE(a.allocated(130));
+  REQUIRE_FALSE(a.allocated(131));
+  REQUIRE(a.capacity() == 200);
+}
@@ -0,0 +1,58 @@
+#include "container/index_pool.hpp"
+#include <new>
+#include <set>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+struct index_test_node {
+  std::uint32_t l, r;
+  int key;
+};
+
+TEST_CASE("Index Pool Allocate Deallocate Test 1") {
+  container::index_pool<index_test_node> pool(4);
+  REQUIRE(pool.capacity() == 4);
+
+  std::set<std::uint32_t> idx;
+  for (int i = 0; i < 10; i++) {
+    idx.insert(pool.allocate());
+  }
+  REQUIRE(idx.size() == 10); // 使用中の添字は重複しない
+  REQUIRE(idx.count(decltype(pool)::nil) == 0);
+  REQUIRE(pool.live() == 10);
+  REQUIRE(pool.high_water() == 10);
+
+  const std::uint32_t x = *idx.begin();
+  pool.deallocate(x);
+  REQUIRE(pool.live() == 9);
+  REQUIRE(pool.allocate() == x); // 自由リストから再利用される
+}
+
+TEST_CASE("Index Pool Exhaustion Test 1") {
+  // 添字の上限は5. 最初に上限より多く確保しようとしても上限で打ち切る
+  container::index_pool<index_test_node> pool(16, 5);
+  REQUIRE(pool.capacity() == 5);
+  for (std::uint32_t i = 1; i <= 5; i++) {
+    REQUIRE(pool.allocate() == i);
+  }
+  REQUIRE_THROWS_AS(pool.allocate(), std::bad_alloc);
+  REQUIRE(pool.live() == 5);
+
+  pool.deallocate(3); // 空きができれば再び割り当てられる
+  REQUIRE(pool.allocate() == 3);
+  REQUIRE_THROWS_AS(pool.allocate(), std::bad_alloc);
+  REQUIRE_THROWS_AS(pool.reserve(6), std::bad_alloc);
+}
+
+TEST_CASE("Index Pool Exhaustion Test 2") {
+  // 倍々に確保し直した末に上限へ達する場合
+  container::index_pool<index_test_node> pool(1, 6);
+  for (std::uint32_t i = 1; i <= 6; i++) {
+    REQUIRE(pool.allocate() == i);
+  }
+  REQUIRE(pool.capacity() == 6);
+  REQUIRE_THROWS_AS(pool.allocate(), std::bad_alloc);
+  REQUIRE(pool.live() == 6);
+  REQUIRE(pool.high_water() == 6);
+}
@@ -0,0 +1,132 @@
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief 大きさnの様々な並びの配列を作る */
+std::vector<std::vector<std::uint32_t>> patterns(std::size_t n) {
+  std::mt19937 mt(static_cast<std::uint32_t>(n));
+  std::vector<std::uint32_t> random(n), sorted(n), reversed(n), few(n),
+      organ(n), equal(n, 7);
+  for (std::size_t i = 0; i < n; i++) {
+    random[i] = mt();
+    sorted[i] = static_cast<std::uint32_t>(i);
+    reversed[i] = static_cast<std::uint32_t>(n - i);
+    few[i] = mt() % 4;
+    organ[i] = static_cast<std::uint32_t>(i < n / 2 ? i : n - i);
+  }
+  return {random, sorted, reversed, few, organ, equal};
+}
+
+/**< @brief レコード(キーが同じものは順序を問わない) */
+struct record {
+  std::uint32_t key;
+  std::string name;
+};
+
+} // namespace
+
+TEST_CASE("Intro Sort Sequential Test 1") {
+  for (std::size_t n : {0, 1, 2, 15, 16, 17, 100, 1000, 100000}) {
+    for (auto v : patterns(n)) {
+      auto w = v;
+      std::sort(w.begin(), w.end());
+      intro_sort(v.begin(), v.end());
+      REQUIRE(v == w);
+    }
+  }
+}
+
+TEST_CASE("Intro Sort Sequential Test 2") {
+  // 分岐の無い分割(算術型)と交換による分割(レコード)の両方で、パターンを見つけて手を抜く経路を通る
+  const auto by_key = [](const record &a, const record &b) {
+    return a.key < b.key;
+  };
+  for (std::size_t n : {129, 1000, 100000}) {
+    auto ps = patterns(n);
+    auto nearly = ps[1]; // 昇順の配列のところどころを入れ替えた配列
+    for (std::size_t i = 0; i + 7 < n; i += 97) {
+      std::swap(nearly[i], nearly[i + 7]);
+    }
+    ps.push_back(nearly);
+    for (auto v : ps) {
+      auto w = v;
+      std::sort(w.begin(), w.end(), std::greater<>());
+      auto u = v;
+      intro_sort(u.begin(), u.end(), std::greater<>());
+      REQUIRE(u == w);
+
+      std::vector<record> r(n);
+      for (std::size_t i = 0; i < n; i++) {
+        r[i] = record{v[i] % 1000, std::to_string(v[i] % 1000)};
+      }
+      intro_sort(r.begin(), r.end(), by_key);
+      REQUIRE(std::is_sorted(r.begin(), r.end(), by_key));
+      REQUIRE(std::all_of(r.begin(), r.end(), [](const record &x) {
+        return x.name == std::to_string(x.key);
+      }));
+    }
+  }
+}
+
+TEST_CASE("Intro Sort Parallel Test 1") {
+  // 並列の分割と逐次の分割の両方を通る大きさ
+  for (std::size_t threads : {1, 2, 3, 4}) {
+    container::task_pool pool(threads);
+    for (std::size_t n : {10, 20000, 70000, 300000, 1000000}) {
+      for (auto v : patterns(n)) {
+        auto w = v;
+        std::sort(w.begin(), w.end());
+        intro_sort(sort::execution::par.on(pool), v.begin(), v.end());
+        REQUIRE(v == w);
+      }
+    }
+  }
+}
+
+TEST_CASE("Intro Sort Parallel Test 2") {
+  // 比較述語とポリシーの指定の仕方
+  std::mt19937 mt(1);
+  std::vector<std::int64_t> v(500000);
+  for (auto &x : v) {
+    x = static_cast<std::int64_t>(mt()) - (1LL << 31);
+  }
+  auto w = v;
+  std::sort(w.begin(), w.end(), std::greater<>());
+  auto u = v;
+  intro_sort(sort::execution::par, u.begin(), u.end(), std::greater<>());
+  REQUIRE(u == w);
+  u = v;
+  intro_sort(sort::execution::par(3), u.begin(), u.end(), std::greater<>());
+  REQUIRE(u == w);
+  u = v;
+  intro_sort(sort::execution::seq, u.begin(), u.end(), std::greater<>());
+  REQUIRE(u == w);
+}
+
+TEST_CASE("Intro Sort Parallel Test 3") {
+  // 要素が重いレコードをキーで並べる
+  std::mt19937 mt(2);
+  std::vector<record> v(200000);
+  for (auto &r : v) {
+    r.key = mt() % 1000;
+    r.name = std::to_string(r.key);
+  }
+  container::task_pool pool(4);
+  intro_sort(sort::execution::par.on(pool), v.begin(), v.end(),
+             [](const record &a, const record &b) { return a.key < b.key; });
+  REQUIRE(std::is_sorted(
+      v.begin(), v.end(),
+      [](const record &a, const record &b) { return a.key < b.key; }));
+  REQUIRE(std::all_of(v.begin(), v.end(), [](const record &r) {
+    return r.name == std::to_string(r.key);
+  }));
+}
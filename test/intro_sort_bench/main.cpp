@@ -0,0 +1,97 @@
+//
+// 並列イントロソートのスレッド数に対するスケーリングのベンチマーク
+//
+// 64ビットのキーと8バイトの中身を持つ16バイトのレコード n 個を、逐次の std::sort と
+// intro_sort、ワーカー数 1, 2, 4, ... の並列 intro_sort でソートした時間を測り、
+// std::sort に対する速度比を表示する
+//
+// usage: intro_sort_bench [レコード数(既定 10000000)] [最大スレッド数(既定 ハードウェアの並列数)]
+//
+
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief 描画やリプレイのレコード */
+struct record {
+  std::uint64_t key;
+  std::uint32_t id;
+  std::uint32_t payload;
+};
+
+inline bool by_key(const record &a, const record &b) noexcept {
+  return a.key < b.key;
+}
+
+/**< @brief 元の配列をコピーしてfでソートし、時間(ms)を返す(3回の最小値) */
+template <class F>
+double measure_ms(const std::vector<record> &src, std::vector<record> &v, F f) {
+  double best = 1e300;
+  for (int round = 0; round < 3; round++) {
+    v = src;
+    const auto t0 = clock_type::now();
+    f(v);
+    const auto t1 = clock_type::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    if (!std::is_sorted(v.begin(), v.end(), by_key)) {
+      std::printf("not sorted!\n");
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                 : 10000000;
+  const std::size_t max_threads =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+
+  std::mt19937_64 mt(12345);
+  std::vector<record> src(n), v;
+  for (std::size_t i = 0; i < n; i++) {
+    src[i] = record{mt(), static_cast<std::uint32_t>(i), 0};
+  }
+
+  const double base = measure_ms(src, v, [](std::vector<record> &x) {
+    std::sort(x.begin(), x.end(), by_key);
+  });
+  std::printf("%zu records, %zu hardware threads\n", n,
+              static_cast<std::size_t>(std::thread::hardware_concurrency()));
+  std::printf("%-24s %10.1f ms  x%.2f\n", "std::sort", base, 1.0);
+  const double seq = measure_ms(src, v, [](std::vector<record> &x) {
+    intro_sort(x.begin(), x.end(), by_key);
+  });
+  std::printf("%-24s %10.1f ms  x%.2f\n", "intro_sort", seq, base / seq);
+
+  std::uint64_t sink = 0;
+  for (std::size_t t = 1;; t = std::min(2 * t, max_threads)) {
+    container::task_pool pool(t);
+    const double ms = measure_ms(src, v, [&](std::vector<record> &x) {
+      intro_sort(sort::execution::par.on(pool), x.begin(), x.end(), by_key);
+    });
+    char name[32];
+    std::snprintf(name, sizeof(name), "intro_sort(par, %zu)", t);
+    std::printf("%-24s %10.1f ms  x%.2f\n", name, ms, base / ms);
+    sink += v[n / 2].id;
+    if (t == max_threads) {
+      break;
+    }
+  }
+  std::printf("(sink %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include "experimental/allocator/je_resource.hpp"
+#include "memory/frame_arena.hpp"
+#include "memory/pool_resource.hpp"
+#include <cstdint>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Jemalloc Resource Test 1") {
+  je::memory_resource r;
+  void *p = r.allocate(100, 64);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+  REQUIRE(r.stats().bytes_in_use() == 100);
+  r.deallocate(p, 100, 64);
+  REQUIRE(r.stats().live() == 0);
+  REQUIRE(r.stats().upstream_bytes == 0);
+  REQUIRE(r.is_equal(*je::get_resource())); // 互いに交換可能
+}
+
+TEST_CASE("Jemalloc Upstream Test 1") {
+  je::memory_resource r;
+  {
+    memory::pool_resource pool(64 * 1024, &r);
+    memory::frame_arena arena(64 * 1024, &pool);
+    std::vector<int, boost::container::pmr::polymorphic_allocator<int>> v(
+        &arena);
+    for (int i = 0; i < 10000; i++) {
+      v.push_back(i);
+    }
+    REQUIRE(r.stats().upstream_bytes > 0);
+  }
+  REQUIRE(r.stats().upstream_bytes == 0);
+}
@@ -0,0 +1,230 @@
+#include "container/skew_heap.hpp"
+#include "container/stack.hpp"
+#include "memory/frame_arena.hpp"
+#include "memory/pool_resource.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace pmr = boost::container::pmr;
+
+TEST_CASE("Frame Arena Test 1") {
+  memory::frame_arena arena(1024, pmr::new_delete_resource());
+  REQUIRE(arena.blocks() == 0);
+
+  void *a = arena.allocate(10, 1);
+  void *b = arena.allocate(8, 8);
+  void *c = arena.allocate(64, 64);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(b) % 8 == 0);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(c) % 64 == 0);
+  REQUIRE(static_cast<char *>(b) >= static_cast<char *>(a) + 10);
+  REQUIRE(arena.blocks() == 1);
+  arena.deallocate(b, 8, 8); // 何もしない
+  const memory::resource_stats s = arena.stats();
+  REQUIRE(s.allocations == 3);
+  REQUIRE(s.deallocations == 1);
+  REQUIRE(s.bytes_in_use() == 74);
+  REQUIRE(s.upstream_bytes >= 1024);
+
+  arena.allocate(4000, 8); // ブロックより大きな要求は専用のブロックになる
+  REQUIRE(arena.blocks() == 2);
+  const std::size_t peak = arena.peak();
+  REQUIRE(peak >= 4082);
+
+  arena.reset();
+  REQUIRE(arena.used() == 0);
+  REQUIRE(arena.stats().bytes_in_use() == 0);
+  REQUIRE(arena.allocate(10, 1) == a); // 先頭のブロックから再利用される
+  arena.allocate(2000, 8);             // 前のフレームのブロックを使う
+  REQUIRE(arena.blocks() == 2);
+  REQUIRE(arena.peak() == peak);
+
+  arena.release();
+  REQUIRE(arena.blocks() == 0);
+  REQUIRE(arena.stats().upstream_bytes == 0);
+}
+
+TEST_CASE("Frame Arena Container Test 1") {
+  memory::frame_arena arena(4096, pmr::new_delete_resource());
+  std::size_t upstream = 0;
+  for (int frame = 0; frame < 10; frame++) {
+    {
+      memory::scoped_default_resource guard(&arena);
+      container::stack<int> s(100);
+      container::skew_heap<int> h;
+      for (int i = 0; i < 100; i++) {
+        s.push(i);
+        h.push(100 - i);
+      }
+      REQUIRE(s.pop() == 99);
+      REQUIRE(h.pop() == 1);
+    }
+    REQUIRE(pmr::get_default_resource() != &arena);
+    if (frame == 0) {
+      upstream = arena.stats().upstream_bytes;
+    }
+    arena.reset();
+  }
+  // 最初のフレームで借りたブロックを使い回すので、上流への要求は増えない
+  REQUIRE(arena.stats().upstream_bytes == upstream);
+  REQUIRE(arena.stats().allocations > 10);
+}
+
+TEST_CASE("Double Frame Arena Test 1") {
+  memory::double_frame_arena arenas(256, pmr::new_delete_resource());
+  int *prev = nullptr;
+  for (int frame = 0; frame < 100; frame++) {
+    int *p = static_cast<int *>(arenas.current().allocate(sizeof(int) * 16));
+    for (int i = 0; i < 16; i++) {
+      p[i] = frame;
+    }
+    if (prev != nullptr) { // 前のフレームのデータは残っている
+      for (int i = 0; i < 16; i++) {
+        REQUIRE(prev[i] == frame - 1);
+      }
+    }
+    prev = p;
+    arenas.flip();
+  }
+  REQUIRE(arenas.current().blocks() == 1);
+  REQUIRE(arenas.previous().blocks() == 1);
+  REQUIRE(arenas.stats().allocations == 100);
+}
+
+TEST_CASE("Pool Resource Test 1") {
+  REQUIRE(memory::pool_resource::class_of(1) == 0);
+  REQUIRE(memory::pool_resource::class_of(8) == 0);
+  REQUIRE(memory::pool_resource::class_of(9) == 1);
+  REQUIRE(memory::pool_resource::class_of(16) == 1);
+  REQUIRE(memory::pool_resource::class_of(4096) == 9);
+
+  memory::pool_resource pool(4096, pmr::new_delete_resource());
+  std::set<void *> ps;
+  for (int i = 0; i < 1000; i++) {
+    void *p = pool.allocate(24, 8);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 8 == 0);
+    ps.insert(p);
+  }
+  REQUIRE(ps.size() == 1000);
+  REQUIRE(pool.chunks() == 8); // 4096 / 32 = 128個ずつ
+  void *x = *ps.begin();
+  pool.deallocate(x, 24, 8);
+  REQUIRE(pool.allocate(24, 8) == x); // 同じクラスの自由リストから再利用される
+
+  void *big = pool.allocate(10000, 16); // 上流へそのまま渡す
+  memory::resource_stats s = pool.stats();
+  REQUIRE(s.allocations == 1002);
+  REQUIRE(s.deallocations == 1);
+  REQUIRE(s.upstream_bytes == 8 * 4096 + 10000);
+  pool.deallocate(big, 10000, 16);
+  for (void *p : ps) {
+    pool.deallocate(p, 24, 8);
+  }
+  s = pool.stats();
+  REQUIRE(s.live() == 0);
+  REQUIRE(s.bytes_in_use() == 0);
+
+  pool.release();
+  REQUIRE(pool.chunks() == 0);
+  REQUIRE(pool.stats().upstream_bytes == 0);
+  ps.clear();
+  for (int i = 0; i < 200; i++) { // releaseの後も使える
+    ps.insert(pool.allocate(24, 8));
+  }
+  REQUIRE(ps.size() == 200);
+}
+
+TEST_CASE("Pool Resource Thread Test 1") {
+  memory::pool_resource pool(64 * 1024, pmr::new_delete_resource());
+  constexpr int threads = 4, n = 20000;
+  std::atomic<int> errors = 0;
+  std::vector<std::thread> ts;
+  for (int t = 0; t < threads; t++) {
+    ts.emplace_back([&, t] {
+      std::vector<std::uint64_t *> ps;
+      for (int i = 0; i < n; i++) {
+        const std::size_t bytes = 8 * (1 + (i + t) % 64);
+        auto *p = static_cast<std::uint64_t *>(pool.allocate(bytes, 8));
+        p[0] = static_cast<std::uint64_t>(t) << 32 | i;
+        p[bytes / 8 - 1] = p[0];
+        ps.push_back(p);
+        if (i % 3 == 2) { // 一部は確保した順に返す
+          std::uint64_t *q = ps[ps.size() - 3];
+          const int j = static_cast<int>(q[0] & 0xffffffff);
+          const std::size_t qb = 8 * (1 + (j + t) % 64);
+          if (q[0] != q[qb / 8 - 1]) {
+            errors++;
+          }
+          pool.deallocate(q, qb, 8);
+          ps[ps.size() - 3] = nullptr;
+        }
+      }
+      for (std::uint64_t *p : ps) {
+        if (p != nullptr) {
+          const int j = static_cast<int>(p[0] & 0xffffffff);
+          const std::size_t bytes = 8 * (1 + (j + t) % 64);
+          if (p[0] != p[bytes / 8 - 1] || (p[0] >> 32) != std::uint64_t(t)) {
+            errors++;
+          }
+          pool.deallocate(p, bytes, 8);
+        }
+      }
+    });
+  }
+  for (auto &t : ts) {
+    t.join();
+  }
+  REQUIRE(errors == 0);
+  const memory::resource_stats s = pool.stats();
+  REQUIRE(s.allocations == threads * n);
+  REQUIRE(s.live() == 0);
+}
+
+TEST_CASE("Pool Resource Thread Test 2") {
+  // 同じスレッドで枠の数より多くのプールを交互に使っても、追い出された自由リストは再利用される
+  std::vector<std::unique_ptr<memory::pool_resource>> pools;
+  for (int i = 0; i < 6; i++) {
+    pools.push_back(std::make_unique<memory::pool_resource>(
+        64 * 1024, pmr::new_delete_resource()));
+  }
+  for (int i = 0; i < 1000; i++) {
+    for (auto &pool : pools) {
+      void *p = pool->allocate(32, 8);
+      pool->deallocate(p, 32, 8);
+    }
+  }
+  for (auto &pool : pools) {
+    REQUIRE(pool->chunks() == 1);
+  }
+
+  // 終了したスレッドの自由リストも再利用される
+  memory::pool_resource &pool = *pools.front();
+  for (int t = 0; t < 100; t++) {
+    std::thread([&] {
+      void *p = pool.allocate(32, 8);
+      pool.deallocate(p, 32, 8);
+    }).join();
+  }
+  REQUIRE(pool.chunks() == 1);
+  REQUIRE(pool.stats().live() == 0);
+}
+
+TEST_CASE("Pool Resource Container Test 1") {
+  memory::pool_resource pool;
+  {
+    std::vector<int, pmr::polymorphic_allocator<int>> v(&pool);
+    for (int i = 0; i < 1000; i++) {
+      v.push_back(i);
+    }
+    REQUIRE(v[999] == 999);
+    REQUIRE(pool.stats().live() == 1);
+  }
+  REQUIRE(pool.stats().live() == 0);
+  REQUIRE(pool.stats().allocations > 1);
+}
@@ -0,0 +1,136 @@
+#include "container/mpmc_queue.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("MPMC Queue Push Pop Test 1") {
+  container::mpmc_queue<int> q(3);
+  REQUIRE(q.capacity() == 4);
+  REQUIRE(q.empty());
+  REQUIRE(q.try_push(1));
+  REQUIRE(q.try_push(2));
+  q.push(3);
+  q.spin_push(4);
+  REQUIRE_FALSE(q.try_push(5));
+  REQUIRE(q.size() == 4);
+  REQUIRE(q.try_pop() == std::make_optional(1));
+  int x = 0;
+  REQUIRE(q.try_pop(x));
+  REQUIRE(x == 2);
+  REQUIRE(q.pop() == 3);
+  REQUIRE(q.spin_pop() == 4);
+  REQUIRE(q.try_pop() == std::nullopt);
+  REQUIRE_FALSE(q.try_pop(x));
+  for (int round = 0; round < 10; round++) { // リングを何周かさせる
+    REQUIRE(q.try_push(round));
+    REQUIRE(q.try_pop() == std::make_optional(round));
+  }
+}
+
+TEST_CASE("MPMC Queue Non Trivial Test 1") {
+  container::mpmc_queue<std::string> q(4);
+  q.push("alpha");
+  q.push(std::string(64, 'x'));
+  q.push("gamma");
+  REQUIRE(q.pop() == "alpha");
+  // 残りの要素はデストラクタで破棄される
+}
+
+namespace {
+
+/**
+ * @brief producers個の生産者とconsumers個の消費者でn個ずつ受け渡す
+ * @note  要素は(生産者の番号, 通し番号)で、各消費者が受け取る同じ生産者の要素は
+ *        通し番号の昇順でなければならない(FIFO). 全ての要素がちょうど1回ずつ受け取られることも確かめる
+ */
+template <class Push, class Pop>
+void stress(std::size_t producers, std::size_t consumers, std::uint32_t n,
+            Push push, Pop pop) {
+  container::mpmc_queue<std::uint64_t> q(64);
+  std::atomic<std::uint64_t> mismatch = 0, sum = 0;
+  std::vector<std::thread> ts;
+  for (std::size_t c = 0; c < consumers; c++) {
+    ts.emplace_back([&, c] {
+      std::vector<std::int64_t> last(producers, -1);
+      std::uint64_t s = 0;
+      const std::size_t m = producers * n / consumers +
+                            (c < producers * n % consumers ? 1 : 0);
+      for (std::size_t i = 0; i < m; i++) {
+        const std::uint64_t x = pop(q);
+        const std::size_t p = x >> 32;
+        const std::int64_t seq = x & 0xffffffff;
+        if (p >= producers || seq <= last[p]) {
+          mismatch++;
+        } else {
+          last[p] = seq;
+        }
+        s += seq;
+      }
+      sum += s;
+    });
+  }
+  for (std::size_t p = 0; p < producers; p++) {
+    ts.emplace_back([&, p] {
+      for (std::uint32_t i = 0; i < n; i++) {
+        push(q, (std::uint64_t{p} << 32) | i);
+      }
+    });
+  }
+  for (auto &t : ts) {
+    t.join();
+  }
+  REQUIRE(mismatch == 0);
+  REQUIRE(sum == producers * (std::uint64_t{n} * (n - 1) / 2));
+  REQUIRE(q.empty());
+}
+
+} // namespace
+
+TEST_CASE("MPMC Queue Blocking Stress Test 1") {
+  stress(
+      4, 3, 100'000, [](auto &q, std::uint64_t x) { q.push(x); },
+      [](auto &q) { return q.pop(); });
+}
+
+TEST_CASE("MPMC Queue Try Stress Test 1") {
+  stress(
+      3, 4, 100'000,
+      [](auto &q, std::uint64_t x) {
+        while (!q.try_push(x)) {
+          std::this_thread::yield();
+        }
+      },
+      [](auto &q) {
+        std::uint64_t x;
+        while (!q.try_pop(x)) {
+          std::this_thread::yield();
+        }
+        return x;
+      });
+}
+
+TEST_CASE("MPMC Queue Mixed Stress Test 1") {
+  // 位置を先に確保する変種と、CASで確保する変種を混ぜても受け渡しが壊れない
+  std::atomic<std::size_t> turn = 0;
+  stress(
+      2, 2, 50'000,
+      [&](auto &q, std::uint64_t x) {
+        if (turn++ % 2 == 0) {
+          q.push(x);
+        } else {
+          while (!q.try_push(x)) {
+            std::this_thread::yield();
+          }
+        }
+      },
+      [](auto &q) {
+        if (std::optional<std::uint64_t> x = q.try_pop(); x) {
+          return *x;
+        }
+        return q.pop();
+      });
+}
@@ -0,0 +1,140 @@
+//
+// mpmc_queue の生産者数に対するスケーリングのベンチマーク
+//
+// io_context の複数のスレッドからゲームループの1スレッドへメッセージを集める場面を想定し、
+// 1〜64個の生産者と1個の消費者で合計 n 個のメッセージを受け渡して毎秒のメッセージ数を測る
+// mutex で保護した container::queue、mpmc_queue の try 版(失敗したら yield)、
+// 眠って待つ版、スピンして待つ版を比べる
+// スピン版は、生産者と消費者の合計がコア数を超えると待つ側がタイムスライスを使い切るまで
+// 回り続けるので、コア数に収まる生産者数でだけ測る
+//
+// usage: mpmc_queue_bench [メッセージ数(既定 4000000)] [最大生産者数(既定 64)]
+//
+
+#include "container/mpmc_queue.hpp"
+#include "container/queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t capacity = 1024; /**< キューの容量 */
+
+std::atomic<std::uint64_t> sink = 0; /**< 受け取った結果を捨てられないように集める */
+
+/**< @brief mutexで保護したcontainer::queue(失敗したらyieldして再試行する) */
+struct locked_queue {
+  void push(std::uint64_t x) {
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!q.full()) {
+          q.push(x);
+          return;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+  std::uint64_t pop() {
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (std::optional<std::uint64_t> x = q.pop(); x) {
+          return *x;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+  std::mutex mtx;
+  container::queue<std::uint64_t> q{capacity};
+};
+
+/**< @brief mpmc_queueのtry版(失敗したらyieldして再試行する) */
+struct try_queue {
+  void push(std::uint64_t x) {
+    while (!q.try_push(x)) {
+      std::this_thread::yield();
+    }
+  }
+  std::uint64_t pop() {
+    std::uint64_t x;
+    while (!q.try_pop(x)) {
+      std::this_thread::yield();
+    }
+    return x;
+  }
+  container::mpmc_queue<std::uint64_t> q{capacity};
+};
+
+/**< @brief mpmc_queueの眠って待つ版 */
+struct blocking_queue {
+  void push(std::uint64_t x) { q.push(x); }
+  std::uint64_t pop() { return q.pop(); }
+  container::mpmc_queue<std::uint64_t> q{capacity};
+};
+
+/**< @brief mpmc_queueのスピンして待つ版 */
+struct spinning_queue {
+  void push(std::uint64_t x) { q.spin_push(x); }
+  std::uint64_t pop() { return q.spin_pop(); }
+  container::mpmc_queue<std::uint64_t> q{capacity};
+};
+
+/**< @brief producers個の生産者から1個の消費者へn個を受け渡し、毎秒のメッセージ数を返す */
+template <class Queue> double run(std::size_t producers, std::uint64_t n) {
+  Queue q;
+  const std::uint64_t per = n / producers;
+  const auto s = clock_type::now();
+  std::vector<std::thread> ts;
+  for (std::size_t p = 0; p < producers; p++) {
+    ts.emplace_back([&q, per] {
+      for (std::uint64_t i = 0; i < per; i++) {
+        q.push(i);
+      }
+    });
+  }
+  std::uint64_t sum = 0;
+  for (std::uint64_t i = 0; i < per * producers; i++) {
+    sum += q.pop();
+  }
+  for (auto &t : ts) {
+    t.join();
+  }
+  const auto e = clock_type::now();
+  sink += sum;
+  return per * producers / std::chrono::duration<double>(e - s).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                   : 4'000'000;
+  const std::size_t max_producers =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+  std::printf("%9s %12s %12s %12s %12s (Mmsg/s)\n", "producers", "mutex",
+              "try", "blocking", "spinning");
+  const std::size_t cores = std::thread::hardware_concurrency();
+  for (std::size_t p = 1; p <= max_producers; p *= 2) {
+    std::printf("%9zu %12.2f %12.2f %12.2f", p, run<locked_queue>(p, n) / 1e6,
+                run<try_queue>(p, n) / 1e6, run<blocking_queue>(p, n) / 1e6);
+    if (p + 1 <= cores) {
+      std::printf(" %12.2f\n", run<spinning_queue>(p, n) / 1e6);
+    } else {
+      std::printf(" %12s\n", "-");
+    }
+  }
+  std::printf("checksum: %llu\n",
+              static_cast<unsigned long long>(sink.load()));
+  return 0;
+}
@@ -0,0 +1,50 @@
+#include "container/node_pool.hpp"
+#include <set>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+struct pool_test_node {
+  pool_test_node *l, *r;
+  int key;
+};
+
+TEST_CASE("Node Pool Allocate Deallocate Test 1") {
+  container::node_pool<pool_test_node> pool(4);
+  REQUIRE(pool.capacity() == 4);
+  REQUIRE(pool.chunks() == 1);
+
+  std::set<pool_test_node *> nodes;
+  for (int i = 0; i < 10; i++) {
+    nodes.insert(pool.allocate());
+  }
+  REQUIRE(nodes.size() == 10); // 使用中のスロットは重複しない
+  REQUIRE(pool.live() == 10);
+  REQUIRE(pool.high_water() == 10);
+  REQUIRE(pool.chunks() == 2); // 4 + 8
+  REQUIRE(pool.capacity() == 12);
+
+  pool_test_node *x = *nodes.begin();
+  pool.deallocate(x);
+  REQUIRE(pool.live() == 9);
+  REQUIRE(pool.allocate() == x); // 自由リストから再利用される
+  REQUIRE(pool.chunks() == 2);
+
+  for (pool_test_node *y : nodes) {
+    pool.deallocate(y);
+  }
+  REQUIRE(pool.live() == 0);
+  REQUIRE(pool.free() == pool.capacity());
+  REQUIRE(pool.high_water() == 10);
+}
+
+TEST_CASE("Node Pool Reserve Test 1") {
+  container::node_pool<pool_test_node> pool(4);
+  pool.reserve(100);
+  REQUIRE(pool.capacity() == 100);
+  for (int i = 0; i < 100; i++) {
+    pool.allocate();
+  }
+  REQUIRE(pool.full());
+  REQUIRE(pool.chunks() == 2);
+}
@@ -0,0 +1,150 @@
+#include "container/persistent_avl_tree.hpp"
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <cmath>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace pmr = boost::container::pmr;
+
+/**< @brief 確保中の節点数を数えるメモリリソース */
+struct counting_resource : pmr::memory_resource {
+  std::atomic<long> live = 0, total = 0;
+
+  void *do_allocate(std::size_t bytes, std::size_t align) override {
+    live++;
+    total++;
+    return pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void *p, std::size_t bytes, std::size_t align) override {
+    live--;
+    pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+using tree_t = container::persistent_avl_tree<int, int>;
+
+TEST_CASE("Persistent AVL trees Insert Find Erase Test 1") {
+  tree_t t;
+  REQUIRE(t.insert(3, 30) == std::nullopt);
+  REQUIRE(t.insert(1, 10) == std::nullopt);
+  REQUIRE(t.insert(2, 20) == std::nullopt);
+  REQUIRE(t.insert(2, 21) == std::make_optional(20));
+  REQUIRE(t.find(2) == std::make_optional(21));
+  REQUIRE(t.find(4) == std::nullopt);
+  REQUIRE(t.erase(3) == std::make_optional(30));
+  REQUIRE(t.erase(3) == std::nullopt);
+  REQUIRE(t.size() == 2);
+}
+
+TEST_CASE("Persistent AVL trees Snapshot Rollback Test 1") {
+  counting_resource res;
+  {
+    tree_t t(&res);
+    std::map<int, int> m;
+    std::vector<std::pair<tree_t, std::map<int, int>>> versions;
+    std::mt19937 rng(1234);
+    for (int i = 0; i < 5000; i++) {
+      const int k = static_cast<int>(rng() % 1000);
+      if (i % 100 == 0) {
+        versions.emplace_back(t.snapshot(), m);
+        REQUIRE(versions.back().first.shares_root(t));
+      }
+      if (rng() % 3 == 0) {
+        auto it = m.find(k);
+        const auto expected =
+            it == m.end() ? std::nullopt : std::make_optional(it->second);
+        REQUIRE(t.erase(k) == expected);
+        m.erase(k);
+      } else {
+        const long before = res.total;
+        const int h = t.height();
+        t.insert(k, i);
+        m[k] = i;
+        // 経路上の節点と新たな葉、平衡化で組み替える高々2つの節点だけを確保する
+        REQUIRE(res.total - before <= h + 3);
+      }
+    }
+    REQUIRE(t.height() <= 1.4405 * std::log2(t.size() + 2));
+    for (auto &[v, vm] : versions) {
+      REQUIRE(v.size() == vm.size());
+      auto it = vm.begin();
+      v.inorder([&](const int &k, const int &x) {
+        REQUIRE(it != vm.end());
+        REQUIRE(k == it->first);
+        REQUIRE(x == it->second);
+        ++it;
+      });
+      REQUIRE(it == vm.end());
+    }
+    t = versions[10].first; // 巻き戻し
+    REQUIRE(t.size() == versions[10].second.size());
+    for (auto &[k, x] : versions[10].second) {
+      REQUIRE(t.find(k) == std::make_optional(x));
+    }
+    versions.clear();
+    REQUIRE(res.live == static_cast<long>(t.size()));
+  }
+  REQUIRE(res.live == 0);
+}
+
+TEST_CASE("Persistent AVL trees Assign Test 1") {
+  // 別のメモリリソースの版を代入しても、節点は確保したリソースへ返す
+  counting_resource ra, rb;
+  {
+    tree_t a(&ra), b(&rb), c(&rb);
+    for (int i = 0; i < 100; i++) {
+      a.insert(i, i);
+      b.insert(i, -i);
+      c.insert(i, i * 2);
+    }
+    a = std::move(b);
+    REQUIRE(ra.live == 100); // bはaの節点とリソースを受け取る
+    REQUIRE(rb.live == 200);
+    a.insert(100, 100); // 受け継いだリソースから確保する
+    b.insert(0, 0);
+    a = c;
+    REQUIRE(a.find(1) == std::make_optional(2));
+  }
+  REQUIRE(ra.live == 0);
+  REQUIRE(rb.live == 0);
+}
+
+TEST_CASE("Persistent AVL trees Concurrent Readers Test 1") {
+  counting_resource res;
+  {
+    tree_t t(&res);
+    for (int i = 0; i < 1000; i++) {
+      t.insert(i, i);
+    }
+    std::vector<std::thread> readers;
+    std::atomic<int> errors = 0;
+    for (int r = 0; r < 4; r++) {
+      readers.emplace_back([snap = t.snapshot(), &errors] {
+        for (int round = 0; round < 20; round++) {
+          long sum = 0;
+          snap.inorder([&](const int &k, const int &v) { sum += k == v; });
+          errors += sum != 1000;
+        }
+      });
+    }
+    for (int i = 0; i < 1000; i++) { // 読み手と並行して書き手が更新する
+      t.erase(i);
+      t.insert(i + 1000, -i);
+    }
+    for (auto &th : readers) {
+      th.join();
+    }
+    REQUIRE(errors == 0);
+    REQUIRE(t.size() == 1000);
+  }
+  REQUIRE(res.live == 0);
+}
@@ -0,0 +1,207 @@
+#include "memory/frame_arena.hpp"
+#include "sort/radix_sort.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief 鍵と元の位置を持つレコード(安定性の確認用) */
+struct record {
+  std::uint32_t key;
+  std::uint32_t pos;
+};
+
+/**< @brief 鍵の分布を変えたレコードの配列を作る */
+std::vector<record> records(std::size_t n, std::uint32_t mod) {
+  std::mt19937 mt(static_cast<std::uint32_t>(n) ^ mod);
+  std::vector<record> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    const std::uint32_t k = static_cast<std::uint32_t>(mt());
+    v[i] = record{mod == 0 ? k : k % mod, static_cast<std::uint32_t>(i)};
+  }
+  return v;
+}
+
+/**< @brief std::stable_sortと同じ並びになるか確かめる */
+template <class Sort> void check_stable(Sort sort) {
+  for (std::size_t n : {0, 1, 2, 63, 64, 1000, 70000, 300000}) {
+    for (std::uint32_t mod : {0u, 1u, 16u, 1u << 20}) {
+      auto v = records(n, mod);
+      auto w = v;
+      auto by_key = [](const record &a, const record &b) {
+        return a.key < b.key;
+      };
+      std::stable_sort(w.begin(), w.end(), by_key);
+      sort(v);
+      REQUIRE(std::equal(v.begin(), v.end(), w.begin(), w.end(),
+                         [](const record &a, const record &b) {
+                           return a.key == b.key && a.pos == b.pos;
+                         }));
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Radix Traits Test 1") {
+  using sort::radix_traits;
+  // 変換後の符号なし整数の順序が元の順序と一致する
+  const std::vector<float> fs = {-std::numeric_limits<float>::infinity(),
+                                 -1e30f, -1.5f, -1e-40f, -0.0f, 0.0f,
+                                 1e-40f, 1.0f, 2.5f, 1e30f,
+                                 std::numeric_limits<float>::infinity()};
+  for (std::size_t i = 1; i < fs.size(); i++) {
+    REQUIRE(radix_traits<float>::encode(fs[i - 1]) <
+            radix_traits<float>::encode(fs[i]));
+  }
+  const std::vector<double> ds = {-1e300, -2.0, -0.5, 0.0, 0.5, 2.0, 1e300};
+  for (std::size_t i = 1; i < ds.size(); i++) {
+    REQUIRE(radix_traits<double>::encode(ds[i - 1]) <
+            radix_traits<double>::encode(ds[i]));
+  }
+  REQUIRE(radix_traits<std::int32_t>::encode(-1) <
+          radix_traits<std::int32_t>::encode(0));
+  REQUIRE(radix_traits<std::int64_t>::encode(
+              std::numeric_limits<std::int64_t>::min()) == 0);
+  REQUIRE(radix_traits<std::uint16_t>::encode(7) == 7);
+}
+
+TEST_CASE("Radix Sort Integer Test 1") {
+  std::mt19937_64 mt(1);
+  for (std::size_t n : {5, 100, 100000}) {
+    std::vector<std::uint64_t> u(n);
+    std::vector<std::int32_t> s(n);
+    std::vector<std::uint8_t> b(n);
+    for (std::size_t i = 0; i < n; i++) {
+      u[i] = mt() >> (i % 3 * 20); // 上位の桁が0になる要素を混ぜる
+      s[i] = static_cast<std::int32_t>(mt());
+      b[i] = static_cast<std::uint8_t>(mt());
+    }
+    auto u2 = u, u3 = u;
+    sort::radix_sort(u.begin(), u.end());
+    sort::radix_sort<8>(u2.begin(), u2.end());
+    sort::radix_sort<16>(u3.begin(), u3.end());
+    REQUIRE(std::is_sorted(u.begin(), u.end()));
+    REQUIRE(u == u2);
+    REQUIRE(u == u3);
+    sort::radix_sort<11>(s.begin(), s.end());
+    REQUIRE(std::is_sorted(s.begin(), s.end()));
+    sort::radix_sort(b.begin(), b.end());
+    REQUIRE(std::is_sorted(b.begin(), b.end()));
+  }
+}
+
+TEST_CASE("Radix Sort Float Test 1") {
+  std::mt19937 mt(2);
+  std::normal_distribution<float> nd(0.0f, 1000.0f);
+  std::vector<float> v(200000);
+  for (auto &x : v) {
+    x = nd(mt);
+  }
+  v[0] = -0.0f;
+  v[1] = std::numeric_limits<float>::infinity();
+  auto w = v;
+  std::sort(w.begin(), w.end());
+  sort::radix_sort(v.begin(), v.end());
+  REQUIRE(v == w);
+
+  std::vector<double> d(1000);
+  for (auto &x : d) {
+    x = static_cast<double>(nd(mt)) * 1e-3;
+  }
+  sort::radix_sort(d.begin(), d.end());
+  REQUIRE(std::is_sorted(d.begin(), d.end()));
+}
+
+TEST_CASE("Radix Sort Stable Test 1") {
+  check_stable([](std::vector<record> &v) {
+    sort::radix_sort(v.begin(), v.end(), [](const record &r) { return r.key; });
+  });
+  check_stable([](std::vector<record> &v) {
+    sort::radix_sort<16>(v.begin(), v.end(),
+                         [](const record &r) { return r.key; });
+  });
+}
+
+TEST_CASE("Radix Sort Parallel Test 1") {
+  for (std::size_t threads : {1, 2, 4}) {
+    container::task_pool pool(threads);
+    check_stable([&](std::vector<record> &v) {
+      sort::radix_sort(sort::execution::par.on(pool), v.begin(), v.end(),
+                       [](const record &r) { return r.key; });
+    });
+  }
+  std::mt19937_64 mt(3);
+  std::vector<std::int64_t> v(400000);
+  for (auto &x : v) {
+    x = static_cast<std::int64_t>(mt());
+  }
+  auto w = v;
+  std::sort(w.begin(), w.end());
+  sort::radix_sort(sort::execution::par(3), v.begin(), v.end(),
+                   [](std::int64_t x) { return x; });
+  REQUIRE(v == w);
+}
+
+TEST_CASE("Radix Sort Parallel Test 2") {
+  // 値の範囲が狭い鍵(上位のビットが全て同じ)でも、最上位の桁を違うビットから取って並べる
+  container::task_pool pool(4);
+  std::mt19937 mt(5);
+  for (const std::uint32_t base : {0u, 1u << 30, 0xFFFFF000u}) {
+    for (const std::uint32_t range : {1u, 7u, 1000u, 1u << 21}) {
+      std::vector<record> v(300000);
+      for (std::size_t i = 0; i < v.size(); i++) {
+        const std::uint32_t k = static_cast<std::uint32_t>(mt());
+        v[i] = record{base + k % std::min(range, ~base),
+                      static_cast<std::uint32_t>(i)};
+      }
+      auto w = v;
+      auto by_key = [](const record &a, const record &b) {
+        return a.key < b.key;
+      };
+      std::stable_sort(w.begin(), w.end(), by_key);
+      sort::radix_sort(sort::execution::par.on(pool), v.begin(), v.end(),
+                       [](const record &r) { return r.key; });
+      REQUIRE(std::equal(v.begin(), v.end(), w.begin(),
+                         [](const record &a, const record &b) {
+                           return a.key == b.key && a.pos == b.pos;
+                         }));
+    }
+  }
+  std::vector<std::int16_t> s(200000); // 0をまたぐ符号付きの鍵
+  for (auto &x : s) {
+    x = static_cast<std::int16_t>(static_cast<int>(mt() % 201) - 100);
+  }
+  auto t = s;
+  std::sort(t.begin(), t.end());
+  sort::radix_sort(sort::execution::par.on(pool), s.begin(), s.end(),
+                   [](std::int16_t x) { return x; });
+  REQUIRE(s == t);
+}
+
+TEST_CASE("Radix Sort Memory Resource Test 1") {
+  // 作業領域は渡したメモリ資源から借りる
+  memory::frame_arena arena(1 << 20);
+  std::vector<std::string> names = {"d", "b", "a", "c"};
+  std::vector<std::pair<float, std::string>> v;
+  std::mt19937 mt(4);
+  for (int i = 0; i < 10000; i++) {
+    v.emplace_back(static_cast<float>(mt() % 100) - 50.0f, names[i % 4]);
+  }
+  auto w = v;
+  std::stable_sort(w.begin(), w.end(), [](const auto &a, const auto &b) {
+    return a.first < b.first;
+  });
+  sort::radix_sort(v.begin(), v.end(), [](const auto &x) { return x.first; },
+                   &arena);
+  REQUIRE(v == w);
+  REQUIRE(arena.stats().allocations > 0);
+}
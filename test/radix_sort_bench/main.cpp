@@ -0,0 +1,121 @@
+//
+// 基数ソートと比較ソートのベンチマーク
+//
+// 32ビットの深度キー(全範囲と2^21未満)、64ビットのキー、floatのキーを持つ n 個のレコードについて、
+// std::sort、intro_sort、桁の幅を変えた radix_sort、並列の radix_sort でソートした時間を測る
+// 作業領域は monotonic_buffer_resource から借りる
+//
+// usage: radix_sort_bench [レコード数(既定 10000000)] [スレッド数(既定 ハードウェアの並列数)]
+//
+
+#include "sort/intro_sort.hpp"
+#include "sort/radix_sort.hpp"
+#include <algorithm>
+#include <boost/container/pmr/monotonic_buffer_resource.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief 鍵と中身を持つレコード */
+template <class K> struct record {
+  K key;
+  std::uint32_t id;
+};
+
+/**< @brief 元の配列をコピーしてfでソートし、時間(ms)を返す(3回の最小値) */
+template <class T, class F>
+double measure_ms(const std::vector<T> &src, std::vector<T> &v, F f) {
+  double best = 1e300;
+  for (int round = 0; round < 3; round++) {
+    v = src;
+    const auto t0 = clock_type::now();
+    f(v);
+    const auto t1 = clock_type::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    if (!std::is_sorted(v.begin(), v.end(), [](const T &a, const T &b) {
+          return a.key < b.key;
+        })) {
+      std::printf("not sorted!\n");
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return best;
+}
+
+/**< @brief 鍵の型Kのレコードで各ソートを比べる */
+template <class K, class Gen>
+std::uint64_t run(const char *title, std::size_t n, std::size_t threads,
+                  Gen gen) {
+  using T = record<K>;
+  std::vector<T> src(n), v;
+  for (std::size_t i = 0; i < n; i++) {
+    src[i] = T{gen(), static_cast<std::uint32_t>(i)};
+  }
+  auto by_key = [](const T &a, const T &b) { return a.key < b.key; };
+  auto key = [](const T &x) { return x.key; };
+  boost::container::pmr::monotonic_buffer_resource mr;
+  container::task_pool pool(threads);
+
+  std::printf("%s\n", title);
+  const double base = measure_ms(src, v, [&](std::vector<T> &x) {
+    std::sort(x.begin(), x.end(), by_key);
+  });
+  auto report = [&](const char *name, double ms) {
+    std::printf("  %-22s %10.1f ms  x%.2f\n", name, ms, base / ms);
+  };
+  report("std::sort", base);
+  report("intro_sort", measure_ms(src, v, [&](std::vector<T> &x) {
+           intro_sort(x.begin(), x.end(), by_key);
+         }));
+  report("radix_sort<8>", measure_ms(src, v, [&](std::vector<T> &x) {
+           sort::radix_sort<8>(x.begin(), x.end(), key, &mr);
+           mr.release();
+         }));
+  report("radix_sort<11>", measure_ms(src, v, [&](std::vector<T> &x) {
+           sort::radix_sort<11>(x.begin(), x.end(), key, &mr);
+           mr.release();
+         }));
+  report("radix_sort<16>", measure_ms(src, v, [&](std::vector<T> &x) {
+           sort::radix_sort<16>(x.begin(), x.end(), key, &mr);
+           mr.release();
+         }));
+  report("radix_sort(par)", measure_ms(src, v, [&](std::vector<T> &x) {
+           sort::radix_sort(sort::execution::par.on(pool), x.begin(), x.end(),
+                            key, &mr);
+           mr.release();
+         }));
+  return v[n / 2].id;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                 : 10000000;
+  const std::size_t threads =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%zu records, %zu threads\n", n, threads);
+
+  std::mt19937_64 mt(12345);
+  std::uniform_real_distribution<float> depth(0.1f, 1000.0f);
+  std::uint64_t sink = 0;
+  sink += run<std::uint32_t>("uint32 key", n, threads,
+                             [&] { return static_cast<std::uint32_t>(mt()); });
+  sink += run<std::uint32_t>("uint32 key < 2^21", n, threads, [&] {
+    return static_cast<std::uint32_t>(mt() & ((1u << 21) - 1));
+  });
+  sink += run<std::uint64_t>("uint64 key", n, threads, [&] { return mt(); });
+  sink += run<float>("float key", n, threads, [&] { return depth(mt); });
+  std::printf("(sink %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+}
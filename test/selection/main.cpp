@@ -0,0 +1,129 @@
+#include "sort/selection.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief 大きさnの様々な並びの配列を作る */
+std::vector<std::vector<std::uint32_t>> patterns(std::size_t n) {
+  std::mt19937 mt(static_cast<std::uint32_t>(n));
+  std::vector<std::uint32_t> random(n), sorted(n), reversed(n), few(n),
+      organ(n), equal(n, 7);
+  for (std::size_t i = 0; i < n; i++) {
+    random[i] = mt();
+    sorted[i] = static_cast<std::uint32_t>(i);
+    reversed[i] = static_cast<std::uint32_t>(n - i);
+    few[i] = mt() % 4;
+    organ[i] = static_cast<std::uint32_t>(i < n / 2 ? i : n - i);
+  }
+  return {random, sorted, reversed, few, organ, equal};
+}
+
+/**< @brief ランキングのエントリ(スコアが同じものは順序を問わない) */
+struct entry {
+  std::uint32_t score;
+  std::string name;
+};
+
+/**< @brief スコアの高い順 */
+struct by_score {
+  bool operator()(const entry &a, const entry &b) const {
+    return a.score > b.score;
+  }
+};
+
+} // namespace
+
+TEST_CASE("Selection Nth Element Test 1") {
+  for (std::size_t n : {1, 2, 16, 17, 100, 1000, 100000}) {
+    for (auto v : patterns(n)) {
+      auto w = v;
+      std::sort(w.begin(), w.end());
+      for (std::size_t k : {std::size_t(0), n / 3, n / 2, n - 1}) {
+        auto u = v;
+        sort::nth_element(u.begin(), u.begin() + k, u.end());
+        REQUIRE(u[k] == w[k]);
+        REQUIRE(std::all_of(u.begin(), u.begin() + k,
+                            [&](std::uint32_t x) { return x <= u[k]; }));
+        REQUIRE(std::all_of(u.begin() + k, u.end(),
+                            [&](std::uint32_t x) { return x >= u[k]; }));
+        std::sort(u.begin(), u.end());
+        REQUIRE(u == w);
+      }
+    }
+  }
+}
+
+TEST_CASE("Selection Partial Sort Test 1") {
+  for (std::size_t n : {0, 1, 20, 1000, 100000}) {
+    for (auto v : patterns(n)) {
+      auto w = v;
+      std::sort(w.begin(), w.end(), std::greater<>());
+      for (std::size_t m : {std::size_t(0), std::min<std::size_t>(n, 10),
+                            n / 2, n}) {
+        auto u = v;
+        sort::partial_sort(u.begin(), u.begin() + m, u.end(),
+                           std::greater<>());
+        REQUIRE(std::equal(u.begin(), u.begin() + m, w.begin()));
+        std::sort(u.begin(), u.end(), std::greater<>());
+        REQUIRE(u == w);
+      }
+    }
+  }
+}
+
+TEST_CASE("Selection Top K Test 1") {
+  // 要素を1つずつ加え、スコアの高い順にk個残す
+  std::mt19937 mt(1);
+  std::vector<entry> v(100000);
+  for (auto &e : v) {
+    e.score = mt() % 5000;
+    e.name = std::to_string(e.score);
+  }
+  auto w = v;
+  std::sort(w.begin(), w.end(), by_score());
+  for (std::size_t k : {0, 1, 1000, 200000}) {
+    sort::top_k<entry, by_score> top(k);
+    for (const auto &e : v) {
+      top.push(e);
+    }
+    REQUIRE(top.size() == std::min(k, v.size()));
+    if (!top.empty()) {
+      REQUIRE(top.threshold().score == w[top.size() - 1].score);
+    }
+    auto r = top.take();
+    REQUIRE(top.empty());
+    REQUIRE(r.size() == std::min(k, v.size()));
+    for (std::size_t i = 0; i < r.size(); i++) {
+      REQUIRE(r[i].score == w[i].score);
+      REQUIRE(r[i].name == std::to_string(r[i].score));
+    }
+  }
+}
+
+TEST_CASE("Selection Top K Test 2") {
+  // 並列に加えたときも逐次と同じ結果になる
+  for (std::size_t threads : {1, 2, 3, 4}) {
+    container::task_pool pool(threads);
+    for (auto v : patterns(300000)) {
+      auto w = v;
+      std::sort(w.begin(), w.end());
+      sort::top_k<std::uint32_t> top(1000);
+      top.push(sort::execution::par.on(pool), v.begin(), v.end());
+      const auto r = top.take();
+      REQUIRE(std::equal(r.begin(), r.end(), w.begin(), w.begin() + 1000));
+
+      // 続けて使う
+      top.push(sort::execution::seq, v.begin(), v.begin() + 10);
+      top.push(sort::execution::par(2), v.begin() + 10, v.end());
+      REQUIRE(top.take() == r);
+    }
+  }
+}
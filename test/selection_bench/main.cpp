@@ -0,0 +1,142 @@
+//
+// 選択アルゴリズムのベンチマーク
+//
+// n 個のランキングのエントリ(スコアとID)からスコアの高い k 個を順に取り出す時間を、
+// 全体のソート(std::sort, intro_sort)、std::partial_sort、std::nth_element + std::sort、
+// sort::partial_sort、sort::nth_element + intro_sort、sort::top_k(逐次、並列)で比べる
+//
+// usage: selection_bench [エントリ数(既定 10000000)] [k(既定 1000)] [スレッド数(既定 ハードウェアの並列数)]
+//
+
+#include "sort/intro_sort.hpp"
+#include "sort/selection.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief ランキングのエントリ */
+struct entry {
+  float score;
+  std::uint32_t id;
+};
+
+/**< @brief スコアの高い順 */
+struct by_score {
+  bool operator()(const entry &a, const entry &b) const {
+    return a.score > b.score;
+  }
+};
+
+/**
+ * @brief 元の配列をコピーしてfで上位k個を取り出し、時間(ms)を返す(3回の最小値)
+ * @note  fは上位k個をスコアの高い順に並べた配列を返す. コピーの時間は含めない
+ */
+template <class F>
+double measure_ms(const std::vector<entry> &src,
+                  const std::vector<entry> &expect, F f) {
+  double best = 1e300;
+  std::vector<entry> v;
+  for (int round = 0; round < 3; round++) {
+    v = src;
+    const auto t0 = clock_type::now();
+    const std::vector<entry> top = f(v);
+    const auto t1 = clock_type::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    if (top.size() != expect.size() ||
+        !std::equal(top.begin(), top.end(), expect.begin(),
+                    [](const entry &a, const entry &b) {
+                      return a.score == b.score;
+                    })) {
+      std::printf("wrong top-k!\n");
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                 : 10000000;
+  const std::size_t k = std::min<std::size_t>(
+      n, argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000);
+  const std::size_t threads =
+      argc > 3 ? std::strtoull(argv[3], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  std::printf("top %zu of %zu entries, %zu threads\n", k, n, threads);
+
+  std::mt19937_64 mt(12345);
+  std::uniform_real_distribution<float> score(0.0f, 1.0e6f);
+  std::vector<entry> src(n);
+  for (std::size_t i = 0; i < n; i++) {
+    src[i] = entry{score(mt), static_cast<std::uint32_t>(i)};
+  }
+  std::vector<entry> expect = src;
+  std::sort(expect.begin(), expect.end(), by_score());
+  expect.resize(k);
+  container::task_pool pool(threads);
+
+  auto head = [k](std::vector<entry> &v) {
+    return std::vector<entry>(v.begin(), v.begin() + k);
+  };
+  const double base = measure_ms(src, expect, [&](std::vector<entry> &v) {
+    std::sort(v.begin(), v.end(), by_score());
+    return head(v);
+  });
+  auto report = [&](const char *name, double ms) {
+    std::printf("  %-28s %10.2f ms  x%.2f\n", name, ms, base / ms);
+  };
+  report("std::sort", base);
+  report("intro_sort", measure_ms(src, expect, [&](std::vector<entry> &v) {
+           intro_sort(v.begin(), v.end(), by_score());
+           return head(v);
+         }));
+  report("std::partial_sort",
+         measure_ms(src, expect, [&](std::vector<entry> &v) {
+           std::partial_sort(v.begin(), v.begin() + k, v.end(), by_score());
+           return head(v);
+         }));
+  report("std::nth_element + sort",
+         measure_ms(src, expect, [&](std::vector<entry> &v) {
+           std::nth_element(v.begin(), v.begin() + (k - 1), v.end(),
+                            by_score());
+           std::sort(v.begin(), v.begin() + k, by_score());
+           return head(v);
+         }));
+  report("sort::partial_sort",
+         measure_ms(src, expect, [&](std::vector<entry> &v) {
+           sort::partial_sort(v.begin(), v.begin() + k, v.end(), by_score());
+           return head(v);
+         }));
+  report("sort::nth_element + intro",
+         measure_ms(src, expect, [&](std::vector<entry> &v) {
+           sort::nth_element(v.begin(), v.begin() + (k - 1), v.end(),
+                             by_score());
+           intro_sort(v.begin(), v.begin() + k, by_score());
+           return head(v);
+         }));
+  report("sort::top_k", measure_ms(src, expect, [&](std::vector<entry> &v) {
+           sort::top_k<entry, by_score, std::allocator<entry>> top(k);
+           top.push(v.begin(), v.end());
+           return top.take();
+         }));
+  report("sort::top_k(par)",
+         measure_ms(src, expect, [&](std::vector<entry> &v) {
+           sort::top_k<entry, by_score, std::allocator<entry>> top(k);
+           top.push(sort::execution::par.on(pool), v.begin(), v.end());
+           return top.take();
+         }));
+  std::printf("(sink %u)\n", expect.empty() ? 0u : expect.back().id);
+  return 0;
+}
@@ -1,5 +1,10 @@
 #include "container/skew_heap.hpp"
+#include <algorithm>
 #include <list>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
@@ -16,3 +21,128 @@ TEST_CASE("Skew Heap Push Pop Test 1") {
   }
   REQUIRE(h.pop() == std::nullopt);
 }
+
+TEST_CASE("Skew Heap Push Pop Test 2") {
+  // SSOを超える長さのキーで、取り出したキーが節点の破棄後も有効であることを確かめる
+  container::skew_heap<std::string> h(2);
+  const std::string pad(64, 'x');
+  for (const char *s : {"d", "b", "e", "a", "c"}) {
+    h.push(s + pad);
+  }
+  for (const char *s : {"a", "b", "c", "d", "e"}) {
+    REQUIRE(h.pop() == std::make_optional(s + pad));
+  }
+  REQUIRE(h.pop() == std::nullopt);
+}
+
+TEST_CASE("Skew Heap Push Pop Churn Test 1") {
+  container::skew_heap<int> h(2);
+  for (int round = 0; round < 4; round++) {
+    for (int i = 64; i > 0; i--) {
+      h.push(i);
+    }
+    for (int i = 1; i <= 64; i++) {
+      REQUIRE(h.pop() == std::make_optional(i));
+    }
+  }
+  REQUIRE(h.empty());
+  REQUIRE(h.size() == 0);
+  REQUIRE(h.pool().live() == 0);
+  REQUIRE(h.pool().high_water() == 64);
+}
+
+TEST_CASE("Skew Heap Long Path Test 1") {
+  // 降順に挿入すると、各節点が左の子だけを持つ長さnの経路になる
+  // マージと破棄はどちらも反復なので、スタックを消費しない
+  constexpr int n = 1 << 20;
+  container::skew_heap<int> h(n), g(n);
+  for (int i = n; i > 0; i--) {
+    h.push(i);
+    g.push(i);
+  }
+  for (int i = 1; i <= n / 2; i++) {
+    REQUIRE(h.pop() == std::make_optional(i));
+  }
+  REQUIRE(h.size() == n / 2);
+  REQUIRE(g.size() == n);
+}
+
+TEST_CASE("Skew Heap Decrease Key Erase Test 1") {
+  std::mt19937 rng(7);
+  container::skew_heap<int> h;
+  std::vector<container::skew_heap<int>::handle> hs;
+  std::multiset<int> ref;
+  for (int step = 0; step < 20000; step++) {
+    const int op = rng() % 8;
+    if (op < 3 || hs.empty()) {
+      const int k = rng() % 100000;
+      hs.push_back(h.push(k));
+      ref.insert(k);
+    } else if (op < 5) {
+      const std::size_t i = rng() % hs.size();
+      const int k = hs[i].key() - static_cast<int>(rng() % 1000);
+      ref.erase(ref.find(hs[i].key()));
+      ref.insert(k);
+      h.decrease_key(hs[i], k);
+      REQUIRE(hs[i].key() == k);
+    } else if (op < 7) {
+      const std::size_t i = rng() % hs.size();
+      ref.erase(ref.find(hs[i].key()));
+      h.erase(hs[i]);
+      hs[i] = hs.back();
+      hs.pop_back();
+    } else {
+      // popした要素のハンドルを取り除く
+      const int k = *ref.begin();
+      auto it = std::find_if(hs.begin(), hs.end(),
+                             [&](const auto &x) { return x.key() == k; });
+      REQUIRE(it != hs.end());
+      REQUIRE(h.pop() == std::make_optional(k));
+      ref.erase(ref.begin());
+      // 同じキーが複数あるときは、popされたのがどれかわからないので全て作り直す
+      if (ref.count(k) > 0) {
+        while (!h.empty()) {
+          h.pop();
+        }
+        hs.clear();
+        for (int x : ref) {
+          hs.push_back(h.push(x));
+        }
+      } else {
+        *it = hs.back();
+        hs.pop_back();
+      }
+    }
+    REQUIRE(h.size() == ref.size());
+  }
+  for (int k : ref) {
+    REQUIRE(h.pop() == std::make_optional(k));
+  }
+  REQUIRE(h.empty());
+  REQUIRE(h.pool().live() == 0);
+}
+
+TEST_CASE("Skew Heap Meld Test 1") {
+  container::skew_heap<int> h;
+  container::skew_heap<int> g(h.pool());
+  container::skew_heap<int>::handle x;
+  for (int i = 0; i < 100; i++) {
+    h.push(2 * i);
+    auto y = g.push(2 * i + 1);
+    if (i == 50) {
+      x = y;
+    }
+  }
+  h.meld(g);
+  REQUIRE(g.empty());
+  REQUIRE(h.size() == 200);
+  REQUIRE(h.pool().live() == 200);
+  h.decrease_key(x, -1); // 移した要素のハンドルも有効
+  REQUIRE(h.pop() == std::make_optional(-1));
+  for (int i = 0; i < 200; i++) {
+    if (i != 101) {
+      REQUIRE(h.pop() == std::make_optional(i));
+    }
+  }
+  REQUIRE(h.empty());
+}
@@ -0,0 +1,127 @@
+#include "container/slot_map.hpp"
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace pmr = boost::container::pmr;
+
+/**< @brief countdown回目の確保でstd::bad_allocを投げるメモリリソース(負のときは投げない) */
+struct failing_resource : pmr::memory_resource {
+  int countdown = -1;
+
+  void *do_allocate(std::size_t bytes, std::size_t align) override {
+    if (countdown > 0 && --countdown == 0) {
+      throw std::bad_alloc();
+    }
+    return pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void *p, std::size_t bytes, std::size_t align) override {
+    pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST_CASE("Slot Map Insert Erase Test 1") {
+  container::slot_map<std::string> m(2);
+  auto a = m.insert("alpha");
+  auto b = m.insert("beta");
+  auto c = m.insert(3, 'c');
+  REQUIRE(m.size() == 3);
+  REQUIRE(*m.get(a) == "alpha");
+  REQUIRE(*m.get(c) == "ccc");
+  REQUIRE(m.erase(a) == std::make_optional<std::string>("alpha"));
+  REQUIRE_FALSE(m.contains(a));
+  REQUIRE(m.get(a) == nullptr);
+  REQUIRE(m.erase(a) == std::nullopt);
+  // 末尾の要素が空いた位置へ移っても、ハンドルは同じ要素を指す
+  REQUIRE(*m.get(b) == "beta");
+  REQUIRE(*m.get(c) == "ccc");
+  // 空いたスロットは世代を進めて再利用される
+  auto d = m.insert("delta");
+  REQUIRE(d.index() == a.index());
+  REQUIRE(d.generation() == a.generation() + 1);
+  REQUIRE(m.get(a) == nullptr);
+  REQUIRE(*m.get(d) == "delta");
+  REQUIRE_FALSE(container::slot_map<int>::handle());
+}
+
+TEST_CASE("Slot Map Random Test 1") {
+  std::mt19937 rng(5);
+  container::slot_map<int> m;
+  std::vector<std::pair<container::slot_handle, int>> live;
+  std::vector<container::slot_handle> dead;
+  for (int step = 0; step < 100'000; step++) {
+    if (live.empty() || rng() % 3 != 0) {
+      const int v = rng();
+      live.emplace_back(m.insert(v), v);
+    } else {
+      const std::size_t i = rng() % live.size();
+      REQUIRE(m.erase(live[i].first) == std::make_optional(live[i].second));
+      dead.push_back(live[i].first);
+      live[i] = live.back();
+      live.pop_back();
+    }
+  }
+  REQUIRE(m.size() == live.size());
+  for (auto [h, v] : live) {
+    REQUIRE(*m.get(h) == v);
+  }
+  for (auto h : dead) {
+    REQUIRE_FALSE(m.contains(h));
+  }
+  // 密な配列の巡回とハンドルが対応している
+  std::unordered_map<std::uint64_t, int> ref;
+  for (auto [h, v] : live) {
+    ref[h.value()] = v;
+  }
+  long long sum = 0;
+  for (int v : m) {
+    sum += v;
+  }
+  long long expected = 0;
+  m.for_each([&](container::slot_handle h, int &v) {
+    REQUIRE(ref.at(h.value()) == v);
+    expected += v;
+  });
+  REQUIRE(sum == expected);
+  m.clear();
+  REQUIRE(m.empty());
+  for (auto [h, v] : live) {
+    REQUIRE_FALSE(m.contains(h));
+  }
+}
+
+TEST_CASE("Slot Map Insert Erase Test 2") {
+  // 要素の構築や配列の拡張が例外を投げても、スロットマップは挿入の前のまま
+  for (int fail_at = 0; fail_at <= 3; fail_at++) {
+    failing_resource r;
+    container::slot_map<std::string> m(2, &r);
+    auto a = m.insert("alpha");
+    auto b = m.insert("beta");
+    m.erase(a);
+    auto c = m.insert("gamma"); // 空いたスロットを再利用する
+    r.countdown = fail_at;     // 次の挿入で密な配列と管理用の配列が広がる
+    if (fail_at == 0) {
+      REQUIRE_THROWS(m.insert(std::string().max_size() + 1, 'x'));
+    } else {
+      REQUIRE_THROWS_AS(m.insert("delta"), std::bad_alloc);
+    }
+    r.countdown = -1;
+    REQUIRE(m.size() == 2);
+    REQUIRE(*m.get(b) == "beta");
+    REQUIRE(*m.get(c) == "gamma");
+    auto d = m.insert("delta");
+    REQUIRE(d.index() == 2);
+    REQUIRE(*m.get(d) == "delta");
+    REQUIRE(m.end() - m.begin() == 3);
+  }
+}
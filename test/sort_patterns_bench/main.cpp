@@ -0,0 +1,101 @@
+//
+// 入力の並びのパターンごとのソートのベンチマーク
+//
+// ランダム、昇順、降順、山型(organ pipe)、少数の値の繰り返し(few unique)の5つのパターンで、
+// int32_t の配列(intro_sort は葉をソーティングネットワークで並べる)と、
+// 浮動小数点数の深度をキーに持つ描画レコードの配列を std::sort と intro_sort で並べた時間を測る
+//
+// usage: sort_patterns_bench [要素数(既定 10000000)]
+//
+
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief 描画レコード */
+struct draw_record {
+  float depth;
+  std::uint32_t id;
+};
+
+/**< @brief 元の配列をコピーしてfでソートし、時間(ms)を返す */
+template <class T, class F, class Cmp>
+double measure_ms(const std::vector<T> &src, std::vector<T> &v, F f, Cmp cmp) {
+  v = src;
+  const auto t0 = clock_type::now();
+  f(v);
+  const auto t1 = clock_type::now();
+  if (!std::is_sorted(v.begin(), v.end(), cmp)) {
+    std::printf("not sorted!\n");
+    std::exit(EXIT_FAILURE);
+  }
+  return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+/**< @brief パターンpの第i要素の元になる値を返す */
+std::uint32_t pattern(int p, std::size_t i, std::size_t n, std::mt19937 &mt) {
+  switch (p) {
+  case 0: // ランダム
+    return mt();
+  case 1: // 昇順
+    return static_cast<std::uint32_t>(i);
+  case 2: // 降順
+    return static_cast<std::uint32_t>(n - i);
+  case 3: // 山型
+    return static_cast<std::uint32_t>(i < n / 2 ? i : n - i);
+  default: // 少数の値の繰り返し
+    return mt() % 16;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                 : 10000000;
+  const char *names[] = {"random", "sorted", "reversed", "organ pipe",
+                         "few unique"};
+  std::printf("%zu elements\n", n);
+  std::printf("%-12s %12s %12s %12s %12s\n", "", "int std", "int intro",
+              "rec std", "rec intro");
+  std::uint64_t sink = 0;
+  for (int p = 0; p < 5; p++) {
+    std::mt19937 mt(12345);
+    std::vector<std::int32_t> ints(n), vi;
+    std::vector<draw_record> recs(n), vr;
+    for (std::size_t i = 0; i < n; i++) {
+      const std::uint32_t x = pattern(p, i, n, mt);
+      ints[i] = static_cast<std::int32_t>(x >> 1);
+      recs[i] = draw_record{static_cast<float>(x) * 0.25f,
+                            static_cast<std::uint32_t>(i)};
+    }
+    auto by_depth = [](const draw_record &a, const draw_record &b) {
+      return a.depth < b.depth;
+    };
+    const std::less<std::int32_t> less;
+    const double is = measure_ms(
+        ints, vi, [&](auto &v) { std::sort(v.begin(), v.end()); }, less);
+    const double ii = measure_ms(
+        ints, vi, [&](auto &v) { intro_sort(v.begin(), v.end()); }, less);
+    const double rs = measure_ms(
+        recs, vr, [&](auto &v) { std::sort(v.begin(), v.end(), by_depth); },
+        by_depth);
+    const double ri = measure_ms(
+        recs, vr, [&](auto &v) { intro_sort(v.begin(), v.end(), by_depth); },
+        by_depth);
+    std::printf("%-12s %9.1f ms %9.1f ms %9.1f ms %9.1f ms\n", names[p], is,
+                ii, rs, ri);
+    sink += static_cast<std::uint64_t>(vi[n / 2]) + vr[n / 2].id;
+  }
+  std::printf("(sink %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+}
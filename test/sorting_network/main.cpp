@@ -0,0 +1,105 @@
+#include "sort/intro_sort.hpp"
+#include "sort/sorting_network.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief 符号まで含めて同じ値かどうか(-0.0と+0.0を区別する) */
+template <class T> bool same(T a, T b) {
+  return a == b && std::signbit(a) == std::signbit(b);
+}
+
+/**< @brief 大きさ0からmax_sizeまでの配列をネットワークで並べ、std::sortと比べる */
+template <class T, class Gen> void check_network(Gen gen) {
+  for (std::size_t n = 0; n <= sort::network::max_size; n++) {
+    for (int round = 0; round < 50; round++) {
+      std::vector<T> v(n);
+      for (auto &x : v) {
+        x = gen();
+      }
+      auto w = v;
+      std::sort(w.begin(), w.end());
+      sort::network::sort(v.data(), n);
+      REQUIRE(v == w);
+      REQUIRE(std::is_permutation(v.begin(), v.end(), w.begin(), same<T>));
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Sorting Network Test 1") {
+  std::mt19937 mt(1);
+  check_network<std::int32_t>(
+      [&] { return static_cast<std::int32_t>(mt()); });
+  check_network<std::int32_t>(
+      [&] { return static_cast<std::int32_t>(mt() % 5); });
+  check_network<std::uint32_t>(
+      [&] { return static_cast<std::uint32_t>(mt()); });
+  check_network<float>([&] {
+    return static_cast<float>(static_cast<std::int32_t>(mt())) * 1e-3f;
+  });
+  check_network<float>([&] { // 等しいが異なる値(-0.0と+0.0)を含む
+    constexpr float values[] = {-0.0f, 0.0f, -2.0f, -1.0f, 1.0f, 2.0f};
+    return values[mt() % 6];
+  });
+}
+
+TEST_CASE("Sorting Network Test 2") {
+  // 埋める値と等しい要素や端の値を含む
+  std::vector<std::int32_t> v = {std::numeric_limits<std::int32_t>::max(), 0,
+                                 std::numeric_limits<std::int32_t>::min(), -1,
+                                 std::numeric_limits<std::int32_t>::max()};
+  sort::network::sort(v.data(), v.size());
+  REQUIRE(std::is_sorted(v.begin(), v.end()));
+  std::vector<float> f = {std::numeric_limits<float>::infinity(), -0.0f, 0.0f,
+                          -std::numeric_limits<float>::infinity(), 1.0f};
+  const auto g = f;
+  sort::network::sort(f.data(), f.size());
+  REQUIRE(std::is_sorted(f.begin(), f.end()));
+  REQUIRE(std::is_permutation(f.begin(), f.end(), g.begin(), same<float>));
+  REQUIRE(f.front() == -std::numeric_limits<float>::infinity());
+  REQUIRE(f.back() == std::numeric_limits<float>::infinity());
+}
+
+TEST_CASE("Sorting Network Applicable Test 1") {
+  using it = std::vector<std::int32_t>::iterator;
+  STATIC_REQUIRE(sort::network::applicable_v<it, std::less<std::int32_t>>);
+  STATIC_REQUIRE(sort::network::applicable_v<float *, std::less<>>);
+  STATIC_REQUIRE(!sort::network::applicable_v<it, std::greater<std::int32_t>>);
+  STATIC_REQUIRE(
+      !sort::network::applicable_v<std::int64_t *, std::less<std::int64_t>>);
+}
+
+TEST_CASE("Intro Sort With Sorting Network Test 1") {
+  // SIMD命令が使えるときは葉をネットワークで並べ、最後の挿入ソートを行わない
+  std::mt19937 mt(2);
+  for (std::size_t n : {1, 31, 32, 33, 64, 65, 1000, 100000}) {
+    std::vector<std::int32_t> v(n);
+    std::vector<float> f(n);
+    for (std::size_t i = 0; i < n; i++) {
+      v[i] = static_cast<std::int32_t>(mt() % (i % 2 == 0 ? 1000 : 7));
+      f[i] = i % 3 == 0 ? (i % 2 == 0 ? -0.0f : 0.0f)
+                        : static_cast<float>(mt() % 100000) - 5e4f;
+    }
+    auto w = v;
+    auto g = f;
+    std::sort(w.begin(), w.end());
+    std::sort(g.begin(), g.end());
+    intro_sort(v.begin(), v.end());
+    const auto h = f;
+    intro_sort(f.data(), f.data() + n, std::less<>());
+    REQUIRE(v == w);
+    REQUIRE(f == g);
+    REQUIRE(std::is_permutation(f.begin(), f.end(), h.begin(), same<float>));
+  }
+}
@@ -0,0 +1,125 @@
+//
+// ソーティングネットワークと挿入ソートのベンチマーク
+//
+// 1. 大きさ n (8, 16, 32, 64) の小さな配列をたくさん並べる1配列あたりの時間を、
+//    挿入ソートとソーティングネットワークで比べる
+// 2. int32_t と float の配列全体を intro_sort で並べる時間を、葉をネットワークで並べる場合
+//    (std::less)と、従来どおり最後に挿入ソートを行う場合(ラムダ式の比較述語)で比べる
+//    SIMD命令を使わないビルドでは、どちらも挿入ソートで仕上げる
+// ネットワークの幅はコンパイル時に決まるので、-mavx2, -msse4.1 を付けるかどうかで結果が変わる
+//
+// usage: sorting_network_bench [要素数(既定 10000000)]
+//
+
+#include "sort/intro_sort.hpp"
+#include "sort/sorting_network.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief 挿入ソート(intro_sortの最後の挿入ソートと同じもの) */
+template <class T> void insertion_sort(T *a, std::size_t n) {
+  for (std::size_t j = 1; j < n; j++) {
+    const T key = a[j];
+    std::size_t i = j;
+    for (; i > 0 && key < a[i - 1]; i--) {
+      a[i] = a[i - 1];
+    }
+    a[i] = key;
+  }
+}
+
+/**< @brief fを実行した時間(ns)を返す */
+template <class F> double measure_ns(F f) {
+  const auto t0 = clock_type::now();
+  f();
+  const auto t1 = clock_type::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+/**< @brief 大きさnの小さな配列を並べる1配列あたりの時間を比べる */
+template <class T, class Gen>
+std::uint64_t small_arrays(std::size_t n, Gen gen) {
+  constexpr std::size_t arrays = 1 << 16;
+  std::vector<T> src(arrays * n), v;
+  for (auto &x : src) {
+    x = gen();
+  }
+  v = src;
+  const double ins = measure_ns([&] {
+    for (std::size_t a = 0; a < arrays; a++) {
+      insertion_sort(v.data() + a * n, n);
+    }
+  });
+  v = src;
+  const double net = measure_ns([&] {
+    for (std::size_t a = 0; a < arrays; a++) {
+      sort::network::sort(v.data() + a * n, n);
+    }
+  });
+  std::printf("  n = %2zu  insertion %7.1f ns  network %7.1f ns  x%.2f\n", n,
+              ins / arrays, net / arrays, ins / net);
+  return static_cast<std::uint64_t>(v[n / 2]);
+}
+
+/**< @brief 配列全体をintro_sortで並べる時間を比べる */
+template <class T, class Gen>
+std::uint64_t whole_array(const char *title, std::size_t n, Gen gen) {
+  std::vector<T> src(n), v;
+  for (auto &x : src) {
+    x = gen();
+  }
+  v = src;
+  const double tail = measure_ns([&] {
+    intro_sort(v.begin(), v.end(), [](T a, T b) { return a < b; });
+  });
+  v = src;
+  const double net = measure_ns([&] { intro_sort(v.begin(), v.end()); });
+  if (!std::is_sorted(v.begin(), v.end())) {
+    std::printf("not sorted!\n");
+    std::exit(EXIT_FAILURE);
+  }
+  std::printf("  %-8s insertion tail %8.1f ms  network leaves %8.1f ms"
+              "  x%.2f\n",
+              title, tail * 1e-6, net * 1e-6, tail / net);
+  return static_cast<std::uint64_t>(v[n / 2]);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                 : 10000000;
+#if defined(__AVX2__)
+  std::printf("lanes: AVX2 (8)\n");
+#elif defined(__SSE4_1__)
+  std::printf("lanes: SSE4.1 (4)\n");
+#else
+  std::printf("lanes: scalar (1)\n");
+#endif
+  std::mt19937 mt(12345);
+  auto i32 = [&] { return static_cast<std::int32_t>(mt()); };
+  auto f32 = [&] { return static_cast<float>(mt() % 1000000) * 1e-3f; };
+  std::uint64_t sink = 0;
+  std::printf("small arrays (int32_t)\n");
+  for (std::size_t k : {8, 16, 32, 64}) {
+    sink += small_arrays<std::int32_t>(k, i32);
+  }
+  std::printf("small arrays (float)\n");
+  for (std::size_t k : {8, 16, 32, 64}) {
+    sink += small_arrays<float>(k, f32);
+  }
+  std::printf("intro_sort (%zu elements)\n", n);
+  sink += whole_array<std::int32_t>("int32_t", n, i32);
+  sink += whole_array<float>("float", n, f32);
+  std::printf("(sink %llu)\n", static_cast<unsigned long long>(sink));
+  return 0;
+}
@@ -0,0 +1,148 @@
+//
+// 空間索引(spatial_hash_grid と aabb_tree)のベンチマーク
+//
+// n 個の物体(一辺0.5〜2の箱)が一辺 L の空間をランダムに動き回る状況で、1フレームあたりの
+// 索引の更新(格子は作り直し、木はmove)、全ての重なりの組の列挙、箱・球・レイの問い合わせ1000個ずつ
+// にかかる時間を測る. 組の列挙と問い合わせは1スレッドとハードウェアの並列数とで比べる
+//
+// usage: spatial_bench [物体数(既定 100000)] [フレーム数(既定 10)]
+//
+
+#include "container/aabb_tree.hpp"
+#include "container/spatial_hash_grid.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using box = container::aabb<3>;
+using vec = container::vec<3>;
+
+template <class F> double measure_ms(F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::milli>(e - s).count();
+}
+
+/**< @brief 動き回る物体 */
+struct scene {
+  std::vector<box> boxes;
+  std::vector<vec> vel;
+  float world;
+
+  scene(std::size_t n, std::mt19937 &rng)
+      : boxes(n), vel(n), world(std::cbrt(static_cast<float>(n)) * 4) {
+    std::uniform_real_distribution<float> pos(0, world), ext(0.5f, 2.0f),
+        v(-0.2f, 0.2f);
+    for (std::size_t i = 0; i < n; i++) {
+      for (std::size_t d = 0; d < 3; d++) {
+        boxes[i].lo[d] = pos(rng);
+        boxes[i].hi[d] = boxes[i].lo[d] + ext(rng);
+        vel[i][d] = v(rng);
+      }
+    }
+  }
+
+  void step() {
+    for (std::size_t i = 0; i < boxes.size(); i++) {
+      for (std::size_t d = 0; d < 3; d++) {
+        if (boxes[i].lo[d] + vel[i][d] < 0 ||
+            boxes[i].hi[d] + vel[i][d] > world) {
+          vel[i][d] = -vel[i][d]; // 壁で跳ね返る
+        }
+        boxes[i].lo[d] += vel[i][d];
+        boxes[i].hi[d] += vel[i][d];
+      }
+    }
+  }
+};
+
+/**< @brief 問い合わせ */
+struct queries {
+  std::vector<box> boxes;
+  std::vector<vec> centers, origins, dirs;
+  std::vector<float> radii;
+
+  queries(std::size_t n, float world, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> pos(0, world), u(-1, 1);
+    for (std::size_t i = 0; i < n; i++) {
+      const vec p{pos(rng), pos(rng), pos(rng)};
+      boxes.push_back(box{p, vec{p[0] + 8, p[1] + 8, p[2] + 8}});
+      centers.push_back(p);
+      radii.push_back(5);
+      origins.push_back(p);
+      dirs.push_back(vec{u(rng), u(rng), u(rng)});
+    }
+  }
+};
+
+template <class Index, class Update>
+void run(const char *name, Index &index, scene &s, const queries &q,
+         int frames, unsigned threads, Update update) {
+  double t_update = 0, t_pairs = 0, t_query = 0;
+  std::size_t pairs = 0, hits = 0;
+  for (int f = 0; f < frames; f++) {
+    s.step();
+    t_update += measure_ms([&] { update(index, s); });
+    t_pairs += measure_ms([&] { pairs = index.find_pairs(threads).size(); });
+    t_query += measure_ms([&] {
+      for (const auto &r : index.query_aabb(q.boxes, threads)) {
+        hits += r.size();
+      }
+      for (const auto &r : index.query_radius(q.centers, q.radii, threads)) {
+        hits += r.size();
+      }
+      for (const auto &h : index.raycast(q.origins, q.dirs, 50, threads)) {
+        hits += h.has_value();
+      }
+    });
+  }
+  std::printf("%-22s x%-3u %10.2f %10.2f %10.2f   (%zu pairs, %zu)\n", name,
+              threads, t_update / frames, t_pairs / frames, t_query / frames,
+              pairs, hits & 0xff);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+  const int frames = argc > 2 ? std::atoi(argv[2]) : 10;
+  const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%-26s %10s %10s %10s (ms/frame)\n", "index", "update", "pairs",
+              "queries");
+
+  for (unsigned threads : {1u, hw}) {
+    std::mt19937 rng(1);
+    scene s(n, rng);
+    const queries q(1000, s.world, rng);
+    container::spatial_hash_grid<3> grid(2.0f);
+    run("spatial_hash_grid", grid, s, q, frames, threads,
+        [](container::spatial_hash_grid<3> &g, scene &s) { g.build(s.boxes); });
+
+    std::mt19937 rng2(1);
+    scene s2(n, rng2);
+    container::aabb_tree<3> tree(0.2f);
+    std::vector<container::aabb_tree<3>::proxy> proxies;
+    for (std::uint32_t i = 0; i < n; i++) {
+      proxies.push_back(tree.insert(s2.boxes[i], i));
+    }
+    run("aabb_tree", tree, s2, q, frames, threads,
+        [&](container::aabb_tree<3> &t, scene &s) {
+          for (std::uint32_t i = 0; i < s.boxes.size(); i++) {
+            t.move(proxies[i], s.boxes[i], s.vel[i]);
+          }
+        });
+    if (hw == 1) {
+      break;
+    }
+  }
+  return 0;
+}
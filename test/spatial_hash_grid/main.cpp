@@ -0,0 +1,163 @@
+#include "container/spatial_hash_grid.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+using grid = container::spatial_hash_grid<3>;
+using box = grid::box;
+using vec = container::vec<3>;
+
+std::vector<box> random_boxes(std::size_t n, float world, float size,
+                              std::mt19937 &rng) {
+  std::uniform_real_distribution<float> pos(0, world), ext(0.1f, size);
+  std::vector<box> bs(n);
+  for (box &b : bs) {
+    for (std::size_t d = 0; d < 3; d++) {
+      b.lo[d] = pos(rng);
+      b.hi[d] = b.lo[d] + ext(rng);
+    }
+  }
+  return bs;
+}
+
+std::vector<container::overlap_pair> brute_pairs(const std::vector<box> &bs) {
+  std::vector<container::overlap_pair> ps;
+  for (std::uint32_t i = 0; i < bs.size(); i++) {
+    for (std::uint32_t j = i + 1; j < bs.size(); j++) {
+      if (bs[i].overlaps(bs[j])) {
+        ps.emplace_back(i, j);
+      }
+    }
+  }
+  return ps;
+}
+
+} // namespace
+
+TEST_CASE("Spatial Hash Grid Query Test 1") {
+  std::mt19937 rng(1);
+  const std::vector<box> bs = random_boxes(2000, 100, 4, rng);
+  grid g(2.0f);
+  g.build(bs);
+  REQUIRE(g.size() == 2000);
+  REQUIRE(g.entries() >= 2000); // セルをまたぐ物体は複数回登録される
+
+  const std::vector<box> qs = random_boxes(200, 100, 20, rng);
+  const auto rs = g.query_aabb(qs, 2);
+  bool ok = true;
+  for (std::size_t i = 0; i < qs.size(); i++) {
+    std::vector<std::uint32_t> expect;
+    for (std::uint32_t j = 0; j < bs.size(); j++) {
+      if (bs[j].overlaps(qs[i])) {
+        expect.push_back(j);
+      }
+    }
+    ok = ok && rs[i] == expect;
+  }
+  REQUIRE(ok);
+
+  std::vector<vec> cs;
+  std::vector<float> radii;
+  for (int i = 0; i < 100; i++) {
+    cs.push_back(
+        vec{float(rng() % 100), float(rng() % 100), float(rng() % 100)});
+    radii.push_back(1.0f + rng() % 10);
+  }
+  const auto rr = g.query_radius(cs, radii, 2);
+  for (std::size_t i = 0; i < cs.size(); i++) {
+    std::vector<std::uint32_t> expect;
+    for (std::uint32_t j = 0; j < bs.size(); j++) {
+      if (bs[j].distance2(cs[i]) <= radii[i] * radii[i]) {
+        expect.push_back(j);
+      }
+    }
+    ok = ok && rr[i] == expect;
+  }
+  REQUIRE(ok);
+
+  // 全体を覆う問い合わせは全てのバケットを読む
+  std::size_t n = 0;
+  g.query_aabb(box{{-1, -1, -1}, {200, 200, 200}}, [&](std::uint32_t) { n++; });
+  REQUIRE(n == bs.size());
+}
+
+TEST_CASE("Spatial Hash Grid Raycast Test 1") {
+  std::mt19937 rng(2);
+  const std::vector<box> bs = random_boxes(1000, 100, 3, rng);
+  grid g(4.0f);
+  g.build(bs);
+  std::uniform_real_distribution<float> u(-1, 1);
+  std::vector<vec> os, ds;
+  for (int i = 0; i < 300; i++) {
+    os.push_back(vec{float(rng() % 100), float(rng() % 100), -10});
+    ds.push_back(vec{u(rng), u(rng), 1});
+  }
+  ds[0] = vec{0, 0, 1}; // 軸に平行なレイ
+  const auto hs = g.raycast(os, ds, 200, 2);
+  bool ok = true;
+  for (std::size_t i = 0; i < os.size(); i++) {
+    const container::ray<3> r(os[i], ds[i], 200);
+    std::optional<container::ray_hit> expect;
+    for (std::uint32_t j = 0; j < bs.size(); j++) {
+      const auto t = r.intersect(bs[j]);
+      if (t && (!expect || *t < expect->t)) {
+        expect = container::ray_hit{j, *t};
+      }
+    }
+    ok = ok && hs[i].has_value() == expect.has_value() &&
+         (!expect || (hs[i]->id == expect->id && hs[i]->t == expect->t));
+  }
+  REQUIRE(ok);
+  REQUIRE_FALSE(g.raycast(vec{-10, -10, -10}, vec{-1, 0, 0}, 100));
+}
+
+TEST_CASE("Spatial Hash Grid Pairs Test 1") {
+  std::mt19937 rng(3);
+  const std::vector<box> bs = random_boxes(3000, 100, 5, rng);
+  grid g(3.0f);
+  g.build(bs);
+  std::vector<container::overlap_pair> ps = g.find_pairs(4);
+  std::sort(ps.begin(), ps.end());
+  REQUIRE(std::adjacent_find(ps.begin(), ps.end()) == ps.end()); // 重複しない
+  REQUIRE(ps == brute_pairs(bs));
+
+  g.build(std::vector<box>{});
+  REQUIRE(g.find_pairs().empty());
+  REQUIRE_FALSE(g.raycast(vec{0, 0, 0}, vec{1, 0, 0}, 10));
+}
+
+TEST_CASE("Spatial Hash Grid Large Box Test 1") {
+  // 1000^3セルにまたがる地面と、座標がint32に収まらないほど遠い箱
+  std::mt19937 rng(4);
+  std::vector<box> bs = random_boxes(100, 100, 2, rng);
+  bs.push_back(box{vec{-500, -500, -500}, vec{500, 500, 500}});
+  bs.push_back(box{vec{1e12f, 0, 0}, vec{2e12f, 1, 1}});
+  bs.push_back(box{vec{-3e38f, 0, 0}, vec{-2e38f, 1, 1}});
+  grid g(1.0f);
+  g.build(bs);
+  REQUIRE(g.size() == bs.size());
+  REQUIRE(g.entries() <= bs.size() * g.buckets()); // 1つの物体の登録はバケット数まで
+
+  std::vector<container::overlap_pair> ps = g.find_pairs(2);
+  std::sort(ps.begin(), ps.end());
+  REQUIRE(ps == brute_pairs(bs));
+
+  const std::vector<box> qs = {box{vec{10, 10, 10}, vec{20, 20, 20}},
+                               box{vec{1.5e12f, 0, 0}, vec{1.6e12f, 2, 2}},
+                               box{vec{-3e38f, -1, -1}, vec{3e38f, 1, 1}}};
+  const auto rs = g.query_aabb(qs, 2);
+  for (std::size_t i = 0; i < qs.size(); i++) {
+    std::vector<std::uint32_t> expect;
+    for (std::uint32_t j = 0; j < bs.size(); j++) {
+      if (bs[j].overlaps(qs[i])) {
+        expect.push_back(j);
+      }
+    }
+    REQUIRE(rs[i] == expect);
+  }
+}
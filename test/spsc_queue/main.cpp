@@ -0,0 +1,103 @@
+#include "container/spsc_queue.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("SPSC Queue Push Pop Test 1") {
+  container::spsc_queue<int, 4> q;
+  REQUIRE(q.empty());
+  REQUIRE(q.try_push(1));
+  REQUIRE(q.try_push(2));
+  REQUIRE(q.try_push(3));
+  REQUIRE(q.try_push(4));
+  REQUIRE_FALSE(q.try_push(5));
+  REQUIRE(q.size() == 4);
+  REQUIRE(q.try_pop() == std::make_optional(1));
+  int x = 0;
+  REQUIRE(q.try_pop(x));
+  REQUIRE(x == 2);
+  REQUIRE(q.try_push(5));
+  REQUIRE(q.try_pop() == std::make_optional(3));
+  REQUIRE(q.try_pop() == std::make_optional(4));
+  REQUIRE(q.try_pop() == std::make_optional(5));
+  REQUIRE(q.try_pop() == std::nullopt);
+  REQUIRE_FALSE(q.try_pop(x));
+}
+
+TEST_CASE("SPSC Queue Batch Wrap Test 1") {
+  // 1度に書き込む区間がリングの末尾で折り返す場合を含めて確かめる
+  container::spsc_queue<int, 8> q;
+  std::vector<int> in(8), out(8);
+  int next = 0, expected = 0;
+  for (int round = 0; round < 100; round++) {
+    const std::size_t n = 1 + round % 7;
+    for (std::size_t i = 0; i < n; i++) {
+      in[i] = next + i;
+    }
+    const std::size_t pushed = q.try_push_n(in.data(), n);
+    next += pushed;
+    const std::size_t popped = q.try_pop_n(out.data(), 1 + round % 5);
+    for (std::size_t i = 0; i < popped; i++) {
+      REQUIRE(out[i] == expected++);
+    }
+  }
+  const std::size_t rest = next - expected;
+  REQUIRE(q.try_pop_n(out.data(), 8) == rest);
+  for (int i = 0; expected < next; i++) {
+    REQUIRE(out[i] == expected++);
+  }
+  REQUIRE(q.try_push_n(in.data(), 8) == 8);
+  REQUIRE(q.try_push_n(in.data(), 1) == 0);
+}
+
+TEST_CASE("SPSC Queue Non Trivial Test 1") {
+  container::spsc_queue<std::string, 4> q;
+  const std::string s[3] = {"alpha", "beta", "gamma"};
+  REQUIRE(q.try_push_n(s, 3) == 3);
+  REQUIRE(q.try_push(std::string(64, 'x')));
+  std::string out[2];
+  REQUIRE(q.try_pop_n(out, 2) == 2);
+  REQUIRE(out[0] == "alpha");
+  REQUIRE(out[1] == "beta");
+  // 残りの要素はデストラクタで破棄される
+}
+
+TEST_CASE("SPSC Queue Two Threads Test 1") {
+  constexpr std::uint64_t n = 1'000'000;
+  container::spsc_queue<std::uint64_t, 1024> q;
+  std::atomic<std::uint64_t> mismatch = 0;
+  std::thread consumer([&] {
+    std::uint64_t buf[64];
+    for (std::uint64_t expected = 0; expected < n;) {
+      const std::size_t k = q.try_pop_n(buf, 64);
+      for (std::size_t i = 0; i < k; i++) {
+        if (buf[i] != expected++) {
+          mismatch++;
+        }
+      }
+      if (k == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::uint64_t buf[37];
+  for (std::uint64_t i = 0; i < n;) {
+    const std::size_t m = std::min<std::uint64_t>(37, n - i);
+    for (std::size_t j = 0; j < m; j++) {
+      buf[j] = i + j;
+    }
+    const std::size_t k = q.try_push_n(buf, m);
+    // 押し込めなかった分は次の回に作り直す
+    i += k;
+    if (k == 0) {
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+  REQUIRE(mismatch == 0);
+  REQUIRE(q.empty());
+}
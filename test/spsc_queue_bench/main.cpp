@@ -0,0 +1,157 @@
+//
+// spsc_queue のスループットのベンチマーク
+//
+// ネットワークスレッドからシミュレーションスレッドへパケットを渡す場面を想定し、
+// 生産者と消費者の2スレッドで64バイトのメッセージを受け渡す
+// 1要素ずつの try_push/try_pop と、まとめて渡す try_push_n/try_pop_n の毎秒のメッセージ数を測る
+// 比較として、mutex で保護した container::queue でも同じ受け渡しを行う
+//
+// usage: spsc_queue_bench [メッセージ数(既定 10000000)]
+//
+
+#include "container/queue.hpp"
+#include "container/spsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**< @brief パケットを模したメッセージ */
+struct message {
+  std::uint64_t seq;        /**< 通し番号 */
+  std::uint8_t payload[56]; /**< 本体 */
+};
+
+constexpr std::size_t capacity = 4096; /**< キューの容量 */
+constexpr std::size_t batch = 32;      /**< まとめて渡す要素数 */
+
+std::atomic<std::uint64_t> sink = 0; /**< 受け取った結果を捨てられないように集める */
+
+/**< @brief mutexで保護したcontainer::queue */
+struct locked_queue {
+  bool try_push(const message &m) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (q.full()) {
+      return false;
+    }
+    q.push(m);
+    return true;
+  }
+  bool try_pop(message &m) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (std::optional<message> x = q.pop(); x) {
+      m = *x;
+      return true;
+    }
+    return false;
+  }
+  std::mutex mtx;
+  container::queue<message> q{capacity};
+};
+
+/**< @brief 生産者と消費者のスレッドでn個のメッセージを受け渡し、毎秒のメッセージ数を返す */
+template <class Producer, class Consumer>
+double run(std::uint64_t n, Producer produce, Consumer consume) {
+  const auto s = clock_type::now();
+  std::thread consumer([&] { sink += consume(n); });
+  produce(n);
+  consumer.join();
+  const auto e = clock_type::now();
+  return n / std::chrono::duration<double>(e - s).count();
+}
+
+/**< @brief 1要素ずつ受け渡す */
+template <class Queue> double run_single(Queue &q, std::uint64_t n) {
+  return run(
+      n,
+      [&](std::uint64_t n) {
+        message m = {};
+        for (m.seq = 0; m.seq < n;) {
+          if (q.try_push(m)) {
+            m.seq++;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      },
+      [&](std::uint64_t n) {
+        std::uint64_t sum = 0;
+        message m;
+        for (std::uint64_t i = 0; i < n;) {
+          if (q.try_pop(m)) {
+            sum += m.seq;
+            i++;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+        return sum;
+      });
+}
+
+/**< @brief batch個ずつまとめて受け渡す */
+template <class Queue> double run_batch(Queue &q, std::uint64_t n) {
+  return run(
+      n,
+      [&](std::uint64_t n) {
+        message buf[batch] = {};
+        for (std::uint64_t i = 0; i < n;) {
+          const std::size_t m = std::min<std::uint64_t>(batch, n - i);
+          for (std::size_t j = 0; j < m; j++) {
+            buf[j].seq = i + j;
+          }
+          const std::size_t k = q.try_push_n(buf, m);
+          i += k;
+          if (k == 0) {
+            std::this_thread::yield();
+          }
+        }
+      },
+      [&](std::uint64_t n) {
+        std::uint64_t sum = 0;
+        message buf[batch];
+        for (std::uint64_t i = 0; i < n;) {
+          const std::size_t k = q.try_pop_n(buf, batch);
+          for (std::size_t j = 0; j < k; j++) {
+            sum += buf[j].seq;
+          }
+          i += k;
+          if (k == 0) {
+            std::this_thread::yield();
+          }
+        }
+        return sum;
+      });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                   : 10'000'000;
+  {
+    locked_queue q;
+    std::printf("mutex queue          : %8.2f Mmsg/s\n",
+                run_single(q, n) / 1e6);
+  }
+  {
+    container::spsc_queue<message, capacity> q;
+    std::printf("spsc_queue           : %8.2f Mmsg/s\n",
+                run_single(q, n) / 1e6);
+  }
+  {
+    container::spsc_queue<message, capacity> q;
+    std::printf("spsc_queue (batch %2zu): %8.2f Mmsg/s\n", batch,
+                run_batch(q, n) / 1e6);
+  }
+  std::printf("checksum: %llu\n",
+              static_cast<unsigned long long>(sink.load()));
+  return 0;
+}
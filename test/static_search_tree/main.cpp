@@ -0,0 +1,97 @@
+#include "container/static_search_tree.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+template <class Key> std::vector<Key> random_keys(std::size_t n) {
+  std::mt19937_64 rng(n);
+  std::vector<Key> keys(n);
+  for (Key &k : keys) {
+    if constexpr (std::is_floating_point_v<Key>) {
+      k = static_cast<Key>(std::uniform_real_distribution<>(-1e6, 1e6)(rng));
+    } else {
+      k = static_cast<Key>(rng());
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+template <class Key> void lower_bound_test(std::size_t n) {
+  const std::vector<Key> keys = random_keys<Key>(n);
+  std::vector<std::pair<Key, std::size_t>> items;
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    items.emplace_back(keys[i], i);
+  }
+  container::static_search_tree<Key, std::size_t> t(items.begin(),
+                                                    items.end());
+  REQUIRE(t.size() == keys.size());
+  std::vector<Key> queries(keys);
+  for (Key k : keys) {
+    queries.push_back(static_cast<Key>(k + 1));
+    queries.push_back(static_cast<Key>(k - 1));
+  }
+  queries.push_back(std::numeric_limits<Key>::lowest());
+  queries.push_back(std::numeric_limits<Key>::max());
+  std::vector<typename decltype(t)::const_iterator> batch;
+  t.lower_bound(queries.begin(), queries.end(), std::back_inserter(batch));
+  REQUIRE(batch.size() == queries.size());
+  for (std::size_t i = 0; i < queries.size(); i++) {
+    const Key q = queries[i];
+    const std::size_t r =
+        std::lower_bound(keys.begin(), keys.end(), q) - keys.begin();
+    REQUIRE(static_cast<std::size_t>(t.lower_bound(q) - t.begin()) == r);
+    REQUIRE(static_cast<std::size_t>(batch[i] - t.begin()) == r);
+    const bool found = r < keys.size() && keys[r] == q;
+    REQUIRE(t.find(q) == (found ? std::make_optional(r) : std::nullopt));
+  }
+}
+
+TEST_CASE("Static Search Tree Lower Bound Test 1") {
+  for (std::size_t n : {0, 1, 7, 8, 9, 16, 17, 153, 289, 4913, 20000}) {
+    lower_bound_test<std::int32_t>(n);
+    lower_bound_test<std::uint32_t>(n);
+    lower_bound_test<std::int64_t>(n);
+    lower_bound_test<std::uint64_t>(n);
+    lower_bound_test<float>(n);
+    lower_bound_test<double>(n);
+  }
+}
+
+TEST_CASE("Static Search Tree String Keys Test 1") {
+  std::vector<std::pair<std::string, int>> items;
+  for (int i = 0; i < 1000; i += 2) {
+    items.emplace_back(std::to_string(100000 + i), i);
+  }
+  container::static_search_tree<std::string, int> t(items.begin(),
+                                                    items.end());
+  REQUIRE(t.find("100000") == std::make_optional(0));
+  REQUIRE(t.find("100998") == std::make_optional(998));
+  REQUIRE(t.find("100001") == std::nullopt);
+  REQUIRE(t.lower_bound("100001")->second == 2);
+  REQUIRE(t.upper_bound("100002")->second == 4);
+  REQUIRE(t.lower_bound("2") == t.end());
+  REQUIRE(std::equal(t.begin(), t.end(), items.begin(), items.end()));
+
+  container::static_search_tree<std::string, int> u(std::move(t));
+  REQUIRE(t.empty());
+  REQUIRE(t.find("100000") == std::nullopt);
+  REQUIRE(u.find("100500") == std::make_optional(500));
+}
+
+TEST_CASE("Static Search Tree Duplicate Keys Test 1") {
+  std::vector<std::pair<int, int>> items = {{1, 0}, {2, 1}, {2, 2},
+                                            {2, 3}, {5, 4}, {5, 5}};
+  container::static_search_tree<int, int> t(items.begin(), items.end());
+  REQUIRE(t.lower_bound(2)->second == 1);
+  REQUIRE(t.upper_bound(2)->second == 4);
+  REQUIRE(t.lower_bound(5)->second == 4);
+  REQUIRE(t.upper_bound(5) == t.end());
+}
@@ -0,0 +1,99 @@
+//
+// static_search_tree と avl_tree、std::lower_bound(整列済み配列の2分探索)の比較ベンチマーク
+//
+// ランダムなキーの探索時間を測る. batch は lower_bound の範囲版(先読みあり)
+// AVX2の探索カーネルを測るには -mavx2 (または -march=native) を付けてビルドする
+//
+// usage: static_search_tree_bench [最大キー数(既定 1e7)]
+//
+
+#include "container/avl_tree.hpp"
+#include "container/static_search_tree.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using key_type = std::uint32_t;
+using clock_type = std::chrono::steady_clock;
+
+template <class F> double measure_ns(std::size_t n, F f) {
+  const auto s = clock_type::now();
+  f();
+  const auto e = clock_type::now();
+  return std::chrono::duration<double, std::nano>(e - s).count() / n;
+}
+
+void report(const char *name, std::size_t n, double ns, std::uint64_t sum) {
+  std::printf("%-10s %10zu %10.1f   (%llu)\n", name, n, ns,
+              static_cast<unsigned long long>(sum & 0xff));
+}
+
+void run(const std::vector<key_type> &keys,
+         const std::vector<key_type> &queries) {
+  const std::size_t n = keys.size(), q = queries.size();
+  std::vector<std::pair<key_type, key_type>> items;
+  for (key_type k : keys) {
+    items.emplace_back(k, k);
+  }
+  std::uint64_t sum = 0;
+
+  container::avl_tree<key_type, key_type> avl(n);
+  avl.build_from_sorted(items.begin(), items.end());
+  report("avl_tree", n, measure_ns(q, [&] {
+           for (key_type k : queries) {
+             sum += avl.lower_bound(k)->first;
+           }
+         }),
+         sum);
+
+  report("binary", n, measure_ns(q, [&] {
+           for (key_type k : queries) {
+             sum += *std::lower_bound(keys.begin(), keys.end(), k);
+           }
+         }),
+         sum);
+
+  container::static_search_tree<key_type, key_type> sst(items.begin(),
+                                                        items.end());
+  report("static", n, measure_ns(q, [&] {
+           for (key_type k : queries) {
+             sum += sst.lower_bound(k)->first;
+           }
+         }),
+         sum);
+
+  std::vector<decltype(sst)::const_iterator> out(q);
+  report("batch", n, measure_ns(q, [&] {
+           sst.lower_bound(queries.begin(), queries.end(), out.begin());
+           for (auto it : out) {
+             sum += it->first;
+           }
+         }),
+         sum);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  std::mt19937 rng(42);
+  std::printf("%-10s %10s %10s\n", "search", "keys", "[ns/op]");
+  for (std::size_t n = 1'000'000; n <= max_n; n *= 10) {
+    std::vector<key_type> keys(n);
+    for (std::size_t i = 0; i < n; i++) {
+      keys[i] = static_cast<key_type>(2 * i + 1);
+    }
+    std::vector<key_type> queries(n);
+    for (key_type &k : queries) {
+      k = static_cast<key_type>(rng() % (2 * n));
+    }
+    run(keys, queries);
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "container/task_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief タスクを再帰的に分けてフィボナッチ数を求める */
+std::uint64_t fib(container::task_pool &pool, int n) {
+  if (n < 12) {
+    return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+  }
+  container::task_group g;
+  std::uint64_t x = 0;
+  pool.spawn(g, [&] { x = fib(pool, n - 1); });
+  const std::uint64_t y = fib(pool, n - 2);
+  pool.wait(g);
+  return x + y;
+}
+
+} // namespace
+
+TEST_CASE("Task Pool Run Test 1") {
+  container::task_pool pool(4);
+  REQUIRE(pool.size() == 4);
+  std::atomic<int> count = 0;
+  pool.run([&] {
+    container::task_group g;
+    for (int i = 0; i < 1000; i++) {
+      pool.spawn(g, [&] { count++; });
+    }
+    pool.wait(g);
+    REQUIRE(!g.busy());
+  });
+  REQUIRE(count == 1000);
+}
+
+TEST_CASE("Task Pool Nested Wait Test 1") {
+  for (std::size_t threads : {1, 2, 4}) {
+    container::task_pool pool(threads);
+    std::uint64_t r = 0;
+    pool.run([&] { r = fib(pool, 27); });
+    REQUIRE(r == 196418);
+  }
+}
+
+TEST_CASE("Task Pool Reuse Test 1") {
+  // 眠ったワーカーが次のrunのタスクで起きることを確かめる
+  container::task_pool pool(3);
+  std::vector<int> v(1 << 16);
+  for (int round = 0; round < 20; round++) {
+    pool.run([&] {
+      container::task_group g;
+      for (std::size_t b = 0; b < v.size(); b += 4096) {
+        pool.spawn(g, [&, b] {
+          std::iota(v.begin() + b, v.begin() + b + 4096, static_cast<int>(b));
+        });
+      }
+      pool.wait(g);
+    });
+    if (round % 5 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::vector<int> w(v.size());
+    std::iota(w.begin(), w.end(), 0);
+    REQUIRE(v == w);
+    std::fill(v.begin(), v.end(), -1);
+  }
+}
+
+TEST_CASE("Task Pool Run Inside Task Test 1") {
+  // タスクの中からのrunはそのまま実行する
+  container::task_pool pool(2);
+  int r = 0;
+  pool.run([&] {
+    container::task_group g;
+    pool.spawn(g, [&] { pool.run([&] { r = 42; }); });
+    pool.wait(g);
+  });
+  REQUIRE(r == 42);
+}
@@ -0,0 +1,86 @@
+#include "container/ws_deque.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Work Stealing Deque Push Pop Test 1") {
+  container::ws_deque<int> d(2);
+  REQUIRE(d.empty());
+  REQUIRE(d.pop() == std::nullopt);
+  REQUIRE(d.steal() == std::nullopt);
+  for (int i = 0; i < 100; i++) { // 配列の差し替えを何度か起こす
+    d.push(i);
+  }
+  REQUIRE(d.size() == 100);
+  REQUIRE(d.capacity() == 128);
+  // 所有者は末尾(LIFO)、盗み手は先頭(FIFO)から取り出す
+  REQUIRE(d.pop() == std::make_optional(99));
+  REQUIRE(d.steal() == std::make_optional(0));
+  REQUIRE(d.steal() == std::make_optional(1));
+  REQUIRE(d.pop() == std::make_optional(98));
+  for (int i = 2; i < 98; i++) {
+    REQUIRE(d.steal() == std::make_optional(i));
+  }
+  REQUIRE(d.steal() == std::nullopt);
+  REQUIRE(d.pop() == std::nullopt);
+  d.push(7);
+  REQUIRE(d.pop() == std::make_optional(7));
+  REQUIRE(d.empty());
+}
+
+TEST_CASE("Work Stealing Deque Stress Test 1") {
+  // 所有者がpushとpopを繰り返す間に盗み手がstealし続け、
+  // 全ての要素がちょうど1回ずつ取り出されること、
+  // 各盗み手が取り出す要素が挿入順(昇順)に並ぶことを確かめる
+  constexpr std::uint32_t n = 200'000;
+  constexpr std::size_t thieves = 4;
+  container::ws_deque<std::uint32_t> d(4);
+  std::unique_ptr<std::atomic<std::uint8_t>[]> taken(
+      new std::atomic<std::uint8_t>[n]());
+  std::atomic<std::uint32_t> count = 0, mismatch = 0;
+  std::atomic<bool> done = false;
+  std::vector<std::thread> ts;
+  for (std::size_t i = 0; i < thieves; i++) {
+    ts.emplace_back([&] {
+      std::int64_t last = -1;
+      while (!done.load(std::memory_order_acquire) || !d.empty()) {
+        if (std::optional<std::uint32_t> x = d.steal(); x) {
+          if (taken[*x]++ != 0 || static_cast<std::int64_t>(*x) <= last) {
+            mismatch++;
+          }
+          last = *x;
+          count++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  auto take = [&](std::uint32_t x) {
+    if (taken[x]++ != 0) {
+      mismatch++;
+    }
+    count++;
+  };
+  for (std::uint32_t i = 0; i < n; i++) {
+    d.push(i);
+    if (i % 3 == 0) {
+      if (std::optional<std::uint32_t> x = d.pop(); x) {
+        take(*x);
+      }
+    }
+  }
+  while (std::optional<std::uint32_t> x = d.pop()) {
+    take(*x);
+  }
+  done.store(true, std::memory_order_release);
+  for (auto &t : ts) {
+    t.join();
+  }
+  REQUIRE(mismatch == 0);
+  REQUIRE(count == n);
+}
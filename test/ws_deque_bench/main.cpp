@@ -0,0 +1,127 @@
+//
+// ws_deque の盗み手の数に対するスループットのベンチマーク
+//
+// 所有者のスレッドが小さなタスクを push し、時々自分でも pop して処理する間に、
+// 盗み手のスレッドが先頭から steal して処理する. 全体で毎秒いくつのタスクを処理できたかを測る
+// 比較として、mutex で保護した std::deque でも同じことを行う
+//
+// usage: ws_deque_bench [タスク数(既定 4000000)] [最大盗み手数(既定 16)]
+//
+
+#include "container/ws_deque.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+std::atomic<std::uint64_t> sink = 0; /**< 処理結果を捨てられないように集める */
+
+/**< @brief mutexで保護したstd::deque */
+struct locked_deque {
+  void push(std::uint64_t x) {
+    std::lock_guard<std::mutex> lock(m);
+    d.push_back(x);
+  }
+  std::optional<std::uint64_t> pop() {
+    std::lock_guard<std::mutex> lock(m);
+    if (d.empty()) {
+      return std::nullopt;
+    }
+    const std::uint64_t x = d.back();
+    d.pop_back();
+    return x;
+  }
+  std::optional<std::uint64_t> steal() {
+    std::lock_guard<std::mutex> lock(m);
+    if (d.empty()) {
+      return std::nullopt;
+    }
+    const std::uint64_t x = d.front();
+    d.pop_front();
+    return x;
+  }
+  std::mutex m;
+  std::deque<std::uint64_t> d;
+};
+
+/**< @brief タスクの処理(少しだけ計算する) */
+inline std::uint64_t work(std::uint64_t x) noexcept {
+  for (int i = 0; i < 16; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return x;
+}
+
+/**< @brief 所有者がn個のタスクを作り、thieves個の盗み手と分け合って処理する. 毎秒のタスク数を返す */
+template <class Deque> double run(std::size_t thieves, std::uint64_t n) {
+  Deque d;
+  std::atomic<std::uint64_t> done = 0;
+  std::vector<std::thread> ts;
+  const auto s = clock_type::now();
+  for (std::size_t i = 0; i < thieves; i++) {
+    ts.emplace_back([&] {
+      std::uint64_t sum = 0, k = 0;
+      while (done.load(std::memory_order_relaxed) < n) {
+        if (std::optional<std::uint64_t> x = d.steal(); x) {
+          sum += work(*x);
+          k++;
+        } else {
+          if (k > 0) {
+            done += k;
+            k = 0;
+          }
+          std::this_thread::yield();
+        }
+      }
+      sink += sum;
+    });
+  }
+  std::uint64_t sum = 0, k = 0;
+  for (std::uint64_t i = 0; i < n; i++) {
+    d.push(i);
+    if (i % 4 == 0) { // 所有者も時々自分で処理する
+      if (std::optional<std::uint64_t> x = d.pop(); x) {
+        sum += work(*x);
+        k++;
+      }
+    }
+  }
+  while (std::optional<std::uint64_t> x = d.pop()) {
+    sum += work(*x);
+    k++;
+  }
+  done += k;
+  for (auto &t : ts) {
+    t.join();
+  }
+  const auto e = clock_type::now();
+  sink += sum;
+  return n / std::chrono::duration<double>(e - s).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                   : 4'000'000;
+  const std::size_t max_thieves =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+  std::printf("%7s %12s %12s (Mtasks/s)\n", "thieves", "mutex", "ws_deque");
+  for (std::size_t t = 0; t <= max_thieves; t = t == 0 ? 1 : 2 * t) {
+    std::printf("%7zu %12.2f %12.2f\n", t, run<locked_deque>(t, n) / 1e6,
+                run<container::ws_deque<std::uint64_t>>(t, n) / 1e6);
+  }
+  std::printf("checksum: %llu\n",
+              static_cast<unsigned long long>(sink.load()));
+  return 0;
+}